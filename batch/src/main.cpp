@@ -0,0 +1,968 @@
+// Headless batch runner for the Magic.TXD mass tools.
+// Runs txdgen, txdbuild and txdexport jobs without the editor, scheduling
+// them across a configurable number of worker threads and reporting progress
+// as one JSON object per line on stdout.
+
+#include "mainwindow.h"
+
+#include "../../src/tools/txdgen.h"
+#include "../../src/tools/txdbuild.h"
+#include "../../src/tools/txdexport.h"
+
+#include "../../src/tools/dirtools.h"
+
+#include <gtaconfig/include.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <list>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// Converts using the C locale, which is what the command line and the config files are in.
+static inline std::wstring batch_ansi_to_wide( const char *str )
+{
+    size_t wideLen = mbstowcs( NULL, str, 0 );
+
+    if ( wideLen == (size_t)-1 )
+    {
+        // Not valid in this locale, so just widen the bytes.
+        std::wstring result;
+
+        for ( const char *iter = str; *iter != 0; iter++ )
+        {
+            result += (wchar_t)(unsigned char)*iter;
+        }
+
+        return result;
+    }
+
+    std::vector <wchar_t> wideBuf( wideLen + 1 );
+
+    mbstowcs( wideBuf.data(), str, wideBuf.size() );
+
+    return std::wstring( wideBuf.data(), wideLen );
+}
+
+static inline std::string batch_wide_to_utf8( const std::wstring& str )
+{
+    return (std::wstring_convert <std::codecvt_utf8 <wchar_t>, wchar_t> ()).to_bytes( str );
+}
+
+// Case-insensitive ASCII compare, since stricmp is not available everywhere.
+static int batch_stricmp( const char *left, const char *right )
+{
+    while ( true )
+    {
+        int leftChar = tolower( (unsigned char)*left );
+        int rightChar = tolower( (unsigned char)*right );
+
+        if ( leftChar != rightChar || leftChar == 0 )
+        {
+            return ( leftChar - rightChar );
+        }
+
+        left++;
+        right++;
+    }
+}
+
+// Escapes a UTF-8 string so that it can be put between quotes in a JSON document.
+static std::string json_escape( const std::string& str )
+{
+    std::string result;
+    result.reserve( str.size() + 2 );
+
+    for ( char c : str )
+    {
+        if ( c == '\"' )
+        {
+            result += "\\\"";
+        }
+        else if ( c == '\\' )
+        {
+            result += "\\\\";
+        }
+        else if ( c == '\n' )
+        {
+            result += "\\n";
+        }
+        else if ( c == '\r' )
+        {
+            result += "\\r";
+        }
+        else if ( c == '\t' )
+        {
+            result += "\\t";
+        }
+        else if ( (unsigned char)c < 0x20 )
+        {
+            char escBuf[ 8 ];
+            snprintf( escBuf, sizeof( escBuf ), "\\u%04x", (unsigned int)(unsigned char)c );
+
+            result += escBuf;
+        }
+        else
+        {
+            result += c;
+        }
+    }
+
+    return result;
+}
+
+static std::string json_number( double value )
+{
+    char numBuf[ 32 ];
+    snprintf( numBuf, sizeof( numBuf ), "%.6f", value );
+
+    return numBuf;
+}
+
+enum eBatchToolType
+{
+    BATCHTOOL_TXDGEN,
+    BATCHTOOL_TXDBUILD,
+    BATCHTOOL_TXDEXPORT
+};
+
+static const char* GetBatchToolName( eBatchToolType toolType )
+{
+    if ( toolType == BATCHTOOL_TXDGEN )
+    {
+        return "txdgen";
+    }
+    else if ( toolType == BATCHTOOL_TXDBUILD )
+    {
+        return "txdbuild";
+    }
+    else if ( toolType == BATCHTOOL_TXDEXPORT )
+    {
+        return "txdexport";
+    }
+
+    return "unknown";
+}
+
+// A single unit of work, described by a job configuration file.
+// The [Main] section selects the tool using the "tool" key; all other keys are the
+// same as the ones the editor stores for the respective tool.
+struct batchJob
+{
+    eBatchToolType toolType = BATCHTOOL_TXDGEN;
+    std::wstring cfgPath;
+
+    TxdGenModule::run_config txdgenConfig;
+    TxdBuildModule::run_config txdbuildConfig;
+    MassExportModule::run_config txdexportConfig;
+};
+
+// Files of a running job that idle workers can help with.
+struct batchFileSet
+{
+    rw::parallelWorkItemCallback_t cb;
+    void *ud;
+    size_t itemCount;
+    size_t nextItem;
+
+    size_t activeHelpers;
+
+    // Helpers run with the configuration of this thread.
+    rw::thread_t ownerThread;
+
+    std::exception_ptr error;
+};
+
+struct batchRunner
+{
+    inline batchRunner( rw::Interface *rwEngine )
+    {
+        this->rwEngine = rwEngine;
+        this->lockOutput = rw::CreateReadWriteLock( rwEngine );
+        this->nextJob = 0;
+        this->runningJobCount = 0;
+        this->failedJobCount = 0;
+        this->verbose = false;
+    }
+
+    inline ~batchRunner( void )
+    {
+        rw::CloseReadWriteLock( this->rwEngine, this->lockOutput );
+    }
+
+    // Writes one complete JSON line; lines from different workers never interleave.
+    void EmitLine( const std::string& jsonObject )
+    {
+        rw::scoped_rwlock_writer <> ctxOutput( this->lockOutput );
+
+        fputs( jsonObject.c_str(), stdout );
+        fputc( '\n', stdout );
+        fflush( stdout );
+    }
+
+    void EmitMessage( size_t jobIndex, const std::string& utf8msg )
+    {
+        if ( !this->verbose )
+            return;
+
+        this->EmitLine(
+            "{\"event\":\"log\",\"job\":" + std::to_string( jobIndex ) +
+            ",\"text\":\"" + json_escape( utf8msg ) + "\"}"
+        );
+    }
+
+    void EmitFileProcessed( size_t jobIndex, const filePath& relPath, double seconds, bool hasDoneAnyWork )
+    {
+        this->EmitLine(
+            "{\"event\":\"file\",\"job\":" + std::to_string( jobIndex ) +
+            ",\"path\":\"" + json_escape( batch_wide_to_utf8( relPath.convert_unicode() ) ) +
+            "\",\"seconds\":" + json_number( seconds ) +
+            ",\"work\":" + ( hasDoneAnyWork ? "true" : "false" ) + "}"
+        );
+    }
+
+    void WorkerMain( rw::thread_t threadHandle );
+
+    void RunJob( size_t jobIndex, rw::thread_t threadHandle );
+
+    void ProcessFileSet( rw::thread_t ownerThread, size_t itemCount, rw::parallelWorkItemCallback_t cb, void *ud );
+
+    rw::Interface *rwEngine;
+
+    std::vector <batchJob> jobs;
+
+    bool verbose;
+
+    size_t failedJobCount;
+
+private:
+    void RunFileSetItems( batchFileSet& fileSet );
+    void HelpFileSet( batchFileSet& fileSet );
+
+    // Requires lockJobs.
+    batchFileSet* FindOpenFileSet( void );
+
+    std::mutex lockJobs;
+    std::condition_variable workChanged;
+
+    rw::rwlock *lockOutput;
+
+    size_t nextJob;
+    size_t runningJobCount;
+
+    std::list <batchFileSet*> fileSets;
+};
+
+// Connects a tool module to the runner output.
+template <typename moduleType>
+struct BatchToolModule : public moduleType
+{
+    inline BatchToolModule( rw::Interface *rwEngine, batchRunner *runner, size_t jobIndex, rw::thread_t jobThread ) : moduleType( rwEngine )
+    {
+        this->runner = runner;
+        this->jobIndex = jobIndex;
+        this->jobThread = jobThread;
+        this->fileCount = 0;
+    }
+
+    void OnMessage( const std::string& msg ) override
+    {
+        runner->EmitMessage( this->jobIndex, batch_wide_to_utf8( batch_ansi_to_wide( msg.c_str() ) ) );
+    }
+
+    void OnMessage( const std::wstring& msg ) override
+    {
+        runner->EmitMessage( this->jobIndex, batch_wide_to_utf8( msg ) );
+    }
+
+    CFile* WrapStreamCodec( CFile *compressed ) override
+    {
+        // The stream codecs live in the editor; the batch runner processes files as they are.
+        return compressed;
+    }
+
+    void OnFileProcessed( const filePath& relPath, double seconds, bool hasDoneAnyWork ) override
+    {
+        this->fileCount++;
+
+        runner->EmitFileProcessed( this->jobIndex, relPath, seconds, hasDoneAnyWork );
+    }
+
+    void ProcessWorkItems( size_t itemCount, rw::parallelWorkItemCallback_t cb, void *ud ) override
+    {
+        runner->ProcessFileSet( this->jobThread, itemCount, cb, ud );
+    }
+
+    batchRunner *runner;
+    size_t jobIndex;
+    rw::thread_t jobThread;
+
+    // Counted by whichever worker finished the file.
+    std::atomic <size_t> fileCount;
+};
+
+struct BatchExportModule : public BatchToolModule <MassExportModule>
+{
+    inline BatchExportModule( rw::Interface *rwEngine, batchRunner *runner, size_t jobIndex, rw::thread_t jobThread ) : BatchToolModule( rwEngine, runner, jobIndex, jobThread )
+    {
+        return;
+    }
+
+    void OnProcessingFile( const std::wstring& fileName ) override
+    {
+        runner->EmitMessage( this->jobIndex, "processing " + batch_wide_to_utf8( fileName ) + "\n" );
+    }
+};
+
+void batchRunner::RunJob( size_t jobIndex, rw::thread_t threadHandle )
+{
+    const batchJob& job = this->jobs[ jobIndex ];
+
+    rw::Interface *rwEngine = this->rwEngine;
+
+    this->EmitLine(
+        "{\"event\":\"job_start\",\"job\":" + std::to_string( jobIndex ) +
+        ",\"tool\":\"" + GetBatchToolName( job.toolType ) +
+        "\",\"config\":\"" + json_escape( batch_wide_to_utf8( job.cfgPath ) ) + "\"}"
+    );
+
+    auto timeStart = std::chrono::steady_clock::now();
+
+    bool success = false;
+    size_t fileCount = 0;
+    std::string errorMessage;
+
+    // Jobs configure the engine for themselves, so every job needs its own configuration.
+    // We assign it per job because tools like txdbuild release it when they are done.
+    rw::AssignThreadedRuntimeConfig( rwEngine );
+
+    try
+    {
+        if ( job.toolType == BATCHTOOL_TXDGEN )
+        {
+            BatchToolModule <TxdGenModule> module( rwEngine, this, jobIndex, threadHandle );
+
+            success = module.ApplicationMain( job.txdgenConfig );
+
+            fileCount = module.fileCount;
+        }
+        else if ( job.toolType == BATCHTOOL_TXDBUILD )
+        {
+            BatchToolModule <TxdBuildModule> module( rwEngine, this, jobIndex, threadHandle );
+
+            success = module.RunApplication( job.txdbuildConfig );
+
+            fileCount = module.fileCount;
+        }
+        else if ( job.toolType == BATCHTOOL_TXDEXPORT )
+        {
+            BatchExportModule module( rwEngine, this, jobIndex, threadHandle );
+
+            success = module.ApplicationMain( job.txdexportConfig );
+
+            fileCount = module.fileCount;
+        }
+    }
+    catch( rw::RwException& except )
+    {
+        errorMessage = except.message;
+    }
+    catch( std::exception& except )
+    {
+        errorMessage = except.what();
+    }
+
+    rw::ReleaseThreadedRuntimeConfig( rwEngine );
+
+    std::chrono::duration <double> timeTaken = ( std::chrono::steady_clock::now() - timeStart );
+
+    if ( !success )
+    {
+        std::lock_guard <std::mutex> ctxJobs( this->lockJobs );
+
+        this->failedJobCount++;
+    }
+
+    std::string jobEndLine =
+        "{\"event\":\"job_end\",\"job\":" + std::to_string( jobIndex ) +
+        ",\"success\":" + ( success ? "true" : "false" ) +
+        ",\"files\":" + std::to_string( fileCount ) +
+        ",\"seconds\":" + json_number( timeTaken.count() );
+
+    if ( !errorMessage.empty() )
+    {
+        jobEndLine += ",\"error\":\"" + json_escape( errorMessage ) + "\"";
+    }
+
+    jobEndLine += "}";
+
+    this->EmitLine( jobEndLine );
+}
+
+batchFileSet* batchRunner::FindOpenFileSet( void )
+{
+    for ( batchFileSet *fileSet : this->fileSets )
+    {
+        if ( fileSet->error == nullptr && fileSet->nextItem < fileSet->itemCount )
+        {
+            return fileSet;
+        }
+    }
+
+    return NULL;
+}
+
+void batchRunner::RunFileSetItems( batchFileSet& fileSet )
+{
+    while ( true )
+    {
+        size_t itemIndex;
+        {
+            std::lock_guard <std::mutex> ctxJobs( this->lockJobs );
+
+            if ( fileSet.error != nullptr || fileSet.nextItem >= fileSet.itemCount )
+                break;
+
+            itemIndex = fileSet.nextItem++;
+        }
+
+        try
+        {
+            fileSet.cb( fileSet.ud, itemIndex );
+        }
+        catch( ... )
+        {
+            // The owner rethrows it; the remaining items are skipped.
+            std::lock_guard <std::mutex> ctxJobs( this->lockJobs );
+
+            if ( fileSet.error == nullptr )
+            {
+                fileSet.error = std::current_exception();
+            }
+        }
+    }
+}
+
+void batchRunner::HelpFileSet( batchFileSet& fileSet )
+{
+    rw::Interface *rwEngine = this->rwEngine;
+
+    try
+    {
+        rw::InheritThreadedRuntimeConfig( rwEngine, fileSet.ownerThread );
+    }
+    catch( ... )
+    {
+        // Then we cannot help; the owner does the work itself.
+        return;
+    }
+
+    this->RunFileSetItems( fileSet );
+
+    rw::ReleaseThreadedRuntimeConfig( rwEngine );
+}
+
+void batchRunner::ProcessFileSet( rw::thread_t ownerThread, size_t itemCount, rw::parallelWorkItemCallback_t cb, void *ud )
+{
+    // Without a thread handle nobody could take our configuration, so we stay on our own.
+    if ( ownerThread == NULL )
+    {
+        for ( size_t n = 0; n < itemCount; n++ )
+        {
+            cb( ud, n );
+        }
+
+        return;
+    }
+
+    batchFileSet fileSet;
+    fileSet.cb = cb;
+    fileSet.ud = ud;
+    fileSet.itemCount = itemCount;
+    fileSet.nextItem = 0;
+    fileSet.activeHelpers = 0;
+    fileSet.ownerThread = ownerThread;
+
+    {
+        std::lock_guard <std::mutex> ctxJobs( this->lockJobs );
+
+        this->fileSets.push_back( &fileSet );
+    }
+
+    this->workChanged.notify_all();
+
+    // We take part in the work, too.
+    this->RunFileSetItems( fileSet );
+
+    {
+        std::unique_lock <std::mutex> ctxJobs( this->lockJobs );
+
+        // Helpers could still be busy with the last items.
+        while ( fileSet.activeHelpers != 0 )
+        {
+            this->workChanged.wait( ctxJobs );
+        }
+
+        this->fileSets.remove( &fileSet );
+    }
+
+    if ( fileSet.error != nullptr )
+    {
+        std::rethrow_exception( fileSet.error );
+    }
+}
+
+void batchRunner::WorkerMain( rw::thread_t threadHandle )
+{
+    std::unique_lock <std::mutex> ctxJobs( this->lockJobs );
+
+    while ( true )
+    {
+        // Whole jobs come first, since they do not share anything.
+        if ( this->nextJob < this->jobs.size() )
+        {
+            size_t jobIndex = this->nextJob++;
+
+            this->runningJobCount++;
+
+            ctxJobs.unlock();
+
+            this->RunJob( jobIndex, threadHandle );
+
+            ctxJobs.lock();
+
+            this->runningJobCount--;
+
+            this->workChanged.notify_all();
+            continue;
+        }
+
+        // Otherwise we help the running jobs with their files.
+        if ( batchFileSet *fileSet = this->FindOpenFileSet() )
+        {
+            fileSet->activeHelpers++;
+
+            ctxJobs.unlock();
+
+            this->HelpFileSet( *fileSet );
+
+            ctxJobs.lock();
+
+            fileSet->activeHelpers--;
+
+            this->workChanged.notify_all();
+            continue;
+        }
+
+        // Running jobs can still open file sets, so we only leave once all of them are done.
+        if ( this->runningJobCount == 0 )
+            break;
+
+        this->workChanged.wait( ctxJobs );
+    }
+}
+
+static void batchWorkerEntry( rw::thread_t threadHandle, rw::Interface *rwEngine, void *ud )
+{
+    batchRunner *runner = (batchRunner*)ud;
+
+    runner->WorkerMain( threadHandle );
+}
+
+static bool ParseBatchJob( const TxdGenModule& txdgenParser, const std::wstring& cfgPath, batchJob& jobOut, std::string& errOut )
+{
+    // Split the path into the directory and the configuration file.
+    filePath cfgDir;
+    filePath cfgFileName = FileSystem::GetFileNameItem( cfgPath.c_str(), true, &cfgDir, NULL );
+
+    if ( cfgDir.size() == 0 )
+    {
+        cfgDir = L"./";
+    }
+
+    CFileTranslator *cfgRoot = NULL;
+
+    if ( !obtainAbsolutePath( cfgDir.convert_unicode().c_str(), cfgRoot, false ) )
+    {
+        errOut = "job configuration directory not found";
+        return false;
+    }
+
+    bool success = false;
+
+    try
+    {
+        CFile *cfgStream = cfgRoot->Open( cfgFileName, "rb" );
+
+        if ( !cfgStream )
+        {
+            errOut = "failed to open job configuration";
+        }
+        else
+        {
+            CINI *configFile = LoadINI( cfgStream );
+
+            delete cfgStream;
+
+            CINI::Entry *mainEntry = NULL;
+
+            if ( configFile )
+            {
+                mainEntry = configFile->GetEntry( "Main" );
+            }
+
+            if ( !mainEntry )
+            {
+                errOut = "job configuration has no [Main] section";
+            }
+            else
+            {
+                jobOut.cfgPath = cfgPath;
+
+                const char *toolName = mainEntry->Get( "tool" );
+
+                if ( toolName == NULL || batch_stricmp( toolName, "txdgen" ) == 0 )
+                {
+                    jobOut.toolType = BATCHTOOL_TXDGEN;
+
+                    // Use the very same parser as the stand-alone txdgen tool.
+                    jobOut.txdgenConfig = txdgenParser.ParseConfig( cfgRoot, cfgFileName );
+
+                    success = true;
+                }
+                else if ( batch_stricmp( toolName, "txdbuild" ) == 0 )
+                {
+                    TxdBuildModule::run_config& cfg = jobOut.txdbuildConfig;
+
+                    jobOut.toolType = BATCHTOOL_TXDBUILD;
+
+                    if ( const char *gameRoot = mainEntry->Get( "gameRoot" ) )
+                    {
+                        cfg.gameRoot = batch_ansi_to_wide( gameRoot );
+                    }
+
+                    if ( const char *outputRoot = mainEntry->Get( "outputRoot" ) )
+                    {
+                        cfg.outputRoot = batch_ansi_to_wide( outputRoot );
+                    }
+
+                    if ( const char *targetPlatform = mainEntry->Get( "targetPlatform" ) )
+                    {
+                        rwkind::GetTargetPlatformFromFriendlyString( targetPlatform, cfg.targetPlatform );
+                    }
+
+                    if ( const char *targetVersion = mainEntry->Get( "targetVersion" ) )
+                    {
+                        rwkind::GetTargetGameFromFriendlyString( targetVersion, cfg.targetGame );
+                    }
+
+                    cfg.generateMipmaps = mainEntry->GetBool( "generateMipmaps", cfg.generateMipmaps );
+                    cfg.curMipMaxLevel = mainEntry->GetInt( "mipGenMaxLevel", cfg.curMipMaxLevel );
+                    cfg.doCompress = mainEntry->GetBool( "compressTextures", cfg.doCompress );
+                    cfg.compressionQuality = (float)mainEntry->GetFloat( "compressionQuality", cfg.compressionQuality );
+                    cfg.doPalettize = mainEntry->GetBool( "palettizeTextures", cfg.doPalettize );
+
+                    if ( const char *paletteType = mainEntry->Get( "paletteType" ) )
+                    {
+                        if ( batch_stricmp( paletteType, "PAL4" ) == 0 )
+                        {
+                            cfg.paletteType = rw::PALETTE_4BIT;
+                        }
+                        else if ( batch_stricmp( paletteType, "PAL8" ) == 0 )
+                        {
+                            cfg.paletteType = rw::PALETTE_8BIT;
+                        }
+                    }
+
+                    success = true;
+                }
+                else if ( batch_stricmp( toolName, "txdexport" ) == 0 )
+                {
+                    MassExportModule::run_config& cfg = jobOut.txdexportConfig;
+
+                    jobOut.toolType = BATCHTOOL_TXDEXPORT;
+
+                    if ( const char *gameRoot = mainEntry->Get( "gameRoot" ) )
+                    {
+                        cfg.gameRoot = batch_ansi_to_wide( gameRoot );
+                    }
+
+                    if ( const char *outputRoot = mainEntry->Get( "outputRoot" ) )
+                    {
+                        cfg.outputRoot = batch_ansi_to_wide( outputRoot );
+                    }
+
+                    if ( const char *imageFormat = mainEntry->Get( "imageFormat" ) )
+                    {
+                        cfg.recImgFormat = imageFormat;
+                    }
+
+                    if ( const char *outputType = mainEntry->Get( "outputType" ) )
+                    {
+                        if ( batch_stricmp( outputType, "plain" ) == 0 )
+                        {
+                            cfg.outputType = MassExportModule::OUTPUT_PLAIN;
+                        }
+                        else if ( batch_stricmp( outputType, "txdname" ) == 0 )
+                        {
+                            cfg.outputType = MassExportModule::OUTPUT_TXDNAME;
+                        }
+                        else if ( batch_stricmp( outputType, "folders" ) == 0 )
+                        {
+                            cfg.outputType = MassExportModule::OUTPUT_FOLDERS;
+                        }
+                    }
+
+                    success = true;
+                }
+                else
+                {
+                    errOut = std::string( "unknown tool '" ) + toolName + "'";
+                }
+            }
+
+            if ( configFile )
+            {
+                delete configFile;
+            }
+        }
+    }
+    catch( ... )
+    {
+        delete cfgRoot;
+
+        throw;
+    }
+
+    delete cfgRoot;
+
+    return success;
+}
+
+static void PrintUsage( void )
+{
+    fputs(
+        "usage: rwbatch [-j <workers>] [-v] <job.ini> [<job.ini> ...]\n"
+        "  -j <workers>  number of worker threads (default: number of CPU cores); workers without\n"
+        "                a job of their own help the running jobs with their files\n"
+        "  -v            also report the log messages of the tools\n",
+        stderr
+    );
+}
+
+static int BatchMain( rw::Interface *rwEngine, int argc, char *argv[] )
+{
+    batchRunner runner( rwEngine );
+
+    unsigned int workerCount = std::thread::hardware_concurrency();
+
+    std::vector <std::wstring> jobPaths;
+
+    for ( int n = 1; n < argc; n++ )
+    {
+        const char *arg = argv[ n ];
+
+        if ( strcmp( arg, "-j" ) == 0 && n + 1 < argc )
+        {
+            int reqWorkerCount = atoi( argv[ ++n ] );
+
+            if ( reqWorkerCount > 0 )
+            {
+                workerCount = (unsigned int)reqWorkerCount;
+            }
+        }
+        else if ( strcmp( arg, "-v" ) == 0 )
+        {
+            runner.verbose = true;
+        }
+        else if ( arg[0] == '-' )
+        {
+            PrintUsage();
+            return -1;
+        }
+        else
+        {
+            jobPaths.push_back( batch_ansi_to_wide( arg ) );
+        }
+    }
+
+    if ( jobPaths.empty() )
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    // Read all jobs up front, so that configuration mistakes are reported before any work is done.
+    {
+        BatchToolModule <TxdGenModule> txdgenParser( rwEngine, &runner, 0, NULL );
+
+        bool allJobsValid = true;
+
+        for ( size_t n = 0; n < jobPaths.size(); n++ )
+        {
+            batchJob job;
+            std::string errMsg;
+
+            if ( ParseBatchJob( txdgenParser, jobPaths[ n ], job, errMsg ) )
+            {
+                runner.jobs.push_back( std::move( job ) );
+            }
+            else
+            {
+                runner.EmitLine(
+                    "{\"event\":\"config_error\",\"config\":\"" + json_escape( batch_wide_to_utf8( jobPaths[ n ] ) ) +
+                    "\",\"error\":\"" + json_escape( errMsg ) + "\"}"
+                );
+
+                allJobsValid = false;
+            }
+        }
+
+        if ( !allJobsValid )
+        {
+            return -1;
+        }
+    }
+
+    if ( workerCount == 0 )
+    {
+        workerCount = 1;
+    }
+
+    runner.EmitLine(
+        "{\"event\":\"batch_start\",\"jobs\":" + std::to_string( runner.jobs.size() ) +
+        ",\"workers\":" + std::to_string( workerCount ) + "}"
+    );
+
+    auto timeStart = std::chrono::steady_clock::now();
+
+    // Spawn the workers; they drain the job list and the files of the running jobs until nothing is left.
+    std::vector <rw::thread_t> workers;
+
+    for ( unsigned int n = 0; n < workerCount; n++ )
+    {
+        rw::thread_t workerThread = rw::MakeThread( rwEngine, batchWorkerEntry, &runner );
+
+        if ( workerThread == NULL )
+            break;
+
+        rw::ResumeThread( rwEngine, workerThread );
+
+        workers.push_back( workerThread );
+    }
+
+    // If we could not get any thread, we just do the work ourselves.
+    if ( workers.empty() )
+    {
+        batchWorkerEntry( NULL, rwEngine, &runner );
+    }
+
+    for ( rw::thread_t workerThread : workers )
+    {
+        rw::JoinThread( rwEngine, workerThread );
+        rw::CloseThread( rwEngine, workerThread );
+    }
+
+    std::chrono::duration <double> timeTaken = ( std::chrono::steady_clock::now() - timeStart );
+
+    runner.EmitLine(
+        "{\"event\":\"batch_end\",\"jobs\":" + std::to_string( runner.jobs.size() ) +
+        ",\"failed\":" + std::to_string( runner.failedJobCount ) +
+        ",\"seconds\":" + json_number( timeTaken.count() ) + "}"
+    );
+
+    return ( runner.failedJobCount == 0 ? 0 : 1 );
+}
+
+int main( int argc, char *argv[] )
+{
+    int iRet = -1;
+
+    // Same default engine version as the editor.
+    rw::LibraryVersion engineVersion;
+    engineVersion.rwLibMajor = 3;
+    engineVersion.rwLibMinor = 6;
+    engineVersion.rwRevMajor = 0;
+    engineVersion.rwRevMinor = 3;
+
+    rw::Interface *rwEngine = rw::CreateEngine( engineVersion );
+
+    if ( rwEngine == NULL )
+    {
+        fputs( "failed to initialize the RenderWare engine\n", stderr );
+        return -1;
+    }
+
+    try
+    {
+        // Typical engine properties; the tools override them per job.
+        rwEngine->SetIgnoreSerializationBlockRegions( true );
+        rwEngine->SetIgnoreSecureWarnings( false );
+
+        rwEngine->SetWarningLevel( 3 );
+
+        rwEngine->SetCompatTransformNativeImaging( true );
+        rwEngine->SetPreferPackedSampleExport( true );
+
+        rwEngine->SetDXTRuntime( rw::DXTRUNTIME_SQUISH );
+        rwEngine->SetPaletteRuntime( rw::PALRUNTIME_PNGQUANT );
+
+        rw::softwareMetaInfo metaInfo;
+        metaInfo.applicationName = "Magic.TXD batch runner";
+        metaInfo.applicationVersion = "1.0";
+        metaInfo.description = "headless txdgen/txdbuild/txdexport runner";
+
+        rwEngine->SetApplicationInfo( metaInfo );
+
+        InitializeBatchFileSystemWrap( rwEngine );
+
+        // Initialize the filesystem.
+        fs_construction_params fsParams;
+        fsParams.nativeExecMan = (NativeExecutive::CExecutiveManager*)rw::GetThreadingNativeManager( rwEngine );
+
+        CFileSystem *fsHandle = CFileSystem::Create( fsParams );
+
+        if ( !fsHandle )
+        {
+            throw std::runtime_error( "failed to initialize the FileSystem module" );
+        }
+
+        try
+        {
+            iRet = BatchMain( rwEngine, argc, argv );
+        }
+        catch( ... )
+        {
+            CFileSystem::Destroy( fsHandle );
+
+            throw;
+        }
+
+        CFileSystem::Destroy( fsHandle );
+    }
+    catch( rw::RwException& except )
+    {
+        fprintf( stderr, "uncaught RenderWare exception: %s\n", except.message.c_str() );
+
+        iRet = -1;
+    }
+    catch( std::exception& except )
+    {
+        fprintf( stderr, "uncaught C++ STL exception: %s\n", except.what() );
+
+        iRet = -2;
+    }
+
+    rw::DeleteEngine( rwEngine );
+
+    return iRet;
+}
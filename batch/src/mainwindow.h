@@ -0,0 +1,29 @@
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+// Headless stand-in for the editor umbrella header.
+// The shared tool sources (src/tools) include "mainwindow.h" first; in the batch runner
+// this header takes its place so that they compile against rwlib and FileSystem only.
+
+#include <assert.h>
+
+#include <string>
+#include <locale>
+#include <codecvt>
+
+#include <renderware.h>
+
+#include <sdk/MemoryUtils.h>
+
+#include <CFileSystemInterface.h>
+#include <CFileSystem.h>
+
+#define NUMELMS(x)      ( sizeof(x) / sizeof(*x) )
+
+#include "rwimageimporter.h"
+#include "rwfswrap.h"
+
+// Registers the "eirfs_file" RenderWare stream type that RwStreamCreateTranslated depends on.
+void InitializeBatchFileSystemWrap( rw::Interface *rwEngine );
+
+#endif //MAINWINDOW_H
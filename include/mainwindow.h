@@ -17,6 +17,9 @@
 #include <QAction>
 #include <QMessageBox>
 
+#include <map>
+#include <mutex>
+
 #include <renderware.h>
 
 #include <sdk/MemoryUtils.h>
@@ -71,6 +74,7 @@ struct magicThemeAwareItem abstract
 #include "guiserialization.h"
 #include "aboutdialog.h"
 #include "streamcompress.h"
+#include "texpreviewcache.h"
 #include "helperruntime.h"
 
 #include "MagicExport.h"
@@ -125,9 +129,14 @@ public:
     void updateAllTextureMetaInfo(void);
 
     void updateTextureView(void);
+    void updateTexturePreviews(void);
 
     void updateTextureViewport(void);
 
+    // Called by the texture preview cache.
+    void onTexturePreviewReady(rw::Raster *raster, eTexPreviewType type, const QPixmap& pixmap);
+    void onTexturePreviewFailed(rw::Raster *raster, eTexPreviewType type, const QString& errorMessage);
+
     bool saveCurrentTXDAt(QString location);
 
     void clearViewImage(void);
@@ -170,6 +179,9 @@ private:
 
     void UpdateTheme( void );
 
+    eTexPreviewType getTextureViewPreviewType( rw::Raster *raster ) const;
+    void showTextureViewPixmap( rw::Raster *raster, const QPixmap& pixmap );
+
 public:
     void NotifyChange( void );
 
@@ -178,6 +190,8 @@ private:
 
     void closeEvent( QCloseEvent *evt ) override;
 
+    void customEvent( QEvent *evt ) override;
+
     typedef std::function <void (void)> modifiedEndCallback_t;
 
     void ModifiedStateBarrier( bool blocking, modifiedEndCallback_t cb );
@@ -243,16 +257,36 @@ private:
             this->mainWnd = theWindow;
         }
 
+        void OnWarning(std::string&& msg) override;
+
+    private:
+        MainWindow *mainWnd;
+    };
+
+    rwPublicWarningDispatcher rwWarnMan;
+
+public:
+    // The log may only be used on the GUI thread, so worker threads install this
+    // on their own configuration and post what they collected to the window.
+    class rwWorkerWarningQueue : public rw::WarningManagerInterface
+    {
+    public:
         void OnWarning(std::string&& msg) override
         {
-            this->mainWnd->txdLog->addLogMessage(ansi_to_qt(msg), LOGMSG_WARNING);
+            // The worker pool shares our configuration, so this can be called concurrently.
+            std::lock_guard <std::mutex> lockMessages(this->lock);
+
+            this->messages.push_back(std::move(msg));
         }
 
+        void PostToWindow(MainWindow *mainWnd);
+
     private:
-        MainWindow *mainWnd;
+        std::mutex lock;
+        std::list <std::string> messages;
     };
 
-    rwPublicWarningDispatcher rwWarnMan;
+private:
 
     rw::Interface *rwEngine;
     rw::TexDictionary *currentTXD;
@@ -275,6 +309,11 @@ private:
 
     TexViewportWidget *imageView; // we handle full 2d-viewport as a scroll-area
     QLabel *imageWidget;    // we use label to put image on it
+    rw::Raster *viewedPreviewRaster;    // only for comparison, may be dangling
+
+    // List items by raster, so that finished thumbnails find their item quickly.
+    // Rebuilt by updateTexturePreviews.
+    std::multimap <rw::Raster*, TexInfoWidget*> thumbnailItems;
 
     QLabel *txdNameLabel;
 
@@ -2,6 +2,7 @@
 
 #include <QLabel>
 #include <QVBoxLayout>
+#include <QHBoxLayout>
 #include "languages.h"
 
 class TexInfoWidget : public QWidget, public magicTextLocalizationItem
@@ -14,13 +15,22 @@ public:
         texName->setObjectName("label19px");
         QLabel *texInfo = new QLabel(QString());
         texInfo->setObjectName("texInfo");
-        QVBoxLayout *layout = new QVBoxLayout();
+        QVBoxLayout *infoLayout = new QVBoxLayout();
+        infoLayout->setContentsMargins(0, 0, 0, 0);
+        infoLayout->addWidget(texName);
+        infoLayout->addWidget(texInfo);
+        // The preview is filled in once it has been decoded in the background.
+        QLabel *texPreview = new QLabel();
+        texPreview->setFixedSize(44, 44);
+        texPreview->setAlignment(Qt::AlignCenter);
+        QHBoxLayout *layout = new QHBoxLayout();
         layout->setContentsMargins(5, 4, 0, 5);
-        layout->addWidget(texName);
-        layout->addWidget(texInfo);
+        layout->addWidget(texPreview);
+        layout->addLayout(infoLayout);
 
         this->texNameLabel = texName;
         this->texInfoLabel = texInfo;
+        this->texPreviewLabel = texPreview;
         this->rwTextureHandle = texItem;
         this->listItem = listItem;
 
@@ -154,6 +164,16 @@ public:
         this->updateInfo();
     }
 
+    inline void SetPreview( const QPixmap& pixmap )
+    {
+        this->texPreviewLabel->setPixmap( pixmap );
+    }
+
+    inline void ClearPreview( void )
+    {
+        this->texPreviewLabel->clear();
+    }
+
     inline void remove( void )
     {
         delete this->listItem;
@@ -162,6 +182,7 @@ public:
 private:
     QLabel *texNameLabel;
     QLabel *texInfoLabel;
+    QLabel *texPreviewLabel;
 
     rw::TextureBase *rwTextureHandle;
 
@@ -0,0 +1,32 @@
+#pragma once
+
+// Texture preview cache.
+// Previews of rasters are decoded on a background thread and kept in a bounded LRU cache,
+// so that browsing through big TXDs does not stall the GUI thread.
+
+#include <QPixmap>
+
+#include <set>
+
+enum class eTexPreviewType
+{
+    THUMBNAIL,      // small picture for the texture list
+    FULL,           // the base layer, as shown in the viewport
+    FULL_MIPMAPS    // all mipmap layers next to each other
+};
+
+// Returns the cached preview if there is one. Otherwise its decoding is scheduled
+// and the main window is notified once it has finished.
+// Previews of rasters that have changed since are decoded again, so nobody has to invalidate them.
+// Urgent requests are decoded before any other.
+bool GetTexturePreview( MainWindow *mainWnd, rw::Raster *raster, eTexPreviewType type, QPixmap& pixmapOut, bool isUrgent = true );
+
+// Schedules the decoding of a preview with low priority, if it is not cached yet.
+void PrefetchTexturePreview( MainWindow *mainWnd, rw::Raster *raster, eTexPreviewType type );
+
+// Drops all cached and scheduled previews, like when the TXD is closed.
+void InvalidateTexturePreviews( MainWindow *mainWnd );
+
+// Drops the cached previews of rasters that are not in usedRasters, so that replaced
+// or deleted rasters are not kept alive by the cache.
+void PruneTexturePreviews( MainWindow *mainWnd, const std::set <rw::Raster*>& usedRasters );
@@ -86,12 +86,30 @@ public:
 
     static QComboBox* createPlatformSelectComboBox(MainWindow *mainWnd);
 
+protected:
+    void customEvent(QEvent *evt) override;
+
 private:
     void UpdatePreview();
     void ClearPreview();
+    void SetPreviewPixmap(const QPixmap& pixmap, int w, int h, bool isProxy);
 
     void releaseConvRaster(void);
 
+    // Properties of the raster that should be given to the texture dictionary.
+    struct rasterConfig
+    {
+        std::string platformName;
+        rw::eCompressionType compressionType;
+        rw::eRasterFormat rasterFormat;
+        rw::ePaletteType paletteType;
+    };
+
+    void getRasterConfiguration(rasterConfig& cfgOut);
+    static void applyRasterConfiguration(rw::Raster *convRaster, const rasterConfig& cfg);
+
+    void waitForConfiguredRaster(void);
+
     inline rw::Raster* GetDisplayRaster(void)
     {
         if (rw::Raster *convRaster = this->convRaster)
@@ -143,6 +161,11 @@ private:
     rw::TextureBase *texHandle;     // if not NULL, then this texture will be used for import.
     rw::Raster *convRaster;
     bool hasPlatformOriginal;
+
+    // Background conversion of the configured raster.
+    struct conversionEnv;
+
+    conversionEnv *convEnv;
     QPixmap pixelsToAdd;
 
     bool hasConfidentPlatform;
@@ -180,6 +203,7 @@ private:
     QCheckBox *fillPreviewCheckBox;
     QCheckBox *backgroundForPreviewCheckBox;
     QLabel *previewInfoLabel;
+    bool isPreviewProxy;
 
     // The buttons.
     QPushButton *cancelButton;
@@ -154,7 +154,21 @@ struct Geometry : public RwObject
 	uint32 write(std::ostream &dff);
 	uint32 writeMeshExtension(std::ostream &dff);
 
-	void cleanUp(void);
+	// Per-attribute tolerances for vertex welding.
+	// An attribute with a tolerance of zero has to match exactly.
+	struct weldTolerances
+	{
+		float32 position;
+		float32 normal;
+		float32 texCoord;
+		float32 boneWeight;
+	};
+
+	// Welds duplicate vertices. With a positive epsilon, vertices whose positions
+	// fall into the same epsilon-sized grid cell are welded aswell.
+	// All other attributes have to match exactly.
+	void cleanUp(float32 epsilon = 0.0f);
+	void cleanUp(const weldTolerances& tolerances);
 
 	void dump(uint32 index, std::string ind = "", bool detailed = false);
 private:
@@ -169,6 +183,8 @@ private:
 	void readData(uint32 vertexCount, uint32 type, // native data block
                       uint32 split, std::istream &dff);
 
+	uint32 getVertexWeldHash(uint32 index) const;
+	bool isTempVertexEqual(uint32 newIndex, uint32 index) const;
 	uint32 addTempVertexIfNew(uint32 index);
 };
 
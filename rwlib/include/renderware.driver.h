@@ -458,7 +458,11 @@ struct DriverSwapChain
 
     inline DriverSwapChain( Interface *engineInterface, Driver *theDriver, Window *ownedWindow )
     {
-        AcquireObject( ownedWindow );
+        // Offscreen swap chains do not have a window.
+        if ( ownedWindow )
+        {
+            AcquireObject( ownedWindow );
+        }
 
         this->driver = theDriver;
         this->ownedWindow = ownedWindow;
@@ -466,7 +470,10 @@ struct DriverSwapChain
 
     inline ~DriverSwapChain( void )
     {
-        ReleaseObject( this->ownedWindow );
+        if ( Window *ownedWindow = this->ownedWindow )
+        {
+            ReleaseObject( ownedWindow );
+        }
     }
 
     Driver* GetDriver( void ) const
@@ -475,6 +482,7 @@ struct DriverSwapChain
     }
 
     // Returns the window that this swap chain is attached to.
+    // Is NULL for offscreen swap chains.
     Window* GetAssociatedWindow( void ) const
     {
         return this->ownedWindow;
@@ -515,6 +523,10 @@ struct Driver
     DriverSwapChain* CreateSwapChain( Window *outputWindow, uint32 frameCount );
     void DestroySwapChain( DriverSwapChain *swapChain );
 
+    // Offscreen swap chains render into memory only; their frames can be read back using GetPresentedBitmap.
+    // Not every driver supports them.
+    DriverSwapChain* CreateOffscreenSwapChain( uint32 width, uint32 height, uint32 frameCount );
+
     // Graphics state management.
     DriverGraphicsState* CreateGraphicsState( const gfxGraphicsState& psoState );
     void DestroyGraphicsState( DriverGraphicsState *pso );
@@ -522,6 +534,18 @@ struct Driver
     // Object creation API.
     // This creates instanced objects to use for rendering.
     DriverRaster* CreateInstancedRaster( Raster *sysRaster );
+    void DestroyInstancedRaster( DriverRaster *instRaster );
+
+    // Command submission API.
+    // Vertices are fetched according to the input layout of the graphics state.
+    // Objects that are used by draw calls have to stay alive until the swap chain has been presented.
+    void Clear( DriverSwapChain *target, float red, float green, float blue, float alpha, float depth = 1.0f );
+    void DrawPrimitives( DriverSwapChain *target, DriverGraphicsState *pso, DriverRaster *texture, ePrimitiveTopology topology, const void *vertexData, uint32 vertexStride, uint32 vertexCount );
+    void Present( DriverSwapChain *swapChain );
+
+    // Copies the last presented frame of a swap chain into a bitmap.
+    // Returns false if the driver cannot read back from that swap chain.
+    bool GetPresentedBitmap( DriverSwapChain *swapChain, Bitmap& bmpOut );
 
     inline void* GetImplementation( void )
     {
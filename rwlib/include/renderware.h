@@ -509,7 +509,8 @@ struct softwareMetaInfo
 enum ePaletteRuntimeType
 {
     PALRUNTIME_NATIVE,      // use the palettizer that is embedded into rwtools
-    PALRUNTIME_PNGQUANT     // use the libimagequant vendor
+    PALRUNTIME_PNGQUANT,    // use the libimagequant vendor
+    PALRUNTIME_MEDIANCUT    // use the embedded median-cut palettizer that runs on the worker threads
 };
 
 // DXT compression configuration.
@@ -519,6 +520,84 @@ enum eDXTCompressionMethod
     DXTRUNTIME_SQUISH       // prefer squish
 };
 
+// PNG encoder configuration.
+enum ePNGCompressionStrategy
+{
+    PNGSTRATEGY_DEFAULT,
+    PNGSTRATEGY_FILTERED,
+    PNGSTRATEGY_HUFFMAN_ONLY,
+    PNGSTRATEGY_RLE
+};
+
+struct pngWriteOptions
+{
+    uint32 compressionLevel;            // zlib level from 0 (store) to 9 (smallest)
+    ePNGCompressionStrategy strategy;
+    bool adaptiveFilters;               // pick the row filter per row, else never filter
+    bool parallelDeflate;               // compress row groups on the worker threads
+};
+
+enum ePNGWritePreset
+{
+    PNGPRESET_DEFAULT,
+    PNGPRESET_FAST,         // for intermediate files that are going to be processed again
+    PNGPRESET_SMALL
+};
+
+inline pngWriteOptions GetPNGWritePreset( ePNGWritePreset preset )
+{
+    pngWriteOptions opts;
+    opts.compressionLevel = 6;
+    opts.strategy = PNGSTRATEGY_DEFAULT;
+    opts.adaptiveFilters = true;
+    opts.parallelDeflate = true;
+
+    if ( preset == PNGPRESET_FAST )
+    {
+        opts.compressionLevel = 1;
+        opts.strategy = PNGSTRATEGY_RLE;
+    }
+    else if ( preset == PNGPRESET_SMALL )
+    {
+        opts.compressionLevel = 9;
+        opts.strategy = PNGSTRATEGY_FILTERED;
+    }
+
+    return opts;
+}
+
+// Processing stages that can be measured by the profiler.
+enum eProfilingStage
+{
+    PROFSTAGE_DESERIALIZE,
+    PROFSTAGE_SERIALIZE,
+    PROFSTAGE_PIXELCONVERT,
+    PROFSTAGE_COMPRESS,
+    PROFSTAGE_DECOMPRESS,
+    PROFSTAGE_PALETTIZE,
+    PROFSTAGE_RESIZE,
+    PROFSTAGE_MIPGEN,
+    PROFSTAGE_SWIZZLE,
+
+    PROFSTAGE_COUNT
+};
+
+struct profilingStageStats
+{
+    uint64 callCount;
+    uint64 totalNanoseconds;    // wall time including nested stages
+    uint64 selfNanoseconds;     // wall time without nested stages
+    uint64 byteCount;
+    uint64 texelCount;
+};
+
+struct profilingSnapshot
+{
+    profilingStageStats stages[ PROFSTAGE_COUNT ];
+};
+
+const char* GetProfilingStageName( eProfilingStage stage );
+
 struct Interface abstract
 {
 protected:
@@ -608,6 +687,21 @@ public:
 
     void                SetIgnoreSerializationBlockRegions  ( bool doIgnore );
     bool                GetIgnoreSerializationBlockRegions  ( void ) const;
+
+    // Amount of threads that rwtools may use for parallel work (zero = all hardware threads).
+    void                SetWorkerThreadCount        ( uint32 count );
+    uint32              GetWorkerThreadCount        ( void ) const;
+
+    void                SetPNGWriteOptions          ( const pngWriteOptions& opts );
+    pngWriteOptions     GetPNGWriteOptions          ( void ) const;
+
+    // Opt-in per-stage timing and counters, aggregated across all threads.
+    void                SetProfilingEnabled         ( bool enabled );
+    bool                IsProfilingEnabled          ( void ) const;
+
+    void                GetProfilingSnapshot        ( profilingSnapshot& snapOut, bool currentThreadOnly = false ) const;
+    void                ResetProfiling              ( void );
+    std::string         DumpProfiling               ( bool asJSON = false ) const;
 };
 
 #include "renderware.utils.h"
@@ -620,6 +714,10 @@ void        DeleteEngine( Interface *theEngine );
 void AssignThreadedRuntimeConfig( Interface *engineInterface );
 void ReleaseThreadedRuntimeConfig( Interface *engineInterface );
 
+// Gives the current thread a copy of the configuration that another thread runs with, so that it can
+// help out with its work. Release it again like an assigned configuration.
+void InheritThreadedRuntimeConfig( Interface *engineInterface, thread_t sourceThread );
+
 }
 
 #endif
@@ -119,4 +119,12 @@ void TerminateThread( Interface *engineInterface, thread_t threadHandle, bool wa
 
 void CheckThreadHazards( Interface *engineInterface );
 
-void* GetThreadingNativeManager( Interface *engineInterface );
\ No newline at end of file
+void* GetThreadingNativeManager( Interface *engineInterface );
+
+// Parallel work API.
+// Calls the callback for every item index in [0, itemCount) on the worker threads of the engine
+// (see Interface::SetWorkerThreadCount). The calling thread takes part in the work.
+// If any item throws, the remaining items are skipped and the exception is rethrown on the calling thread.
+typedef void (*parallelWorkItemCallback_t)( void *ud, size_t itemIndex );
+
+void ParallelForEachItem( Interface *engineInterface, size_t itemCount, parallelWorkItemCallback_t cb, void *ud, uint32 maxWorkers = 0 );
\ No newline at end of file
@@ -199,6 +199,8 @@ struct Raster
         this->platformData = NULL;
         this->refCount = 1;
         this->constRefCount = 0;
+        this->frozen = false;
+        this->revision = 0;
     }
 
     Raster( const Raster& right );
@@ -212,6 +214,19 @@ struct Raster
     void readImage(rw::Stream *inputStream);
 
     Bitmap getBitmap(void) const;
+
+    // Direct mipmap access without an intermediate Bitmap.
+    // readMipmapBGRA decodes a mipmap layer into caller memory as packed B, G, R, A bytes,
+    // box-filtering it if the destination dimensions are smaller than the layer.
+    bool getMipmapSize( uint32 mipIndex, uint32& width, uint32& height ) const;
+    void readMipmapBGRA( uint32 mipIndex, uint32 dstWidth, uint32 dstHeight, void *dstTexels, uint32 dstStride ) const;
+
+    // Hash over the texel data and pixel format of all mipmap layers.
+    // Rasters of the same native type with equal hashes have the same image contents.
+    // If dataSizeOut is given, it receives the byte size of all hashed texel data.
+    // checkHashOut receives a second, independent hash to confirm that two equal hashes are no collision.
+    uint64 getTexelDataHash( uint64 *dataSizeOut = NULL, uint64 *checkHashOut = NULL ) const;
+
     void setImageData(const Bitmap& srcImage);
 
     void resize(uint32 width, uint32 height, const char *downsampleMode = NULL, const char *upscaleMode = NULL);
@@ -227,6 +242,15 @@ struct Raster
     void remConstRef( void );
     bool isImmutable( void ) const;
 
+    // Makes the raster read-only for the rest of its lifetime.
+    // Readers of frozen rasters do not take the consistency lock anymore.
+    void freeze( void );
+    bool isFrozen( void ) const;
+
+    // Counts the changes to the native data.
+    // If it differs from a previous query, anything derived from the raster is outdated.
+    uint32 getRevision( void ) const;
+
     bool hasNativeDataOfType( const char *typeName ) const;
     const char* getNativeDataTypeName( void ) const;
 
@@ -270,6 +294,41 @@ struct Raster
     std::atomic <uint32> refCount;          // general life-time reference count
 
     std::atomic <uint32> constRefCount;     // if != 0, the native data is immutable
+
+    std::atomic <bool> frozen;              // if true, the native data never changes again
+
+    std::atomic <uint32> revision;          // incremented whenever the native data is changed
+};
+
+// Shared read-only handle to a raster.
+// Keeps the raster alive and immutable for as long as the handle exists.
+// For frozen rasters this is just a reference count.
+struct RasterReadHandle
+{
+    inline RasterReadHandle( void )
+    {
+        this->theRaster = NULL;
+        this->hasConstRef = false;
+    }
+
+    RasterReadHandle( Raster *theRaster );
+    RasterReadHandle( const RasterReadHandle& right );
+    RasterReadHandle( RasterReadHandle&& right );
+    ~RasterReadHandle( void );
+
+    RasterReadHandle& operator = ( const RasterReadHandle& right );
+    RasterReadHandle& operator = ( RasterReadHandle&& right );
+
+    inline const Raster* get( void ) const      { return this->theRaster; }
+    inline const Raster* operator -> ( void ) const { return this->theRaster; }
+
+    inline explicit operator bool ( void ) const    { return ( this->theRaster != NULL ); }
+
+private:
+    void release( void );
+
+    Raster *theRaster;
+    bool hasConstRef;
 };
 
 struct TexDictionary;
@@ -452,10 +511,42 @@ TextureBase* CreateTexture( Interface *engineInterface, Raster *theRaster );
 TextureBase* ToTexture( Interface *engineInterface, RwObject *rwObj );
 const TextureBase* ToConstTexture( Interface *engineInterface, const RwObject *rwObj );
 
+// Thumbnail extraction straight from a serialized TXD (or a single texture native).
+// Only the requested texture is deserialized and only the smallest mipmap level that still
+// covers the thumbnail size is decoded, so this is a lot cheaper than loading the whole archive.
+struct textureThumbnail
+{
+    std::string textureName;
+    uint32 baseWidth, baseHeight;   // dimensions of the base mipmap level
+    uint32 width, height;           // dimensions of the thumbnail
+    bool hasAlpha;
+    std::vector <uint8> texels;     // width * height texels as packed B, G, R, A bytes
+};
+
+// The thumbnail keeps the aspect ratio and fits into maxWidth * maxHeight (zero means unbounded).
+// If textureName is NULL then the first texture is taken. Returns false if no such texture was found.
+bool ReadTextureThumbnail( Interface *engineInterface, Stream *inputStream, uint32 maxWidth, uint32 maxHeight, textureThumbnail& thumbOut, const char *textureName = NULL );
+
 typedef std::list <std::string> platformTypeNameList_t;
 
+// How ConvertRasterTo got the texels into the destination native texture.
+// Cheaper plans are listed first.
+enum eRasterConversionPlan
+{
+    RASTERCONV_NONE,            // no conversion took place (failure)
+    RASTERCONV_SAME_TYPE,       // the raster already had the requested native type
+    RASTERCONV_PASSTHROUGH,     // the texel buffers were handed over as they were
+    RASTERCONV_SWIZZLE_ONLY,    // the texel format stayed, but a native memory layout had to be redone
+    RASTERCONV_PALETTE_ONLY,    // the palette indices were kept, only the palette colors were converted
+    RASTERCONV_REPACK,          // raw texels were converted into another raw format
+    RASTERCONV_TRANSCODE        // texels had to be decompressed, compressed or palettized
+};
+
+const char* GetRasterConversionPlanName( eRasterConversionPlan plan );
+
 // Complex native texture API.
-bool ConvertRasterTo( Raster *theRaster, const char *nativeName );
+// If planOut is not NULL it receives the conversion plan that was used.
+bool ConvertRasterTo( Raster *theRaster, const char *nativeName, eRasterConversionPlan *planOut = NULL );
 
 void* GetNativeTextureDriverInterface( Interface *engineInterface, const char *nativeName );
 
@@ -516,4 +607,4 @@ bool PutTexelLuminance(
 );
 
 // Debug API.
-bool DebugDrawMipmaps( Interface *engineInterface, Raster *debugRaster, Bitmap& drawSurface );
\ No newline at end of file
+bool DebugDrawMipmaps( Interface *engineInterface, const Raster *debugRaster, Bitmap& drawSurface );
\ No newline at end of file
@@ -0,0 +1,711 @@
+// rwtools micro-benchmark suite.
+// Generates synthetic rasters of standard sizes and measures the throughput of the
+// pixel conversion, DXT, palettization, resizing, mipmap generation and native
+// texture (swizzling) paths in MPix/s. Results can be saved as a baseline JSON
+// file and compared against one to catch regressions.
+
+#include <renderware.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct benchResult
+{
+    std::string name;
+    double mpixPerSecond;
+    bool hasRun;
+    std::string errorMessage;
+};
+
+struct benchEnvironment
+{
+    rw::Interface *rwEngine;
+
+    // Minimum amount of time to spend inside of each measured routine.
+    double minSeconds = 0.25;
+    unsigned int minIterations = 3;
+
+    // If set, only benchmarks whose name contains this string are run.
+    const char *nameFilter = NULL;
+
+    std::vector <benchResult> results;
+};
+
+// Deterministic image content with gradients, hard edges and varying alpha,
+// so that neither the DXT nor the palette compressors hit a trivial case.
+static rw::Raster* MakeSyntheticRaster( rw::Interface *rwEngine, rw::uint32 width, rw::uint32 height )
+{
+    rw::Bitmap bmp( rwEngine, 32, rw::RASTER_8888, rw::COLOR_BGRA );
+    bmp.setSize( width, height );
+
+    rw::uint8 *texels = (rw::uint8*)bmp.getTexelsData();
+
+    rw::uint32 rowSize = rw::getRasterDataRowSize( width, 32, bmp.getRowAlignment() );
+
+    rw::uint32 seed = 0x9E3779B9;
+
+    for ( rw::uint32 y = 0; y < height; y++ )
+    {
+        rw::uint8 *row = ( texels + rowSize * y );
+
+        for ( rw::uint32 x = 0; x < width; x++ )
+        {
+            seed = seed * 1664525 + 1013904223;
+
+            rw::uint8 noise = (rw::uint8)( seed >> 27 );
+
+            bool checker = ( ( ( x / 16 ) ^ ( y / 16 ) ) & 1 ) != 0;
+
+            rw::uint8 *texel = ( row + x * 4 );
+
+            texel[0] = (rw::uint8)( ( x * 255 ) / width ) + noise;
+            texel[1] = (rw::uint8)( ( y * 255 ) / height ) + noise;
+            texel[2] = ( checker ? 0xE0 : 0x20 ) + noise;
+            texel[3] = (rw::uint8)( ( ( x + y ) * 255 ) / ( width + height ) );
+        }
+    }
+
+    rw::Raster *texRaster = rw::CreateRaster( rwEngine );
+
+    if ( texRaster )
+    {
+        try
+        {
+            texRaster->newNativeData( "Direct3D9" );
+            texRaster->setImageData( bmp );
+        }
+        catch( ... )
+        {
+            rw::DeleteRaster( texRaster );
+
+            throw;
+        }
+    }
+
+    return texRaster;
+}
+
+typedef std::function <void ( rw::Raster *texRaster )> benchRoutine_t;
+
+// Runs a benchmark on fresh clones of the source raster. Only the time spent inside of
+// the routine counts; cloning and preparation are not measured.
+static void RunBenchmark(
+    benchEnvironment& env, const std::string& name, const rw::Raster *srcRaster,
+    const benchRoutine_t& prepare, const benchRoutine_t& routine
+)
+{
+    if ( env.nameFilter && name.find( env.nameFilter ) == std::string::npos )
+        return;
+
+    benchResult result;
+    result.name = name;
+    result.mpixPerSecond = 0;
+    result.hasRun = false;
+
+    rw::uint32 width, height;
+    srcRaster->getSize( width, height );
+
+    double pixelCount = (double)width * (double)height;
+
+    try
+    {
+        double totalSeconds = 0;
+        unsigned int iterCount = 0;
+
+        // The first iteration warms up caches and lazily created runtime state.
+        bool isWarmup = true;
+
+        while ( isWarmup || iterCount < env.minIterations || totalSeconds < env.minSeconds )
+        {
+            rw::Raster *workRaster = rw::CloneRaster( srcRaster );
+
+            if ( !workRaster )
+            {
+                throw rw::RwException( "failed to clone raster" );
+            }
+
+            try
+            {
+                if ( prepare )
+                {
+                    prepare( workRaster );
+                }
+
+                auto timeStart = std::chrono::steady_clock::now();
+
+                routine( workRaster );
+
+                std::chrono::duration <double> timeTaken = ( std::chrono::steady_clock::now() - timeStart );
+
+                if ( !isWarmup )
+                {
+                    totalSeconds += timeTaken.count();
+                    iterCount++;
+                }
+            }
+            catch( ... )
+            {
+                rw::DeleteRaster( workRaster );
+
+                throw;
+            }
+
+            rw::DeleteRaster( workRaster );
+
+            isWarmup = false;
+        }
+
+        result.mpixPerSecond = ( pixelCount * iterCount ) / ( totalSeconds * 1000000.0 );
+        result.hasRun = true;
+    }
+    catch( rw::RwException& except )
+    {
+        result.errorMessage = except.message;
+    }
+
+    if ( result.hasRun )
+    {
+        printf( "%-48s %12.2f MPix/s\n", name.c_str(), result.mpixPerSecond );
+    }
+    else
+    {
+        printf( "%-48s      skipped (%s)\n", name.c_str(), result.errorMessage.c_str() );
+    }
+    fflush( stdout );
+
+    env.results.push_back( std::move( result ) );
+}
+
+static void ConvertToNative( rw::Raster *texRaster, const char *nativeName, rw::eRasterConversionPlan *planOut = NULL )
+{
+    if ( !rw::ConvertRasterTo( texRaster, nativeName, planOut ) )
+    {
+        throw rw::RwException( std::string( "cannot convert to " ) + nativeName );
+    }
+}
+
+// "RASTER_8888" -> "8888"
+static std::string GetShortFormatName( rw::eRasterFormat rasterFormat )
+{
+    std::string name = rw::GetRasterFormatStandardName( rasterFormat );
+
+    if ( name.compare( 0, 7, "RASTER_" ) == 0 )
+    {
+        name.erase( 0, 7 );
+    }
+
+    return name;
+}
+
+static void RunBenchmarksForSize( benchEnvironment& env, rw::uint32 size )
+{
+    rw::Interface *rwEngine = env.rwEngine;
+
+    rw::Raster *srcRaster = MakeSyntheticRaster( rwEngine, size, size );
+
+    if ( !srcRaster )
+    {
+        throw rw::RwException( "failed to create synthetic raster" );
+    }
+
+    const std::string sizeSuffix = "@" + std::to_string( size );
+
+    try
+    {
+        // Pixel format conversion (ConvertPixelData).
+        {
+            struct formatPair
+            {
+                rw::eRasterFormat srcFormat;
+                rw::eRasterFormat dstFormat;
+            };
+
+            static const formatPair formatPairs[] =
+            {
+                { rw::RASTER_8888, rw::RASTER_565 },
+                { rw::RASTER_8888, rw::RASTER_1555 },
+                { rw::RASTER_8888, rw::RASTER_4444 },
+                { rw::RASTER_8888, rw::RASTER_888 },
+                { rw::RASTER_8888, rw::RASTER_LUM },
+                { rw::RASTER_565, rw::RASTER_8888 },
+                { rw::RASTER_1555, rw::RASTER_8888 },
+                { rw::RASTER_888, rw::RASTER_8888 }
+            };
+
+            for ( const formatPair& pair : formatPairs )
+            {
+                rw::eRasterFormat srcFormat = pair.srcFormat;
+                rw::eRasterFormat dstFormat = pair.dstFormat;
+
+                std::string name =
+                    "convert." + GetShortFormatName( srcFormat ) + "_to_" + GetShortFormatName( dstFormat ) + sizeSuffix;
+
+                RunBenchmark( env, name, srcRaster,
+                    [=]( rw::Raster *texRaster ) { if ( srcFormat != rw::RASTER_8888 ) texRaster->convertToFormat( srcFormat ); },
+                    [=]( rw::Raster *texRaster ) { texRaster->convertToFormat( dstFormat ); }
+                );
+            }
+        }
+
+        // DXT compression and decompression through each runtime.
+        {
+            struct dxtRuntimeInfo
+            {
+                rw::eDXTCompressionMethod method;
+                const char *name;
+            };
+
+            static const dxtRuntimeInfo dxtRuntimes[] =
+            {
+                { rw::DXTRUNTIME_NATIVE, "native" },
+                { rw::DXTRUNTIME_SQUISH, "squish" }
+            };
+
+            struct dxtTypeInfo
+            {
+                rw::eCompressionType type;
+                const char *name;
+            };
+
+            static const dxtTypeInfo dxtTypes[] =
+            {
+                { rw::RWCOMPRESS_DXT1, "dxt1" },
+                { rw::RWCOMPRESS_DXT3, "dxt3" },
+                { rw::RWCOMPRESS_DXT5, "dxt5" }
+            };
+
+            for ( const dxtRuntimeInfo& runtime : dxtRuntimes )
+            {
+                rwEngine->SetDXTRuntime( runtime.method );
+
+                for ( const dxtTypeInfo& dxtType : dxtTypes )
+                {
+                    rw::eCompressionType compressionType = dxtType.type;
+
+                    RunBenchmark( env, std::string( "dxt." ) + runtime.name + ".compress." + dxtType.name + sizeSuffix, srcRaster,
+                        nullptr,
+                        [=]( rw::Raster *texRaster ) { texRaster->compressCustom( compressionType ); }
+                    );
+
+                    RunBenchmark( env, std::string( "dxt." ) + runtime.name + ".decompress." + dxtType.name + sizeSuffix, srcRaster,
+                        [=]( rw::Raster *texRaster ) { texRaster->compressCustom( compressionType ); },
+                        []( rw::Raster *texRaster ) { texRaster->convertToFormat( rw::RASTER_8888 ); }
+                    );
+                }
+            }
+
+            rwEngine->SetDXTRuntime( rw::DXTRUNTIME_SQUISH );
+        }
+
+        // Palettization (PalettizePixelData).
+        {
+            struct palRuntimeInfo
+            {
+                rw::ePaletteRuntimeType type;
+                const char *name;
+            };
+
+            static const palRuntimeInfo palRuntimes[] =
+            {
+                { rw::PALRUNTIME_NATIVE, "native" },
+                { rw::PALRUNTIME_PNGQUANT, "pngquant" },
+                { rw::PALRUNTIME_MEDIANCUT, "mediancut" }
+            };
+
+            for ( const palRuntimeInfo& runtime : palRuntimes )
+            {
+                rwEngine->SetPaletteRuntime( runtime.type );
+
+                RunBenchmark( env, std::string( "palette." ) + runtime.name + ".pal8" + sizeSuffix, srcRaster,
+                    nullptr,
+                    []( rw::Raster *texRaster ) { texRaster->convertToPalette( rw::PALETTE_8BIT ); }
+                );
+
+                RunBenchmark( env, std::string( "palette." ) + runtime.name + ".pal4" + sizeSuffix, srcRaster,
+                    nullptr,
+                    []( rw::Raster *texRaster ) { texRaster->convertToPalette( rw::PALETTE_4BIT ); }
+                );
+            }
+
+            rwEngine->SetPaletteRuntime( rw::PALRUNTIME_PNGQUANT );
+        }
+
+        // Resizing filters; "blur" only minifies while "linear" only magnifies.
+        RunBenchmark( env, "resize.blur.down" + sizeSuffix, srcRaster,
+            nullptr,
+            [=]( rw::Raster *texRaster ) { texRaster->resize( size / 2, size / 2, "blur", "linear" ); }
+        );
+
+        RunBenchmark( env, "resize.linear.up" + sizeSuffix, srcRaster,
+            nullptr,
+            [=]( rw::Raster *texRaster ) { texRaster->resize( size * 2, size * 2, "blur", "linear" ); }
+        );
+
+        // Mipmap generation.
+        RunBenchmark( env, "mipmaps.generate" + sizeSuffix, srcRaster,
+            nullptr,
+            []( rw::Raster *texRaster ) { texRaster->generateMipmaps( 32, rw::MIPMAPGEN_DEFAULT ); }
+        );
+
+        // Native texture conversion, which runs the platform swizzlers in both directions.
+        {
+            static const char *const swizzlePlatforms[] =
+            {
+                "PlayStation2",
+                "PSP",
+                "Gamecube",
+                "XBOX"
+            };
+
+            for ( const char *nativeName : swizzlePlatforms )
+            {
+                if ( !rw::IsNativeTexture( rwEngine, nativeName ) )
+                    continue;
+
+                RunBenchmark( env, std::string( "swizzle." ) + nativeName + ".to" + sizeSuffix, srcRaster,
+                    nullptr,
+                    [=]( rw::Raster *texRaster ) { ConvertToNative( texRaster, nativeName ); }
+                );
+
+                RunBenchmark( env, std::string( "swizzle." ) + nativeName + ".from" + sizeSuffix, srcRaster,
+                    [=]( rw::Raster *texRaster ) { ConvertToNative( texRaster, nativeName ); },
+                    []( rw::Raster *texRaster ) { ConvertToNative( texRaster, "Direct3D9" ); }
+                );
+            }
+        }
+
+        // Moves between native textures that share the texel representation.
+        // These should not decode anything, so the chosen conversion plan is printed aswell.
+        {
+            struct nativeMoveInfo
+            {
+                const char *name;
+                const char *nativeName;
+                bool isPalette;
+            };
+
+            static const nativeMoveInfo nativeMoves[] =
+            {
+                { "dxt1.XBOX", "XBOX", false },
+                { "dxt1.s3tc_mobile", "s3tc_mobile", false },
+                { "pal8.PlayStation2", "PlayStation2", true },
+                { "pal8.PSP", "PSP", true }
+            };
+
+            for ( const nativeMoveInfo& move : nativeMoves )
+            {
+                const char *nativeName = move.nativeName;
+                bool isPalette = move.isPalette;
+
+                if ( !rw::IsNativeTexture( rwEngine, nativeName ) )
+                    continue;
+
+                rw::eRasterConversionPlan movePlan = rw::RASTERCONV_NONE;
+
+                RunBenchmark( env, std::string( "move." ) + move.name + sizeSuffix, srcRaster,
+                    [=]( rw::Raster *texRaster )
+                    {
+                        if ( isPalette )
+                        {
+                            texRaster->convertToPalette( rw::PALETTE_8BIT );
+                        }
+                        else
+                        {
+                            texRaster->compressCustom( rw::RWCOMPRESS_DXT1 );
+                        }
+                    },
+                    [=, &movePlan]( rw::Raster *texRaster ) { ConvertToNative( texRaster, nativeName, &movePlan ); }
+                );
+
+                if ( movePlan != rw::RASTERCONV_NONE )
+                {
+                    printf( "    plan: %s\n", rw::GetRasterConversionPlanName( movePlan ) );
+                    fflush( stdout );
+                }
+            }
+        }
+    }
+    catch( ... )
+    {
+        rw::DeleteRaster( srcRaster );
+
+        throw;
+    }
+
+    rw::DeleteRaster( srcRaster );
+}
+
+// The baseline is a flat JSON object that maps benchmark names to MPix/s.
+static bool WriteBaseline( const char *path, const std::vector <benchResult>& results )
+{
+    FILE *outFile = fopen( path, "w" );
+
+    if ( !outFile )
+        return false;
+
+    fputs( "{\n", outFile );
+
+    bool isFirst = true;
+
+    for ( const benchResult& result : results )
+    {
+        if ( !result.hasRun )
+            continue;
+
+        fprintf( outFile, "%s  \"%s\": %.3f", ( isFirst ? "" : ",\n" ), result.name.c_str(), result.mpixPerSecond );
+
+        isFirst = false;
+    }
+
+    fputs( "\n}\n", outFile );
+
+    fclose( outFile );
+    return true;
+}
+
+static bool ReadBaseline( const char *path, std::map <std::string, double>& baselineOut )
+{
+    FILE *inFile = fopen( path, "rb" );
+
+    if ( !inFile )
+        return false;
+
+    std::string content;
+    {
+        char buf[ 4096 ];
+        size_t readCount;
+
+        while ( ( readCount = fread( buf, 1, sizeof( buf ), inFile ) ) != 0 )
+        {
+            content.append( buf, readCount );
+        }
+    }
+
+    fclose( inFile );
+
+    // Benchmark names never contain quotes, so we can get away with a tiny scanner.
+    size_t pos = 0;
+
+    while ( ( pos = content.find( '\"', pos ) ) != std::string::npos )
+    {
+        size_t nameEnd = content.find( '\"', pos + 1 );
+
+        if ( nameEnd == std::string::npos )
+            break;
+
+        std::string name = content.substr( pos + 1, nameEnd - pos - 1 );
+
+        size_t colonPos = content.find_first_not_of( " \t\r\n", nameEnd + 1 );
+
+        if ( colonPos == std::string::npos || content[ colonPos ] != ':' )
+        {
+            pos = nameEnd + 1;
+            continue;
+        }
+
+        const char *numStart = content.c_str() + colonPos + 1;
+        char *numEnd = NULL;
+
+        double value = strtod( numStart, &numEnd );
+
+        if ( numEnd != numStart )
+        {
+            baselineOut[ name ] = value;
+        }
+
+        pos = ( numEnd - content.c_str() );
+    }
+
+    return true;
+}
+
+// Returns the number of benchmarks that fell below the baseline by more than the tolerance.
+static size_t CompareWithBaseline( const std::vector <benchResult>& results, const std::map <std::string, double>& baseline, double tolerance )
+{
+    size_t regressionCount = 0;
+
+    printf( "\ncomparison against baseline (tolerance %.0f%%):\n", tolerance * 100.0 );
+
+    for ( const benchResult& result : results )
+    {
+        auto baselineIter = baseline.find( result.name );
+
+        if ( baselineIter == baseline.end() || !result.hasRun || baselineIter->second <= 0 )
+            continue;
+
+        double ratio = ( result.mpixPerSecond / baselineIter->second );
+
+        bool isRegression = ( ratio < 1.0 - tolerance );
+
+        printf(
+            "%-48s %12.2f -> %12.2f  %+7.1f%%%s\n",
+            result.name.c_str(), baselineIter->second, result.mpixPerSecond, ( ratio - 1.0 ) * 100.0,
+            ( isRegression ? "  REGRESSION" : "" )
+        );
+
+        if ( isRegression )
+        {
+            regressionCount++;
+        }
+    }
+
+    return regressionCount;
+}
+
+static void PrintUsage( void )
+{
+    fputs(
+        "usage: rwbench [options]\n"
+        "  -s <size>             raster edge length to test; may be repeated (default: 256 and 1024)\n"
+        "  -t <seconds>          minimum measuring time per benchmark (default: 0.25)\n"
+        "  -f <filter>           only run benchmarks whose name contains <filter>\n"
+        "  --baseline <file>     compare the results against a baseline\n"
+        "  --tolerance <percent> allowed slowdown before reporting a regression (default: 10)\n"
+        "  --write-baseline <file>  store the results as a new baseline\n",
+        stderr
+    );
+}
+
+int main( int argc, char *argv[] )
+{
+    std::vector <rw::uint32> sizes;
+    const char *baselinePath = NULL;
+    const char *writeBaselinePath = NULL;
+    const char *nameFilter = NULL;
+    double tolerance = 0.1;
+    double minSeconds = 0.25;
+
+    for ( int n = 1; n < argc; n++ )
+    {
+        const char *arg = argv[ n ];
+        const char *nextArg = ( n + 1 < argc ? argv[ n + 1 ] : NULL );
+
+        if ( strcmp( arg, "-s" ) == 0 && nextArg )
+        {
+            int size = atoi( nextArg );
+
+            if ( size > 0 )
+            {
+                sizes.push_back( (rw::uint32)size );
+            }
+            n++;
+        }
+        else if ( strcmp( arg, "-t" ) == 0 && nextArg )
+        {
+            minSeconds = atof( nextArg );
+            n++;
+        }
+        else if ( strcmp( arg, "-f" ) == 0 && nextArg )
+        {
+            nameFilter = nextArg;
+            n++;
+        }
+        else if ( strcmp( arg, "--baseline" ) == 0 && nextArg )
+        {
+            baselinePath = nextArg;
+            n++;
+        }
+        else if ( strcmp( arg, "--tolerance" ) == 0 && nextArg )
+        {
+            tolerance = atof( nextArg ) / 100.0;
+            n++;
+        }
+        else if ( strcmp( arg, "--write-baseline" ) == 0 && nextArg )
+        {
+            writeBaselinePath = nextArg;
+            n++;
+        }
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    if ( sizes.empty() )
+    {
+        sizes.push_back( 256 );
+        sizes.push_back( 1024 );
+    }
+
+    rw::LibraryVersion engineVersion;
+    engineVersion.rwLibMajor = 3;
+    engineVersion.rwLibMinor = 6;
+    engineVersion.rwRevMajor = 0;
+    engineVersion.rwRevMinor = 3;
+
+    rw::Interface *rwEngine = rw::CreateEngine( engineVersion );
+
+    if ( rwEngine == NULL )
+    {
+        fputs( "failed to initialize the RenderWare engine\n", stderr );
+        return -1;
+    }
+
+    int iRet = 0;
+
+    try
+    {
+        rwEngine->SetWarningLevel( 0 );
+        rwEngine->SetIgnoreSecureWarnings( true );
+
+        rwEngine->SetCompatTransformNativeImaging( true );
+        rwEngine->SetPreferPackedSampleExport( true );
+
+        rwEngine->SetDXTRuntime( rw::DXTRUNTIME_SQUISH );
+        rwEngine->SetPaletteRuntime( rw::PALRUNTIME_PNGQUANT );
+
+        benchEnvironment env;
+        env.rwEngine = rwEngine;
+        env.minSeconds = minSeconds;
+        env.nameFilter = nameFilter;
+
+        for ( rw::uint32 size : sizes )
+        {
+            printf( "\n--- %ux%u ---\n", size, size );
+
+            RunBenchmarksForSize( env, size );
+        }
+
+        if ( writeBaselinePath )
+        {
+            if ( !WriteBaseline( writeBaselinePath, env.results ) )
+            {
+                fprintf( stderr, "failed to write baseline '%s'\n", writeBaselinePath );
+                iRet = -1;
+            }
+        }
+
+        if ( baselinePath )
+        {
+            std::map <std::string, double> baseline;
+
+            if ( !ReadBaseline( baselinePath, baseline ) )
+            {
+                fprintf( stderr, "failed to read baseline '%s'\n", baselinePath );
+                iRet = -1;
+            }
+            else if ( CompareWithBaseline( env.results, baseline, tolerance ) != 0 )
+            {
+                iRet = 1;
+            }
+        }
+    }
+    catch( rw::RwException& except )
+    {
+        fprintf( stderr, "uncaught RenderWare exception: %s\n", except.message.c_str() );
+
+        iRet = -1;
+    }
+
+    rw::DeleteEngine( rwEngine );
+
+    return iRet;
+}
@@ -119,6 +119,7 @@ extern RwInterfaceFactory_t engineFactory;
 #include "rwprivate.txd.h"
 #include "rwprivate.imaging.h"
 #include "rwprivate.warnings.h"
+#include "rwprivate.profiling.h"
 
 }
 
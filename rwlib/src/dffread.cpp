@@ -812,73 +812,209 @@ static std::vector<uint8>    nightColors_new;
 static std::vector<uint32>   vertexBoneIndices_new;
 static std::vector<float32>  vertexBoneWeights_new;
 
-// used only by Geometry::cleanUp()
-// adds new temporary vertex if it isn't already in the list
-// and returns the new index of that vertex
-uint32 Geometry::addTempVertexIfNew(uint32 index)
+// Scratch arena of the vertex welder.
+// It is an open-addressing hash table that maps the hash of all vertex attributes
+// to the index of a vertex in the cleaned up lists. The memory is kept across
+// calls to Geometry::cleanUp() so that processing many geometries does not
+// reallocate the table each time.
+static std::vector<uint32>   weldBuckets;       // new vertex index + 1, zero if the slot is empty.
+static std::vector<uint32>   weldBucketHashes;
+static uint32                weldBucketMask = 0;
+static Geometry::weldTolerances weldTolerance = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+static inline uint32 weldMixHash( uint32 hash, uint32 value )
 {
-	// return if we already have the vertex
-	for (uint32 i = 0; i < vertices_new.size()/3; i++)
+    // FNV-1a style mixing on a whole word at a time.
+    hash ^= value;
+    hash *= 16777619u;
+    hash ^= ( hash >> 15 );
+    return hash;
+}
+
+static inline int64 weldQuantize( float32 value, float32 epsilon )
+{
+    // Vertices inside of the same epsilon cell are treated as equal.
+    // The cell is computed in double precision and clamped, so that huge coordinates
+    // or a tiny epsilon cannot overflow the key.
+    const double cellLimit = 4611686018427387904.0;    // 2^62
+
+    double cell = std::floor( (double)value / epsilon + 0.5 );
+
+    // Also catches NaN.
+    if ( !( cell > -cellLimit ) )
+    {
+        cell = -cellLimit;
+    }
+    else if ( cell > cellLimit )
     {
-		if (vertices_new[i*3+0] != vertices[index*3+0] ||
-		    vertices_new[i*3+1] != vertices[index*3+1] ||
-		    vertices_new[i*3+2] != vertices[index*3+2])
-			continue;
+        cell = cellLimit;
+    }
 
-		if (flags & FLAGS_NORMALS)
-        {
-			if (normals_new[i*3+0] != normals[index*3+0] ||
-			    normals_new[i*3+1] != normals[index*3+1] ||
-			    normals_new[i*3+2] != normals[index*3+2])
-				continue;
-		}
-		if (flags & FLAGS_TEXTURED || flags & FLAGS_TEXTURED2)
-        {
-			for (uint32 j = 0; j < numUVs; j++)
-            {
-				if (texCoords_new[j][i*2+0] != texCoords[j][index*2+0] ||
-				    texCoords_new[j][i*2+1] != texCoords[j][index*2+1])
-                {
-					goto cont;
-                }
-            }
-		}
-		if (flags & FLAGS_PRELIT)
-        {
-			if (vertexColors_new[i*4+0]!=vertexColors[index*4+0] ||
-			    vertexColors_new[i*4+1]!=vertexColors[index*4+1] ||
-			    vertexColors_new[i*4+2]!=vertexColors[index*4+2] ||
-			    vertexColors_new[i*4+3]!=vertexColors[index*4+3])
-				continue;
-		}
-		if (hasNightColors)
+    return (int64)cell;
+}
+
+static inline uint32 weldFloatKey( float32 value, float32 epsilon )
+{
+    if ( epsilon > 0.0f )
+    {
+        uint64 cell = (uint64)weldQuantize( value, epsilon );
+
+        return (uint32)( cell ^ ( cell >> 32 ) );
+    }
+
+    // Make sure that negative zero hashes the same as positive zero,
+    // because they compare equal.
+    value += 0.0f;
+
+    uint32 bits;
+    memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+}
+
+static inline bool weldFloatEqual( float32 left, float32 right, float32 epsilon )
+{
+    if ( epsilon > 0.0f )
+    {
+        return ( weldQuantize( left, epsilon ) == weldQuantize( right, epsilon ) );
+    }
+
+    return ( left == right );
+}
+
+static inline uint32 weldColorKey( const uint8 *color )
+{
+    return ( (uint32)color[0] | ( (uint32)color[1] << 8 ) | ( (uint32)color[2] << 16 ) | ( (uint32)color[3] << 24 ) );
+}
+
+// Returns the hash of all attributes of a vertex that take part in welding.
+uint32 Geometry::getVertexWeldHash(uint32 index) const
+{
+	uint32 hash = 2166136261u;
+
+	hash = weldMixHash(hash, weldFloatKey(vertices[index*3+0], weldTolerance.position));
+	hash = weldMixHash(hash, weldFloatKey(vertices[index*3+1], weldTolerance.position));
+	hash = weldMixHash(hash, weldFloatKey(vertices[index*3+2], weldTolerance.position));
+
+	if (flags & FLAGS_NORMALS)
+    {
+		hash = weldMixHash(hash, weldFloatKey(normals[index*3+0], weldTolerance.normal));
+		hash = weldMixHash(hash, weldFloatKey(normals[index*3+1], weldTolerance.normal));
+		hash = weldMixHash(hash, weldFloatKey(normals[index*3+2], weldTolerance.normal));
+	}
+	if (flags & FLAGS_TEXTURED || flags & FLAGS_TEXTURED2)
+    {
+		for (uint32 j = 0; j < numUVs; j++)
         {
-			if (nightColors_new[i*4+0] != nightColors[index*4+0] ||
-			    nightColors_new[i*4+1] != nightColors[index*4+1] ||
-			    nightColors_new[i*4+2] != nightColors[index*4+2] ||
-			    nightColors_new[i*4+3] != nightColors[index*4+3])
-				continue;
+			hash = weldMixHash(hash, weldFloatKey(texCoords[j][index*2+0], weldTolerance.texCoord));
+			hash = weldMixHash(hash, weldFloatKey(texCoords[j][index*2+1], weldTolerance.texCoord));
 		}
-		if (hasSkin)
+	}
+	if (flags & FLAGS_PRELIT)
+    {
+		hash = weldMixHash(hash, weldColorKey(&vertexColors[index*4]));
+	}
+	if (hasNightColors)
+    {
+		hash = weldMixHash(hash, weldColorKey(&nightColors[index*4]));
+	}
+	if (hasSkin)
+    {
+		hash = weldMixHash(hash, vertexBoneIndices[index]);
+
+		for (uint32 j = 0; j < 4; j++)
         {
-			if ( vertexBoneIndices_new[i] != vertexBoneIndices[index] )
-				continue;
+			hash = weldMixHash(hash, weldFloatKey(vertexBoneWeights[index*4+j], weldTolerance.boneWeight));
+        }
+	}
+	return hash;
+}
+
+// Returns true if the vertex at index is equal to the already added vertex newIndex.
+bool Geometry::isTempVertexEqual(uint32 newIndex, uint32 index) const
+{
+	uint32 i = newIndex;
+
+	if (!weldFloatEqual(vertices_new[i*3+0], vertices[index*3+0], weldTolerance.position) ||
+	    !weldFloatEqual(vertices_new[i*3+1], vertices[index*3+1], weldTolerance.position) ||
+	    !weldFloatEqual(vertices_new[i*3+2], vertices[index*3+2], weldTolerance.position))
+		return false;
 
-			if (vertexBoneWeights_new[i*4+0] != vertexBoneWeights[index*4+0] ||
-			    vertexBoneWeights_new[i*4+1] != vertexBoneWeights[index*4+1] ||
-			    vertexBoneWeights_new[i*4+2] != vertexBoneWeights[index*4+2] ||
-			    vertexBoneWeights_new[i*4+3] != vertexBoneWeights[index*4+3])
+	if (flags & FLAGS_NORMALS)
+    {
+		if (!weldFloatEqual(normals_new[i*3+0], normals[index*3+0], weldTolerance.normal) ||
+		    !weldFloatEqual(normals_new[i*3+1], normals[index*3+1], weldTolerance.normal) ||
+		    !weldFloatEqual(normals_new[i*3+2], normals[index*3+2], weldTolerance.normal))
+			return false;
+	}
+	if (flags & FLAGS_TEXTURED || flags & FLAGS_TEXTURED2)
+    {
+		for (uint32 j = 0; j < numUVs; j++)
+        {
+			if (!weldFloatEqual(texCoords_new[j][i*2+0], texCoords[j][index*2+0], weldTolerance.texCoord) ||
+			    !weldFloatEqual(texCoords_new[j][i*2+1], texCoords[j][index*2+1], weldTolerance.texCoord))
             {
-				continue;
+				return false;
             }
-		}
-		// this is only reached when the vertex is already in the list
-		return i;
+        }
+	}
+	if (flags & FLAGS_PRELIT)
+    {
+		if (vertexColors_new[i*4+0]!=vertexColors[index*4+0] ||
+		    vertexColors_new[i*4+1]!=vertexColors[index*4+1] ||
+		    vertexColors_new[i*4+2]!=vertexColors[index*4+2] ||
+		    vertexColors_new[i*4+3]!=vertexColors[index*4+3])
+			return false;
+	}
+	if (hasNightColors)
+    {
+		if (nightColors_new[i*4+0] != nightColors[index*4+0] ||
+		    nightColors_new[i*4+1] != nightColors[index*4+1] ||
+		    nightColors_new[i*4+2] != nightColors[index*4+2] ||
+		    nightColors_new[i*4+3] != nightColors[index*4+3])
+			return false;
+	}
+	if (hasSkin)
+    {
+		if ( vertexBoneIndices_new[i] != vertexBoneIndices[index] )
+			return false;
 
-		cont: ;
+		if (!weldFloatEqual(vertexBoneWeights_new[i*4+0], vertexBoneWeights[index*4+0], weldTolerance.boneWeight) ||
+		    !weldFloatEqual(vertexBoneWeights_new[i*4+1], vertexBoneWeights[index*4+1], weldTolerance.boneWeight) ||
+		    !weldFloatEqual(vertexBoneWeights_new[i*4+2], vertexBoneWeights[index*4+2], weldTolerance.boneWeight) ||
+		    !weldFloatEqual(vertexBoneWeights_new[i*4+3], vertexBoneWeights[index*4+3], weldTolerance.boneWeight))
+        {
+			return false;
+        }
 	}
+	return true;
+}
+
+// used only by Geometry::cleanUp()
+// adds new temporary vertex if it isn't already in the list
+// and returns the new index of that vertex
+uint32 Geometry::addTempVertexIfNew(uint32 index)
+{
+	uint32 hash = getVertexWeldHash(index);
+
+	// return if we already have the vertex
+	uint32 slot = ( hash & weldBucketMask );
+
+	while ( uint32 entry = weldBuckets[slot] )
+    {
+		if ( weldBucketHashes[slot] == hash && isTempVertexEqual(entry - 1, index) )
+        {
+			return entry - 1;
+        }
+
+		slot = ( slot + 1 ) & weldBucketMask;
+    }
 
 	// else add the vertex
+	uint32 newIndex = vertices_new.size()/3;
+
+	weldBuckets[slot] = newIndex + 1;
+	weldBucketHashes[slot] = hash;
+
 	vertices_new.push_back(vertices[index*3+0]);
 	vertices_new.push_back(vertices[index*3+1]);
 	vertices_new.push_back(vertices[index*3+2]);
@@ -920,17 +1056,35 @@ uint32 Geometry::addTempVertexIfNew(uint32 index)
 		vertexBoneWeights_new.push_back(vertexBoneWeights[index*4+2]);
 		vertexBoneWeights_new.push_back(vertexBoneWeights[index*4+3]);
 	}
-	return vertices_new.size()/3 - 1;
+	return newIndex;
 }
 
 // removes duplicate vertices (only useful with ps2 meshes)
-void Geometry::cleanUp(void)
+// If epsilon is bigger than zero then vertices whose positions fall into the same
+// epsilon-sized grid cell are welded together, otherwise they have to match exactly.
+void Geometry::cleanUp(float32 epsilon)
+{
+	weldTolerances tolerances;
+	tolerances.position = epsilon;
+	tolerances.normal = 0.0f;
+	tolerances.texCoord = 0.0f;
+	tolerances.boneWeight = 0.0f;
+
+	cleanUp(tolerances);
+}
+
+// Same as above, but every welded attribute has its own tolerance.
+void Geometry::cleanUp(const weldTolerances& tolerances)
 {
+	uint32 numVertices = vertices.size()/3;
+
 	vertices_new.clear();
 	normals_new.clear();
 	vertexColors_new.clear();
 	nightColors_new.clear();
 
+	vertices_new.reserve(numVertices*3);
+
 	for (uint32 i = 0; i < 8; i++)
     {
 		texCoords_new[i].clear();
@@ -939,10 +1093,35 @@ void Geometry::cleanUp(void)
 	vertexBoneIndices_new.clear();
 	vertexBoneWeights_new.clear();
 
+	// Prepare the hash table, keeping the load factor at or below one half.
+	{
+		uint32 bucketCount = 16;
+
+		while ( bucketCount < numVertices * 2 )
+        {
+			bucketCount *= 2;
+        }
+
+		if ( weldBuckets.size() < bucketCount )
+        {
+			weldBuckets.resize( bucketCount );
+			weldBucketHashes.resize( bucketCount );
+        }
+
+		std::fill( weldBuckets.begin(), weldBuckets.begin() + bucketCount, 0 );
+
+		weldBucketMask = ( bucketCount - 1 );
+		weldTolerance.position = std::max( tolerances.position, 0.0f );
+		weldTolerance.normal = std::max( tolerances.normal, 0.0f );
+		weldTolerance.texCoord = std::max( tolerances.texCoord, 0.0f );
+		weldTolerance.boneWeight = std::max( tolerances.boneWeight, 0.0f );
+	}
+
 	std::vector<uint32> newIndices;
+	newIndices.reserve(numVertices);
 
 	// create new vertex list
-	for (uint32 i = 0; i < vertices.size()/3; i++)
+	for (uint32 i = 0; i < numVertices; i++)
     {
 		newIndices.push_back(addTempVertexIfNew(i));
     }
@@ -617,7 +617,7 @@ void NativeImage::fetchFromRaster( Raster *raster )
         // Attempt to read from the raster into this native texture.
         // This can fail in many cases, we basically rely on the runtime creating a good dispatcher.
         {
-            scoped_rwlock_reader <rwlock> ctxHandle( GetRasterLock( raster ) );
+            scoped_rwlock_reader <rwlock> ctxHandle( GetRasterReadLock( raster ) );
 
             NativeImageFetchFromRaster_internal(
                 engineInterface,
@@ -757,6 +757,8 @@ void NativeImage::putToRaster( Raster *raster )
     {
         scoped_rwlock_writer <rwlock> ctxWriteToRaster( GetRasterLock( raster ) );
 
+        NativeCheckRasterMutable( raster );
+
         NativeImagePutToRaster_internal( engineInterface, typeMan, nativeImageMem, raster );
     }
 }
@@ -2414,12 +2414,6 @@ struct pvrNativeImageTypeManager : public nativeImageTypeManager
                     {
                         if ( isPVRTC_compressed )
                         {
-                            // Prepare decompression params.
-                            // Some handles to compressor params.
-                            pvrNativeTextureTypeProvider::PVRPixelType pvrSrcPixelType = pvrNativeEnv->PVRGetCachedPixelType( pvrtc_comprType );
-
-                            pvrNativeTextureTypeProvider::PVRPixelType pvrDstPixelType = pvrNativeEnv->pvrPixelType_rgba8888;
-
                             // Decompress the layers.
                             pvrNativeImage::mipmaps_t transLayers;
 
@@ -2445,11 +2439,9 @@ struct pvrNativeImageTypeManager : public nativeImageTypeManager
                                     uint32 dstDataSize;
                                 
                                     pvrNativeEnv->DecompressPVRMipmap(
-                                        engineInterface,
-                                        surfWidth, surfHeight, layerWidth, layerHeight, srcTexels,
-                                        RASTER_8888, 32, COLOR_RGBA,
+                                        engineInterface, pvrtc_comprType,
+                                        surfWidth, surfHeight, layerWidth, layerHeight, srcTexels, srcDataSize,
                                         frm_pvrRasterFormat, frm_pvrDepth, frm_pvrRowAlignment, frm_pvrColorOrder,
-                                        pvrSrcPixelType, pvrDstPixelType,
                                         dstTexels, dstDataSize
                                     );
 
@@ -2830,17 +2822,6 @@ struct pvrNativeImageTypeManager : public nativeImageTypeManager
                         pvrtc_comprType = pvrNativeEnv->GetRecommendedPVRCompressionFormat( baseLayer.layerWidth, baseLayer.layerHeight, shouldHaveAlpha );
                     }
 
-                    uint32 comprBitDepth = getDepthByPVRFormat( pvrtc_comprType );
-
-                    // Prepare PVR compression params.
-                    pvrNativeTextureTypeProvider::PVRPixelType pvrSrcPixelType = pvrNativeEnv->pvrPixelType_rgba8888;
-
-                    pvrNativeTextureTypeProvider::PVRPixelType pvrDstPixelType = pvrNativeEnv->PVRGetCachedPixelType( pvrtc_comprType );
-
-                    uint32 pvrBlockWidth, pvrBlockHeight;
-
-                    getPVRCompressionBlockDimensions( comprBitDepth, pvrBlockWidth, pvrBlockHeight );
-
                     // Compress!
                     pvrNativeImage::mipmaps_t convLayers;
 
@@ -2865,13 +2846,9 @@ struct pvrNativeImageTypeManager : public nativeImageTypeManager
                             uint32 dstDataSize;
 
                             pvrNativeEnv->GenericCompressMipmapToPVR(
-                                engineInterface,
+                                engineInterface, pvrtc_comprType,
                                 layerWidth, layerHeight, srcTexels,
                                 tmpColorDispatch, tmpPixelDepth, frm_pvrRowAlignment,
-                                RASTER_8888, 32, COLOR_RGBA,
-                                pvrSrcPixelType, pvrDstPixelType,
-                                pvrBlockWidth, pvrBlockHeight,
-                                comprBitDepth,
                                 dstSurfWidth, dstSurfHeight,
                                 dstTexels, dstDataSize
                             );
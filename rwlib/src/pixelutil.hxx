@@ -7,6 +7,8 @@
 
 #include "txdread.d3d.dxt.hxx"
 
+#include <emmintrin.h>
+
 namespace rw
 {
 
@@ -172,6 +174,70 @@ AINLINE bool rawGenericColorBufferHasAlpha(
     return false;
 }
 
+// Returns the byte offset of the alpha channel inside of a 32bit RASTER_8888 texel.
+inline bool getRaster8888AlphaByteOffset( eColorOrdering colorOrder, uint32& offsetOut )
+{
+    switch( colorOrder )
+    {
+    case COLOR_RGBA:
+    case COLOR_BGRA:
+        offsetOut = 3;
+        return true;
+    case COLOR_ABGR:
+        offsetOut = 0;
+        return true;
+    case COLOR_ARGB:
+        offsetOut = 2;
+        return true;
+    case COLOR_BARG:
+        offsetOut = 1;
+        return true;
+    }
+
+    return false;
+}
+
+// Scans 32bit texels for an alpha value that is not 255, four texels at a time.
+AINLINE bool raw8888ColorBufferHasAlpha(
+    uint32 layerWidth, uint32 layerHeight, const void *texelSource, uint32 rowAlignment, uint32 alphaByteOffset
+)
+{
+    uint32 srcRowSize = getRasterDataRowSize( layerWidth, 32, rowAlignment );
+
+    // We force all color bytes to 0xFF, so an opaque group of texels is all bits set.
+    const __m128i colorMask = _mm_set1_epi32( (int)~( 0xFFu << ( alphaByteOffset * 8 ) ) );
+    const __m128i allSet = _mm_set1_epi32( -1 );
+
+    for ( uint32 row = 0; row < layerHeight; row++ )
+    {
+        const uint8 *srcRowData = (const uint8*)getConstTexelDataRow( texelSource, srcRowSize, row );
+
+        uint32 col = 0;
+
+        for ( ; col + 4 <= layerWidth; col += 4 )
+        {
+            __m128i texels = _mm_loadu_si128( (const __m128i*)( srcRowData + col * 4 ) );
+
+            __m128i isOpaque = _mm_cmpeq_epi8( _mm_or_si128( texels, colorMask ), allSet );
+
+            if ( _mm_movemask_epi8( isOpaque ) != 0xFFFF )
+            {
+                return true;
+            }
+        }
+
+        for ( ; col < layerWidth; col++ )
+        {
+            if ( srcRowData[ col * 4 + alphaByteOffset ] != 255 )
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 // Returns whether a original RW types only mipmap has transparent texels.
 AINLINE bool rawMipmapCalculateHasAlpha(
     uint32 layerWidth, uint32 layerHeight, const void *texelSource, uint32 texelDataSize,
@@ -188,23 +254,43 @@ AINLINE bool rawMipmapCalculateHasAlpha(
         // If we are palettized, we can just check the palette colors.
         if (paletteType != PALETTE_NONE)
         {
-            // Determine whether we REALLY use all palette indice.
-            uint32 palItemCount = paletteSize;
+            // Palettes have at most 256 entries.
+            uint32 palItemCount = std::min( paletteSize, 256u );
+
+            // Find out which palette colors are transparent first.
+            // If none of them is, then no texel can be either.
+            bool isTransparentColor[ 256 ];
+
+            bool hasTransparentColor = false;
+
+            const void *palColorSource = paletteData;
+
+            uint32 palFormatDepth = Bitmap::getRasterFormatDepth(rasterFormat);
 
-            bool *usageFlags = new bool[ palItemCount ];
+            colorModelDispatcher fetchDispatch( rasterFormat, colorOrder, palFormatDepth, NULL, 0, PALETTE_NONE );
 
-            for ( uint32 n = 0; n < palItemCount; n++ )
+            for (uint32 n = 0; n < palItemCount; n++)
             {
-                usageFlags[ n ] = false;
-            }
+                uint8 r, g, b, a;
+
+                bool hasColor = fetchDispatch.getRGBA( palColorSource, n, r, g, b, a);
 
-            uint32 srcRowSize = getRasterDataRowSize( layerWidth, depth, rowAlignment );
+                bool isTransparent = ( hasColor && a != 255 );
 
-            // Loop through all pixels of the image.
+                isTransparentColor[ n ] = isTransparent;
+
+                if ( isTransparent )
+                {
+                    hasTransparentColor = true;
+                }
+            }
+
+            if ( hasTransparentColor )
             {
-                const void *texelData = texelSource;
+                // Only palette colors that are really used count.
+                uint32 srcRowSize = getRasterDataRowSize( layerWidth, depth, rowAlignment );
 
-                for ( uint32 row = 0; row < layerHeight; row++ )
+                for ( uint32 row = 0; row < layerHeight && !hasAlpha; row++ )
                 {
                     const void *srcRowData = getConstTexelDataRow( texelSource, srcRowSize, row );
 
@@ -214,44 +300,30 @@ AINLINE bool rawMipmapCalculateHasAlpha(
 
                         bool hasIndex = getpaletteindex(srcRowData, paletteType, palItemCount, depth, col, palIndex);
 
-                        if ( hasIndex && palIndex < palItemCount )
+                        if ( hasIndex && palIndex < palItemCount && isTransparentColor[ palIndex ] )
                         {
-                            usageFlags[ palIndex ] = true;
+                            hasAlpha = true;
+                            break;
                         }
                     }
                 }
             }
-
-            const void *palColorSource = paletteData;
-
-            uint32 palFormatDepth = Bitmap::getRasterFormatDepth(rasterFormat);
-
-            colorModelDispatcher fetchDispatch( rasterFormat, colorOrder, palFormatDepth, NULL, 0, PALETTE_NONE );
-
-            for (uint32 n = 0; n < palItemCount; n++)
-            {
-                if ( usageFlags[ n ] == true )
-                {
-                    uint8 r, g, b, a;
-
-                    bool hasColor = fetchDispatch.getRGBA( palColorSource, n, r, g, b, a);
-
-                    if (hasColor && a != 255)
-                    {
-                        hasAlpha = true;
-                        break;
-                    }
-                }
-            }
-
-            // Free memory.
-            delete [] usageFlags;
         }
         else
         {
-            colorModelDispatcher fetchDispatch( rasterFormat, colorOrder, depth, NULL, 0, PALETTE_NONE );
+            uint32 alphaByteOffset;
+
+            if ( rasterFormat == RASTER_8888 && depth == 32 && getRaster8888AlphaByteOffset( colorOrder, alphaByteOffset ) )
+            {
+                // The most common format gets a fast path.
+                hasAlpha = raw8888ColorBufferHasAlpha( layerWidth, layerHeight, texelSource, rowAlignment, alphaByteOffset );
+            }
+            else
+            {
+                colorModelDispatcher fetchDispatch( rasterFormat, colorOrder, depth, NULL, 0, PALETTE_NONE );
 
-            hasAlpha = rawGenericColorBufferHasAlpha( layerWidth, layerHeight, texelSource, texelDataSize, fetchDispatch, depth, rowAlignment );
+                hasAlpha = rawGenericColorBufferHasAlpha( layerWidth, layerHeight, texelSource, texelDataSize, fetchDispatch, depth, rowAlignment );
+            }
         }
     }
 
@@ -259,6 +331,7 @@ AINLINE bool rawMipmapCalculateHasAlpha(
 }
 
 // Returns whether a DXT compressed mipmap has transparent data.
+// Every block is decided by its header or by a bit trick on its index list, so no texel is decoded.
 AINLINE bool dxtMipmapCalculateHasAlpha(
     uint32 mipWidth, uint32 mipHeight, uint32 layerWidth, uint32 layerHeight, const void *srcTexels,
     uint32 dxtType
@@ -273,112 +346,90 @@ AINLINE bool dxtMipmapCalculateHasAlpha(
 
     uint32 compressionBlockCount = ( alignedSurfWidth * alignedSurfHeight ) / ( block_width * block_height );
 
-    // Process the blocks. 
-    uint32 cur_block_x = 0;
-    uint32 cur_block_y = 0;
-
-    for ( uint32 n = 0; n < compressionBlockCount; n++ )
+    if ( dxtType == 1 )
     {
-        // Process this block.
-        bool canBlockHaveAlpha = true;
+        const dxt1_block <endian::little_endian> *dxtBlocks = (const dxt1_block <endian::little_endian> *)srcTexels;
 
-        // Check whether this block can even have alpha.
-        if ( dxtType == 1 )
+        for ( uint32 n = 0; n < compressionBlockCount; n++ )
         {
-            const dxt1_block <endian::little_endian> *dxtBlock = (const dxt1_block <endian::little_endian> *)srcTexels + n;
-
-            rgb565 col0 = dxtBlock->col0;
-            rgb565 col1 = dxtBlock->col1;
-
-            canBlockHaveAlpha = ( col0.val <= col1.val );
-        }
+            const dxt1_block <endian::little_endian>& dxtBlock = dxtBlocks[ n ];
 
-        bool doesHaveAlpha = false;
+            rgb565 col0 = dxtBlock.col0;
+            rgb565 col1 = dxtBlock.col1;
 
-        if ( canBlockHaveAlpha )
-        {
-            for ( uint32 local_y = 0; local_y < block_height; local_y++ )
+            // Only blocks in three-color mode can have transparent texels.
+            if ( col0.val <= col1.val )
             {
-                for ( uint32 local_x = 0; local_x < block_width; local_x++ )
+                // A texel is transparent if it is on index 3, so both of its index bits are set.
+                uint32 indexList = dxtBlock.indexList;
+
+                if ( ( indexList & ( indexList >> 1 ) & 0x55555555u ) != 0 )
                 {
-                    if ( dxtType == 1 )
-                    {
-                        const dxt1_block <endian::little_endian> *dxtBlock = (const dxt1_block <endian::little_endian> *)srcTexels + n;
+                    return true;
+                }
+            }
+        }
+    }
+    else if ( dxtType == 2 || dxtType == 3 )
+    {
+        const dxt2_3_block <endian::little_endian> *dxtBlocks = (const dxt2_3_block <endian::little_endian> *)srcTexels;
 
-                        // If this pixel is on index 3, it is transparent.
-                        uint32 index = fetchDXTIndexList( dxtBlock->indexList, local_x, local_y );
+        for ( uint32 n = 0; n < compressionBlockCount; n++ )
+        {
+            // Sixteen explicit 4bit alpha values; the block is opaque if all of them are 15.
+            uint64 alphaList = dxtBlocks[ n ].alphaList;
 
-                        if ( index == 3 )
-                        {
-                            doesHaveAlpha = true;
-                            break;
-                        }
-                    }
-                    else if ( dxtType == 2 || dxtType == 3 )
-                    {
-                        const dxt2_3_block <endian::little_endian> *dxtBlock = (const dxt2_3_block <endian::little_endian> *)srcTexels + n;
+            if ( alphaList != 0xFFFFFFFFFFFFFFFFull )
+            {
+                return true;
+            }
+        }
+    }
+    else if ( dxtType == 4 || dxtType == 5 )
+    {
+        const dxt4_5_block <endian::little_endian> *dxtBlocks = (const dxt4_5_block <endian::little_endian> *)srcTexels;
 
-                        // Here, we have individual alpha fields.
-                        // That is why we have to index it properly.
-                        uint32 coord_index = getDXTLocalBlockIndex( local_x, local_y );
+        for ( uint32 n = 0; n < compressionBlockCount; n++ )
+        {
+            const dxt4_5_block <endian::little_endian>& dxtBlock = dxtBlocks[ n ];
 
-                        uint32 alpha = dxtBlock->getAlphaForTexel( coord_index );
+            uint32 first_alpha = dxtBlock.alphaPreMult[0];
+            uint32 second_alpha = dxtBlock.alphaPreMult[1];
 
-                        if ( alpha != 15u )
-                        {
-                            doesHaveAlpha = true;
-                            break;
-                        }
-                    }
-                    else if ( dxtType == 4 || dxtType == 5 )
-                    {
-                        const dxt4_5_block <endian::little_endian> *dxtBlock = (const dxt4_5_block <endian::little_endian> *)srcTexels + n;
+            // Find out which of the eight alpha indice are not opaque.
+            uint32 transparentIndexMask = 0;
 
-                        // In this format there is really high quality alpha, sort of.
-                        uint32 coord_index = getDXTLocalBlockIndex( local_x, local_y );
+            for ( uint32 alphaIndex = 0; alphaIndex < 8; alphaIndex++ )
+            {
+                if ( dxt4_5_block <endian::little_endian>::getAlphaByIndex( first_alpha, second_alpha, alphaIndex ) != 255u )
+                {
+                    transparentIndexMask |= ( 1u << alphaIndex );
+                }
+            }
 
-                        uint48_t alphaListMetric = dxtBlock->alphaList;
+            if ( transparentIndexMask == 0 )
+                continue;
 
-                        const uint64 *alphaList = (const uint64*)&alphaListMetric;
+            // Check the texels against it.
+            uint48_t alphaListMetric = dxtBlock.alphaList;
 
-                        uint32 alphaIndex = (uint32)indexlist_lookup( *alphaList, (uint64)coord_index, (uint64)3 );
+            uint64 alphaList = 0;
 
-                        uint8 theAlpha = dxt4_5_block <endian::little_endian>::getAlphaByIndex( dxtBlock->alphaPreMult[0], dxtBlock->alphaPreMult[1], alphaIndex );
+            for ( uint32 byteIndex = 0; byteIndex < 6; byteIndex++ )
+            {
+                alphaList |= ( (uint64)(uint8)alphaListMetric.data[ byteIndex ] << ( byteIndex * 8 ) );
+            }
 
-                        if ( theAlpha != 255u )
-                        {
-                            doesHaveAlpha = true;
-                            break;
-                        }
-                    }
-                }
+            for ( uint32 coord_index = 0; coord_index < 16; coord_index++ )
+            {
+                uint32 alphaIndex = (uint32)( ( alphaList >> ( coord_index * 3 ) ) & 7u );
 
-                if ( doesHaveAlpha )
+                if ( transparentIndexMask & ( 1u << alphaIndex ) )
                 {
-                    break;
+                    return true;
                 }
             }
         }
-
-        if ( doesHaveAlpha )
-        {
-            return true;
-        }
-
-        // Advance the texel pointer.
-        cur_block_x += block_width;
-
-        if ( cur_block_x >= alignedSurfWidth )
-        {
-            cur_block_x = 0;
-            cur_block_y += block_height;
-        }
-
-        if ( cur_block_y >= alignedSurfHeight )
-        {
-            // We reached the end of the texture.
-            break;
-        }
     }
 
     // We found no transparent texel.
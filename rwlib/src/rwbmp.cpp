@@ -350,66 +350,6 @@ void Bitmap::scale(
     this->rowSize = getRasterDataRowSize( width, depth, rowAlignment );
 }
 
-AINLINE void fetchpackedcolor(
-    const void *texels, uint32 x, uint32 y, eRasterFormat theFormat, eColorOrdering colorOrder, uint32 itemDepth, uint32 rowSize, double& redOut, double& greenOut, double& blueOut, double& alphaOut
-)
-{
-    colorModelDispatcher fetchDispatch( theFormat, colorOrder, itemDepth, NULL, 0, PALETTE_NONE );
-
-    const void *srcRow = getConstTexelDataRow( texels, rowSize, y );
-
-    fetchDispatch.getRGBA(
-        srcRow, x,
-        redOut, greenOut, blueOut, alphaOut
-    );
-}
-
-AINLINE void getblendfactor(
-    double srcRed, double srcGreen, double srcBlue, double srcAlpha,
-    double dstRed, double dstGreen, double dstBlue, double dstAlpha,
-    Bitmap::eShadeMode shadeMode,
-    double& blendRed, double& blendGreen, double& blendBlue, double& blendAlpha
-)
-{
-    if ( shadeMode == Bitmap::SHADE_SRCALPHA )
-    {
-        blendRed = srcAlpha;
-        blendGreen = srcAlpha;
-        blendBlue = srcAlpha;
-        blendAlpha = srcAlpha;
-    }
-    else if ( shadeMode == Bitmap::SHADE_INVSRCALPHA )
-    {
-        double invAlpha = ( 1.0 - srcAlpha );
-
-        blendRed = invAlpha;
-        blendGreen = invAlpha;
-        blendBlue = invAlpha;
-        blendAlpha = invAlpha;
-    }
-    else if ( shadeMode == Bitmap::SHADE_ONE )
-    {
-        blendRed = 1;
-        blendGreen = 1;
-        blendBlue = 1;
-        blendAlpha = 1;
-    }
-    else if ( shadeMode == Bitmap::SHADE_ZERO )
-    {
-        blendRed = 0;
-        blendGreen = 0;
-        blendBlue = 0;
-        blendAlpha = 0;
-    }
-    else
-    {
-        blendRed = 1;
-        blendGreen = 1;
-        blendBlue = 1;
-        blendAlpha = 1;
-    }
-}
-
 eColorModel Bitmap::getColorModel( void ) const
 {
     return getColorModelFromRasterFormat( this->rasterFormat );
@@ -485,135 +425,275 @@ bool Bitmap::browsecolorex(uint32 x, uint32 y, rwAbstractColorItem& colorItem) c
     return hasColor;
 }
 
-void Bitmap::draw(
-    sourceColorPipeline& colorSource, uint32 offX, uint32 offY, uint32 drawWidth, uint32 drawHeight,
-    eShadeMode srcChannel, eShadeMode dstChannel, eBlendMode blendMode
-)
+// Color of a pixel inside of a drawing span.
+struct drawSpanColor
+{
+    uint8 r, g, b, a;
+};
+
+// Returns a * b / 255, rounded.
+AINLINE uint8 mulcolor( uint32 a, uint32 b )
+{
+    uint32 prod = ( a * b + 128 );
+
+    return (uint8)( ( prod + ( prod >> 8 ) ) >> 8 );
+}
+
+AINLINE uint32 getshadefactor( Bitmap::eShadeMode shadeMode, uint8 srcAlpha )
+{
+    if ( shadeMode == Bitmap::SHADE_SRCALPHA )
+    {
+        return srcAlpha;
+    }
+    else if ( shadeMode == Bitmap::SHADE_INVSRCALPHA )
+    {
+        return ( 255u - srcAlpha );
+    }
+    else if ( shadeMode == Bitmap::SHADE_ZERO )
+    {
+        return 0;
+    }
+
+    return 255;
+}
+
+AINLINE bool isPackedBGRA8888( eRasterFormat rasterFormat, eColorOrdering colorOrder, uint32 depth )
 {
-    // Put parameters on stack.
-    uint32 ourWidth = this->width;
-    uint32 ourHeight = this->height;
-    uint32 ourDepth = this->depth;
-    uint32 ourRowSize = this->rowSize;
-    void *ourTexels = this->texels;
-    eRasterFormat ourFormat = this->rasterFormat;
-    eColorOrdering ourOrder = this->colorOrder;
+    return ( rasterFormat == RASTER_8888 && colorOrder == COLOR_BGRA && depth == 32 );
+}
+
+AINLINE drawSpanColor unpackBGRA8888( uint32 packed )
+{
+    drawSpanColor color;
+    color.b = (uint8)( packed );
+    color.g = (uint8)( packed >> 8 );
+    color.r = (uint8)( packed >> 16 );
+    color.a = (uint8)( packed >> 24 );
+
+    return color;
+}
+
+AINLINE uint32 packBGRA8888( const drawSpanColor& color )
+{
+    return ( (uint32)color.b | ( (uint32)color.g << 8 ) | ( (uint32)color.r << 16 ) | ( (uint32)color.a << 24 ) );
+}
+
+// Provider of the colors that are drawn onto a bitmap.
+// Colors are requested span-by-span so that the per-pixel overhead stays small.
+struct drawSpanSource abstract
+{
+    virtual uint32 getWidth( void ) const = 0;
+    virtual uint32 getHeight( void ) const = 0;
+
+    // Fetches the colors of row srcY at the given columns.
+    virtual void fetchspan( uint32 srcY, const uint32 *srcColumns, uint32 spanWidth, drawSpanColor *colorsOut ) = 0;
+
+    // Returns the row as packed BGRA8888 if the source is stored that way, NULL otherwise.
+    virtual const uint32* getpackedrow( uint32 srcY )
+    {
+        return NULL;
+    }
+};
+
+// Maps destination steps to source coordinates using exact integer stepping (dst * srcSize / drawSize).
+static void calculateDrawSpanCoords( uint32 srcSize, uint32 drawSize, uint32 count, uint32 *coordsOut )
+{
+    uint32 stepWhole = ( srcSize / drawSize );
+    uint32 stepFrac = ( srcSize % drawSize );
+
+    uint32 coord = 0;
+    uint32 frac = 0;
+
+    for ( uint32 n = 0; n < count; n++ )
+    {
+        coordsOut[ n ] = coord;
+
+        coord += stepWhole;
+        frac += stepFrac;
+
+        if ( frac >= drawSize )
+        {
+            frac -= drawSize;
+            coord++;
+        }
+    }
+}
 
+static void drawspans(
+    void *ourTexels, uint32 ourWidth, uint32 ourHeight, uint32 ourDepth, uint32 ourRowSize, eRasterFormat ourFormat, eColorOrdering ourOrder,
+    drawSpanSource& colorSource, uint32 offX, uint32 offY, uint32 drawWidth, uint32 drawHeight,
+    Bitmap::eShadeMode srcChannel, Bitmap::eShadeMode dstChannel, Bitmap::eBlendMode blendMode
+)
+{
     uint32 theirWidth = colorSource.getWidth();
     uint32 theirHeight = colorSource.getHeight();
 
-    // Determine the output codec for pixel set.
+    // Clip the drawing area against our plane.
+    if ( offX >= ourWidth || offY >= ourHeight || theirWidth == 0 || theirHeight == 0 )
+        return;
+
+    uint32 spanWidth = std::min( drawWidth, ourWidth - offX );
+    uint32 spanHeight = std::min( drawHeight, ourHeight - offY );
+
+    if ( spanWidth == 0 || spanHeight == 0 )
+        return;
+
+    // Source coordinates for every destination column and row.
+    std::vector <uint32> srcColumns( spanWidth );
+    std::vector <uint32> srcRows( spanHeight );
+
+    calculateDrawSpanCoords( theirWidth, drawWidth, spanWidth, srcColumns.data() );
+    calculateDrawSpanCoords( theirHeight, drawHeight, spanHeight, srcRows.data() );
+
+    bool isUnscaled = ( theirWidth == drawWidth );
+
+    bool isPackedTarget = isPackedBGRA8888( ourFormat, ourOrder, ourDepth );
+
+    // Detect the common blending setups.
+    bool isStraightCopy = ( srcChannel == Bitmap::SHADE_ZERO && dstChannel == Bitmap::SHADE_ONE && blendMode == Bitmap::BLEND_ADDITIVE );
+    bool isAlphaOver = ( srcChannel == Bitmap::SHADE_SRCALPHA && dstChannel == Bitmap::SHADE_INVSRCALPHA && blendMode == Bitmap::BLEND_ADDITIVE );
+
     colorModelDispatcher putDispatch( ourFormat, ourOrder, ourDepth, NULL, 0, PALETTE_NONE );
 
-    // Calculate drawing parameters.
-    double floatOffX = (double)offX;
-    double floatOffY = (double)offY;
-    double floatDrawWidth = (double)drawWidth;
-    double floatDrawHeight = (double)drawHeight;
-    double srcBitmapWidthStride = ( theirWidth / floatDrawWidth );
-    double srcBitmapHeightStride = ( theirHeight / floatDrawHeight );
+    std::vector <drawSpanColor> spanColors( spanWidth );
 
-    // Perform the drawing.
-    for ( double y = 0; y < floatDrawHeight; y++ )
+    for ( uint32 y = 0; y < spanHeight; y++ )
     {
-        for ( double x = 0; x < floatDrawWidth; x++ )
-        {
-            // Get the coordinates to draw on into this bitmap.
-            uint32 sourceX = (uint32)( x + floatOffX );
-            uint32 sourceY = (uint32)( y + floatOffY );
+        uint32 srcY = srcRows[ y ];
 
-            // Get the coordinates from the bitmap that is being drawn from.
-            uint32 targetX = (uint32)( x * srcBitmapWidthStride );
-            uint32 targetY = (uint32)( y * srcBitmapHeightStride );
+        void *dstRow = getTexelDataRow( ourTexels, ourRowSize, offY + y );
 
-            // Check that all coordinates are inside of their dimensions.
-            if ( targetX < theirWidth && targetY < theirHeight &&
-                 sourceX < ourWidth && sourceY < ourHeight )
-            {
-                // Fetch the colors from both bitmaps.
-                double sourceRed, sourceGreen, sourceBlue, sourceAlpha;
-                double dstRed, dstGreen, dstBlue, dstAlpha;
+        if ( isPackedTarget && isStraightCopy )
+        {
+            // Fast path: plain copy or nearest scaling of packed pixels.
+            uint32 *dstPixels = (uint32*)dstRow + offX;
 
-                // Fetch from "source".
+            if ( const uint32 *srcPixels = colorSource.getpackedrow( srcY ) )
+            {
+                if ( isUnscaled )
                 {
-                    fetchpackedcolor(
-                        ourTexels, sourceX, sourceY, ourFormat, ourOrder, ourDepth, ourRowSize,
-                        sourceRed, sourceGreen, sourceBlue, sourceAlpha
-                    );
+                    memcpy( dstPixels, srcPixels, sizeof( uint32 ) * spanWidth );
                 }
-
-                // Fetch from "destination".
+                else
                 {
-                    colorSource.fetchcolor(targetX, targetY, dstRed, dstGreen, dstBlue, dstAlpha);
+                    for ( uint32 x = 0; x < spanWidth; x++ )
+                    {
+                        dstPixels[ x ] = srcPixels[ srcColumns[ x ] ];
+                    }
                 }
+            }
+            else
+            {
+                colorSource.fetchspan( srcY, srcColumns.data(), spanWidth, spanColors.data() );
 
-                // Get the blend factors.
-                double srcBlendRed, srcBlendGreen, srcBlendBlue, srcBlendAlpha;
-                double dstBlendRed, dstBlendGreen, dstBlendBlue, dstBlendAlpha;
-                
-                getblendfactor(
-                    sourceRed, sourceGreen, sourceBlue, sourceAlpha,
-                    dstRed, dstGreen, dstBlue, dstAlpha, srcChannel,
-                    srcBlendRed, srcBlendGreen, srcBlendBlue, srcBlendAlpha
-                );
-                getblendfactor(
-                    sourceRed, sourceGreen, sourceBlue, sourceAlpha,
-                    dstRed, dstGreen, dstBlue, dstAlpha, dstChannel,
-                    dstBlendRed, dstBlendGreen, dstBlendBlue, dstBlendAlpha
-                );
-
-                // Get the blended colors.
-                double srcBlendedRed = ( sourceRed * srcBlendRed );
-                double srcBlendedGreen = ( sourceGreen * srcBlendGreen );
-                double srcBlendedBlue = ( sourceBlue * srcBlendBlue );
-                double srcBlendedAlpha = ( sourceAlpha * srcBlendAlpha );
-
-                double dstBlendedRed = ( dstRed * dstBlendRed );
-                double dstBlendedGreen = ( dstGreen * dstBlendGreen );
-                double dstBlendedBlue = ( dstBlue * dstBlendBlue );
-                double dstBlendedAlpha = ( dstAlpha * dstBlendAlpha );
-
-                // Perform the color op.
-                double resRed, resGreen, resBlue, resAlpha;
+                for ( uint32 x = 0; x < spanWidth; x++ )
                 {
-                    if ( blendMode == BLEND_MODULATE )
-                    {
-                        resRed = srcBlendedRed * dstBlendedRed;
-                        resGreen = srcBlendedGreen * dstBlendedGreen;
-                        resBlue = srcBlendedBlue * dstBlendedBlue;
-                        resAlpha = srcBlendedAlpha * dstBlendedAlpha;
-                    }
-                    else if ( blendMode == BLEND_ADDITIVE )
-                    {
-                        resRed = srcBlendedRed + dstBlendedRed;
-                        resGreen = srcBlendedGreen + dstBlendedGreen;
-                        resBlue = srcBlendedBlue + dstBlendedBlue;
-                        resAlpha = srcBlendedAlpha + dstBlendedAlpha;
-                    }
-                    else
-                    {
-                        resRed = sourceRed;
-                        resGreen = sourceGreen;
-                        resBlue = sourceBlue;
-                        resAlpha = sourceAlpha;
-                    }
+                    dstPixels[ x ] = packBGRA8888( spanColors[ x ] );
                 }
+            }
 
-                // Clamp the colors.
-                resRed = std::max( 0.0, std::min( 1.0, resRed ) );
-                resGreen = std::max( 0.0, std::min( 1.0, resGreen ) );
-                resBlue = std::max( 0.0, std::min( 1.0, resBlue ) );
-                resAlpha = std::max( 0.0, std::min( 1.0, resAlpha ) );
+            continue;
+        }
 
-                // Write back the new color.
-                {
-                    void *dstRow = getTexelDataRow( ourTexels, ourRowSize, sourceY );
+        colorSource.fetchspan( srcY, srcColumns.data(), spanWidth, spanColors.data() );
+
+        if ( isPackedTarget && isAlphaOver )
+        {
+            // Fast path: the bitmap pixels are blended over the drawn colors by their alpha.
+            uint32 *dstPixels = (uint32*)dstRow + offX;
+
+            for ( uint32 x = 0; x < spanWidth; x++ )
+            {
+                drawSpanColor ourColor = unpackBGRA8888( dstPixels[ x ] );
+                const drawSpanColor& theirColor = spanColors[ x ];
+
+                uint32 ourFactor = ourColor.a;
+                uint32 theirFactor = ( 255u - ourFactor );
+
+                drawSpanColor resColor;
+                resColor.r = (uint8)std::min( 255u, (uint32)mulcolor( ourColor.r, ourFactor ) + mulcolor( theirColor.r, theirFactor ) );
+                resColor.g = (uint8)std::min( 255u, (uint32)mulcolor( ourColor.g, ourFactor ) + mulcolor( theirColor.g, theirFactor ) );
+                resColor.b = (uint8)std::min( 255u, (uint32)mulcolor( ourColor.b, ourFactor ) + mulcolor( theirColor.b, theirFactor ) );
+                resColor.a = (uint8)std::min( 255u, (uint32)mulcolor( ourColor.a, ourFactor ) + mulcolor( theirColor.a, theirFactor ) );
+
+                dstPixels[ x ] = packBGRA8888( resColor );
+            }
+
+            continue;
+        }
+
+        // General path.
+        for ( uint32 x = 0; x < spanWidth; x++ )
+        {
+            uint32 dstX = ( offX + x );
+
+            drawSpanColor ourColor;
+
+            if ( isPackedTarget )
+            {
+                ourColor = unpackBGRA8888( ( (const uint32*)dstRow )[ dstX ] );
+            }
+            else if ( !putDispatch.getRGBA( dstRow, dstX, ourColor.r, ourColor.g, ourColor.b, ourColor.a ) )
+            {
+                ourColor.r = 0;
+                ourColor.g = 0;
+                ourColor.b = 0;
+                ourColor.a = 0;
+            }
+
+            const drawSpanColor& theirColor = spanColors[ x ];
 
-                    putDispatch.setRGBA(
-                        dstRow, sourceX,
-                        packcolor( resRed ), packcolor( resGreen ), packcolor( resBlue ), packcolor( resAlpha )
-                    );
+            uint32 ourFactor = getshadefactor( srcChannel, ourColor.a );
+            uint32 theirFactor = getshadefactor( dstChannel, ourColor.a );
+
+            uint8 ourBlended[4] =
+            {
+                mulcolor( ourColor.r, ourFactor ),
+                mulcolor( ourColor.g, ourFactor ),
+                mulcolor( ourColor.b, ourFactor ),
+                mulcolor( ourColor.a, ourFactor )
+            };
+            uint8 theirBlended[4] =
+            {
+                mulcolor( theirColor.r, theirFactor ),
+                mulcolor( theirColor.g, theirFactor ),
+                mulcolor( theirColor.b, theirFactor ),
+                mulcolor( theirColor.a, theirFactor )
+            };
+
+            // Perform the color op.
+            uint8 res[4];
+
+            for ( uint32 n = 0; n < 4; n++ )
+            {
+                if ( blendMode == Bitmap::BLEND_MODULATE )
+                {
+                    res[ n ] = mulcolor( ourBlended[ n ], theirBlended[ n ] );
+                }
+                else if ( blendMode == Bitmap::BLEND_ADDITIVE )
+                {
+                    res[ n ] = (uint8)std::min( 255u, (uint32)ourBlended[ n ] + theirBlended[ n ] );
                 }
+                else
+                {
+                    res[ n ] = ( n == 0 ? ourColor.r : n == 1 ? ourColor.g : n == 2 ? ourColor.b : ourColor.a );
+                }
+            }
+
+            // Write back the new color.
+            if ( isPackedTarget )
+            {
+                drawSpanColor resColor;
+                resColor.r = res[0];
+                resColor.g = res[1];
+                resColor.b = res[2];
+                resColor.a = res[3];
+
+                ( (uint32*)dstRow )[ dstX ] = packBGRA8888( resColor );
+            }
+            else
+            {
+                putDispatch.setRGBA( dstRow, dstX, res[0], res[1], res[2], res[3] );
             }
         }
     }
@@ -621,33 +701,95 @@ void Bitmap::draw(
     // We are finished!
 }
 
+AINLINE uint8 packclampedcolor( double color )
+{
+    return packcolor( std::max( 0.0, std::min( 1.0, color ) ) );
+}
+
+void Bitmap::draw(
+    sourceColorPipeline& colorSource, uint32 offX, uint32 offY, uint32 drawWidth, uint32 drawHeight,
+    eShadeMode srcChannel, eShadeMode dstChannel, eBlendMode blendMode
+)
+{
+    // Feeds the spans from a generic color pipeline.
+    struct pipelineSpanSource : public drawSpanSource
+    {
+        sourceColorPipeline& pipeline;
+
+        inline pipelineSpanSource( sourceColorPipeline& pipeline ) : pipeline( pipeline )
+        {
+            return;
+        }
+
+        uint32 getWidth( void ) const
+        {
+            return pipeline.getWidth();
+        }
+
+        uint32 getHeight( void ) const
+        {
+            return pipeline.getHeight();
+        }
+
+        void fetchspan( uint32 srcY, const uint32 *srcColumns, uint32 spanWidth, drawSpanColor *colorsOut )
+        {
+            for ( uint32 x = 0; x < spanWidth; x++ )
+            {
+                uint32 srcX = srcColumns[ x ];
+
+                // Magnified spans repeat source pixels, so reuse the previous fetch.
+                if ( x != 0 && srcColumns[ x - 1 ] == srcX )
+                {
+                    colorsOut[ x ] = colorsOut[ x - 1 ];
+                    continue;
+                }
+
+                double red, green, blue, alpha;
+
+                pipeline.fetchcolor( srcX, srcY, red, green, blue, alpha );
+
+                drawSpanColor& color = colorsOut[ x ];
+                color.r = packclampedcolor( red );
+                color.g = packclampedcolor( green );
+                color.b = packclampedcolor( blue );
+                color.a = packclampedcolor( alpha );
+            }
+        }
+    };
+
+    pipelineSpanSource spanSource( colorSource );
+
+    drawspans(
+        this->texels, this->width, this->height, this->depth, this->rowSize, this->rasterFormat, this->colorOrder,
+        spanSource, offX, offY, drawWidth, drawHeight,
+        srcChannel, dstChannel, blendMode
+    );
+}
+
 void Bitmap::drawBitmap(
     const Bitmap& theBitmap, uint32 offX, uint32 offY, uint32 drawWidth, uint32 drawHeight,
     eShadeMode srcChannel, eShadeMode dstChannel, eBlendMode blendMode
 )
 {
-    struct bitmapColorSource : public sourceColorPipeline
+    // Reads the spans straight from the bitmap rows.
+    struct bitmapSpanSource : public drawSpanSource
     {
-        const Bitmap& bmpSource;
-
         uint32 theWidth;
         uint32 theHeight;
-        uint32 theDepth;
         uint32 rowSize;
-        eRasterFormat theFormat;
-        eColorOrdering theOrder;
-        void *theTexels;
+        bool isPacked;
+        const void *theTexels;
 
-        inline bitmapColorSource( const Bitmap& bmp ) : bmpSource( bmp )
+        colorModelDispatcher fetchDispatch;
+
+        inline bitmapSpanSource( const Bitmap& bmp, const void *texels ) : fetchDispatch( bmp.getFormat(), bmp.getColorOrder(), bmp.getDepth(), NULL, 0, PALETTE_NONE )
         {
             bmp.getSize(this->theWidth, this->theHeight);
 
-            this->theDepth = bmp.getDepth();
-            this->theFormat = bmp.getFormat();
-            this->theOrder = bmp.getColorOrder();
-            this->theTexels = bmp.texels;
+            this->theTexels = texels;
+            this->isPacked = isPackedBGRA8888( bmp.getFormat(), bmp.getColorOrder(), bmp.getDepth() );
 
-            this->rowSize = getRasterDataRowSize( this->theWidth, this->theDepth, bmp.getRowAlignment() );
+            this->rowSize = getRasterDataRowSize( this->theWidth, bmp.getDepth(), bmp.getRowAlignment() );
         }
 
         uint32 getWidth( void ) const
@@ -660,18 +802,50 @@ void Bitmap::drawBitmap(
             return this->theHeight;
         }
 
-        void fetchcolor( uint32 x, uint32 y, double& red, double& green, double& blue, double& alpha )
+        void fetchspan( uint32 srcY, const uint32 *srcColumns, uint32 spanWidth, drawSpanColor *colorsOut )
+        {
+            const void *srcRow = getConstTexelDataRow( this->theTexels, this->rowSize, srcY );
+
+            if ( this->isPacked )
+            {
+                for ( uint32 x = 0; x < spanWidth; x++ )
+                {
+                    colorsOut[ x ] = unpackBGRA8888( ( (const uint32*)srcRow )[ srcColumns[ x ] ] );
+                }
+
+                return;
+            }
+
+            for ( uint32 x = 0; x < spanWidth; x++ )
+            {
+                drawSpanColor& color = colorsOut[ x ];
+
+                if ( !fetchDispatch.getRGBA( srcRow, srcColumns[ x ], color.r, color.g, color.b, color.a ) )
+                {
+                    color.r = 0;
+                    color.g = 0;
+                    color.b = 0;
+                    color.a = 0;
+                }
+            }
+        }
+
+        const uint32* getpackedrow( uint32 srcY )
         {
-            fetchpackedcolor(
-                this->theTexels, x, y, this->theFormat, this->theOrder, this->theDepth, this->rowSize, red, green, blue, alpha
-            );
+            if ( !this->isPacked )
+                return NULL;
+
+            return (const uint32*)getConstTexelDataRow( this->theTexels, this->rowSize, srcY );
         }
     };
 
-    bitmapColorSource bmpSource( theBitmap );
+    bitmapSpanSource bmpSource( theBitmap, theBitmap.texels );
 
-    // Draw using general-purpose pipeline.
-    this->draw( bmpSource, offX, offY, drawWidth, drawHeight, srcChannel, dstChannel, blendMode );
+    drawspans(
+        this->texels, this->width, this->height, this->depth, this->rowSize, this->rasterFormat, this->colorOrder,
+        bmpSource, offX, offY, drawWidth, drawHeight,
+        srcChannel, dstChannel, blendMode
+    );
 }
 
 };
\ No newline at end of file
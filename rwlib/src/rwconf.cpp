@@ -36,6 +36,11 @@ rwConfigBlock::rwConfigBlock( EngineInterface *intf )
 
     this->enableMetaDataTagging = true;
 
+    // Use all the threads that the system has got.
+    this->workerThreadCount = 0;
+
+    this->pngWriteOpts = GetPNGWritePreset( PNGPRESET_DEFAULT );
+
     // Set per-thread states.
     this->enableThreadedConfig = false;
 }
@@ -80,6 +85,10 @@ rwConfigBlock::rwConfigBlock( const rwConfigBlock& right )
 
     this->enableMetaDataTagging = right.enableMetaDataTagging;
 
+    this->workerThreadCount = right.workerThreadCount;
+
+    this->pngWriteOpts = right.pngWriteOpts;
+
     // Copy per-thread states.
     this->enableThreadedConfig = right.enableThreadedConfig;
 }
@@ -167,9 +176,9 @@ bool rwConfigBlock::SetPaletteRuntime( ePaletteRuntimeType palRunType )
     // Make sure we support this runtime.
     bool success = false;
 
-    if ( palRunType == PALRUNTIME_NATIVE )
+    if ( palRunType == PALRUNTIME_NATIVE || palRunType == PALRUNTIME_MEDIANCUT )
     {
-        // We always support the native palette system.
+        // We always support the native palette systems.
         this->palRuntimeType = palRunType;
 
         success = true;
@@ -278,6 +287,34 @@ bool rwConfigBlock::GetIgnoreSerializationBlockRegions( void ) const
     return this->ignoreSerializationBlockRegions;
 }
 
+void rwConfigBlock::SetWorkerThreadCount( uint32 count )
+{
+    scoped_rwlock_writer <rwlock> lock( GetConfigLock() );
+
+    this->workerThreadCount = count;
+}
+
+uint32 rwConfigBlock::GetWorkerThreadCount( void ) const
+{
+    scoped_rwlock_reader <rwlock> lock( GetConfigLock() );
+
+    return this->workerThreadCount;
+}
+
+void rwConfigBlock::SetPNGWriteOptions( const pngWriteOptions& opts )
+{
+    scoped_rwlock_writer <rwlock> lock( GetConfigLock() );
+
+    this->pngWriteOpts = opts;
+}
+
+pngWriteOptions rwConfigBlock::GetPNGWriteOptions( void ) const
+{
+    scoped_rwlock_reader <rwlock> lock( GetConfigLock() );
+
+    return this->pngWriteOpts;
+}
+
 rwConfigEnvRegister_t rwConfigEnvRegister;
 
 void registerConfigurationEnvironment( void )
@@ -266,6 +266,73 @@ void ReleaseThreadedRuntimeConfig( Interface *intf )
     // Success!
 }
 
+void InheritThreadedRuntimeConfig( EngineInterface *engineInterface, const rwConfigBlock& parentCfg )
+{
+    // If the parent does not run with a private configuration, then we simply
+    // use the global configuration aswell. Pooled worker threads may still have
+    // the private configuration of an earlier job, so drop it.
+    if ( parentCfg.enableThreadedConfig == false )
+    {
+        ReleaseThreadedRuntimeConfig( engineInterface );
+        return;
+    }
+
+    rwConfigEnv *cfgEnv = rwConfigEnvRegister.GetPluginStruct( engineInterface );
+
+    if ( !cfgEnv )
+        return;
+
+    rwConfigDispatchEnv *cfgDispatch = rwConfigDispatchEnvRegister.GetPluginStruct( engineInterface );
+
+    if ( !cfgDispatch )
+        return;
+
+    CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+
+    if ( !nativeMan )
+        return;
+
+    CExecThread *curThread = nativeMan->GetCurrentThread();
+
+    if ( !curThread )
+        return;
+
+    rwConfigBlock *threadedCfg = cfgDispatch->GetThreadConfig( curThread );
+
+    if ( !threadedCfg || threadedCfg == &parentCfg )
+        return;
+
+    bool couldSet = cfgEnv->configFactory.Assign( threadedCfg, &parentCfg );
+
+    if ( !couldSet )
+    {
+        throw RwException( "failed to inherit threaded configuration from parent thread" );
+    }
+
+    threadedCfg->enableThreadedConfig = true;
+}
+
+void InheritThreadedRuntimeConfig( Interface *intf, thread_t sourceThread )
+{
+    EngineInterface *engineInterface = (EngineInterface*)intf;
+
+    rwConfigDispatchEnv *cfgDispatch = rwConfigDispatchEnvRegister.GetPluginStruct( engineInterface );
+
+    if ( !cfgDispatch )
+        return;
+
+    const rwConfigBlock *sourceCfg = cfgDispatch->GetConstThreadConfig( (CExecThread*)sourceThread );
+
+    if ( !sourceCfg )
+    {
+        // Then the source thread runs with the global configuration.
+        ReleaseThreadedRuntimeConfig( engineInterface );
+        return;
+    }
+
+    InheritThreadedRuntimeConfig( engineInterface, *sourceCfg );
+}
+
 void registerConfigurationBlockDispatching( void )
 {
     rwConfigDispatchEnvRegister.RegisterPlugin( engineFactory );
@@ -55,6 +55,12 @@ struct rwConfigBlock
     void                        SetIgnoreSerializationBlockRegions( bool doIgnore );
     bool                        GetIgnoreSerializationBlockRegions( void ) const;
 
+    void                        SetWorkerThreadCount( uint32 count );
+    uint32                      GetWorkerThreadCount( void ) const;
+
+    void                        SetPNGWriteOptions( const pngWriteOptions& opts );
+    pngWriteOptions             GetPNGWriteOptions( void ) const;
+
     EngineInterface *engineInterface;
 
 private:
@@ -80,6 +86,10 @@ private:
 
     bool enableMetaDataTagging;
 
+    uint32 workerThreadCount;   // zero means as many as there are hardware threads.
+
+    pngWriteOptions pngWriteOpts;
+
 public:
     // Per-Thread config states (only valid if accessed from thread).
     bool enableThreadedConfig;
@@ -162,4 +172,8 @@ extern rwConfigEnvRegister_t rwConfigEnvRegister;
 rwConfigBlock& GetEnvironmentConfigBlock( EngineInterface *engineInterface );
 const rwConfigBlock& GetConstEnvironmentConfigBlock( const EngineInterface *engineInterface );
 
+// Makes the current thread use a private copy of another configuration block.
+// Used by worker threads so that they run under the configuration of the thread that spawned them.
+void InheritThreadedRuntimeConfig( EngineInterface *engineInterface, const rwConfigBlock& parentCfg );
+
 };
\ No newline at end of file
@@ -95,6 +95,7 @@ struct nativeDriverTypeInterface : public RwTypeSystem::typeInterface
     {
         Driver *driverObj;
         Window *sysWnd;
+        uint32 width, height;
         uint32 frameCount;
     };
 
@@ -117,7 +118,7 @@ struct nativeDriverTypeInterface : public RwTypeSystem::typeInterface
                     engineInterface,
                     theDriver->GetImplementation(),
                     swapChain->GetImplementation(),
-                    sysWnd, params->frameCount
+                    sysWnd, params->width, params->height, params->frameCount
                 );
             }
             catch( ... )
@@ -484,21 +485,23 @@ void DestroyDriver( Interface *intf, Driver *theDriver )
 }
 
 // Driver interface.
-DriverSwapChain* Driver::CreateSwapChain( Window *outputWindow, uint32 frameCount )
+static DriverSwapChain* CreateDriverSwapChain( Driver *theDriver, Window *outputWindow, uint32 width, uint32 height, uint32 frameCount )
 {
     DriverSwapChain *swapChainOut = NULL;
 
-    EngineInterface *engineInterface = (EngineInterface*)this->engineInterface;
+    EngineInterface *engineInterface = (EngineInterface*)theDriver->GetEngineInterface();
 
-    if ( nativeDriverTypeInterface *driverInfo = driverEnvironment::GetDriverTypeInterface( this ) )
+    if ( nativeDriverTypeInterface *driverInfo = driverEnvironment::GetDriverTypeInterface( theDriver ) )
     {
         // Make the friggin swap chain.
         if ( RwTypeSystem::typeInfoBase *swapChainType = driverInfo->swapChainType )
         {
             // Create it.
             nativeDriverTypeInterface::swapchain_const_params params;
-            params.driverObj = this;
+            params.driverObj = theDriver;
             params.sysWnd = outputWindow;
+            params.width = width;
+            params.height = height;
             params.frameCount = frameCount;
 
             GenericRTTI *rtObj = engineInterface->typeSystem.Construct( engineInterface, swapChainType, &params );
@@ -513,6 +516,21 @@ DriverSwapChain* Driver::CreateSwapChain( Window *outputWindow, uint32 frameCoun
     return swapChainOut;
 }
 
+DriverSwapChain* Driver::CreateSwapChain( Window *outputWindow, uint32 frameCount )
+{
+    if ( outputWindow == NULL )
+    {
+        throw RwException( "cannot create swap chain without output window; use an offscreen swap chain instead" );
+    }
+
+    return CreateDriverSwapChain( this, outputWindow, outputWindow->GetClientWidth(), outputWindow->GetClientHeight(), frameCount );
+}
+
+DriverSwapChain* Driver::CreateOffscreenSwapChain( uint32 width, uint32 height, uint32 frameCount )
+{
+    return CreateDriverSwapChain( this, NULL, width, height, frameCount );
+}
+
 void Driver::DestroySwapChain( DriverSwapChain *swapChain )
 {
     EngineInterface *engineInterface = (EngineInterface*)this->engineInterface;
@@ -565,12 +583,109 @@ void Driver::DestroyGraphicsState( DriverGraphicsState *pso )
     }
 }
 
+DriverRaster* Driver::CreateInstancedRaster( Raster *sysRaster )
+{
+    DriverRaster *rasterOut = NULL;
+
+    EngineInterface *engineInterface = (EngineInterface*)this->engineInterface;
+
+    if ( nativeDriverTypeInterface *driverInfo = driverEnvironment::GetDriverTypeInterface( this ) )
+    {
+        if ( RwTypeSystem::typeInfoBase *rasterTypeInfo = driverInfo->rasterType )
+        {
+            nativeDriverTypeInterface::driver_obj_constr_params params;
+            params.driverObj = this->GetImplementation();
+
+            GenericRTTI *rtObj = engineInterface->typeSystem.Construct( engineInterface, rasterTypeInfo, &params );
+
+            if ( rtObj )
+            {
+                void *objMem = RwTypeSystem::GetObjectFromTypeStruct( rtObj );
+
+                // Let the driver put the raster data into its own representation.
+                try
+                {
+                    driverInfo->driverImpl->RasterInstance( engineInterface, this->GetImplementation(), objMem, sysRaster );
+                }
+                catch( ... )
+                {
+                    engineInterface->typeSystem.Destroy( engineInterface, rtObj );
+
+                    throw;
+                }
+
+                rasterOut = (DriverRaster*)objMem;
+            }
+        }
+    }
+
+    return rasterOut;
+}
+
+void Driver::DestroyInstancedRaster( DriverRaster *instRaster )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this->engineInterface;
+
+    if ( nativeDriverTypeInterface *driverInfo = driverEnvironment::GetDriverTypeInterface( this ) )
+    {
+        driverInfo->driverImpl->RasterUninstance( engineInterface, this->GetImplementation(), instRaster );
+    }
+
+    GenericRTTI *rtObj = RwTypeSystem::GetTypeStructFromObject( instRaster );
+
+    if ( rtObj )
+    {
+        engineInterface->typeSystem.Destroy( engineInterface, rtObj );
+    }
+}
+
+void Driver::Clear( DriverSwapChain *target, float red, float green, float blue, float alpha, float depth )
+{
+    if ( nativeDriverTypeInterface *driverInfo = driverEnvironment::GetDriverTypeInterface( this ) )
+    {
+        driverInfo->driverImpl->Clear(
+            this->engineInterface, this->GetImplementation(), target->GetImplementation(),
+            red, green, blue, alpha, depth
+        );
+    }
+}
+
+void Driver::DrawPrimitives( DriverSwapChain *target, DriverGraphicsState *pso, DriverRaster *texture, ePrimitiveTopology topology, const void *vertexData, uint32 vertexStride, uint32 vertexCount )
+{
+    if ( nativeDriverTypeInterface *driverInfo = driverEnvironment::GetDriverTypeInterface( this ) )
+    {
+        driverInfo->driverImpl->DrawPrimitives(
+            this->engineInterface, this->GetImplementation(), target->GetImplementation(),
+            pso, texture, topology, vertexData, vertexStride, vertexCount
+        );
+    }
+}
+
+void Driver::Present( DriverSwapChain *swapChain )
+{
+    if ( nativeDriverTypeInterface *driverInfo = driverEnvironment::GetDriverTypeInterface( this ) )
+    {
+        driverInfo->driverImpl->SwapChainPresent( this->engineInterface, this->GetImplementation(), swapChain->GetImplementation() );
+    }
+}
+
+bool Driver::GetPresentedBitmap( DriverSwapChain *swapChain, Bitmap& bmpOut )
+{
+    if ( nativeDriverTypeInterface *driverInfo = driverEnvironment::GetDriverTypeInterface( this ) )
+    {
+        return driverInfo->driverImpl->SwapChainGetBitmap( this->engineInterface, swapChain->GetImplementation(), bmpOut );
+    }
+
+    return false;
+}
+
 // Registration of driver general sub modules.
 extern void registerDriverResourceEnvironment( void );
 extern void registerDriverProgramManagerEnv( void );
 
 // Registration of driver implementations.
 extern void registerD3D12DriverImplementation( void );
+extern void registerSoftwareDriverImplementation( void );
 
 void registerDriverEnvironment( void )
 {
@@ -583,6 +698,7 @@ void registerDriverEnvironment( void )
 
     // TODO: register all driver implementations.
     registerD3D12DriverImplementation();
+    registerSoftwareDriverImplementation();
 }
 
 };
\ No newline at end of file
@@ -231,6 +231,27 @@ struct d3d12DriverInterface : public nativeDriverImplementation
         ((d3d12PipelineStateObject*)objMem)->~d3d12PipelineStateObject();
     }
 
+    // Command submission.
+    // The Direct3D 12 driver does not record command lists, so it cannot execute
+    // the immediate-mode commands. Use the software driver for rendering.
+    NATIVE_DRIVER_CLEAR() override
+    {
+        throw RwException( "Direct3D 12 driver does not support clearing" );
+    }
+    NATIVE_DRIVER_DRAW_PRIMITIVES() override
+    {
+        throw RwException( "Direct3D 12 driver does not support drawing" );
+    }
+    NATIVE_DRIVER_SWAPCHAIN_PRESENT() override
+    {
+        throw RwException( "Direct3D 12 driver does not support presenting" );
+    }
+    NATIVE_DRIVER_SWAPCHAIN_GETBITMAP() override
+    {
+        // Read-back of hardware swap chains is not supported.
+        return false;
+    }
+
     bool hasRegisteredDriver;
 
     inline void InitializeD3D12Module( void )
@@ -18,6 +18,11 @@ d3d12DriverInterface::d3d12SwapChain::d3d12SwapChain( d3d12DriverInterface *env,
     this->driver = driver;
     this->sysWnd = sysWnd;
 
+    if ( sysWnd == NULL )
+    {
+        throw RwException( "Direct3D 12 swap chains require an output window" );
+    }
+
     CreateDXGIFactory1_t factCreate = env->CreateDXGIFactory1;
 
     if ( !factCreate )
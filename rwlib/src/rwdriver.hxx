@@ -85,8 +85,9 @@ struct nativeDriverImplementation abstract
     NATIVE_DRIVER_DEFINE_INSTANCING_VIRTUAL( Material );
 
     // Drivers need swap chains for windowing system output.
+    // Offscreen swap chains are requested by passing no window (sysWnd == NULL).
 #define NATIVE_DRIVER_SWAPCHAIN_CONSTRUCT() \
-    void SwapChainConstruct( Interface *engineInterface, void *driverObjMem, void *objMem, Window *sysWnd, uint32 frameCount )
+    void SwapChainConstruct( Interface *engineInterface, void *driverObjMem, void *objMem, Window *sysWnd, uint32 width, uint32 height, uint32 frameCount )
 #define NATIVE_DRIVER_SWAPCHAIN_DESTROY() \
     void SwapChainDestroy( Interface *engineInterface, void *objMem )
 
@@ -104,6 +105,22 @@ struct nativeDriverImplementation abstract
 
     virtual NATIVE_DRIVER_GRAPHICS_STATE_CONSTRUCT() = 0;
     virtual NATIVE_DRIVER_GRAPHICS_STATE_DESTROY() = 0;
+
+    // Command submission API.
+    // Objects are passed as their implementation memory.
+#define NATIVE_DRIVER_CLEAR() \
+    void Clear( Interface *engineInterface, void *driverObjMem, void *swapChainMem, float red, float green, float blue, float alpha, float depth )
+#define NATIVE_DRIVER_DRAW_PRIMITIVES() \
+    void DrawPrimitives( Interface *engineInterface, void *driverObjMem, void *swapChainMem, void *psoMem, void *rasterMem, ePrimitiveTopology topology, const void *vertexData, uint32 vertexStride, uint32 vertexCount )
+#define NATIVE_DRIVER_SWAPCHAIN_PRESENT() \
+    void SwapChainPresent( Interface *engineInterface, void *driverObjMem, void *swapChainMem )
+#define NATIVE_DRIVER_SWAPCHAIN_GETBITMAP() \
+    bool SwapChainGetBitmap( Interface *engineInterface, void *swapChainMem, Bitmap& bmpOut )
+
+    virtual NATIVE_DRIVER_CLEAR() = 0;
+    virtual NATIVE_DRIVER_DRAW_PRIMITIVES() = 0;
+    virtual NATIVE_DRIVER_SWAPCHAIN_PRESENT() = 0;
+    virtual NATIVE_DRIVER_SWAPCHAIN_GETBITMAP() = 0;
 };
 
 // Driver registration API.
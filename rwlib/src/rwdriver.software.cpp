@@ -0,0 +1,759 @@
+#include "StdInc.h"
+
+#include "rwdriver.software.hxx"
+
+#include "pluginutil.hxx"
+
+#include "pixelformat.hxx"
+
+#include "rwthreading.parallel.hxx"
+
+namespace rw
+{
+
+softwareDriverInterface::swNativeDriver::swNativeDriver( softwareDriverInterface *env, Interface *engineInterface )
+{
+    this->engineInterface = engineInterface;
+}
+
+softwareDriverInterface::swNativeDriver::swNativeDriver( const swNativeDriver& right )
+{
+    // There is no device state that would prevent cloning.
+    this->engineInterface = right.engineInterface;
+}
+
+softwareDriverInterface::swNativeDriver::~swNativeDriver( void )
+{
+    return;
+}
+
+// Raster instancing.
+// We decode the base level of the raster into packed BGRA, which is what the rasterizer samples from.
+void softwareDriverInterface::RasterInstance( Interface *engineInterface, void *driverObjMem, void *objMem, Raster *sysRaster )
+{
+    swNativeRaster *nativeRaster = (swNativeRaster*)objMem;
+
+    Bitmap baseLevel = sysRaster->getBitmap();
+
+    uint32 width, height;
+    baseLevel.getSize( width, height );
+
+    uint32 depth = baseLevel.getDepth();
+    uint32 srcRowSize = getRasterDataRowSize( width, depth, baseLevel.getRowAlignment() );
+
+    const void *srcTexels = baseLevel.getTexelsData();
+
+    colorModelDispatcher fetchDispatch( baseLevel.getFormat(), baseLevel.getColorOrder(), depth, NULL, 0, PALETTE_NONE );
+
+    nativeRaster->texels.resize( width * height );
+
+    uint32 *dstTexels = nativeRaster->texels.data();
+
+    for ( uint32 y = 0; y < height; y++ )
+    {
+        const void *srcRow = getConstTexelDataRow( srcTexels, srcRowSize, y );
+
+        for ( uint32 x = 0; x < width; x++ )
+        {
+            abstractColorItem colorItem;
+
+            fetchDispatch.getColor( srcRow, x, colorItem );
+
+            uint8 r, g, b, a;
+
+            colorItem2RGBA( colorItem, r, g, b, a );
+
+            dstTexels[ y * width + x ] = ( (uint32)b | ( (uint32)g << 8 ) | ( (uint32)r << 16 ) | ( (uint32)a << 24 ) );
+        }
+    }
+
+    nativeRaster->width = width;
+    nativeRaster->height = height;
+}
+
+void softwareDriverInterface::RasterUninstance( Interface *engineInterface, void *driverObjMem, void *objMem )
+{
+    swNativeRaster *nativeRaster = (swNativeRaster*)objMem;
+
+    nativeRaster->texels.clear();
+    nativeRaster->width = 0;
+    nativeRaster->height = 0;
+}
+
+void softwareDriverInterface::GeometryInstance( Interface *engineInterface, void *driverObjMem, void *objMem, Geometry *sysGeom )
+{
+    // Geometry is submitted through DrawPrimitives, so there is nothing to instance.
+}
+
+void softwareDriverInterface::GeometryUninstance( Interface *engineInterface, void *driverObjMem, void *objMem )
+{
+    return;
+}
+
+void softwareDriverInterface::MaterialInstance( Interface *engineInterface, void *driverObjMem, void *objMem, Material *sysMat )
+{
+    // Materials are expressed through graphics states and rasters.
+}
+
+void softwareDriverInterface::MaterialUninstance( Interface *engineInterface, void *driverObjMem, void *objMem )
+{
+    return;
+}
+
+// Graphics state compilation.
+inline bool IsValidFetchType( eVertexAttribValueType valueType )
+{
+    switch( valueType )
+    {
+    case eVertexAttribValueType::INT8:
+    case eVertexAttribValueType::INT16:
+    case eVertexAttribValueType::INT32:
+    case eVertexAttribValueType::UINT8:
+    case eVertexAttribValueType::UINT16:
+    case eVertexAttribValueType::UINT32:
+    case eVertexAttribValueType::FLOAT32:
+        return true;
+    }
+
+    return false;
+}
+
+softwareDriverInterface::swGraphicsState::swGraphicsState( softwareDriverInterface *env, Interface *engineInterface, swNativeDriver *driver, const gfxGraphicsState& psoState )
+{
+    this->driver = driver;
+
+    this->blendState = psoState.blendState;
+    this->rasterizerState = psoState.rasterizerState;
+    this->depthStencilState = psoState.depthStencilState;
+    this->topologyType = psoState.topologyType;
+
+    this->posAttrib.isPresent = false;
+    this->colorAttrib.isPresent = false;
+    this->texCoordAttrib.isPresent = false;
+
+    // Decode the input layout.
+    // We only understand the first attribute of each semantic.
+    for ( uint32 n = 0; n < psoState.inputLayout.paramCount; n++ )
+    {
+        const vertexAttrib& attrib = psoState.inputLayout.params[ n ];
+
+        if ( attrib.semanticIndex != 0 )
+            continue;
+
+        attribFetch *fetch = NULL;
+
+        if ( attrib.semanticType == eVertexAttribSemanticType::POSITION )
+        {
+            fetch = &this->posAttrib;
+        }
+        else if ( attrib.semanticType == eVertexAttribSemanticType::COLOR )
+        {
+            fetch = &this->colorAttrib;
+        }
+        else if ( attrib.semanticType == eVertexAttribSemanticType::TEXCOORD )
+        {
+            fetch = &this->texCoordAttrib;
+        }
+
+        if ( fetch == NULL )
+            continue;
+
+        if ( IsValidFetchType( attrib.attribType ) == false )
+        {
+            throw RwException( "invalid vertex attribute type in software driver graphics state" );
+        }
+
+        fetch->isPresent = true;
+        fetch->valueType = attrib.attribType;
+        fetch->count = std::min( attrib.count, 4u );
+        fetch->byteOffset = attrib.alignedByteOffset;
+    }
+
+    if ( this->posAttrib.isPresent == false || this->posAttrib.count < 2 )
+    {
+        throw RwException( "software driver graphics state requires a vertex position with at least two components" );
+    }
+
+    // Sampling parameters.
+    this->linearFiltering = false;
+    this->uAddressing = RWTEXADDRESS_WRAP;
+    this->vAddressing = RWTEXADDRESS_WRAP;
+
+    if ( psoState.regMapping.numStaticSamplers > 0 )
+    {
+        const gfxStaticSampler& sampler = psoState.regMapping.staticSamplers[ 0 ];
+
+        eRasterStageFilterMode filterMode = sampler.filterMode;
+
+        this->linearFiltering =
+            ( filterMode == RWFILTER_LINEAR ||
+              filterMode == RWFILTER_LINEAR_POINT ||
+              filterMode == RWFILTER_LINEAR_LINEAR ||
+              filterMode == RWFILTER_ANISOTROPY );
+
+        this->uAddressing = sampler.uAddressing;
+        this->vAddressing = sampler.vAddressing;
+    }
+}
+
+// Swap chain management.
+softwareDriverInterface::swSwapChain::swSwapChain( softwareDriverInterface *env, Interface *engineInterface, swNativeDriver *driver, Window *sysWnd, uint32 width, uint32 height, uint32 frameCount )
+{
+    this->driver = driver;
+
+    // Frames are only kept in memory and read back through GetPresentedBitmap,
+    // so there is nothing that could show them on a window.
+    if ( sysWnd != NULL )
+    {
+        throw RwException( "software driver can only create offscreen swap chains" );
+    }
+
+    if ( width == 0 || height == 0 )
+    {
+        throw RwException( "cannot create software swap chain with empty dimensions" );
+    }
+
+    if ( frameCount == 0 )
+    {
+        frameCount = 1;
+    }
+
+    this->width = width;
+    this->height = height;
+
+    this->colorBuffers.resize( frameCount );
+
+    for ( std::vector <uint32>& colorBuf : this->colorBuffers )
+    {
+        colorBuf.resize( width * height, 0 );
+    }
+
+    this->depthBuffer.resize( width * height, 1.0f );
+
+    this->backBufferIndex = 0;
+    this->frontBufferIndex = 0;
+
+    this->tilesX = ( width + SWRAST_TILE_SIZE - 1 ) / SWRAST_TILE_SIZE;
+    this->tilesY = ( height + SWRAST_TILE_SIZE - 1 ) / SWRAST_TILE_SIZE;
+
+    this->tileBins.resize( this->tilesX * this->tilesY );
+}
+
+void softwareDriverInterface::swSwapChain::BinTriangle( const swTriangle& tri )
+{
+    uint32 triIndex = (uint32)this->pendingTriangles.size();
+
+    this->pendingTriangles.push_back( tri );
+
+    // Put the triangle into every tile that its bounding box touches.
+    uint32 firstTileX = (uint32)tri.minX / SWRAST_TILE_SIZE;
+    uint32 firstTileY = (uint32)tri.minY / SWRAST_TILE_SIZE;
+    uint32 lastTileX = (uint32)( tri.maxX - 1 ) / SWRAST_TILE_SIZE;
+    uint32 lastTileY = (uint32)( tri.maxY - 1 ) / SWRAST_TILE_SIZE;
+
+    for ( uint32 tileY = firstTileY; tileY <= lastTileY; tileY++ )
+    {
+        for ( uint32 tileX = firstTileX; tileX <= lastTileX; tileX++ )
+        {
+            this->tileBins[ tileY * this->tilesX + tileX ].push_back( triIndex );
+        }
+    }
+}
+
+void softwareDriverInterface::swSwapChain::Flush( void )
+{
+    if ( this->pendingTriangles.empty() )
+        return;
+
+    EngineInterface *engineInterface = (EngineInterface*)this->driver->engineInterface;
+
+    uint32 tilesX = this->tilesX;
+
+    // Tiles do not share any pixels, so they can be rasterized independently.
+    ParallelForEach( engineInterface, this->tileBins.size(),
+        [&]( size_t tileIndex )
+        {
+            swRasterizeTile( this, (uint32)( tileIndex % tilesX ), (uint32)( tileIndex / tilesX ) );
+        }
+    );
+
+    this->pendingTriangles.clear();
+
+    for ( std::vector <uint32>& bin : this->tileBins )
+    {
+        bin.clear();
+    }
+}
+
+void softwareDriverInterface::Clear( Interface *engineInterface, void *driverObjMem, void *swapChainMem, float red, float green, float blue, float alpha, float depth )
+{
+    swSwapChain *swapChain = (swSwapChain*)swapChainMem;
+
+    // Previous draws have to land in the buffer before we overwrite it.
+    swapChain->Flush();
+
+    uint32 clearColor =
+        ( (uint32)swPackColorChannel( blue ) |
+          ( (uint32)swPackColorChannel( green ) << 8 ) |
+          ( (uint32)swPackColorChannel( red ) << 16 ) |
+          ( (uint32)swPackColorChannel( alpha ) << 24 ) );
+
+    std::vector <uint32>& colorBuf = swapChain->colorBuffers[ swapChain->backBufferIndex ];
+
+    std::fill( colorBuf.begin(), colorBuf.end(), clearColor );
+    std::fill( swapChain->depthBuffer.begin(), swapChain->depthBuffer.end(), depth );
+}
+
+// Primitive processing.
+struct swClipVertex
+{
+    float pos[4];
+    float color[4];
+    float texCoord[2];
+};
+
+struct swScreenVertex
+{
+    float x, y, z;
+    float invW;
+    float color[4];
+    float texCoord[2];
+};
+
+AINLINE float swFetchComponent( const void *attribData, eVertexAttribValueType valueType, uint32 idx )
+{
+    // Normalized integer types, like Direct3D does.
+    switch( valueType )
+    {
+    case eVertexAttribValueType::INT8:      return std::max( (float)( (const int8*)attribData )[ idx ] / 127.0f, -1.0f );
+    case eVertexAttribValueType::INT16:     return std::max( (float)( (const int16*)attribData )[ idx ] / 32767.0f, -1.0f );
+    case eVertexAttribValueType::INT32:     return (float)( (const int32*)attribData )[ idx ];
+    case eVertexAttribValueType::UINT8:     return (float)( (const uint8*)attribData )[ idx ] / 255.0f;
+    case eVertexAttribValueType::UINT16:    return (float)( (const uint16*)attribData )[ idx ] / 65535.0f;
+    case eVertexAttribValueType::UINT32:    return (float)( (const uint32*)attribData )[ idx ];
+    case eVertexAttribValueType::FLOAT32:   return ( (const float*)attribData )[ idx ];
+    }
+
+    return 0.0f;
+}
+
+AINLINE void swFetchAttrib( const softwareDriverInterface::swGraphicsState::attribFetch& fetch, const void *vertexData, float *valuesOut, uint32 maxCount )
+{
+    const void *attribData = (const char*)vertexData + fetch.byteOffset;
+
+    uint32 count = std::min( fetch.count, maxCount );
+
+    for ( uint32 n = 0; n < count; n++ )
+    {
+        valuesOut[ n ] = swFetchComponent( attribData, fetch.valueType, n );
+    }
+}
+
+static void swFetchVertex( const softwareDriverInterface::swGraphicsState *pso, const void *vertexData, swClipVertex& vertOut )
+{
+    // Defaults for missing components.
+    vertOut.pos[0] = 0.0f;
+    vertOut.pos[1] = 0.0f;
+    vertOut.pos[2] = 0.0f;
+    vertOut.pos[3] = 1.0f;
+
+    vertOut.color[0] = 1.0f;
+    vertOut.color[1] = 1.0f;
+    vertOut.color[2] = 1.0f;
+    vertOut.color[3] = 1.0f;
+
+    vertOut.texCoord[0] = 0.0f;
+    vertOut.texCoord[1] = 0.0f;
+
+    swFetchAttrib( pso->posAttrib, vertexData, vertOut.pos, 4 );
+
+    if ( pso->colorAttrib.isPresent )
+    {
+        swFetchAttrib( pso->colorAttrib, vertexData, vertOut.color, 4 );
+    }
+
+    if ( pso->texCoordAttrib.isPresent )
+    {
+        swFetchAttrib( pso->texCoordAttrib, vertexData, vertOut.texCoord, 2 );
+    }
+}
+
+// Vertices closer than this to the eye plane are clipped away.
+static const float swNearW = 1.0e-5f;
+
+AINLINE void swLerpClipVertex( const swClipVertex& a, const swClipVertex& b, float t, swClipVertex& out )
+{
+    for ( uint32 n = 0; n < 4; n++ )
+    {
+        out.pos[n] = a.pos[n] + ( b.pos[n] - a.pos[n] ) * t;
+        out.color[n] = a.color[n] + ( b.color[n] - a.color[n] ) * t;
+    }
+
+    out.texCoord[0] = a.texCoord[0] + ( b.texCoord[0] - a.texCoord[0] ) * t;
+    out.texCoord[1] = a.texCoord[1] + ( b.texCoord[1] - a.texCoord[1] ) * t;
+}
+
+AINLINE void swProjectVertex( const swClipVertex& clipVert, uint32 width, uint32 height, swScreenVertex& out )
+{
+    float invW = 1.0f / clipVert.pos[3];
+
+    out.x = ( clipVert.pos[0] * invW * 0.5f + 0.5f ) * (float)width;
+    out.y = ( 0.5f - clipVert.pos[1] * invW * 0.5f ) * (float)height;
+    out.z = clipVert.pos[2] * invW;
+    out.invW = invW;
+
+    for ( uint32 n = 0; n < 4; n++ )
+    {
+        out.color[n] = clipVert.color[n] * invW;
+    }
+
+    out.texCoord[0] = clipVert.texCoord[0] * invW;
+    out.texCoord[1] = clipVert.texCoord[1] * invW;
+}
+
+AINLINE bool swIsTopLeftEdge( const swScreenVertex& a, const swScreenVertex& b )
+{
+    // Our triangles are clockwise in screen space (y pointing down).
+    return ( ( a.y == b.y && b.x > a.x ) || ( b.y < a.y ) );
+}
+
+static void swSetupTriangle(
+    softwareDriverInterface::swSwapChain *swapChain,
+    const softwareDriverInterface::swGraphicsState *pso, const softwareDriverInterface::swNativeRaster *texture,
+    const swScreenVertex *v0, const swScreenVertex *v1, const swScreenVertex *v2,
+    bool applyCulling
+)
+{
+    float area = ( v1->x - v0->x ) * ( v2->y - v0->y ) - ( v1->y - v0->y ) * ( v2->x - v0->x );
+
+    if ( area == 0.0f || area != area )
+        return;
+
+    if ( applyCulling )
+    {
+        rwCullModeState cullMode = pso->rasterizerState.cullMode;
+
+        if ( cullMode == RWCULL_CLOCKWISE && area > 0.0f )
+            return;
+
+        if ( cullMode == RWCULL_COUNTERCLOCKWISE && area < 0.0f )
+            return;
+    }
+
+    // Make the triangle clockwise so that the edge functions are positive inside.
+    if ( area < 0.0f )
+    {
+        std::swap( v1, v2 );
+
+        area = -area;
+    }
+
+    softwareDriverInterface::swTriangle tri;
+
+    // Bounding box, clipped to the render target.
+    float minX = std::min( std::min( v0->x, v1->x ), v2->x );
+    float minY = std::min( std::min( v0->y, v1->y ), v2->y );
+    float maxX = std::max( std::max( v0->x, v1->x ), v2->x );
+    float maxY = std::max( std::max( v0->y, v1->y ), v2->y );
+
+    // Float to int conversion is only defined for values in range, so do not let
+    // off-screen or broken vertices through.
+    if ( minX != minX || minY != minY || maxX != maxX || maxY != maxY )
+        return;
+
+    float targetWidth = (float)swapChain->width;
+    float targetHeight = (float)swapChain->height;
+
+    tri.minX = (int32)std::min( std::max( std::floor( minX ), 0.0f ), targetWidth );
+    tri.minY = (int32)std::min( std::max( std::floor( minY ), 0.0f ), targetHeight );
+    tri.maxX = (int32)std::min( std::max( std::ceil( maxX ), 0.0f ), targetWidth );
+    tri.maxY = (int32)std::min( std::max( std::ceil( maxY ), 0.0f ), targetHeight );
+
+    if ( tri.minX >= tri.maxX || tri.minY >= tri.maxY )
+        return;
+
+    // Edge i is opposite of vertex i.
+    const swScreenVertex *verts[3] = { v0, v1, v2 };
+
+    for ( uint32 n = 0; n < 3; n++ )
+    {
+        const swScreenVertex *a = verts[ ( n + 1 ) % 3 ];
+        const swScreenVertex *b = verts[ ( n + 2 ) % 3 ];
+
+        tri.edgeA[n] = ( a->y - b->y );
+        tri.edgeB[n] = ( b->x - a->x );
+        tri.edgeC[n] = -( tri.edgeA[n] * a->x + tri.edgeB[n] * a->y );
+        tri.edgeTopLeft[n] = swIsTopLeftEdge( *a, *b );
+    }
+
+    tri.invArea = ( 1.0f / area );
+
+    for ( uint32 n = 0; n < 3; n++ )
+    {
+        const swScreenVertex *vert = verts[n];
+
+        tri.z[n] = vert->z;
+        tri.invW[n] = vert->invW;
+
+        for ( uint32 c = 0; c < 4; c++ )
+        {
+            tri.color[n][c] = vert->color[c];
+        }
+
+        tri.texCoord[n][0] = vert->texCoord[0];
+        tri.texCoord[n][1] = vert->texCoord[1];
+    }
+
+    tri.pso = pso;
+    tri.texture = texture;
+
+    swapChain->BinTriangle( tri );
+}
+
+static void swClipAndSetupTriangle(
+    softwareDriverInterface::swSwapChain *swapChain,
+    const softwareDriverInterface::swGraphicsState *pso, const softwareDriverInterface::swNativeRaster *texture,
+    const swClipVertex& c0, const swClipVertex& c1, const swClipVertex& c2
+)
+{
+    const swClipVertex *inVerts[3] = { &c0, &c1, &c2 };
+
+    // Clip against the near plane (w > swNearW), which can produce a quad.
+    swClipVertex clipped[4];
+    uint32 clippedCount = 0;
+
+    for ( uint32 n = 0; n < 3; n++ )
+    {
+        const swClipVertex& cur = *inVerts[n];
+        const swClipVertex& next = *inVerts[ ( n + 1 ) % 3 ];
+
+        bool curInside = ( cur.pos[3] > swNearW );
+        bool nextInside = ( next.pos[3] > swNearW );
+
+        if ( curInside )
+        {
+            clipped[ clippedCount++ ] = cur;
+        }
+
+        if ( curInside != nextInside )
+        {
+            float t = ( swNearW - cur.pos[3] ) / ( next.pos[3] - cur.pos[3] );
+
+            swLerpClipVertex( cur, next, t, clipped[ clippedCount++ ] );
+        }
+    }
+
+    if ( clippedCount < 3 )
+        return;
+
+    swScreenVertex screenVerts[4];
+
+    for ( uint32 n = 0; n < clippedCount; n++ )
+    {
+        swProjectVertex( clipped[n], swapChain->width, swapChain->height, screenVerts[n] );
+    }
+
+    swSetupTriangle( swapChain, pso, texture, &screenVerts[0], &screenVerts[1], &screenVerts[2], true );
+
+    if ( clippedCount == 4 )
+    {
+        swSetupTriangle( swapChain, pso, texture, &screenVerts[0], &screenVerts[2], &screenVerts[3], true );
+    }
+}
+
+// Lines and points are rasterized as screen-space quads that are one pixel wide.
+static void swSetupScreenQuad(
+    softwareDriverInterface::swSwapChain *swapChain,
+    const softwareDriverInterface::swGraphicsState *pso, const softwareDriverInterface::swNativeRaster *texture,
+    const swScreenVertex& start, const swScreenVertex& end
+)
+{
+    float dirX = ( end.x - start.x );
+    float dirY = ( end.y - start.y );
+
+    float len = sqrt( dirX * dirX + dirY * dirY );
+
+    float normX, normY;
+
+    if ( len < 1.0e-6f )
+    {
+        // A point; make a pixel-sized square.
+        dirX = 0.5f;
+        dirY = 0.0f;
+        normX = 0.0f;
+        normY = 0.5f;
+    }
+    else
+    {
+        dirX *= 0.5f / len;
+        dirY *= 0.5f / len;
+        normX = -dirY;
+        normY = dirX;
+    }
+
+    swScreenVertex quad[4] = { start, start, end, end };
+
+    quad[0].x += -dirX + normX;     quad[0].y += -dirY + normY;
+    quad[1].x += -dirX - normX;     quad[1].y += -dirY - normY;
+    quad[2].x += dirX - normX;      quad[2].y += dirY - normY;
+    quad[3].x += dirX + normX;      quad[3].y += dirY + normY;
+
+    swSetupTriangle( swapChain, pso, texture, &quad[0], &quad[1], &quad[2], false );
+    swSetupTriangle( swapChain, pso, texture, &quad[0], &quad[2], &quad[3], false );
+}
+
+void softwareDriverInterface::DrawPrimitives( Interface *engineInterface, void *driverObjMem, void *swapChainMem, void *psoMem, void *rasterMem, ePrimitiveTopology topology, const void *vertexData, uint32 vertexStride, uint32 vertexCount )
+{
+    swSwapChain *swapChain = (swSwapChain*)swapChainMem;
+    const swGraphicsState *pso = (const swGraphicsState*)psoMem;
+    const swNativeRaster *texture = (const swNativeRaster*)rasterMem;
+
+    if ( pso == NULL )
+    {
+        throw RwException( "software driver requires a graphics state for drawing" );
+    }
+
+    if ( texture && texture->texels.empty() )
+    {
+        texture = NULL;
+    }
+
+    auto fetch_vertex = [&]( uint32 idx, swClipVertex& vertOut )
+    {
+        swFetchVertex( pso, (const char*)vertexData + vertexStride * idx, vertOut );
+    };
+
+    if ( topology == ePrimitiveTopology::TRIANGLELIST || topology == ePrimitiveTopology::TRIANGLESTRIP )
+    {
+        bool isStrip = ( topology == ePrimitiveTopology::TRIANGLESTRIP );
+
+        uint32 triCount = 0;
+
+        if ( vertexCount >= 3 )
+        {
+            triCount = ( isStrip ? ( vertexCount - 2 ) : ( vertexCount / 3 ) );
+        }
+
+        for ( uint32 n = 0; n < triCount; n++ )
+        {
+            uint32 idx0, idx1, idx2;
+
+            if ( isStrip )
+            {
+                // Keep the winding consistent across the strip.
+                idx0 = n;
+                idx1 = ( n % 2 == 0 ) ? ( n + 1 ) : ( n + 2 );
+                idx2 = ( n % 2 == 0 ) ? ( n + 2 ) : ( n + 1 );
+            }
+            else
+            {
+                idx0 = n * 3;
+                idx1 = n * 3 + 1;
+                idx2 = n * 3 + 2;
+            }
+
+            swClipVertex c0, c1, c2;
+
+            fetch_vertex( idx0, c0 );
+            fetch_vertex( idx1, c1 );
+            fetch_vertex( idx2, c2 );
+
+            swClipAndSetupTriangle( swapChain, pso, texture, c0, c1, c2 );
+        }
+    }
+    else if ( topology == ePrimitiveTopology::LINELIST || topology == ePrimitiveTopology::LINESTRIP )
+    {
+        bool isStrip = ( topology == ePrimitiveTopology::LINESTRIP );
+
+        uint32 lineCount = 0;
+
+        if ( vertexCount >= 2 )
+        {
+            lineCount = ( isStrip ? ( vertexCount - 1 ) : ( vertexCount / 2 ) );
+        }
+
+        for ( uint32 n = 0; n < lineCount; n++ )
+        {
+            uint32 idx0 = ( isStrip ? n : n * 2 );
+
+            swClipVertex c0, c1;
+
+            fetch_vertex( idx0, c0 );
+            fetch_vertex( idx0 + 1, c1 );
+
+            // We do not clip lines; they are dropped if they reach behind the eye.
+            if ( c0.pos[3] <= swNearW || c1.pos[3] <= swNearW )
+                continue;
+
+            swScreenVertex s0, s1;
+
+            swProjectVertex( c0, swapChain->width, swapChain->height, s0 );
+            swProjectVertex( c1, swapChain->width, swapChain->height, s1 );
+
+            swSetupScreenQuad( swapChain, pso, texture, s0, s1 );
+        }
+    }
+    else if ( topology == ePrimitiveTopology::POINTLIST )
+    {
+        for ( uint32 n = 0; n < vertexCount; n++ )
+        {
+            swClipVertex c0;
+
+            fetch_vertex( n, c0 );
+
+            if ( c0.pos[3] <= swNearW )
+                continue;
+
+            swScreenVertex s0;
+
+            swProjectVertex( c0, swapChain->width, swapChain->height, s0 );
+
+            swSetupScreenQuad( swapChain, pso, texture, s0, s0 );
+        }
+    }
+    else
+    {
+        throw RwException( "unsupported primitive topology in software driver" );
+    }
+}
+
+void softwareDriverInterface::SwapChainPresent( Interface *engineInterface, void *driverObjMem, void *swapChainMem )
+{
+    swSwapChain *swapChain = (swSwapChain*)swapChainMem;
+
+    swapChain->Flush();
+
+    // The back buffer becomes the presented frame.
+    uint32 frameCount = (uint32)swapChain->colorBuffers.size();
+
+    swapChain->frontBufferIndex = swapChain->backBufferIndex;
+    swapChain->backBufferIndex = ( swapChain->backBufferIndex + 1 ) % frameCount;
+}
+
+bool softwareDriverInterface::SwapChainGetBitmap( Interface *engineInterface, void *swapChainMem, Bitmap& bmpOut )
+{
+    swSwapChain *swapChain = (swSwapChain*)swapChainMem;
+
+    const std::vector <uint32>& frontBuf = swapChain->colorBuffers[ swapChain->frontBufferIndex ];
+
+    uint32 width = swapChain->width;
+    uint32 height = swapChain->height;
+
+    // Rows of 32bit pixels are always aligned, so the buffer is laid out like a bitmap.
+    uint32 dataSize = getRasterDataSizeByRowSize( getRasterDataRowSize( width, 32, 4 ), height );
+
+    bmpOut.setImageData( (void*)frontBuf.data(), RASTER_8888, COLOR_BGRA, 32, 4, width, height, dataSize, false );
+
+    return true;
+}
+
+softwareDriverInterface::swDriverFactory_t softwareDriverInterface::swDriverFactory;
+
+static PluginDependantStructRegister <softwareDriverInterface, RwInterfaceFactory_t> softwareDriverReg;
+
+void registerSoftwareDriverImplementation( void )
+{
+    softwareDriverReg.RegisterPlugin( engineFactory );
+}
+
+};
@@ -0,0 +1,292 @@
+#ifndef _RENDERWARE_SOFTWARE_DRIVER_
+#define _RENDERWARE_SOFTWARE_DRIVER_
+
+// CPU rasterizer driver.
+// It renders into offscreen color buffers, so it does not need any graphics hardware or windowing system.
+// Triangles are set up and binned into screen tiles on the submitting thread; the tiles are
+// rasterized in parallel once the frame is flushed (on Clear or Present).
+
+#include "rwdriver.hxx"
+
+namespace rw
+{
+
+// Size of a screen tile in pixels (both dimensions).
+#define SWRAST_TILE_SIZE        64
+
+struct softwareDriverInterface : public nativeDriverImplementation
+{
+    struct swNativeDriver
+    {
+        Interface *engineInterface;
+
+        swNativeDriver( softwareDriverInterface *env, Interface *engineInterface );
+        swNativeDriver( const swNativeDriver& right );
+
+        ~swNativeDriver( void );
+    };
+
+    typedef StaticPluginClassFactory <swNativeDriver> swDriverFactory_t;
+
+    static swDriverFactory_t swDriverFactory;
+
+    // Decoded copy of the base level of a raster.
+    // Texels are stored as packed 32bit BGRA values.
+    struct swNativeRaster
+    {
+        swNativeDriver *driver;
+
+        inline swNativeRaster( softwareDriverInterface *env, Interface *engineInterface, swNativeDriver *driver )
+        {
+            this->driver = driver;
+            this->width = 0;
+            this->height = 0;
+        }
+
+        inline swNativeRaster( const swNativeRaster& right ) : texels( right.texels )
+        {
+            this->driver = right.driver;
+            this->width = right.width;
+            this->height = right.height;
+        }
+
+        inline ~swNativeRaster( void )
+        {
+            return;
+        }
+
+        uint32 width, height;
+        std::vector <uint32> texels;
+    };
+
+    // Geometry and materials are not used by the immediate drawing path.
+    struct swNativeGeometry
+    {
+        swNativeDriver *driver;
+
+        inline swNativeGeometry( softwareDriverInterface *env, Interface *engineInterface, swNativeDriver *driver )
+        {
+            this->driver = driver;
+        }
+
+        inline swNativeGeometry( const swNativeGeometry& right )
+        {
+            this->driver = right.driver;
+        }
+
+        inline ~swNativeGeometry( void )
+        {
+            return;
+        }
+    };
+
+    struct swNativeMaterial
+    {
+        swNativeDriver *driver;
+
+        inline swNativeMaterial( softwareDriverInterface *env, Interface *engineInterface, swNativeDriver *driver )
+        {
+            this->driver = driver;
+        }
+
+        inline swNativeMaterial( const swNativeMaterial& right )
+        {
+            this->driver = right.driver;
+        }
+
+        inline ~swNativeMaterial( void )
+        {
+            return;
+        }
+    };
+
+    // Compiled pipeline state.
+    // Since there are no programmable stages, vertex positions are expected in clip space.
+    struct swGraphicsState
+    {
+        swGraphicsState( softwareDriverInterface *env, Interface *engineInterface, swNativeDriver *driver, const gfxGraphicsState& psoState );
+
+        swNativeDriver *driver;
+
+        gfxBlendState blendState;
+        gfxRasterizerState rasterizerState;
+        gfxDepthStencilState depthStencilState;
+        ePrimitiveTopologyType topologyType;
+
+        // Decoded input layout.
+        struct attribFetch
+        {
+            bool isPresent;
+            eVertexAttribValueType valueType;
+            uint32 count;
+            uint32 byteOffset;
+        };
+
+        attribFetch posAttrib;
+        attribFetch colorAttrib;
+        attribFetch texCoordAttrib;
+
+        // Sampling of the texture.
+        bool linearFiltering;
+        eRasterStageAddressMode uAddressing;
+        eRasterStageAddressMode vAddressing;
+    };
+
+    // Triangle after setup, ready for rasterization.
+    struct swTriangle
+    {
+        // Edge functions E(x,y) = A*x + B*y + C, positive inside.
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        bool edgeTopLeft[3];
+
+        float invArea;
+
+        // Screen-space bounding box (inclusive-exclusive).
+        int32 minX, minY, maxX, maxY;
+
+        // Per-vertex attributes, pre-divided by w for perspective correction.
+        float z[3];
+        float invW[3];
+        float color[3][4];
+        float texCoord[3][2];
+
+        const swGraphicsState *pso;
+        const swNativeRaster *texture;
+    };
+
+    struct swSwapChain
+    {
+        swNativeDriver *driver;
+
+        swSwapChain( softwareDriverInterface *env, Interface *engineInterface, swNativeDriver *driver, Window *sysWnd, uint32 width, uint32 height, uint32 frameCount );
+
+        uint32 width, height;
+
+        // Color buffers (packed BGRA) and the shared depth buffer.
+        std::vector <std::vector <uint32>> colorBuffers;
+        std::vector <float> depthBuffer;
+
+        uint32 backBufferIndex;
+        uint32 frontBufferIndex;
+
+        // Binned work of the current frame.
+        uint32 tilesX, tilesY;
+
+        std::vector <swTriangle> pendingTriangles;
+        std::vector <std::vector <uint32>> tileBins;
+
+        void BinTriangle( const swTriangle& tri );
+        void Flush( void );
+    };
+
+    // Object construction.
+    struct driverFactoryConstructor
+    {
+        inline driverFactoryConstructor( softwareDriverInterface *env, Interface *engineInterface )
+        {
+            this->env = env;
+            this->engineInterface = engineInterface;
+        }
+
+        inline swNativeDriver* Construct( void *mem ) const
+        {
+            return new (mem) swNativeDriver( this->env, this->engineInterface );
+        }
+
+        softwareDriverInterface *env;
+        Interface *engineInterface;
+    };
+
+    void OnDriverConstruct( Interface *engineInterface, void *driverObjMem, size_t driverMemSize ) override
+    {
+        driverFactoryConstructor constructor( this, engineInterface );
+
+        swDriverFactory.ConstructPlacementEx( driverObjMem, constructor );
+    }
+
+    void OnDriverCopyConstruct( Interface *engineInterface, void *driverObjMem, const void *srcDriverObjMem, size_t driverMemSize ) override
+    {
+        swDriverFactory.ClonePlacement( driverObjMem, (const swNativeDriver*)srcDriverObjMem );
+    }
+
+    void OnDriverDestroy( Interface *engineInterface, void *driverObjMem, size_t driverMemSize ) override
+    {
+        swDriverFactory.DestroyPlacement( (swNativeDriver*)driverObjMem );
+    }
+
+    NATIVE_DRIVER_OBJ_CONSTRUCT_IMPL( Raster, swNativeRaster, swNativeDriver );
+    NATIVE_DRIVER_OBJ_CONSTRUCT_IMPL( Geometry, swNativeGeometry, swNativeDriver );
+    NATIVE_DRIVER_OBJ_CONSTRUCT_IMPL( Material, swNativeMaterial, swNativeDriver );
+
+    NATIVE_DRIVER_DEFINE_INSTANCING_FORWARD( Raster );
+    NATIVE_DRIVER_DEFINE_INSTANCING_FORWARD( Geometry );
+    NATIVE_DRIVER_DEFINE_INSTANCING_FORWARD( Material );
+
+    NATIVE_DRIVER_SWAPCHAIN_CONSTRUCT() override
+    {
+        new (objMem) swSwapChain( this, engineInterface, (swNativeDriver*)driverObjMem, sysWnd, width, height, frameCount );
+    }
+    NATIVE_DRIVER_SWAPCHAIN_DESTROY() override
+    {
+        ((swSwapChain*)objMem)->~swSwapChain();
+    }
+
+    NATIVE_DRIVER_GRAPHICS_STATE_CONSTRUCT() override
+    {
+        new (objMem) swGraphicsState( this, engineInterface, (swNativeDriver*)driverObjMem, gfxState );
+    }
+    NATIVE_DRIVER_GRAPHICS_STATE_DESTROY() override
+    {
+        ((swGraphicsState*)objMem)->~swGraphicsState();
+    }
+
+    // Command submission.
+    NATIVE_DRIVER_CLEAR() override;
+    NATIVE_DRIVER_DRAW_PRIMITIVES() override;
+    NATIVE_DRIVER_SWAPCHAIN_PRESENT() override;
+    NATIVE_DRIVER_SWAPCHAIN_GETBITMAP() override;
+
+    bool hasRegisteredDriver;
+
+    inline void Initialize( EngineInterface *engineInterface )
+    {
+        // We can always run on the CPU.
+        driverConstructionProps props;
+        props.rasterMemSize = sizeof( swNativeRaster );
+        props.geomMemSize = sizeof( swNativeGeometry );
+        props.matMemSize = sizeof( swNativeMaterial );
+        props.swapChainMemSize = sizeof( swSwapChain );
+        props.graphicsStateMemSize = sizeof( swGraphicsState );
+
+        this->hasRegisteredDriver = RegisterDriver( engineInterface, "software", props, this, swDriverFactory.GetClassSize() );
+    }
+
+    inline void Shutdown( EngineInterface *engineInterface )
+    {
+        if ( this->hasRegisteredDriver )
+        {
+            UnregisterDriver( engineInterface, this );
+        }
+    }
+};
+
+// Converts a normalized color channel to 8bit, clamping it to the valid range.
+inline uint8 swPackColorChannel( float value )
+{
+    if ( !( value > 0.0f ) )
+        return 0;
+
+    if ( value >= 1.0f )
+        return 255;
+
+    return (uint8)( value * 255.0f + 0.5f );
+}
+
+// Rasterizer entry points (rwdriver.software.rasterizer.cpp).
+void swRasterizeTile( softwareDriverInterface::swSwapChain *swapChain, uint32 tileX, uint32 tileY );
+
+};
+
+#endif //_RENDERWARE_SOFTWARE_DRIVER_
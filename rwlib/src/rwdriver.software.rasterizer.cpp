@@ -0,0 +1,385 @@
+#include "StdInc.h"
+
+#include "rwdriver.software.hxx"
+
+#include <emmintrin.h>
+
+// Pixel processing of the software driver.
+// Every tile owns its pixels, so tiles can be processed on different threads without locking.
+// Inside of a tile the triangles are processed in submission order to keep blending correct.
+
+namespace rw
+{
+
+struct swColor
+{
+    float r, g, b, a;
+};
+
+AINLINE swColor swUnpackColor( uint32 packed )
+{
+    const float scale = ( 1.0f / 255.0f );
+
+    swColor color;
+    color.b = (float)( packed & 0xFF ) * scale;
+    color.g = (float)( ( packed >> 8 ) & 0xFF ) * scale;
+    color.r = (float)( ( packed >> 16 ) & 0xFF ) * scale;
+    color.a = (float)( ( packed >> 24 ) & 0xFF ) * scale;
+
+    return color;
+}
+
+AINLINE uint32 swPackColor( const swColor& color )
+{
+    return
+        ( (uint32)swPackColorChannel( color.b ) |
+          ( (uint32)swPackColorChannel( color.g ) << 8 ) |
+          ( (uint32)swPackColorChannel( color.r ) << 16 ) |
+          ( (uint32)swPackColorChannel( color.a ) << 24 ) );
+}
+
+AINLINE bool swCompare( rwCompareOpState func, float value, float ref )
+{
+    switch( func )
+    {
+    case RWCMP_NEVER:           return false;
+    case RWCMP_LESS:            return ( value < ref );
+    case RWCMP_EQUAL:           return ( value == ref );
+    case RWCMP_LESSEQUAL:       return ( value <= ref );
+    case RWCMP_GREATER:         return ( value > ref );
+    case RWCMP_NOTEQUAL:        return ( value != ref );
+    case RWCMP_GREATEREQUAL:    return ( value >= ref );
+    case RWCMP_ALWAYS:          return true;
+    }
+
+    return true;
+}
+
+// Texture addressing of a single coordinate, in texels.
+AINLINE int32 swAddressTexel( int32 coord, int32 size, eRasterStageAddressMode mode )
+{
+    if ( mode == RWTEXADDRESS_CLAMP || mode == RWTEXADDRESS_BORDER )
+    {
+        return std::min( std::max( coord, 0 ), size - 1 );
+    }
+
+    if ( mode == RWTEXADDRESS_MIRROR )
+    {
+        int32 period = ( size * 2 );
+
+        int32 wrapped = ( coord % period );
+
+        if ( wrapped < 0 )
+        {
+            wrapped += period;
+        }
+
+        return ( wrapped < size ) ? wrapped : ( period - 1 - wrapped );
+    }
+
+    // Wrap.
+    int32 wrapped = ( coord % size );
+
+    if ( wrapped < 0 )
+    {
+        wrapped += size;
+    }
+
+    return wrapped;
+}
+
+AINLINE swColor swFetchTexel( const softwareDriverInterface::swNativeRaster *texture, const softwareDriverInterface::swGraphicsState *pso, int32 x, int32 y )
+{
+    int32 width = (int32)texture->width;
+    int32 height = (int32)texture->height;
+
+    x = swAddressTexel( x, width, pso->uAddressing );
+    y = swAddressTexel( y, height, pso->vAddressing );
+
+    return swUnpackColor( texture->texels[ y * width + x ] );
+}
+
+static swColor swSampleTexture( const softwareDriverInterface::swNativeRaster *texture, const softwareDriverInterface::swGraphicsState *pso, float u, float v )
+{
+    float texU = ( u * (float)texture->width );
+    float texV = ( v * (float)texture->height );
+
+    if ( pso->linearFiltering == false )
+    {
+        return swFetchTexel( texture, pso, (int32)std::floor( texU ), (int32)std::floor( texV ) );
+    }
+
+    // Bilinear filtering between the four closest texel centers.
+    texU -= 0.5f;
+    texV -= 0.5f;
+
+    float floorU = std::floor( texU );
+    float floorV = std::floor( texV );
+
+    float fracU = ( texU - floorU );
+    float fracV = ( texV - floorV );
+
+    int32 x0 = (int32)floorU;
+    int32 y0 = (int32)floorV;
+
+    swColor c00 = swFetchTexel( texture, pso, x0, y0 );
+    swColor c10 = swFetchTexel( texture, pso, x0 + 1, y0 );
+    swColor c01 = swFetchTexel( texture, pso, x0, y0 + 1 );
+    swColor c11 = swFetchTexel( texture, pso, x0 + 1, y0 + 1 );
+
+    float w00 = ( 1.0f - fracU ) * ( 1.0f - fracV );
+    float w10 = fracU * ( 1.0f - fracV );
+    float w01 = ( 1.0f - fracU ) * fracV;
+    float w11 = fracU * fracV;
+
+    swColor result;
+    result.r = ( c00.r * w00 + c10.r * w10 + c01.r * w01 + c11.r * w11 );
+    result.g = ( c00.g * w00 + c10.g * w10 + c01.g * w01 + c11.g * w11 );
+    result.b = ( c00.b * w00 + c10.b * w10 + c01.b * w01 + c11.b * w11 );
+    result.a = ( c00.a * w00 + c10.a * w10 + c01.a * w01 + c11.a * w11 );
+
+    return result;
+}
+
+// Returns the blend factor for the color channels (RGB) or the alpha channel.
+AINLINE float swBlendFactor( rwBlendModeState mode, const swColor& src, const swColor& dst, float srcChannel, float dstChannel, bool isAlpha )
+{
+    switch( mode )
+    {
+    case RWBLEND_ZERO:          return 0.0f;
+    case RWBLEND_ONE:           return 1.0f;
+    case RWBLEND_SRCCOLOR:      return srcChannel;
+    case RWBLEND_INVSRCCOLOR:   return ( 1.0f - srcChannel );
+    case RWBLEND_SRCALPHA:      return src.a;
+    case RWBLEND_INVSRCALPHA:   return ( 1.0f - src.a );
+    case RWBLEND_DESTALPHA:     return dst.a;
+    case RWBLEND_INVDESTALPHA:  return ( 1.0f - dst.a );
+    case RWBLEND_DESTCOLOR:     return dstChannel;
+    case RWBLEND_INVDESTCOLOR:  return ( 1.0f - dstChannel );
+    case RWBLEND_SRCALPHASAT:
+        return ( isAlpha ? 1.0f : std::min( src.a, 1.0f - dst.a ) );
+    }
+
+    return 1.0f;
+}
+
+AINLINE float swBlendChannel( rwBlendOp op, float src, float srcFactor, float dst, float dstFactor )
+{
+    switch( op )
+    {
+    case RWBLENDOP_ADD:             return ( src * srcFactor + dst * dstFactor );
+    case RWBLENDOP_SUBTRACT:        return ( src * srcFactor - dst * dstFactor );
+    case RWBLENDOP_REV_SUBTRACT:    return ( dst * dstFactor - src * srcFactor );
+    case RWBLENDOP_MIN:             return std::min( src, dst );
+    case RWBLENDOP_MAX:             return std::max( src, dst );
+    }
+
+    return src;
+}
+
+static swColor swBlend( const gfxBlendState& blendState, const swColor& src, const swColor& dst )
+{
+    swColor result;
+
+    result.r = swBlendChannel( blendState.blendOp,
+        src.r, swBlendFactor( blendState.srcBlend, src, dst, src.r, dst.r, false ),
+        dst.r, swBlendFactor( blendState.dstBlend, src, dst, src.r, dst.r, false )
+    );
+    result.g = swBlendChannel( blendState.blendOp,
+        src.g, swBlendFactor( blendState.srcBlend, src, dst, src.g, dst.g, false ),
+        dst.g, swBlendFactor( blendState.dstBlend, src, dst, src.g, dst.g, false )
+    );
+    result.b = swBlendChannel( blendState.blendOp,
+        src.b, swBlendFactor( blendState.srcBlend, src, dst, src.b, dst.b, false ),
+        dst.b, swBlendFactor( blendState.dstBlend, src, dst, src.b, dst.b, false )
+    );
+    result.a = swBlendChannel( blendState.alphaBlendOp,
+        src.a, swBlendFactor( blendState.srcAlphaBlend, src, dst, src.a, dst.a, true ),
+        dst.a, swBlendFactor( blendState.dstAlphaBlend, src, dst, src.a, dst.a, true )
+    );
+
+    return result;
+}
+
+// Shades a covered pixel, given the edge function values at its center.
+AINLINE void swShadePixel(
+    const softwareDriverInterface::swTriangle& tri,
+    uint32 *colorPtr, float *depthPtr,
+    float e0, float e1, float e2
+)
+{
+    const softwareDriverInterface::swGraphicsState *pso = tri.pso;
+
+    float l0 = ( e0 * tri.invArea );
+    float l1 = ( e1 * tri.invArea );
+    float l2 = ( e2 * tri.invArea );
+
+    // Depth is affine in screen space.
+    float z = ( l0 * tri.z[0] + l1 * tri.z[1] + l2 * tri.z[2] );
+
+    const gfxDepthStencilState& depthState = pso->depthStencilState;
+
+    if ( depthState.enableDepthTest )
+    {
+        if ( swCompare( depthState.depthFunc, z, *depthPtr ) == false )
+            return;
+
+        if ( depthState.enableDepthWrite )
+        {
+            *depthPtr = z;
+        }
+    }
+
+    // Perspective correct attributes.
+    float w = 1.0f / ( l0 * tri.invW[0] + l1 * tri.invW[1] + l2 * tri.invW[2] );
+
+    l0 *= w;
+    l1 *= w;
+    l2 *= w;
+
+    swColor color;
+    color.r = ( l0 * tri.color[0][0] + l1 * tri.color[1][0] + l2 * tri.color[2][0] );
+    color.g = ( l0 * tri.color[0][1] + l1 * tri.color[1][1] + l2 * tri.color[2][1] );
+    color.b = ( l0 * tri.color[0][2] + l1 * tri.color[1][2] + l2 * tri.color[2][2] );
+    color.a = ( l0 * tri.color[0][3] + l1 * tri.color[1][3] + l2 * tri.color[2][3] );
+
+    if ( const softwareDriverInterface::swNativeRaster *texture = tri.texture )
+    {
+        float u = ( l0 * tri.texCoord[0][0] + l1 * tri.texCoord[1][0] + l2 * tri.texCoord[2][0] );
+        float v = ( l0 * tri.texCoord[0][1] + l1 * tri.texCoord[1][1] + l2 * tri.texCoord[2][1] );
+
+        swColor texColor = swSampleTexture( texture, pso, u, v );
+
+        color.r *= texColor.r;
+        color.g *= texColor.g;
+        color.b *= texColor.b;
+        color.a *= texColor.a;
+    }
+
+    if ( pso->blendState.enableBlend )
+    {
+        color = swBlend( pso->blendState, color, swUnpackColor( *colorPtr ) );
+    }
+
+    *colorPtr = swPackColor( color );
+}
+
+static void swRasterizeTriangleInTile(
+    const softwareDriverInterface::swTriangle& tri,
+    uint32 *colorBuf, float *depthBuf, uint32 bufWidth,
+    int32 tileMinX, int32 tileMinY, int32 tileMaxX, int32 tileMaxY
+)
+{
+    int32 minX = std::max( tri.minX, tileMinX );
+    int32 minY = std::max( tri.minY, tileMinY );
+    int32 maxX = std::min( tri.maxX, tileMaxX );
+    int32 maxY = std::min( tri.maxY, tileMaxY );
+
+    if ( minX >= maxX || minY >= maxY )
+        return;
+
+    // We test four pixels of a row at once.
+    const __m128 pixelOffsets = _mm_setr_ps( 0.5f, 1.5f, 2.5f, 3.5f );
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128 edgeA[3];
+    __m128 topLeftMask[3];
+
+    for ( uint32 n = 0; n < 3; n++ )
+    {
+        edgeA[n] = _mm_set1_ps( tri.edgeA[n] );
+
+        // Pixels exactly on an edge only belong to the triangle if the edge is a top or left one.
+        topLeftMask[n] = _mm_castsi128_ps( _mm_set1_epi32( tri.edgeTopLeft[n] ? -1 : 0 ) );
+    }
+
+    for ( int32 y = minY; y < maxY; y++ )
+    {
+        float centerY = ( (float)y + 0.5f );
+
+        __m128 rowBase[3];
+
+        for ( uint32 n = 0; n < 3; n++ )
+        {
+            rowBase[n] = _mm_set1_ps( tri.edgeB[n] * centerY + tri.edgeC[n] );
+        }
+
+        uint32 *colorRow = ( colorBuf + y * bufWidth );
+        float *depthRow = ( depthBuf + y * bufWidth );
+
+        for ( int32 x = minX; x < maxX; x += 4 )
+        {
+            __m128 centerX = _mm_add_ps( _mm_set1_ps( (float)x ), pixelOffsets );
+
+            __m128 edgeVal[3];
+            __m128 covered = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+
+            for ( uint32 n = 0; n < 3; n++ )
+            {
+                edgeVal[n] = _mm_add_ps( _mm_mul_ps( edgeA[n], centerX ), rowBase[n] );
+
+                __m128 inside =
+                    _mm_or_ps(
+                        _mm_cmpgt_ps( edgeVal[n], zero ),
+                        _mm_and_ps( topLeftMask[n], _mm_cmpeq_ps( edgeVal[n], zero ) )
+                    );
+
+                covered = _mm_and_ps( covered, inside );
+            }
+
+            int coverMask = _mm_movemask_ps( covered );
+
+            // Drop the pixels that are past the end of the span.
+            int32 spanLeft = ( maxX - x );
+
+            if ( spanLeft < 4 )
+            {
+                coverMask &= ( ( 1 << spanLeft ) - 1 );
+            }
+
+            if ( coverMask == 0 )
+                continue;
+
+            alignas(16) float e0[4], e1[4], e2[4];
+
+            _mm_store_ps( e0, edgeVal[0] );
+            _mm_store_ps( e1, edgeVal[1] );
+            _mm_store_ps( e2, edgeVal[2] );
+
+            for ( int32 n = 0; n < 4; n++ )
+            {
+                if ( ( coverMask & ( 1 << n ) ) == 0 )
+                    continue;
+
+                swShadePixel( tri, colorRow + x + n, depthRow + x + n, e0[n], e1[n], e2[n] );
+            }
+        }
+    }
+}
+
+void swRasterizeTile( softwareDriverInterface::swSwapChain *swapChain, uint32 tileX, uint32 tileY )
+{
+    const std::vector <uint32>& bin = swapChain->tileBins[ tileY * swapChain->tilesX + tileX ];
+
+    if ( bin.empty() )
+        return;
+
+    uint32 bufWidth = swapChain->width;
+
+    int32 tileMinX = (int32)( tileX * SWRAST_TILE_SIZE );
+    int32 tileMinY = (int32)( tileY * SWRAST_TILE_SIZE );
+    int32 tileMaxX = std::min( tileMinX + SWRAST_TILE_SIZE, (int32)swapChain->width );
+    int32 tileMaxY = std::min( tileMinY + SWRAST_TILE_SIZE, (int32)swapChain->height );
+
+    uint32 *colorBuf = swapChain->colorBuffers[ swapChain->backBufferIndex ].data();
+    float *depthBuf = swapChain->depthBuffer.data();
+
+    for ( uint32 triIndex : bin )
+    {
+        const softwareDriverInterface::swTriangle& tri = swapChain->pendingTriangles[ triIndex ];
+
+        swRasterizeTriangleInTile( tri, colorBuf, depthBuf, bufWidth, tileMinX, tileMinY, tileMaxX, tileMaxY );
+    }
+}
+
+};
@@ -8,8 +8,11 @@
 
 #include "streamutil.hxx"
 
+#include "rwthreading.parallel.hxx"
+
 #ifdef RWLIB_INCLUDE_PNG_IMAGING
 #include <png.h>
+#include <zlib.h>
 #endif //RWLIB_INCLUDE_PNG_IMAGING
 
 namespace rw
@@ -28,6 +31,442 @@ inline uint32 getPNGRasterDataRowSize( uint32 width, uint32 depth )
     return getRasterDataRowSize( width, depth, getPNGTexelDataRowAlignment() );
 }
 
+// Size of the row groups that are deflated independently of each other.
+#define PNG_DEFLATE_GROUP_SIZE      ( 256 * 1024 )
+
+// Size of the deflate window that each row group is primed with.
+#define PNG_DEFLATE_WINDOW_SIZE     32768
+
+inline uint8 pngPaethPredictor( uint8 a, uint8 b, uint8 c )
+{
+    int p = ( (int)a + (int)b - (int)c );
+
+    int pa = abs( p - (int)a );
+    int pb = abs( p - (int)b );
+    int pc = abs( p - (int)c );
+
+    if ( pa <= pb && pa <= pc )
+        return a;
+
+    if ( pb <= pc )
+        return b;
+
+    return c;
+}
+
+// Applies one of the five PNG row filters.
+// prevRow is NULL for the first row of the image.
+static void pngFilterRow( uint8 filterType, const uint8 *row, const uint8 *prevRow, size_t rowSize, size_t bpp, uint8 *dstRow )
+{
+    if ( filterType == 0 )
+    {
+        memcpy( dstRow, row, rowSize );
+    }
+    else if ( filterType == 1 )
+    {
+        for ( size_t n = 0; n < rowSize; n++ )
+        {
+            uint8 left = ( n >= bpp ? row[ n - bpp ] : 0 );
+
+            dstRow[ n ] = (uint8)( row[ n ] - left );
+        }
+    }
+    else if ( filterType == 2 )
+    {
+        for ( size_t n = 0; n < rowSize; n++ )
+        {
+            uint8 up = ( prevRow ? prevRow[ n ] : 0 );
+
+            dstRow[ n ] = (uint8)( row[ n ] - up );
+        }
+    }
+    else if ( filterType == 3 )
+    {
+        for ( size_t n = 0; n < rowSize; n++ )
+        {
+            uint32 left = ( n >= bpp ? row[ n - bpp ] : 0 );
+            uint32 up = ( prevRow ? prevRow[ n ] : 0 );
+
+            dstRow[ n ] = (uint8)( row[ n ] - (uint8)( ( left + up ) / 2 ) );
+        }
+    }
+    else
+    {
+        for ( size_t n = 0; n < rowSize; n++ )
+        {
+            uint8 left = ( n >= bpp ? row[ n - bpp ] : 0 );
+            uint8 up = ( prevRow ? prevRow[ n ] : 0 );
+            uint8 upLeft = ( prevRow && n >= bpp ? prevRow[ n - bpp ] : 0 );
+
+            dstRow[ n ] = (uint8)( row[ n ] - pngPaethPredictor( left, up, upLeft ) );
+        }
+    }
+}
+
+// Cost of a filtered row: the sum of the residuals taken as signed bytes.
+inline uint64 pngFilteredRowCost( const uint8 *filteredRow, size_t rowSize )
+{
+    uint64 cost = 0;
+
+    for ( size_t n = 0; n < rowSize; n++ )
+    {
+        cost += (uint64)abs( (int)(int8)filteredRow[ n ] );
+    }
+
+    return cost;
+}
+
+inline int getZlibCompressionStrategy( ePNGCompressionStrategy strategy )
+{
+    if ( strategy == PNGSTRATEGY_FILTERED )
+    {
+        return Z_FILTERED;
+    }
+    else if ( strategy == PNGSTRATEGY_HUFFMAN_ONLY )
+    {
+        return Z_HUFFMAN_ONLY;
+    }
+    else if ( strategy == PNGSTRATEGY_RLE )
+    {
+        return Z_RLE;
+    }
+
+    return Z_DEFAULT_STRATEGY;
+}
+
+// Deflates a group of filtered rows as raw deflate data.
+// Every group but the last one ends on a sync-flush boundary, so that the groups can be
+// concatenated into a single zlib stream.
+static void pngDeflateRowGroup(
+    const uint8 *streamData, size_t groupOffset, size_t groupSize, bool isLastGroup,
+    int compressionLevel, int compressionStrategy,
+    std::vector <uint8>& compressedOut
+)
+{
+    z_stream zstream;
+    memset( &zstream, 0, sizeof( zstream ) );
+
+    int initErr = deflateInit2( &zstream, compressionLevel, Z_DEFLATED, -15, 8, compressionStrategy );
+
+    if ( initErr != Z_OK )
+    {
+        throw RwException( "failed to initialize .png deflate stream" );
+    }
+
+    try
+    {
+        // Prime the group with the data that precedes it, so that we lose almost no compression.
+        if ( groupOffset != 0 )
+        {
+            size_t dictSize = std::min( (size_t)PNG_DEFLATE_WINDOW_SIZE, groupOffset );
+
+            deflateSetDictionary( &zstream, (const Bytef*)streamData + groupOffset - dictSize, (uInt)dictSize );
+        }
+
+        compressedOut.resize( deflateBound( &zstream, (uLong)groupSize ) + 16 );
+
+        zstream.next_in = (Bytef*)streamData + groupOffset;
+        zstream.avail_in = (uInt)groupSize;
+        zstream.next_out = compressedOut.data();
+        zstream.avail_out = (uInt)compressedOut.size();
+
+        int flushMode = ( isLastGroup ? Z_FINISH : Z_SYNC_FLUSH );
+
+        while ( true )
+        {
+            int deflateErr = deflate( &zstream, flushMode );
+
+            if ( deflateErr == Z_STREAM_ERROR )
+            {
+                throw RwException( "failed to deflate .png image data" );
+            }
+
+            bool isDone;
+
+            if ( isLastGroup )
+            {
+                isDone = ( deflateErr == Z_STREAM_END );
+            }
+            else
+            {
+                isDone = ( zstream.avail_in == 0 && zstream.avail_out != 0 );
+            }
+
+            if ( isDone )
+                break;
+
+            // Give the stream more room.
+            size_t curSize = compressedOut.size();
+
+            compressedOut.resize( curSize * 2 );
+
+            zstream.next_out = compressedOut.data() + zstream.total_out;
+            zstream.avail_out = (uInt)( compressedOut.size() - zstream.total_out );
+        }
+
+        compressedOut.resize( zstream.total_out );
+    }
+    catch( ... )
+    {
+        deflateEnd( &zstream );
+
+        throw;
+    }
+
+    deflateEnd( &zstream );
+}
+
+// Writes the IDAT chunks of a PNG image.
+// We do this instead of libpng so that rows are filtered and deflated on the worker threads.
+static void pngWriteImageData(
+    EngineInterface *engineInterface, png_structp write_info, const pngWriteOptions& writeOpts,
+    const void *texelSource, uint32 mipWidth, uint32 mipHeight, bool isAlreadyTransformed,
+    eRasterFormat rasterFormat, uint32 depth, uint32 rowAlignment, eColorOrdering colorOrder, ePaletteType paletteType, uint32 paletteSize,
+    eRasterFormat wantedRasterFormat, uint32 wantedItemDepth, eColorOrdering wantedColorOrder, ePaletteType wantedPaletteType
+)
+{
+    size_t rowSizeSrc = getRasterDataRowSize( mipWidth, depth, rowAlignment );
+
+    size_t pngRowSize = getPNGRasterDataRowSize( mipWidth, wantedItemDepth );
+
+    // Distance of corresponding bytes of neighboring pixels, for filtering.
+    size_t filterBpp = std::max( 1u, wantedItemDepth / 8 );
+
+    // PNG stores packed pixels from the most significant bits, unlike us.
+    bool needsNibbleSwap = ( wantedItemDepth == 4 );
+
+    uint32 maxWorkers = ( writeOpts.parallelDeflate ? 0 : 1 );
+
+    // Split the image into row groups.
+    size_t streamRowSize = ( pngRowSize + 1 );
+
+    uint32 groupRowCount = std::max( 1u, mipHeight );
+
+    if ( writeOpts.parallelDeflate )
+    {
+        groupRowCount = (uint32)std::max( (size_t)1, PNG_DEFLATE_GROUP_SIZE / streamRowSize );
+    }
+
+    // Empty layers still get one empty group, so that a valid zlib stream is written.
+    uint32 groupCount = std::max( 1u, ( mipHeight + groupRowCount - 1 ) / groupRowCount );
+
+    // 1. Get the rows into PNG pixel layout.
+    const uint8 *rawRows = (const uint8*)texelSource;
+    size_t rawRowStride = rowSizeSrc;
+
+    std::vector <uint8> transformedImage;
+
+    if ( !isAlreadyTransformed || needsNibbleSwap )
+    {
+        transformedImage.resize( pngRowSize * mipHeight );
+
+        uint8 *dstImage = transformedImage.data();
+
+        ParallelForEach( engineInterface, groupCount,
+            [&]( size_t groupIndex )
+        {
+            uint32 startRow = (uint32)( groupIndex * groupRowCount );
+            uint32 endRow = std::min( mipHeight, startRow + groupRowCount );
+
+            for ( uint32 row = startRow; row < endRow; row++ )
+            {
+                uint8 *dstRow = ( dstImage + pngRowSize * row );
+
+                if ( isAlreadyTransformed )
+                {
+                    memcpy( dstRow, (const uint8*)texelSource + rowSizeSrc * row, pngRowSize );
+                }
+                else
+                {
+                    // Call the generic transformation routine.
+                    moveTexels(
+                        texelSource, dstRow,
+                        0, row,
+                        0, 0,
+                        mipWidth, 1,
+                        mipWidth, mipHeight,
+                        rasterFormat, depth, rowAlignment, colorOrder, paletteType, paletteSize,
+                        wantedRasterFormat, wantedItemDepth, getPNGTexelDataRowAlignment(), wantedColorOrder, wantedPaletteType, paletteSize
+                    );
+                }
+
+                if ( needsNibbleSwap )
+                {
+                    for ( size_t n = 0; n < pngRowSize; n++ )
+                    {
+                        uint8 val = dstRow[ n ];
+
+                        dstRow[ n ] = (uint8)( ( val << 4 ) | ( val >> 4 ) );
+                    }
+                }
+            }
+        }, maxWorkers );
+
+        rawRows = dstImage;
+        rawRowStride = pngRowSize;
+    }
+
+    // 2. Filter the rows.
+    // Filters do not pay off for palette indices and packed pixels.
+    bool useAdaptiveFilters = ( writeOpts.adaptiveFilters && wantedPaletteType == PALETTE_NONE && wantedItemDepth >= 8 );
+
+    std::vector <uint8> filteredStream( streamRowSize * mipHeight );
+
+    uint8 *streamData = filteredStream.data();
+
+    ParallelForEach( engineInterface, groupCount,
+        [&]( size_t groupIndex )
+    {
+        uint32 startRow = (uint32)( groupIndex * groupRowCount );
+        uint32 endRow = std::min( mipHeight, startRow + groupRowCount );
+
+        std::vector <uint8> trialRow;
+
+        if ( useAdaptiveFilters )
+        {
+            trialRow.resize( pngRowSize );
+        }
+
+        for ( uint32 row = startRow; row < endRow; row++ )
+        {
+            const uint8 *srcRow = ( rawRows + rawRowStride * row );
+            const uint8 *prevRow = ( row != 0 ? ( rawRows + rawRowStride * ( row - 1 ) ) : NULL );
+
+            uint8 *dstStreamRow = ( streamData + streamRowSize * row );
+
+            uint8 bestFilter = 0;
+
+            pngFilterRow( 0, srcRow, prevRow, pngRowSize, filterBpp, dstStreamRow + 1 );
+
+            if ( useAdaptiveFilters )
+            {
+                // Take the filter that leaves the smallest residuals.
+                uint64 bestCost = pngFilteredRowCost( dstStreamRow + 1, pngRowSize );
+
+                for ( uint8 filterType = 1; filterType < 5; filterType++ )
+                {
+                    pngFilterRow( filterType, srcRow, prevRow, pngRowSize, filterBpp, trialRow.data() );
+
+                    uint64 trialCost = pngFilteredRowCost( trialRow.data(), pngRowSize );
+
+                    if ( trialCost < bestCost )
+                    {
+                        bestCost = trialCost;
+                        bestFilter = filterType;
+
+                        memcpy( dstStreamRow + 1, trialRow.data(), pngRowSize );
+                    }
+                }
+            }
+
+            dstStreamRow[ 0 ] = bestFilter;
+        }
+    }, maxWorkers );
+
+    // 3. Deflate the row groups.
+    int compressionLevel = (int)std::min( 9u, writeOpts.compressionLevel );
+    int compressionStrategy = getZlibCompressionStrategy( writeOpts.strategy );
+
+    std::vector <std::vector <uint8>> groupData( groupCount );
+    std::vector <uLong> groupChecksums( groupCount );
+
+    ParallelForEach( engineInterface, groupCount,
+        [&]( size_t groupIndex )
+    {
+        uint32 startRow = (uint32)( groupIndex * groupRowCount );
+        uint32 endRow = std::min( mipHeight, startRow + groupRowCount );
+
+        size_t groupOffset = ( streamRowSize * startRow );
+        size_t groupSize = ( streamRowSize * ( endRow - startRow ) );
+
+        bool isLastGroup = ( groupIndex == groupCount - 1 );
+
+        pngDeflateRowGroup( streamData, groupOffset, groupSize, isLastGroup, compressionLevel, compressionStrategy, groupData[ groupIndex ] );
+
+        groupChecksums[ groupIndex ] = adler32( adler32( 0, Z_NULL, 0 ), streamData + groupOffset, (uInt)groupSize );
+    }, maxWorkers );
+
+    // 4. Write it as one zlib stream.
+    uint8 zlibHeader[2];
+    {
+        uint32 levelFlags = 3;
+
+        if ( compressionLevel < 2 )
+        {
+            levelFlags = 0;
+        }
+        else if ( compressionLevel < 6 )
+        {
+            levelFlags = 1;
+        }
+        else if ( compressionLevel == 6 )
+        {
+            levelFlags = 2;
+        }
+
+        uint32 cmf = 0x78;      // deflate with a 32K window.
+        uint32 flg = ( levelFlags << 6 );
+
+        flg += ( 31 - ( ( cmf * 256 + flg ) % 31 ) );
+
+        zlibHeader[0] = (uint8)cmf;
+        zlibHeader[1] = (uint8)flg;
+    }
+
+    uLong checksum = adler32( 0, Z_NULL, 0 );
+
+    for ( uint32 groupIndex = 0; groupIndex < groupCount; groupIndex++ )
+    {
+        uint32 startRow = ( groupIndex * groupRowCount );
+        uint32 endRow = std::min( mipHeight, startRow + groupRowCount );
+
+        checksum = adler32_combine( checksum, groupChecksums[ groupIndex ], (z_off_t)( streamRowSize * ( endRow - startRow ) ) );
+    }
+
+    uint8 zlibTrailer[4];
+    zlibTrailer[0] = (uint8)( checksum >> 24 );
+    zlibTrailer[1] = (uint8)( checksum >> 16 );
+    zlibTrailer[2] = (uint8)( checksum >> 8 );
+    zlibTrailer[3] = (uint8)( checksum );
+
+    // Each group goes into its own IDAT chunk.
+    for ( uint32 groupIndex = 0; groupIndex < groupCount; groupIndex++ )
+    {
+        const std::vector <uint8>& compressed = groupData[ groupIndex ];
+
+        bool isFirstGroup = ( groupIndex == 0 );
+        bool isLastGroup = ( groupIndex == groupCount - 1 );
+
+        size_t chunkSize = compressed.size();
+
+        if ( isFirstGroup )
+        {
+            chunkSize += sizeof( zlibHeader );
+        }
+
+        if ( isLastGroup )
+        {
+            chunkSize += sizeof( zlibTrailer );
+        }
+
+        png_write_chunk_start( write_info, (png_const_bytep)"IDAT", (png_uint_32)chunkSize );
+
+        if ( isFirstGroup )
+        {
+            png_write_chunk_data( write_info, zlibHeader, sizeof( zlibHeader ) );
+        }
+
+        png_write_chunk_data( write_info, compressed.data(), compressed.size() );
+
+        if ( isLastGroup )
+        {
+            png_write_chunk_data( write_info, zlibTrailer, sizeof( zlibTrailer ) );
+        }
+
+        png_write_chunk_end( write_info );
+    }
+}
+
 static const imaging_filename_ext png_ext[] =
 {
     { "PNG", true }
@@ -802,9 +1241,6 @@ struct pngImagingExtension : public imagingFormatExtension
                     }
                 }
 
-                // Cache the row size.
-                size_t rowSizeSrc = getRasterDataRowSize( mipWidth, depth, rowAlignment );
-
                 // Check whether we need transformation of pixels before writing.
                 // If we do not, then writing can happen very fast.
                 bool isAlreadyTransformed = true;
@@ -929,70 +1365,18 @@ struct pngImagingExtension : public imagingFormatExtension
                     // Now that everything is set up properly... write it.
                     png_write_info( write_info, img_info );
 
-                    // Make sure we swap pixels if they are packed.
-                    png_set_packswap( write_info );
-
-                    // Alright, lets start writing the pixels.
-                    if ( isAlreadyTransformed )
-                    {
-                        // Optimized write.
-                        // We do not want to allocate row pointers, because we will never interlace the image.
-                        const void *current_row_pointer = texelSource;
-
-                        for ( uint32 row = 0; row < mipHeight; row++ )
-                        {
-                            // Write it.
-                            png_write_row( write_info, (png_const_bytep)current_row_pointer );
-
-                            // Increment the row pointer.
-                            current_row_pointer = (const char*)current_row_pointer + rowSizeSrc;
-                        }
-                    }
-                    else
-                    {
-                        // We need to allocate a row where we transform pixels to.
-                        size_t rowSizeTransformed = getPNGRasterDataRowSize( mipWidth, wantedItemDepth );
-
-                        // We have to extract special row-bits and write them.
-                        png_voidp alloc_row = (png_voidp)engineInterface->PixelAllocate( rowSizeTransformed );
-
-                        if ( alloc_row == NULL )
-                        {
-                            throw RwException( "failed to allocate special row buffer for .png writing" );
-                        }
-
-                        try
-                        {
-                            for ( uint32 row = 0; row < mipHeight; row++ )
-                            {
-                                // Call the generic transformation routine.
-                                moveTexels(
-                                    texelSource, alloc_row,
-                                    0, row,
-                                    0, 0,
-                                    mipWidth, 1,
-                                    mipWidth, mipHeight,
-                                    rasterFormat, depth, rowAlignment, colorOrder, paletteType, paletteSize,
-                                    wantedRasterFormat, wantedItemDepth, getPNGTexelDataRowAlignment(), wantedColorOrder, wantedPaletteType, paletteSize
-                                );
-
-                                // Write our row.
-                                png_write_row( write_info, (png_const_bytep)alloc_row );
-                            }
-                        }
-                        catch( ... )
-                        {
-                            // Free the row again.
-                            engineInterface->PixelFree( alloc_row );
+                    // The image data is encoded by ourselves.
+                    pngWriteOptions writeOpts = engineInterface->GetPNGWriteOptions();
 
-                            throw;
-                        }
-
-                        engineInterface->PixelFree( alloc_row );
-                    }
+                    pngWriteImageData(
+                        (EngineInterface*)engineInterface, write_info, writeOpts,
+                        texelSource, mipWidth, mipHeight, isAlreadyTransformed,
+                        rasterFormat, depth, rowAlignment, colorOrder, paletteType, paletteSize,
+                        wantedRasterFormat, wantedItemDepth, wantedColorOrder, wantedPaletteType
+                    );
 
                     // Write the end of the PNG.
-                    png_write_end( write_info, img_info );
+                    png_write_chunk( write_info, (png_const_bytep)"IEND", NULL, 0 );
                 }
                 catch( ... )
                 {
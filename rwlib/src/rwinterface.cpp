@@ -561,10 +561,39 @@ bool Interface::GetIgnoreSerializationBlockRegions( void ) const
     return GetConstEnvironmentConfigBlock( engineInterface ).GetIgnoreSerializationBlockRegions();
 }
 
+void Interface::SetWorkerThreadCount( uint32 count )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    GetEnvironmentConfigBlock( engineInterface ).SetWorkerThreadCount( count );
+}
+
+uint32 Interface::GetWorkerThreadCount( void ) const
+{
+    const EngineInterface *engineInterface = (const EngineInterface*)this;
+
+    return GetConstEnvironmentConfigBlock( engineInterface ).GetWorkerThreadCount();
+}
+
+void Interface::SetPNGWriteOptions( const pngWriteOptions& opts )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    GetEnvironmentConfigBlock( engineInterface ).SetPNGWriteOptions( opts );
+}
+
+pngWriteOptions Interface::GetPNGWriteOptions( void ) const
+{
+    const EngineInterface *engineInterface = (const EngineInterface*)this;
+
+    return GetConstEnvironmentConfigBlock( engineInterface ).GetPNGWriteOptions();
+}
+
 // Static library object that takes care of initializing the module dependencies properly.
 extern void registerConfigurationEnvironment( void );
 extern void registerThreadingEnvironment( void );
 extern void registerWarningHandlerEnvironment( void );
+extern void registerProfilingEnvironment( void );
 extern void registerEventSystem( void );
 extern void registerTXDPlugins( void );
 extern void registerObjectExtensionsPlugins( void );
@@ -617,6 +646,7 @@ Interface* CreateEngine( LibraryVersion theVersion )
             // Now do the main modules.
             registerThreadingEnvironment();
             registerWarningHandlerEnvironment();
+            registerProfilingEnvironment();
             registerEventSystem();
             registerStreamGlobalPlugins();
             registerFileSystemDataRepository();
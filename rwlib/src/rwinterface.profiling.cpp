@@ -0,0 +1,464 @@
+// RenderWare per-stage profiling.
+// Timers and counters are kept per thread so that measuring does not serialize the worker threads.
+#include "StdInc.h"
+
+#include "rwinterface.hxx"
+
+#include "rwthreading.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+using namespace NativeExecutive;
+
+namespace rw
+{
+
+static inline uint64 GetProfilingTime( void )
+{
+    return (uint64)std::chrono::duration_cast <std::chrono::nanoseconds> ( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+struct profilingStageCounters
+{
+    inline profilingStageCounters( void )
+    {
+        this->Reset();
+    }
+
+    inline void Reset( void )
+    {
+        this->callCount = 0;
+        this->totalNanoseconds = 0;
+        this->selfNanoseconds = 0;
+        this->byteCount = 0;
+        this->texelCount = 0;
+    }
+
+    inline void AddTo( profilingStageStats& statsOut ) const
+    {
+        statsOut.callCount += this->callCount;
+        statsOut.totalNanoseconds += this->totalNanoseconds;
+        statsOut.selfNanoseconds += this->selfNanoseconds;
+        statsOut.byteCount += this->byteCount;
+        statsOut.texelCount += this->texelCount;
+    }
+
+    inline void Merge( const profilingStageCounters& right )
+    {
+        this->callCount += right.callCount;
+        this->totalNanoseconds += right.totalNanoseconds;
+        this->selfNanoseconds += right.selfNanoseconds;
+        this->byteCount += right.byteCount;
+        this->texelCount += right.texelCount;
+    }
+
+    // Only ever written by the owning thread, but read by snapshots from any thread.
+    std::atomic <uint64> callCount;
+    std::atomic <uint64> totalNanoseconds;
+    std::atomic <uint64> selfNanoseconds;
+    std::atomic <uint64> byteCount;
+    std::atomic <uint64> texelCount;
+};
+
+struct profilingEnv;
+
+struct profilingThreadEnv
+{
+    inline profilingThreadEnv( void )
+    {
+        this->currentScope = NULL;
+    }
+
+    profilingStageCounters stages[ PROFSTAGE_COUNT ];
+
+    // Innermost running scope, so that nested stages can be subtracted from self time.
+    profilingScope *currentScope;
+};
+
+struct profilingThreadEnvPluginInterface : public threadPluginInterface
+{
+    bool OnPluginConstruct( CExecThread *theThread, threadPluginOffset pluginOffset, ExecutiveManager::threadPluginContainer_t::pluginDescriptor pluginId ) override;
+    void OnPluginDestruct( CExecThread *theThread, threadPluginOffset pluginOffset, ExecutiveManager::threadPluginContainer_t::pluginDescriptor pluginId ) override;
+
+    bool OnPluginAssign( CExecThread *dstThread, const CExecThread *srcThread, threadPluginOffset pluginOffset, ExecutiveManager::threadPluginContainer_t::pluginDescriptor pluginId ) override
+    {
+        // Counters belong to the thread that collected them.
+        return true;
+    }
+
+    profilingEnv *ownerEnv;
+};
+
+struct profilingEnv
+{
+    inline void Initialize( EngineInterface *engineInterface )
+    {
+        this->isEnabled = false;
+        this->lockThreadEnvs = CreateReadWriteLock( engineInterface );
+
+        this->_threadEnvPluginIntf.ownerEnv = this;
+        this->_threadEnvPluginOffset = ExecutiveManager::threadPluginContainer_t::INVALID_PLUGIN_OFFSET;
+
+        CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+
+        if ( nativeMan )
+        {
+            this->_threadEnvPluginOffset =
+                nativeMan->RegisterThreadPlugin( sizeof( profilingThreadEnv ), &_threadEnvPluginIntf );
+        }
+    }
+
+    inline void Shutdown( EngineInterface *engineInterface )
+    {
+        if ( ExecutiveManager::threadPluginContainer_t::IsOffsetValid( this->_threadEnvPluginOffset ) )
+        {
+            CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+
+            if ( nativeMan )
+            {
+                nativeMan->UnregisterThreadPlugin( this->_threadEnvPluginOffset );
+            }
+        }
+
+        if ( rwlock *theLock = this->lockThreadEnvs )
+        {
+            CloseReadWriteLock( engineInterface, theLock );
+        }
+    }
+
+    inline profilingThreadEnv* GetThreadEnv( CExecThread *theThread ) const
+    {
+        return ExecutiveManager::threadPluginContainer_t::RESOLVE_STRUCT <profilingThreadEnv> ( theThread, this->_threadEnvPluginOffset );
+    }
+
+    inline profilingThreadEnv* GetCurrentThreadEnv( EngineInterface *engineInterface ) const
+    {
+        CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+
+        if ( !nativeMan )
+            return NULL;
+
+        CExecThread *curThread = nativeMan->GetCurrentThread();
+
+        if ( !curThread )
+            return NULL;
+
+        return GetThreadEnv( curThread );
+    }
+
+    std::atomic <bool> isEnabled;
+
+    // All threads that currently own counters, plus what finished threads left behind.
+    rwlock *lockThreadEnvs;
+    std::vector <profilingThreadEnv*> liveThreadEnvs;
+    profilingStageCounters retiredStages[ PROFSTAGE_COUNT ];
+
+    profilingThreadEnvPluginInterface _threadEnvPluginIntf;
+    threadPluginOffset _threadEnvPluginOffset;
+};
+
+static PluginDependantStructRegister <profilingEnv, RwInterfaceFactory_t> profilingEnvRegister;
+
+bool profilingThreadEnvPluginInterface::OnPluginConstruct( CExecThread *theThread, threadPluginOffset pluginOffset, ExecutiveManager::threadPluginContainer_t::pluginDescriptor pluginId )
+{
+    void *objMem = pluginId.RESOLVE_STRUCT <void> ( theThread, pluginOffset );
+
+    if ( !objMem )
+        return false;
+
+    profilingThreadEnv *threadEnv = new (objMem) profilingThreadEnv();
+
+    profilingEnv *env = this->ownerEnv;
+
+    scoped_rwlock_writer <rwlock> lock( env->lockThreadEnvs );
+
+    env->liveThreadEnvs.push_back( threadEnv );
+
+    return true;
+}
+
+void profilingThreadEnvPluginInterface::OnPluginDestruct( CExecThread *theThread, threadPluginOffset pluginOffset, ExecutiveManager::threadPluginContainer_t::pluginDescriptor pluginId )
+{
+    profilingThreadEnv *threadEnv = pluginId.RESOLVE_STRUCT <profilingThreadEnv> ( theThread, pluginOffset );
+
+    if ( !threadEnv )
+        return;
+
+    profilingEnv *env = this->ownerEnv;
+    {
+        scoped_rwlock_writer <rwlock> lock( env->lockThreadEnvs );
+
+        // Keep the numbers of finished worker threads.
+        for ( unsigned int n = 0; n < PROFSTAGE_COUNT; n++ )
+        {
+            env->retiredStages[ n ].Merge( threadEnv->stages[ n ] );
+        }
+
+        auto iter = std::find( env->liveThreadEnvs.begin(), env->liveThreadEnvs.end(), threadEnv );
+
+        if ( iter != env->liveThreadEnvs.end() )
+        {
+            env->liveThreadEnvs.erase( iter );
+        }
+    }
+
+    threadEnv->~profilingThreadEnv();
+}
+
+profilingScope::profilingScope( Interface *intf, eProfilingStage stage )
+{
+    EngineInterface *engineInterface = (EngineInterface*)intf;
+
+    this->threadEnv = NULL;
+    this->parentScope = NULL;
+    this->stage = stage;
+    this->startTime = 0;
+    this->childNanoseconds = 0;
+    this->byteCount = 0;
+    this->texelCount = 0;
+
+    profilingEnv *env = profilingEnvRegister.GetPluginStruct( engineInterface );
+
+    if ( !env || env->isEnabled == false )
+        return;
+
+    profilingThreadEnv *threadEnv = env->GetCurrentThreadEnv( engineInterface );
+
+    if ( !threadEnv )
+        return;
+
+    this->threadEnv = threadEnv;
+    this->parentScope = threadEnv->currentScope;
+
+    threadEnv->currentScope = this;
+
+    this->startTime = GetProfilingTime();
+}
+
+profilingScope::~profilingScope( void )
+{
+    profilingThreadEnv *threadEnv = this->threadEnv;
+
+    if ( !threadEnv )
+        return;
+
+    uint64 timeTaken = ( GetProfilingTime() - this->startTime );
+    uint64 selfTime = ( timeTaken - std::min( this->childNanoseconds, timeTaken ) );
+
+    threadEnv->currentScope = this->parentScope;
+
+    if ( profilingScope *parentScope = this->parentScope )
+    {
+        parentScope->childNanoseconds += timeTaken;
+    }
+
+    profilingStageCounters& counters = threadEnv->stages[ this->stage ];
+
+    counters.callCount++;
+    counters.totalNanoseconds += timeTaken;
+    counters.selfNanoseconds += selfTime;
+    counters.byteCount += this->byteCount;
+    counters.texelCount += this->texelCount;
+}
+
+const char* GetProfilingStageName( eProfilingStage stage )
+{
+    switch( stage )
+    {
+    case PROFSTAGE_DESERIALIZE:     return "deserialize";
+    case PROFSTAGE_SERIALIZE:       return "serialize";
+    case PROFSTAGE_PIXELCONVERT:    return "pixelconvert";
+    case PROFSTAGE_COMPRESS:        return "compress";
+    case PROFSTAGE_DECOMPRESS:      return "decompress";
+    case PROFSTAGE_PALETTIZE:       return "palettize";
+    case PROFSTAGE_RESIZE:          return "resize";
+    case PROFSTAGE_MIPGEN:          return "mipgen";
+    case PROFSTAGE_SWIZZLE:         return "swizzle";
+    default:
+        break;
+    }
+
+    return "unknown";
+}
+
+void Interface::SetProfilingEnabled( bool enabled )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    profilingEnv *env = profilingEnvRegister.GetPluginStruct( engineInterface );
+
+    if ( env )
+    {
+        env->isEnabled = enabled;
+    }
+}
+
+bool Interface::IsProfilingEnabled( void ) const
+{
+    const EngineInterface *engineInterface = (const EngineInterface*)this;
+
+    const profilingEnv *env = profilingEnvRegister.GetConstPluginStruct( engineInterface );
+
+    if ( !env )
+        return false;
+
+    return env->isEnabled;
+}
+
+void Interface::GetProfilingSnapshot( profilingSnapshot& snapOut, bool currentThreadOnly ) const
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    for ( unsigned int n = 0; n < PROFSTAGE_COUNT; n++ )
+    {
+        profilingStageStats& stats = snapOut.stages[ n ];
+
+        stats.callCount = 0;
+        stats.totalNanoseconds = 0;
+        stats.selfNanoseconds = 0;
+        stats.byteCount = 0;
+        stats.texelCount = 0;
+    }
+
+    profilingEnv *env = profilingEnvRegister.GetPluginStruct( engineInterface );
+
+    if ( !env )
+        return;
+
+    if ( currentThreadOnly )
+    {
+        if ( profilingThreadEnv *threadEnv = env->GetCurrentThreadEnv( engineInterface ) )
+        {
+            for ( unsigned int n = 0; n < PROFSTAGE_COUNT; n++ )
+            {
+                threadEnv->stages[ n ].AddTo( snapOut.stages[ n ] );
+            }
+        }
+        return;
+    }
+
+    scoped_rwlock_reader <rwlock> lock( env->lockThreadEnvs );
+
+    for ( unsigned int n = 0; n < PROFSTAGE_COUNT; n++ )
+    {
+        env->retiredStages[ n ].AddTo( snapOut.stages[ n ] );
+    }
+
+    for ( profilingThreadEnv *threadEnv : env->liveThreadEnvs )
+    {
+        for ( unsigned int n = 0; n < PROFSTAGE_COUNT; n++ )
+        {
+            threadEnv->stages[ n ].AddTo( snapOut.stages[ n ] );
+        }
+    }
+}
+
+void Interface::ResetProfiling( void )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    profilingEnv *env = profilingEnvRegister.GetPluginStruct( engineInterface );
+
+    if ( !env )
+        return;
+
+    scoped_rwlock_writer <rwlock> lock( env->lockThreadEnvs );
+
+    for ( unsigned int n = 0; n < PROFSTAGE_COUNT; n++ )
+    {
+        env->retiredStages[ n ].Reset();
+    }
+
+    for ( profilingThreadEnv *threadEnv : env->liveThreadEnvs )
+    {
+        for ( unsigned int n = 0; n < PROFSTAGE_COUNT; n++ )
+        {
+            threadEnv->stages[ n ].Reset();
+        }
+    }
+}
+
+std::string Interface::DumpProfiling( bool asJSON ) const
+{
+    profilingSnapshot snap;
+
+    this->GetProfilingSnapshot( snap );
+
+    std::string dumpOut;
+    char lineBuf[ 256 ];
+
+    if ( asJSON )
+    {
+        dumpOut += "{";
+
+        for ( unsigned int n = 0; n < PROFSTAGE_COUNT; n++ )
+        {
+            const profilingStageStats& stats = snap.stages[ n ];
+
+            _snprintf( lineBuf, sizeof( lineBuf ),
+                "%s\"%s\":{\"calls\":%llu,\"total_ns\":%llu,\"self_ns\":%llu,\"bytes\":%llu,\"texels\":%llu}",
+                ( n != 0 ? "," : "" ),
+                GetProfilingStageName( (eProfilingStage)n ),
+                (unsigned long long)stats.callCount,
+                (unsigned long long)stats.totalNanoseconds,
+                (unsigned long long)stats.selfNanoseconds,
+                (unsigned long long)stats.byteCount,
+                (unsigned long long)stats.texelCount
+            );
+
+            dumpOut += lineBuf;
+        }
+
+        dumpOut += "}";
+    }
+    else
+    {
+        _snprintf( lineBuf, sizeof( lineBuf ),
+            "%-14s %10s %12s %12s %12s %12s %10s\n",
+            "stage", "calls", "total ms", "self ms", "KiB", "texels", "MTex/s"
+        );
+
+        dumpOut += lineBuf;
+
+        for ( unsigned int n = 0; n < PROFSTAGE_COUNT; n++ )
+        {
+            const profilingStageStats& stats = snap.stages[ n ];
+
+            if ( stats.callCount == 0 )
+                continue;
+
+            double totalMS = ( (double)stats.totalNanoseconds / 1000000.0 );
+            double selfMS = ( (double)stats.selfNanoseconds / 1000000.0 );
+
+            double texelRate = 0;
+
+            if ( stats.totalNanoseconds != 0 )
+            {
+                texelRate = ( (double)stats.texelCount * 1000.0 / (double)stats.totalNanoseconds );
+            }
+
+            _snprintf( lineBuf, sizeof( lineBuf ),
+                "%-14s %10llu %12.3f %12.3f %12llu %12llu %10.2f\n",
+                GetProfilingStageName( (eProfilingStage)n ),
+                (unsigned long long)stats.callCount,
+                totalMS, selfMS,
+                (unsigned long long)( stats.byteCount / 1024 ),
+                (unsigned long long)stats.texelCount,
+                texelRate
+            );
+
+            dumpOut += lineBuf;
+        }
+    }
+
+    return dumpOut;
+}
+
+void registerProfilingEnvironment( void )
+{
+    profilingEnvRegister.RegisterPlugin( engineFactory );
+}
+
+};
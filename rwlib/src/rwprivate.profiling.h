@@ -0,0 +1,51 @@
+// RenderWare private global include file about the stage profiler.
+
+#ifndef _RENDERWARE_PRIVATE_PROFILING_
+#define _RENDERWARE_PRIVATE_PROFILING_
+
+struct profilingThreadEnv;
+
+// Measures a processing stage for as long as this object is alive.
+// Does nothing if profiling has not been enabled on the engine.
+struct profilingScope
+{
+    profilingScope( Interface *engineInterface, eProfilingStage stage );
+    ~profilingScope( void );
+
+    inline void AddBytes( uint64 count )
+    {
+        this->byteCount += count;
+    }
+
+    inline void AddTexels( uint64 count )
+    {
+        this->texelCount += count;
+    }
+
+    // Counts the texels and bytes of every mipmap layer.
+    inline void AddPixelData( const pixelDataTraversal& pixelData )
+    {
+        for ( const pixelDataTraversal::mipmapResource& mipLayer : pixelData.mipmaps )
+        {
+            this->texelCount += (uint64)mipLayer.layerWidth * mipLayer.layerHeight;
+            this->byteCount += mipLayer.dataSize;
+        }
+    }
+
+    inline bool IsActive( void ) const
+    {
+        return ( this->threadEnv != NULL );
+    }
+
+private:
+    profilingThreadEnv *threadEnv;
+    profilingScope *parentScope;
+    eProfilingStage stage;
+
+    uint64 startTime;
+    uint64 childNanoseconds;
+    uint64 byteCount;
+    uint64 texelCount;
+};
+
+#endif //_RENDERWARE_PRIVATE_PROFILING_
@@ -210,9 +210,18 @@ void Interface::SerializeBlock( RwObject *objectToStore, BlockProvider& outputPr
 
 void Interface::Serialize( RwObject *objectToStore, Stream *outputStream )
 {
+    profilingScope profile( this, PROFSTAGE_SERIALIZE );
+
+    int64 startPos = ( profile.IsActive() ? outputStream->tell() : 0 );
+
     BlockProvider mainBlock( outputStream, RWBLOCKMODE_WRITE );
 
     this->SerializeBlock( objectToStore, mainBlock );
+
+    if ( profile.IsActive() )
+    {
+        profile.AddBytes( (uint64)( outputStream->tell() - startPos ) );
+    }
 }
 
 RwObject* Interface::DeserializeBlock( BlockProvider& inputProvider )
@@ -310,9 +319,20 @@ RwObject* Interface::DeserializeBlock( BlockProvider& inputProvider )
 
 RwObject* Interface::Deserialize( Stream *inputStream )
 {
+    profilingScope profile( this, PROFSTAGE_DESERIALIZE );
+
+    int64 startPos = ( profile.IsActive() ? inputStream->tell() : 0 );
+
     BlockProvider mainBlock( inputStream, RWBLOCKMODE_READ );
 
-    return this->DeserializeBlock( mainBlock );
+    RwObject *resultObj = this->DeserializeBlock( mainBlock );
+
+    if ( profile.IsActive() )
+    {
+        profile.AddBytes( (uint64)( inputStream->tell() - startPos ) );
+    }
+
+    return resultObj;
 }
 
 void registerSerializationPlugins( void )
@@ -154,47 +154,161 @@ struct FileStream : public Stream
 };
 
 // Memory stream.
+// If constructed over a user buffer then it is bound to the size of that buffer.
+// Else it allocates its own memory and grows while being written to.
 struct MemoryStream : public Stream
 {
     inline MemoryStream( Interface *engineInterface, void *construction_params ) : Stream( engineInterface, construction_params )
     {
-        return;
+        streamConstructionMemoryParam_t *memParam = (streamConstructionMemoryParam_t*)construction_params;
+
+        this->buf = NULL;
+        this->bufSize = 0;
+        this->dataSize = 0;
+        this->seekPos = 0;
+        this->ownsBuffer = true;
+
+        if ( memParam && memParam->buf != NULL )
+        {
+            this->buf = (char*)memParam->buf;
+            this->bufSize = memParam->bufSize;
+            this->dataSize = memParam->bufSize;
+            this->ownsBuffer = false;
+        }
     }
 
-    size_t read( void *out_buf, size_t readCount )
+    inline ~MemoryStream( void )
     {
-        return 0;
+        if ( this->ownsBuffer )
+        {
+            if ( void *memBuf = this->buf )
+            {
+                this->engineInterface->MemFree( memBuf );
+            }
+        }
     }
 
-    size_t write( const void *in_buf, size_t writeCount )
+    size_t read( void *out_buf, size_t readCount ) override
     {
-        return 0;
+        size_t seekPos = this->seekPos;
+
+        if ( seekPos >= this->dataSize )
+            return 0;
+
+        size_t actualReadCount = std::min( readCount, this->dataSize - seekPos );
+
+        memcpy( out_buf, this->buf + seekPos, actualReadCount );
+
+        this->seekPos += actualReadCount;
+
+        return actualReadCount;
     }
 
-    void skip( int64 skipCount )
+    size_t write( const void *in_buf, size_t writeCount ) override
     {
+        size_t seekPos = this->seekPos;
+
+        size_t reqSize = ( seekPos + writeCount );
+
+        if ( reqSize > this->bufSize )
+        {
+            if ( this->ownsBuffer )
+            {
+                // Grow geometrically so that many small writes stay cheap.
+                size_t newBufSize = std::max( reqSize, this->bufSize * 2 );
+
+                char *newBuf = (char*)this->engineInterface->MemAllocate( newBufSize );
+
+                if ( !newBuf )
+                {
+                    throw RwStreamException( "failed to grow memory stream" );
+                }
+
+                if ( char *oldBuf = this->buf )
+                {
+                    memcpy( newBuf, oldBuf, this->dataSize );
+
+                    this->engineInterface->MemFree( oldBuf );
+                }
+
+                this->buf = newBuf;
+                this->bufSize = newBufSize;
+            }
+            else
+            {
+                if ( seekPos >= this->bufSize )
+                    return 0;
+
+                writeCount = ( this->bufSize - seekPos );
+            }
+        }
+
+        // Skipped-over memory has to be defined.
+        if ( seekPos > this->dataSize )
+        {
+            memset( this->buf + this->dataSize, 0, seekPos - this->dataSize );
+        }
+
+        memcpy( this->buf + seekPos, in_buf, writeCount );
+
+        this->seekPos += writeCount;
+
+        if ( this->seekPos > this->dataSize )
+        {
+            this->dataSize = this->seekPos;
+        }
 
+        return writeCount;
     }
 
-    int64 tell( void ) const
+    void skip( int64 skipCount ) override
     {
-        return 0;
+        this->seek( skipCount, RWSEEK_CUR );
     }
 
-    void seek( int64 seek_off, eSeekMode seek_mode )
+    int64 tell( void ) const override
+    {
+        return (int64)this->seekPos;
+    }
+
+    void seek( int64 seek_off, eSeekMode seek_mode ) override
     {
+        int64 basePos = 0;
+
+        if ( seek_mode == RWSEEK_CUR )
+        {
+            basePos = (int64)this->seekPos;
+        }
+        else if ( seek_mode == RWSEEK_END )
+        {
+            basePos = (int64)this->dataSize;
+        }
+
+        int64 newPos = ( basePos + seek_off );
+
+        if ( newPos < 0 )
+        {
+            throw RwStreamException( "attempt to seek before the beginning of a memory stream" );
+        }
 
+        this->seekPos = (size_t)newPos;
     }
 
-    int64 size( void ) const
+    int64 size( void ) const override
     {
-        return 0;
+        return (int64)this->dataSize;
     }
 
-    bool supportsSize( void ) const
+    bool supportsSize( void ) const override
     {
         return true;
     }
+
+    char *buf;
+    size_t bufSize;
+    size_t dataSize;
+    size_t seekPos;
+    bool ownsBuffer;
 };
 
 // Custom stream.
@@ -578,7 +692,25 @@ Stream* Interface::CreateStream( eBuiltinStreamType streamType, eStreamMode stre
         }
         else if ( streamType == RWSTREAMTYPE_MEMORY )
         {
+            if ( RwTypeSystem::typeInfoBase *memoryStreamTypeInfo = streamSysEnv->memoryStreamTypeInfo )
+            {
+                // Without parameters we create a stream that owns its memory.
+                streamConstructionMemoryParam_t ownedParam( NULL, 0 );
+
+                streamConstructionMemoryParam_t *memParam = &ownedParam;
+
+                if ( param != NULL && param->dwSize >= sizeof( streamConstructionMemoryParam_t ) )
+                {
+                    memParam = (streamConstructionMemoryParam_t*)param;
+                }
 
+                GenericRTTI *rttiObj = engineInterface->typeSystem.Construct( engineInterface, memoryStreamTypeInfo, memParam );
+
+                if ( rttiObj )
+                {
+                    outputStream = (MemoryStream*)RwTypeSystem::GetObjectFromTypeStruct( rttiObj );
+                }
+            }
         }
         else if ( streamType == RWSTREAMTYPE_CUSTOM )
         {
@@ -2,6 +2,16 @@
 
 #include "rwthreading.hxx"
 
+#include "rwthreading.parallel.hxx"
+
+#include "rwconf.hxx"
+
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
 using namespace NativeExecutive;
 
 namespace rw
@@ -329,6 +339,326 @@ void PurgeActiveThreadingObjects( EngineInterface *engineInterface )
     threadEnv->nativeMan->PurgeActiveObjects();
 }
 
+// Parallel work distribution.
+uint32 GetParallelWorkerCount( EngineInterface *engineInterface )
+{
+    uint32 workerCount = GetConstEnvironmentConfigBlock( engineInterface ).GetWorkerThreadCount();
+
+    if ( workerCount == 0 )
+    {
+        workerCount = std::thread::hardware_concurrency();
+
+        if ( workerCount == 0 )
+        {
+            workerCount = 1;
+        }
+    }
+
+    return workerCount;
+}
+
+struct parallelWorkContext
+{
+    EngineInterface *engineInterface;
+    const rwConfigBlock *parentCfg;
+
+    parallelWorkItemCallback_t cb;
+    void *ud;
+
+    size_t itemCount;
+    std::atomic <size_t> nextItem;
+
+    std::atomic <bool> hasFailed;
+    std::exception_ptr failure;
+
+    // Termination requests only reach the thread that gave us the work, so the
+    // workers have to look at it themselves.
+    CExecThread *ownerThread;
+
+    inline bool IsOwnerTerminating( void ) const
+    {
+        CExecThread *ownerThread = this->ownerThread;
+
+        return ( ownerThread != NULL && ownerThread->GetStatus() == THREAD_TERMINATING );
+    }
+
+    inline void ProcessItems( void )
+    {
+        while ( true )
+        {
+            size_t itemIndex = this->nextItem.fetch_add( 1 );
+
+            if ( itemIndex >= this->itemCount )
+                break;
+
+            // Stop between items if the work was cancelled.
+            if ( this->IsOwnerTerminating() )
+            {
+                this->nextItem.store( this->itemCount );
+                break;
+            }
+
+            try
+            {
+                this->cb( this->ud, itemIndex );
+            }
+            catch( ... )
+            {
+                // Only the first failure is reported.
+                bool expected = false;
+
+                if ( this->hasFailed.compare_exchange_strong( expected, true ) )
+                {
+                    this->failure = std::current_exception();
+                }
+
+                // Skip all remaining items.
+                this->nextItem.store( this->itemCount );
+                break;
+            }
+        }
+    }
+};
+
+// Worker threads are kept alive across ParallelForEach calls, so that kernels which
+// are called per texture (or per row band of a texture) do not pay for thread creation.
+// The pool runs one job at a time; calls that happen while the pool is busy (nested calls
+// from inside of a work item, or calls from other threads) just process their items inline.
+struct parallelWorkerPool
+{
+    EngineInterface *engineInterface;
+    CExecutiveManager *nativeMan;
+
+    std::mutex lock;
+    std::condition_variable workAvailable;
+    std::condition_variable workFinished;
+
+    std::vector <CExecThread*> workers;
+
+    bool isTerminating;
+
+    // Current job.
+    parallelWorkContext *curJob;
+    uint64 jobGeneration;
+    uint32 jobHelperCount;      // how many workers may join the current job.
+    uint32 joinedHelpers;
+    uint32 activeHelpers;       // workers still processing items of the current job.
+
+    inline bool IsWorkerThread( CExecThread *theThread ) const
+    {
+        return ( std::find( this->workers.begin(), this->workers.end(), theThread ) != this->workers.end() );
+    }
+
+    void WorkerMain( void )
+    {
+        uint64 lastGeneration = 0;
+
+        std::unique_lock <std::mutex> ctxLock( this->lock );
+
+        while ( true )
+        {
+            this->workAvailable.wait( ctxLock,
+                [&]
+                {
+                    return ( this->isTerminating ||
+                             ( this->curJob != NULL && this->jobGeneration != lastGeneration && this->joinedHelpers < this->jobHelperCount ) );
+                }
+            );
+
+            if ( this->isTerminating )
+                break;
+
+            parallelWorkContext *job = this->curJob;
+
+            lastGeneration = this->jobGeneration;
+
+            this->joinedHelpers++;
+            this->activeHelpers++;
+
+            ctxLock.unlock();
+
+            // Run under the same configuration as the thread that gave us the work.
+            try
+            {
+                InheritThreadedRuntimeConfig( job->engineInterface, *job->parentCfg );
+            }
+            catch( ... )
+            {
+                // Without the configuration we just leave the items to the other workers.
+                ctxLock.lock();
+
+                if ( --this->activeHelpers == 0 )
+                {
+                    this->workFinished.notify_all();
+                }
+                continue;
+            }
+
+            job->ProcessItems();
+
+            ctxLock.lock();
+
+            if ( --this->activeHelpers == 0 )
+            {
+                this->workFinished.notify_all();
+            }
+        }
+    }
+};
+
+static void __cdecl parallel_worker_entry( thread_t threadHandle, Interface *intf, void *ud )
+{
+    parallelWorkerPool *workerPool = (parallelWorkerPool*)ud;
+
+    workerPool->WorkerMain();
+}
+
+parallelWorkerPool* CreateParallelWorkerPool( threadingEnvironment *threadEnv, Interface *engineInterface )
+{
+    parallelWorkerPool *workerPool = new parallelWorkerPool;
+
+    workerPool->engineInterface = (EngineInterface*)engineInterface;
+    workerPool->nativeMan = threadEnv->nativeMan;
+    workerPool->isTerminating = false;
+    workerPool->curJob = NULL;
+    workerPool->jobGeneration = 0;
+    workerPool->jobHelperCount = 0;
+    workerPool->joinedHelpers = 0;
+    workerPool->activeHelpers = 0;
+
+    // Threads are spawned on demand by the first parallel job.
+    return workerPool;
+}
+
+void DestroyParallelWorkerPool( threadingEnvironment *threadEnv, parallelWorkerPool *workerPool )
+{
+    {
+        std::unique_lock <std::mutex> ctxLock( workerPool->lock );
+
+        workerPool->isTerminating = true;
+    }
+
+    workerPool->workAvailable.notify_all();
+
+    CExecutiveManager *nativeMan = workerPool->nativeMan;
+
+    for ( CExecThread *workerThread : workerPool->workers )
+    {
+        nativeMan->JoinThread( workerThread );
+        nativeMan->CloseThread( workerThread );
+    }
+
+    delete workerPool;
+}
+
+void ParallelForEachNative( EngineInterface *engineInterface, size_t itemCount, parallelWorkItemCallback_t cb, void *ud, uint32 maxWorkers )
+{
+    if ( itemCount == 0 )
+        return;
+
+    uint32 workerCount = GetParallelWorkerCount( engineInterface );
+
+    if ( maxWorkers != 0 && workerCount > maxWorkers )
+    {
+        workerCount = maxWorkers;
+    }
+
+    if ( workerCount > itemCount )
+    {
+        workerCount = (uint32)itemCount;
+    }
+
+    threadingEnvironment *threadEnv = GetThreadingEnv( engineInterface );
+
+    parallelWorkerPool *workerPool = ( threadEnv ? threadEnv->workerPool : NULL );
+
+    bool runsOnPool = false;
+
+    parallelWorkContext ctx;
+    ctx.engineInterface = engineInterface;
+    ctx.parentCfg = &GetConstEnvironmentConfigBlock( engineInterface );
+    ctx.cb = cb;
+    ctx.ud = ud;
+    ctx.itemCount = itemCount;
+    ctx.nextItem = 0;
+    ctx.hasFailed = false;
+    ctx.ownerThread = ( threadEnv && threadEnv->nativeMan ? threadEnv->nativeMan->GetCurrentThread() : NULL );
+
+    if ( workerCount > 1 && workerPool != NULL )
+    {
+        CExecThread *curThread = workerPool->nativeMan->GetCurrentThread();
+
+        std::unique_lock <std::mutex> ctxLock( workerPool->lock );
+
+        // Nested calls and calls while the pool is busy run inline.
+        if ( workerPool->curJob == NULL && workerPool->IsWorkerThread( curThread ) == false )
+        {
+            // The calling thread is a worker aswell, so we need one thread less.
+            uint32 helperCount = ( workerCount - 1 );
+
+            while ( workerPool->workers.size() < helperCount )
+            {
+                thread_t helperThread = MakeThread( engineInterface, parallel_worker_entry, workerPool );
+
+                if ( !helperThread )
+                {
+                    // We simply make do with less threads.
+                    break;
+                }
+
+                workerPool->workers.push_back( (CExecThread*)helperThread );
+
+                ResumeThread( engineInterface, helperThread );
+            }
+
+            if ( workerPool->workers.size() != 0 )
+            {
+                workerPool->curJob = &ctx;
+                workerPool->jobGeneration++;
+                workerPool->jobHelperCount = helperCount;
+                workerPool->joinedHelpers = 0;
+
+                runsOnPool = true;
+            }
+        }
+    }
+
+    if ( runsOnPool )
+    {
+        workerPool->workAvailable.notify_all();
+    }
+
+    ctx.ProcessItems();
+
+    if ( runsOnPool )
+    {
+        std::unique_lock <std::mutex> ctxLock( workerPool->lock );
+
+        // No more workers may join, then wait for the ones that did.
+        workerPool->curJob = NULL;
+
+        workerPool->workFinished.wait( ctxLock, [&] { return ( workerPool->activeHelpers == 0 ); } );
+    }
+
+    if ( ctx.hasFailed )
+    {
+        std::rethrow_exception( ctx.failure );
+    }
+
+    // If we were cancelled, the remaining items were skipped, so terminate the caller now.
+    if ( ctx.IsOwnerTerminating() )
+    {
+        threadEnv->nativeMan->CheckHazardCondition();
+    }
+}
+
+void ParallelForEachItem( Interface *intf, size_t itemCount, parallelWorkItemCallback_t cb, void *ud, uint32 maxWorkers )
+{
+    EngineInterface *engineInterface = (EngineInterface*)intf;
+
+    ParallelForEachNative( engineInterface, itemCount, cb, ud, maxWorkers );
+}
+
 void* GetThreadingNativeManager( Interface *intf )
 {
     EngineInterface *engineInterface = (EngineInterface*)intf;
@@ -7,15 +7,33 @@
 namespace rw
 {
 
+struct parallelWorkerPool;
+
+struct threadingEnvironment;
+
+// Persistent worker threads of the parallel work distribution (see rwthreading.cpp).
+parallelWorkerPool* CreateParallelWorkerPool( threadingEnvironment *threadEnv, Interface *engineInterface );
+void DestroyParallelWorkerPool( threadingEnvironment *threadEnv, parallelWorkerPool *workerPool );
+
 struct threadingEnvironment
 {
     inline void Initialize( Interface *engineInterface )
     {
         this->nativeMan = NativeExecutive::CExecutiveManager::Create();
+
+        this->workerPool = CreateParallelWorkerPool( this, engineInterface );
     }
 
     inline void Shutdown( Interface *engineInterface )
     {
+        // The worker threads have to be gone before the executive manager.
+        if ( parallelWorkerPool *workerPool = this->workerPool )
+        {
+            DestroyParallelWorkerPool( this, workerPool );
+
+            this->workerPool = NULL;
+        }
+
         if ( NativeExecutive::CExecutiveManager *nativeMan = this->nativeMan )
         {
             NativeExecutive::CExecutiveManager::Delete( nativeMan );
@@ -25,6 +43,7 @@ struct threadingEnvironment
     }
 
     NativeExecutive::CExecutiveManager *nativeMan;   // (optional) NativeExecutive library handle.
+    parallelWorkerPool *workerPool;                  // threads that run ParallelForEach work.
 };
 
 typedef PluginDependantStructRegister <threadingEnvironment, RwInterfaceFactory_t> threadingEnvRegister_t;
@@ -0,0 +1,68 @@
+// RenderWare parallel work distribution helpers.
+// Algorithms that can split their work into independent items (pixel blocks, rows, textures, ...)
+// use these to spread the items across the worker threads of the engine.
+
+#ifndef _RENDERWARE_PARALLEL_WORK_
+#define _RENDERWARE_PARALLEL_WORK_
+
+#include <type_traits>
+
+namespace rw
+{
+
+// Returns the amount of threads that should process parallel work, including the calling thread.
+// This is decided by the runtime configuration (Interface::SetWorkerThreadCount).
+uint32 GetParallelWorkerCount( EngineInterface *engineInterface );
+
+// Calls the callback for every item index in [0, itemCount) on the worker threads.
+// Items are fetched dynamically, so uneven work is balanced automatically.
+// The calling thread takes part in the work and returns once every item has been processed.
+// If any item throws an exception then the remaining items are skipped and the exception
+// is rethrown on the calling thread.
+// The helpers come from a persistent thread pool. Calls made while the pool is busy,
+// like nested calls from inside of a work item, process their items on the calling thread.
+void ParallelForEachNative( EngineInterface *engineInterface, size_t itemCount, parallelWorkItemCallback_t cb, void *ud, uint32 maxWorkers = 0 );
+
+template <typename callbackType>
+inline void ParallelForEach( EngineInterface *engineInterface, size_t itemCount, callbackType&& cb, uint32 maxWorkers = 0 )
+{
+    typedef typename std::remove_reference <callbackType>::type cbType;
+
+    struct dispatcher
+    {
+        static void ProcessItem( void *ud, size_t itemIndex )
+        {
+            (*(cbType*)ud)( itemIndex );
+        }
+    };
+
+    ParallelForEachNative( engineInterface, itemCount, dispatcher::ProcessItem, (void*)&cb, maxWorkers );
+}
+
+// Splits a range of rows into bands for parallel processing.
+// It is good to have a few more bands than workers so that the load is balanced.
+inline uint32 GetParallelBandHeight( uint32 height, uint32 workerCount, uint32 rowGranularity = 1 )
+{
+    if ( workerCount <= 1 || height == 0 )
+    {
+        return height;
+    }
+
+    uint32 bandCount = ( workerCount * 4 );
+
+    uint32 bandHeight = ( ( height + bandCount - 1 ) / bandCount );
+
+    // Round up to the granularity so that blocks are not split.
+    bandHeight = ( ( bandHeight + rowGranularity - 1 ) / rowGranularity ) * rowGranularity;
+
+    if ( bandHeight == 0 )
+    {
+        bandHeight = rowGranularity;
+    }
+
+    return bandHeight;
+}
+
+};
+
+#endif //_RENDERWARE_PARALLEL_WORK_
@@ -0,0 +1,751 @@
+// ATI texture compression (ATC) block codec.
+// Decodes and encodes the ATC_RGB_AMD, ATC_RGBA_EXPLICIT_ALPHA_AMD and ATC_RGBA_INTERPOLATED_ALPHA_AMD
+// formats. Every 4x4 texel block is independent, so whole block rows are spread across the worker threads.
+
+#ifndef _RENDERWARE_ATC_CODEC_
+#define _RENDERWARE_ATC_CODEC_
+
+#include "pixelformat.hxx"
+
+#include "rwthreading.parallel.hxx"
+
+#include <emmintrin.h>
+
+namespace rw
+{
+
+// Texel layout of decoded blocks, which is RASTER_8888 with COLOR_BGRA.
+struct atcColor
+{
+    uint8 blue;
+    uint8 green;
+    uint8 red;
+    uint8 alpha;
+};
+static_assert( sizeof( atcColor ) == 4, "ATC color must be 4 bytes in size!" );
+
+#pragma pack(push, 1)
+struct atc_rgb_block
+{
+    // Stored as RGB555, the most significant bit selects the color interpolation method.
+    endian::little_endian <uint16> color0;
+    // Stored as RGB565.
+    endian::little_endian <uint16> color1;
+
+    // 2bit color indices, row by row.
+    endian::little_endian <uint32> indexList;
+};
+static_assert( sizeof( atc_rgb_block ) == 8, "ATC RGB block must be 8 bytes in size!" );
+
+struct atc_explicit_alpha_block
+{
+    // 4bit alpha values, row by row.
+    endian::little_endian <uint64> alphaList;
+
+    atc_rgb_block colorBlock;
+};
+static_assert( sizeof( atc_explicit_alpha_block ) == 16, "ATC explicit alpha block must be 16 bytes in size!" );
+
+struct atc_interpolated_alpha_block
+{
+    uint8 alpha0;
+    uint8 alpha1;
+
+    // 3bit alpha indices, row by row.
+    uint8 alphaIndices[6];
+
+    atc_rgb_block colorBlock;
+};
+static_assert( sizeof( atc_interpolated_alpha_block ) == 16, "ATC interpolated alpha block must be 16 bytes in size!" );
+#pragma pack(pop)
+
+#define ATC_INTERP_METHOD_BIT       0x8000
+
+AINLINE uint8 atcExpand5( uint32 val )
+{
+    return (uint8)( ( val << 3 ) | ( val >> 2 ) );
+}
+
+AINLINE uint8 atcExpand6( uint32 val )
+{
+    return (uint8)( ( val << 2 ) | ( val >> 4 ) );
+}
+
+AINLINE uint32 atcQuantize( int32 val, uint32 maxVal )
+{
+    if ( val <= 0 )
+        return 0;
+
+    if ( val >= 255 )
+        return maxVal;
+
+    return (uint32)( ( val * (int32)maxVal + 127 ) / 255 );
+}
+
+AINLINE void atcUnpackColor0( uint32 color0, int32 rgbOut[3] )
+{
+    rgbOut[0] = atcExpand5( ( color0 >> 10 ) & 0x1F );
+    rgbOut[1] = atcExpand5( ( color0 >> 5 ) & 0x1F );
+    rgbOut[2] = atcExpand5( color0 & 0x1F );
+}
+
+AINLINE void atcUnpackColor1( uint32 color1, int32 rgbOut[3] )
+{
+    rgbOut[0] = atcExpand5( ( color1 >> 11 ) & 0x1F );
+    rgbOut[1] = atcExpand6( ( color1 >> 5 ) & 0x3F );
+    rgbOut[2] = atcExpand5( color1 & 0x1F );
+}
+
+AINLINE uint32 atcPackColor0( const int32 rgb[3] )
+{
+    return ( ( atcQuantize( rgb[0], 31 ) << 10 ) | ( atcQuantize( rgb[1], 31 ) << 5 ) | atcQuantize( rgb[2], 31 ) );
+}
+
+AINLINE uint32 atcPackColor1( const int32 rgb[3] )
+{
+    return ( ( atcQuantize( rgb[0], 31 ) << 11 ) | ( atcQuantize( rgb[1], 63 ) << 5 ) | atcQuantize( rgb[2], 31 ) );
+}
+
+// Calculates the four colors that the indices of a color block select from, as red, green and blue.
+inline void getATCBlockPalette( uint32 color0, uint32 color1, int32 paletteOut[4][3] )
+{
+    int32 first[3];
+    int32 second[3];
+
+    atcUnpackColor0( color0, first );
+    atcUnpackColor1( color1, second );
+
+    if ( ( color0 & ATC_INTERP_METHOD_BIT ) == 0 )
+    {
+        for ( uint32 c = 0; c < 3; c++ )
+        {
+            paletteOut[0][c] = first[c];
+            paletteOut[1][c] = ( 5 * first[c] + 3 * second[c] ) / 8;
+            paletteOut[2][c] = ( 3 * first[c] + 5 * second[c] ) / 8;
+            paletteOut[3][c] = second[c];
+        }
+    }
+    else
+    {
+        for ( uint32 c = 0; c < 3; c++ )
+        {
+            paletteOut[0][c] = 0;
+            paletteOut[1][c] = std::max( 0, first[c] - second[c] / 4 );
+            paletteOut[2][c] = first[c];
+            paletteOut[3][c] = second[c];
+        }
+    }
+}
+
+AINLINE uint8 getATCInterpolatedAlpha( uint32 alpha0, uint32 alpha1, uint32 alphaIndex )
+{
+    if ( alphaIndex == 0 )
+        return alpha0;
+
+    if ( alphaIndex == 1 )
+        return alpha1;
+
+    if ( alpha0 > alpha1 )
+    {
+        return (uint8)( ( ( 8 - alphaIndex ) * alpha0 + ( alphaIndex - 1 ) * alpha1 ) / 7 );
+    }
+
+    if ( alphaIndex == 6 )
+        return 0;
+
+    if ( alphaIndex == 7 )
+        return 255;
+
+    return (uint8)( ( ( 6 - alphaIndex ) * alpha0 + ( alphaIndex - 1 ) * alpha1 ) / 5 );
+}
+
+AINLINE uint64 getATCInterpolatedAlphaIndexList( const uint8 alphaIndices[6] )
+{
+    uint64 indexList = 0;
+
+    for ( uint32 n = 0; n < 6; n++ )
+    {
+        indexList |= ( (uint64)alphaIndices[n] << ( n * 8 ) );
+    }
+
+    return indexList;
+}
+
+// Decodes a single block into 16 BGRA texels, row by row.
+// Each row is selected out of the block palette with SSE2 masks.
+inline void decodeATCBlock( eATCInternalFormat internalFormat, const void *blockData, atcColor texelsOut[16] )
+{
+    const atc_rgb_block *colorBlock;
+
+    uint8 alphaValues[16];
+    bool hasAlpha = true;
+
+    if ( internalFormat == ATC_RGBA_EXPLICIT_ALPHA_AMD )
+    {
+        const atc_explicit_alpha_block *alphaBlock = (const atc_explicit_alpha_block*)blockData;
+
+        uint64 alphaList = alphaBlock->alphaList;
+
+        for ( uint32 n = 0; n < 16; n++ )
+        {
+            alphaValues[n] = (uint8)( ( ( alphaList >> ( n * 4 ) ) & 0xF ) * 17 );
+        }
+
+        colorBlock = &alphaBlock->colorBlock;
+    }
+    else if ( internalFormat == ATC_RGBA_INTERPOLATED_ALPHA_AMD )
+    {
+        const atc_interpolated_alpha_block *alphaBlock = (const atc_interpolated_alpha_block*)blockData;
+
+        uint32 alpha0 = alphaBlock->alpha0;
+        uint32 alpha1 = alphaBlock->alpha1;
+
+        uint64 indexList = getATCInterpolatedAlphaIndexList( alphaBlock->alphaIndices );
+
+        for ( uint32 n = 0; n < 16; n++ )
+        {
+            alphaValues[n] = getATCInterpolatedAlpha( alpha0, alpha1, (uint32)( ( indexList >> ( n * 3 ) ) & 0x7 ) );
+        }
+
+        colorBlock = &alphaBlock->colorBlock;
+    }
+    else
+    {
+        hasAlpha = false;
+
+        colorBlock = (const atc_rgb_block*)blockData;
+    }
+
+    int32 palette[4][3];
+
+    getATCBlockPalette( colorBlock->color0, colorBlock->color1, palette );
+
+    atcColor packedPalette[4];
+
+    for ( uint32 n = 0; n < 4; n++ )
+    {
+        packedPalette[n].red = (uint8)palette[n][0];
+        packedPalette[n].green = (uint8)palette[n][1];
+        packedPalette[n].blue = (uint8)palette[n][2];
+        packedPalette[n].alpha = 255;
+    }
+
+    __m128i paletteVec = _mm_loadu_si128( (const __m128i*)packedPalette );
+
+    __m128i paletteColor0 = _mm_shuffle_epi32( paletteVec, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+    __m128i paletteColor1 = _mm_shuffle_epi32( paletteVec, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+    __m128i paletteColor2 = _mm_shuffle_epi32( paletteVec, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+    __m128i paletteColor3 = _mm_shuffle_epi32( paletteVec, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+
+    __m128i colorMask = _mm_set1_epi32( 0x00FFFFFF );
+
+    uint32 indexList = colorBlock->indexList;
+
+    for ( uint32 row = 0; row < 4; row++ )
+    {
+        uint32 rowIndices = ( indexList >> ( row * 8 ) );
+
+        __m128i indexVec = _mm_setr_epi32(
+            rowIndices & 0x3, ( rowIndices >> 2 ) & 0x3, ( rowIndices >> 4 ) & 0x3, ( rowIndices >> 6 ) & 0x3
+        );
+
+        __m128i rowColors =
+            _mm_or_si128(
+                _mm_or_si128(
+                    _mm_and_si128( _mm_cmpeq_epi32( indexVec, _mm_setzero_si128() ), paletteColor0 ),
+                    _mm_and_si128( _mm_cmpeq_epi32( indexVec, _mm_set1_epi32( 1 ) ), paletteColor1 )
+                ),
+                _mm_or_si128(
+                    _mm_and_si128( _mm_cmpeq_epi32( indexVec, _mm_set1_epi32( 2 ) ), paletteColor2 ),
+                    _mm_and_si128( _mm_cmpeq_epi32( indexVec, _mm_set1_epi32( 3 ) ), paletteColor3 )
+                )
+            );
+
+        if ( hasAlpha )
+        {
+            const uint8 *rowAlpha = ( alphaValues + row * 4 );
+
+            __m128i alphaVec = _mm_setr_epi32(
+                (int)( (uint32)rowAlpha[0] << 24 ), (int)( (uint32)rowAlpha[1] << 24 ),
+                (int)( (uint32)rowAlpha[2] << 24 ), (int)( (uint32)rowAlpha[3] << 24 )
+            );
+
+            rowColors = _mm_or_si128( _mm_and_si128( rowColors, colorMask ), alphaVec );
+        }
+
+        _mm_storeu_si128( (__m128i*)( texelsOut + row * 4 ), rowColors );
+    }
+}
+
+// Decodes a compressed ATC surface into BGRA texels.
+// surfWidth and surfHeight are the dimensions of the compressed surface, while only
+// the layerWidth x layerHeight area is written into the destination.
+inline void decompressATCTexels(
+    Interface *engineInterface, eATCInternalFormat internalFormat,
+    uint32 surfWidth, uint32 surfHeight, const void *srcTexels, uint32 srcDataSize,
+    uint32 layerWidth, uint32 layerHeight, void *dstTexels, uint32 dstRowSize
+)
+{
+    uint32 blockSize = getATCCompressionBlockSize( internalFormat );
+
+    uint32 widthBlocks = ALIGN_SIZE( surfWidth, 4u ) / 4;
+    uint32 heightBlocks = ALIGN_SIZE( surfHeight, 4u ) / 4;
+
+    if ( srcDataSize < widthBlocks * heightBlocks * blockSize )
+    {
+        throw RwException( "ATC mipmap data is too small for its dimensions" );
+    }
+
+    uint32 processBlocksX = std::min( widthBlocks, ALIGN_SIZE( layerWidth, 4u ) / 4 );
+    uint32 processBlocksY = std::min( heightBlocks, ALIGN_SIZE( layerHeight, 4u ) / 4 );
+
+    ParallelForEach( (EngineInterface*)engineInterface, processBlocksY,
+        [&]( size_t block_y )
+        {
+            const uint8 *srcBlock = (const uint8*)srcTexels + block_y * widthBlocks * blockSize;
+
+            uint32 y = (uint32)( block_y * 4 );
+
+            uint32 rowCount = std::min( 4u, layerHeight - y );
+
+            for ( uint32 block_x = 0; block_x < processBlocksX; block_x++, srcBlock += blockSize )
+            {
+                atcColor decoded[16];
+
+                decodeATCBlock( internalFormat, srcBlock, decoded );
+
+                uint32 x = ( block_x * 4 );
+
+                uint32 columnCount = std::min( 4u, layerWidth - x );
+
+                for ( uint32 row = 0; row < rowCount; row++ )
+                {
+                    atcColor *dstRow = (atcColor*)getTexelDataRow( dstTexels, dstRowSize, y + row );
+
+                    memcpy( dstRow + x, decoded + row * 4, columnCount * sizeof( atcColor ) );
+                }
+            }
+        }
+    );
+}
+
+// Finds the color endpoints of a block along its principal axis.
+inline void findATCColorEndpoints( const int32 colors[16][3], float minOut[3], float maxOut[3] )
+{
+    float mean[3] = { 0, 0, 0 };
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        for ( uint32 c = 0; c < 3; c++ )
+        {
+            mean[c] += (float)colors[n][c];
+        }
+    }
+
+    for ( uint32 c = 0; c < 3; c++ )
+    {
+        mean[c] /= 16.0f;
+    }
+
+    // Covariance of the block colors.
+    float cov[6] = { 0, 0, 0, 0, 0, 0 };
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        float r = ( colors[n][0] - mean[0] );
+        float g = ( colors[n][1] - mean[1] );
+        float b = ( colors[n][2] - mean[2] );
+
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    // Power iteration towards the principal axis.
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+
+    for ( uint32 iter = 0; iter < 8; iter++ )
+    {
+        float r = ( axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2] );
+        float g = ( axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4] );
+        float b = ( axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5] );
+
+        float maxComponent = std::max( fabsf( r ), std::max( fabsf( g ), fabsf( b ) ) );
+
+        if ( maxComponent < 1e-6f )
+            break;
+
+        axis[0] = ( r / maxComponent );
+        axis[1] = ( g / maxComponent );
+        axis[2] = ( b / maxComponent );
+    }
+
+    float minProj = 0;
+    float maxProj = 0;
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        float proj =
+            ( ( colors[n][0] - mean[0] ) * axis[0] +
+              ( colors[n][1] - mean[1] ) * axis[1] +
+              ( colors[n][2] - mean[2] ) * axis[2] );
+
+        if ( n == 0 || proj < minProj )
+        {
+            minProj = proj;
+        }
+
+        if ( n == 0 || proj > maxProj )
+        {
+            maxProj = proj;
+        }
+    }
+
+    float axisLenSq = ( axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] );
+
+    if ( axisLenSq < 1e-6f )
+    {
+        axisLenSq = 1.0f;
+    }
+
+    for ( uint32 c = 0; c < 3; c++ )
+    {
+        minOut[c] = mean[c] + axis[c] * ( minProj / axisLenSq );
+        maxOut[c] = mean[c] + axis[c] * ( maxProj / axisLenSq );
+    }
+}
+
+// Picks the best palette entry for every texel and returns the summed squared error.
+inline uint32 fitATCColorIndices( const int32 colors[16][3], uint32 color0, uint32 color1, uint32& indexListOut )
+{
+    int32 palette[4][3];
+
+    getATCBlockPalette( color0, color1, palette );
+
+    uint32 totalError = 0;
+    uint32 indexList = 0;
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        uint32 bestIndex = 0;
+        uint32 bestError = 0xFFFFFFFF;
+
+        for ( uint32 p = 0; p < 4; p++ )
+        {
+            int32 dr = ( colors[n][0] - palette[p][0] );
+            int32 dg = ( colors[n][1] - palette[p][1] );
+            int32 db = ( colors[n][2] - palette[p][2] );
+
+            uint32 error = (uint32)( dr * dr + dg * dg + db * db );
+
+            if ( error < bestError )
+            {
+                bestError = error;
+                bestIndex = p;
+            }
+        }
+
+        indexList |= ( bestIndex << ( n * 2 ) );
+        totalError += bestError;
+    }
+
+    indexListOut = indexList;
+
+    return totalError;
+}
+
+// Solves the endpoints that best fit the given interpolation method indices in the least squares sense.
+inline bool refineATCColorEndpoints( const int32 colors[16][3], uint32 indexList, int32 firstOut[3], int32 secondOut[3] )
+{
+    // Weights of color0 for each index of the interpolation method.
+    static const float weights[4] = { 1.0f, 5.0f / 8.0f, 3.0f / 8.0f, 0.0f };
+
+    float aa = 0, ab = 0, bb = 0;
+    float ax[3] = { 0, 0, 0 };
+    float bx[3] = { 0, 0, 0 };
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        float a = weights[ ( indexList >> ( n * 2 ) ) & 0x3 ];
+        float b = ( 1.0f - a );
+
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+
+        for ( uint32 c = 0; c < 3; c++ )
+        {
+            ax[c] += a * colors[n][c];
+            bx[c] += b * colors[n][c];
+        }
+    }
+
+    float det = ( aa * bb - ab * ab );
+
+    if ( fabsf( det ) < 1e-6f )
+        return false;
+
+    float invDet = ( 1.0f / det );
+
+    for ( uint32 c = 0; c < 3; c++ )
+    {
+        firstOut[c] = (int32)( ( ax[c] * bb - bx[c] * ab ) * invDet + 0.5f );
+        secondOut[c] = (int32)( ( bx[c] * aa - ax[c] * ab ) * invDet + 0.5f );
+    }
+
+    return true;
+}
+
+inline void encodeATCColorBlock( const int32 colors[16][3], atc_rgb_block& blockOut )
+{
+    float minColor[3];
+    float maxColor[3];
+
+    findATCColorEndpoints( colors, minColor, maxColor );
+
+    int32 low[3];
+    int32 high[3];
+
+    for ( uint32 c = 0; c < 3; c++ )
+    {
+        low[c] = (int32)( minColor[c] + 0.5f );
+        high[c] = (int32)( maxColor[c] + 0.5f );
+    }
+
+    uint32 bestColor0 = 0;
+    uint32 bestColor1 = 0;
+    uint32 bestIndexList = 0;
+    uint32 bestError = 0xFFFFFFFF;
+
+    auto tryEndpoints = [&]( uint32 color0, uint32 color1 )
+    {
+        uint32 indexList;
+
+        uint32 error = fitATCColorIndices( colors, color0, color1, indexList );
+
+        if ( error < bestError )
+        {
+            bestError = error;
+            bestColor0 = color0;
+            bestColor1 = color1;
+            bestIndexList = indexList;
+        }
+    };
+
+    // color0 has less precision than color1, so we try both directions.
+    tryEndpoints( atcPackColor0( low ), atcPackColor1( high ) );
+    tryEndpoints( atcPackColor0( high ), atcPackColor1( low ) );
+
+    // Improve the interpolated endpoints based on the chosen indices.
+    if ( bestError != 0 )
+    {
+        int32 first[3];
+        int32 second[3];
+
+        if ( refineATCColorEndpoints( colors, bestIndexList, first, second ) )
+        {
+            tryEndpoints( atcPackColor0( first ), atcPackColor1( second ) );
+        }
+    }
+
+    // Dark blocks can profit from the black entry of the second method.
+    if ( bestError != 0 )
+    {
+        tryEndpoints( atcPackColor0( low ) | ATC_INTERP_METHOD_BIT, atcPackColor1( high ) );
+    }
+
+    blockOut.color0 = (uint16)bestColor0;
+    blockOut.color1 = (uint16)bestColor1;
+    blockOut.indexList = bestIndexList;
+}
+
+inline void encodeATCExplicitAlpha( const uint8 alphaValues[16], atc_explicit_alpha_block& blockOut )
+{
+    uint64 alphaList = 0;
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        uint64 quantAlpha = ( ( (uint32)alphaValues[n] * 15 + 127 ) / 255 );
+
+        alphaList |= ( quantAlpha << ( n * 4 ) );
+    }
+
+    blockOut.alphaList = alphaList;
+}
+
+inline uint32 fitATCAlphaIndices( const uint8 alphaValues[16], uint32 alpha0, uint32 alpha1, uint64& indexListOut )
+{
+    uint8 palette[8];
+
+    for ( uint32 n = 0; n < 8; n++ )
+    {
+        palette[n] = getATCInterpolatedAlpha( alpha0, alpha1, n );
+    }
+
+    uint32 totalError = 0;
+    uint64 indexList = 0;
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        uint32 bestIndex = 0;
+        uint32 bestError = 0xFFFFFFFF;
+
+        for ( uint32 p = 0; p < 8; p++ )
+        {
+            int32 diff = ( (int32)alphaValues[n] - (int32)palette[p] );
+
+            uint32 error = (uint32)( diff * diff );
+
+            if ( error < bestError )
+            {
+                bestError = error;
+                bestIndex = p;
+            }
+        }
+
+        indexList |= ( (uint64)bestIndex << ( n * 3 ) );
+        totalError += bestError;
+    }
+
+    indexListOut = indexList;
+
+    return totalError;
+}
+
+inline void encodeATCInterpolatedAlpha( const uint8 alphaValues[16], atc_interpolated_alpha_block& blockOut )
+{
+    uint32 minAlpha = 255;
+    uint32 maxAlpha = 0;
+
+    // Range of the alpha values without the fully transparent and fully opaque ones.
+    uint32 minInnerAlpha = 255;
+    uint32 maxInnerAlpha = 0;
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        uint32 alpha = alphaValues[n];
+
+        minAlpha = std::min( minAlpha, alpha );
+        maxAlpha = std::max( maxAlpha, alpha );
+
+        if ( alpha != 0 && alpha != 255 )
+        {
+            minInnerAlpha = std::min( minInnerAlpha, alpha );
+            maxInnerAlpha = std::max( maxInnerAlpha, alpha );
+        }
+    }
+
+    // Eight interpolated values between the extremes.
+    uint32 bestAlpha0 = maxAlpha;
+    uint32 bestAlpha1 = minAlpha;
+    uint64 bestIndexList;
+
+    uint32 bestError = fitATCAlphaIndices( alphaValues, bestAlpha0, bestAlpha1, bestIndexList );
+
+    // Six interpolated values with explicit 0 and 255.
+    if ( bestError != 0 )
+    {
+        if ( minInnerAlpha > maxInnerAlpha )
+        {
+            minInnerAlpha = maxInnerAlpha = 0;
+        }
+
+        uint64 indexList;
+
+        uint32 error = fitATCAlphaIndices( alphaValues, minInnerAlpha, maxInnerAlpha, indexList );
+
+        if ( error < bestError )
+        {
+            bestAlpha0 = minInnerAlpha;
+            bestAlpha1 = maxInnerAlpha;
+            bestIndexList = indexList;
+        }
+    }
+
+    blockOut.alpha0 = (uint8)bestAlpha0;
+    blockOut.alpha1 = (uint8)bestAlpha1;
+
+    for ( uint32 n = 0; n < 6; n++ )
+    {
+        blockOut.alphaIndices[n] = (uint8)( bestIndexList >> ( n * 8 ) );
+    }
+}
+
+// Encodes texels of any framework format into a compressed ATC surface of ALIGN_SIZE( mipWidth, 4 ) x ALIGN_SIZE( mipHeight, 4 ).
+// Texels outside of the mipmap are filled up by repeating the border.
+inline void compressATCTexels(
+    Interface *engineInterface, eATCInternalFormat internalFormat,
+    uint32 mipWidth, uint32 mipHeight, const void *srcTexels, uint32 srcRowSize,
+    const colorModelDispatcher& fetchDispatch,
+    void *dstBlocks
+)
+{
+    uint32 blockSize = getATCCompressionBlockSize( internalFormat );
+
+    uint32 widthBlocks = ALIGN_SIZE( mipWidth, 4u ) / 4;
+    uint32 heightBlocks = ALIGN_SIZE( mipHeight, 4u ) / 4;
+
+    ParallelForEach( (EngineInterface*)engineInterface, heightBlocks,
+        [&]( size_t block_y )
+        {
+            uint8 *dstBlock = (uint8*)dstBlocks + block_y * widthBlocks * blockSize;
+
+            for ( uint32 block_x = 0; block_x < widthBlocks; block_x++, dstBlock += blockSize )
+            {
+                int32 colors[16][3];
+                uint8 alphaValues[16];
+
+                for ( uint32 n = 0; n < 16; n++ )
+                {
+                    uint32 x = std::min( block_x * 4 + ( n % 4 ), mipWidth - 1 );
+                    uint32 y = std::min( (uint32)block_y * 4 + ( n / 4 ), mipHeight - 1 );
+
+                    const void *srcRow = getConstTexelDataRow( srcTexels, srcRowSize, y );
+
+                    uint8 r, g, b, a;
+
+                    bool gotColor = fetchDispatch.getRGBA( srcRow, x, r, g, b, a );
+
+                    if ( !gotColor )
+                    {
+                        r = 0;
+                        g = 0;
+                        b = 0;
+                        a = 0;
+                    }
+
+                    colors[n][0] = r;
+                    colors[n][1] = g;
+                    colors[n][2] = b;
+                    alphaValues[n] = a;
+                }
+
+                if ( internalFormat == ATC_RGBA_EXPLICIT_ALPHA_AMD )
+                {
+                    atc_explicit_alpha_block *outBlock = (atc_explicit_alpha_block*)dstBlock;
+
+                    encodeATCExplicitAlpha( alphaValues, *outBlock );
+                    encodeATCColorBlock( colors, outBlock->colorBlock );
+                }
+                else if ( internalFormat == ATC_RGBA_INTERPOLATED_ALPHA_AMD )
+                {
+                    atc_interpolated_alpha_block *outBlock = (atc_interpolated_alpha_block*)dstBlock;
+
+                    encodeATCInterpolatedAlpha( alphaValues, *outBlock );
+                    encodeATCColorBlock( colors, outBlock->colorBlock );
+                }
+                else
+                {
+                    encodeATCColorBlock( colors, *(atc_rgb_block*)dstBlock );
+                }
+            }
+        }
+    );
+}
+
+};
+
+#endif //_RENDERWARE_ATC_CODEC_
@@ -6,6 +6,8 @@
 
 #include "txdread.atc.hxx"
 
+#include "txdread.atc.codec.hxx"
+
 #include "txdread.common.hxx"
 
 #include "streamutil.hxx"
@@ -234,162 +236,46 @@ void atcNativeTextureTypeProvider::DeserializeTexture( TextureBase *theTexture,
     engineInterface->DeserializeExtensions( theTexture, inputProvider );
 }
 
-inline CMP_FORMAT getAMDTCFormatFromInternalFormat( eATCInternalFormat internalFormat )
-{
-    CMP_FORMAT actualFormat;
-
-    if ( internalFormat == ATC_RGB_AMD )
-    {
-        actualFormat = CMP_FORMAT_ATC_RGB;
-    }
-    else if ( internalFormat == ATC_RGBA_EXPLICIT_ALPHA_AMD )
-    {
-        actualFormat = CMP_FORMAT_ATC_RGBA_Explicit;
-    }
-    else if ( internalFormat == ATC_RGBA_INTERPOLATED_ALPHA_AMD )
-    {
-        actualFormat = CMP_FORMAT_ATC_RGBA_Interpolated;
-    }
-    else
-    {
-        assert( 0 );
-    }
-
-    return actualFormat;
-}
-
-inline void getAMDTCFormatTargetParams(
-    eATCInternalFormat internalFormat,CMP_FORMAT& requiredOutputCodec,
-    eRasterFormat& outputCodecRasterFormat, uint32& outputCodecDepth, eColorOrdering& outputCodecColorOrder
-)
-{
-    if ( internalFormat == ATC_RGB_AMD )
-    {
-        requiredOutputCodec = CMP_FORMAT_ARGB_8888;
-
-        outputCodecRasterFormat = RASTER_888;
-        outputCodecDepth = 32;
-        outputCodecColorOrder = COLOR_BGRA;
-    }
-    else if ( internalFormat == ATC_RGBA_EXPLICIT_ALPHA_AMD ||
-              internalFormat == ATC_RGBA_INTERPOLATED_ALPHA_AMD )
-    {
-        requiredOutputCodec = CMP_FORMAT_ARGB_8888;
-
-        outputCodecRasterFormat = RASTER_8888;
-        outputCodecDepth = 32;
-        outputCodecColorOrder = COLOR_BGRA;
-    }
-    else
-    {
-        assert( 0 );
-    }
-}
-
 // Pixel API.
 inline void DecompressATCMipmap(
-    Interface *engineInterface,
+    Interface *engineInterface, eATCInternalFormat internalFormat,
     uint32 mipWidth, uint32 mipHeight, uint32 layerWidth, uint32 layerHeight, const void *srcTexels, uint32 srcDataSize,
-    eRasterFormat atcRasterFormat, uint32 atcDepth, eColorOrdering atcColorOrder,
-    eRasterFormat targetRasterFormat, uint32 targetDepth, uint32 targetRowAlignment, eColorOrdering targetColorOrder,
-    CMP_FORMAT srcRasterATITCFormat, CMP_FORMAT dstRasterATITCFormat,
+    uint32 targetRowAlignment,
     void*& dstTexelsOut, uint32& dstDataSizeOut
 )
 {
-    CMP_Texture srcTexture;
-    srcTexture.dwSize = sizeof( CMP_Texture );
-    srcTexture.dwWidth = mipWidth;
-    srcTexture.dwHeight = mipHeight;
-    srcTexture.dwPitch = 0;
-    srcTexture.format = srcRasterATITCFormat;
-    srcTexture.dwDataSize = srcDataSize;
-    srcTexture.pData = (CMP_BYTE*)srcTexels;
-
-    CMP_Texture dstTexture;
-    dstTexture.dwSize = sizeof( CMP_Texture );
-    dstTexture.dwWidth = mipWidth;
-    dstTexture.dwHeight = mipHeight;
-    dstTexture.dwPitch = 0;
-    dstTexture.format = dstRasterATITCFormat;
-    dstTexture.dwDataSize = CMP_CalculateBufferSize( &dstTexture );
-
-    void *atcTexels = engineInterface->PixelAllocate( dstTexture.dwDataSize );
-
-    dstTexture.pData = (CMP_BYTE*)atcTexels;
-
-    if ( !dstTexture.pData )
-    {
-        throw RwException( "failed to allocate decompression surface buffer for AMDCompress decompression task" );
-    }
-
-    void *dstTexels = atcTexels;
-    uint32 dstDataSize = dstTexture.dwDataSize;
-
-    try
-    {
-        // Decompress, wazaaa!
-        CMP_ERROR atcErrorCode = CMP_ConvertTexture( &srcTexture, &dstTexture, NULL, NULL, NULL, NULL );
-
-        if ( atcErrorCode != CMP_OK )
-        {
-            throw RwException( "failed to decompress AMDCompress native texture surface data" );
-        }
-
-        // Put the texels into a format we want.
-        uint32 atcRowAlignment = getATCToolTextureDataRowAlignment();
+    profilingScope profile( engineInterface, PROFSTAGE_DECOMPRESS );
 
-        bool needsNewBuffer = shouldAllocateNewRasterBuffer( mipWidth, atcDepth, atcRowAlignment, targetDepth, targetRowAlignment );
+    profile.AddTexels( (uint64)layerWidth * layerHeight );
+    profile.AddBytes( srcDataSize );
 
-        if ( atcRasterFormat != targetRasterFormat || mipWidth != layerWidth || mipHeight != layerHeight || needsNewBuffer || atcColorOrder != targetColorOrder )
-        {
-            uint32 atcRowSize = getRasterDataRowSize( mipWidth, atcDepth, atcRowAlignment );
+    // The codec writes RASTER_8888 texels in COLOR_BGRA order straight into the destination.
+    uint32 dstRowSize = getRasterDataRowSize( layerWidth, 32, targetRowAlignment );
 
-            uint32 dstRowSize = getRasterDataRowSize( layerWidth, targetDepth, targetRowAlignment );
+    uint32 dstDataSize = getRasterDataSizeByRowSize( dstRowSize, layerHeight );
 
-            if ( mipWidth != layerWidth || mipHeight != layerHeight || needsNewBuffer )
-            {
-                dstDataSize = getRasterDataSizeByRowSize( dstRowSize, mipHeight );
+    void *dstTexels = engineInterface->PixelAllocate( dstDataSize );
 
-                dstTexels = engineInterface->PixelAllocate( dstDataSize );
-            }
+    if ( !dstTexels )
+    {
+        throw RwException( "failed to allocate decompression surface buffer for ATC decompression task" );
+    }
 
-            try
-            {
-                colorModelDispatcher fetchSrcDispatch( atcRasterFormat, atcColorOrder, atcDepth, NULL, 0, PALETTE_NONE );
-                colorModelDispatcher putDispatch( targetRasterFormat, targetColorOrder, targetDepth, NULL, 0, PALETTE_NONE );
-
-                copyTexelDataEx(
-                    atcTexels, dstTexels,
-                    fetchSrcDispatch, putDispatch,
-                    layerWidth, layerHeight,
-                    0, 0,
-                    0, 0,
-                    atcRowSize, dstRowSize
-                );
-            }
-            catch( ... )
-            {
-                if ( dstTexels != atcTexels )
-                {
-                    engineInterface->PixelFree( dstTexels );
-                }
-            
-                throw;
-            }
-        }
+    try
+    {
+        decompressATCTexels(
+            engineInterface, internalFormat,
+            mipWidth, mipHeight, srcTexels, srcDataSize,
+            layerWidth, layerHeight, dstTexels, dstRowSize
+        );
     }
     catch( ... )
     {
-        engineInterface->PixelFree( atcTexels );
+        engineInterface->PixelFree( dstTexels );
 
         throw;
     }
 
-    if ( dstTexels != atcTexels )
-    {
-        engineInterface->PixelFree( atcTexels );
-    }
-
     dstTexelsOut = dstTexels;
     dstDataSizeOut = dstDataSize;
 }
@@ -401,10 +287,10 @@ void atcNativeTextureTypeProvider::GetPixelDataFromTexture( Interface *engineInt
     // Get properties of the compressed texture.
     eATCInternalFormat internalFormat = nativeTex->internalFormat;
 
-    // Decompress the texels into a good format.
+    // Decompress the texels into the format that our codec outputs.
     eRasterFormat targetRasterFormat = RASTER_8888;
     uint32 targetDepth = 32;
-    eColorOrdering targetColorOrder = COLOR_RGBA;
+    eColorOrdering targetColorOrder = COLOR_BGRA;
 
     uint32 targetRowAlignment = getATCExportTextureDataRowAlignment();
 
@@ -412,18 +298,6 @@ void atcNativeTextureTypeProvider::GetPixelDataFromTexture( Interface *engineInt
 
     pixelsOut.mipmaps.resize( mipmapCount );
 
-    // Calculate the properties of the ATI TC source and destination textures.
-    CMP_FORMAT srcRasterATITCFormat = getAMDTCFormatFromInternalFormat( internalFormat );
-
-    // Fetch format properties that are required as decompression destination surface.
-    eRasterFormat atcRasterFormat = RASTER_8888;
-    uint32 atcDepth = 32;
-    eColorOrdering atcColorOrder = COLOR_RGBA;
-
-    CMP_FORMAT dstRasterATITCFormat;
-
-    getAMDTCFormatTargetParams( internalFormat, dstRasterATITCFormat, atcRasterFormat, atcDepth, atcColorOrder );
-
     for ( uint32 n = 0; n < mipmapCount; n++ )
     {
         const NativeTextureATC::mipmapLayer& mipLayer = nativeTex->mipmaps[ n ];
@@ -449,11 +323,9 @@ void atcNativeTextureTypeProvider::GetPixelDataFromTexture( Interface *engineInt
         void *mipTexels = NULL;
         
         DecompressATCMipmap(
-            engineInterface,
+            engineInterface, internalFormat,
             mipWidth, mipHeight, layerWidth, layerHeight, mipLayer.texels, mipLayer.dataSize,
-            atcRasterFormat, atcDepth, atcColorOrder,
-            targetRasterFormat, targetDepth, targetRowAlignment, targetColorOrder,
-            srcRasterATITCFormat, dstRasterATITCFormat,
+            targetRowAlignment,
             mipTexels, texDataSize
         );
 
@@ -485,124 +357,59 @@ void atcNativeTextureTypeProvider::GetPixelDataFromTexture( Interface *engineInt
 }
 
 inline void CompressMipmapToATC(
-    Interface *engineInterface,
+    Interface *engineInterface, eATCInternalFormat internalFormat,
     uint32 mipWidth, uint32 mipHeight, const void *srcTexels,
     eRasterFormat srcRasterFormat, uint32 srcDepth, uint32 srcRowAlignment, eColorOrdering srcColorOrder, ePaletteType srcPaletteType, const void *srcPaletteData, uint32 srcPaletteSize,
-    eRasterFormat feedRasterFormat, uint32 feedDepth, eColorOrdering feedColorOrder,
-    uint32 compressionBlockSize,
-    CMP_FORMAT srcTextureFormat, CMP_FORMAT dstTextureFormat,
     uint32& dstWidthOut, uint32& dstHeightOut,
     void*& dstTexelsOut, uint32& dstDataSizeOut
 )
 {
+    profilingScope profile( engineInterface, PROFSTAGE_COMPRESS );
+
+    profile.AddTexels( (uint64)mipWidth * mipHeight );
+
     uint32 srcLayerRowSize = getRasterDataRowSize( mipWidth, srcDepth, srcRowAlignment );
 
-    // Put this mipmap in a ATI_Compress compatible texture.
-    uint32 feedLayerTexRowSize = getRasterDataRowSize( mipWidth, feedDepth, getATCToolTextureDataRowAlignment() );
+    // Determine the compressed texture dimensions.
+    uint32 compressWidth = ALIGN_SIZE( mipWidth, 4u );
+    uint32 compressHeight = ALIGN_SIZE( mipHeight, 4u );
 
-    uint32 feedTextureDataSize = getRasterDataSizeByRowSize( feedLayerTexRowSize, mipHeight );
+    uint32 compressionBlockCount = ( compressWidth * compressHeight ) / 16;
 
-    void *feedTexels = engineInterface->PixelAllocate( feedTextureDataSize );
+    // Allocate the output buffer.
+    uint32 dstDataSize = ( compressionBlockCount * getATCCompressionBlockSize( internalFormat ) );
 
-    if ( feedTexels == NULL )
+    void *dstTexels = engineInterface->PixelAllocate( dstDataSize );
+
+    if ( dstTexels == NULL )
     {
-        throw RwException( "failed to allocate traversal texel buffer for ATC mipmap encoding" );
+        throw RwException( "failed to allocate output texel buffer for ATC mipmap encoding" );
     }
 
-    void *outTexels = NULL;
-    uint32 outTexelsDataSize = 0;
-    uint32 outWidth, outHeight;
-
     try
     {
+        // The encoder fetches the source texels directly, so we do not need a proxy texture.
         colorModelDispatcher fetchDispatch( srcRasterFormat, srcColorOrder, srcDepth, srcPaletteData, srcPaletteSize, srcPaletteType );
-        colorModelDispatcher putDispatch( feedRasterFormat, feedColorOrder, feedDepth, NULL, 0, PALETTE_NONE );
-
-        copyTexelDataEx(
-            srcTexels, feedTexels,
-            fetchDispatch, putDispatch,
-            mipWidth, mipHeight,
-            0, 0,
-            0, 0,
-            srcLayerRowSize, feedLayerTexRowSize
-        );
-
-        // Determine the compressed texture dimensions.
-        uint32 compressWidth = ALIGN_SIZE( mipWidth, 4u );
-        uint32 compressHeight = ALIGN_SIZE( mipHeight, 4u );
-
-        uint32 compressionBlockCount = ( compressWidth * compressHeight ) / 16;
-
-        // Allocate the output buffer.
-        uint32 dstDataSize = ( compressionBlockCount * compressionBlockSize );
 
-        void *dstTexels = engineInterface->PixelAllocate( dstDataSize );
-
-        if ( dstTexels == NULL )
-        {
-            throw RwException( "failed to allocate output texel buffer for ATC mipmap encoding" );
-        }
-
-        try
-        {
-            // Compress the texture now.
-            {
-                CMP_Texture srcTexture;
-                srcTexture.dwSize = sizeof( srcTexture );
-                srcTexture.dwWidth = mipWidth;
-                srcTexture.dwHeight = mipHeight;
-                srcTexture.dwPitch = 0;
-                srcTexture.format = srcTextureFormat;
-                srcTexture.dwDataSize = feedTextureDataSize;
-                srcTexture.pData = (CMP_BYTE*)feedTexels;
-
-                CMP_Texture dstTexture;
-                dstTexture.dwSize = sizeof( dstTexture );
-                dstTexture.dwWidth = mipWidth;
-                dstTexture.dwHeight = mipHeight;
-                dstTexture.dwPitch = 0;
-                dstTexture.format = dstTextureFormat;
-                dstTexture.dwDataSize = dstDataSize;
-                dstTexture.pData = (CMP_BYTE*)dstTexels;
-
-                // Do the conversion.
-                CMP_ERROR atcErrorCode =
-                    CMP_ConvertTexture( &srcTexture, &dstTexture, NULL, NULL, NULL, NULL );
-
-                if ( atcErrorCode != CMP_OK )
-                {
-                    throw RwException( "unknown error in ATC mipmap encoding" );
-                }
-
-                // Return stuff.
-                outWidth = compressWidth;
-                outHeight = compressHeight;
-                outTexels = dstTexels;
-                outTexelsDataSize = dstDataSize;
-            }
-        }
-        catch( ... )
-        {
-            engineInterface->PixelFree( dstTexels );
-
-            throw;
-        }
+        compressATCTexels(
+            engineInterface, internalFormat,
+            mipWidth, mipHeight, srcTexels, srcLayerRowSize,
+            fetchDispatch,
+            dstTexels
+        );
     }
     catch( ... )
     {
-        engineInterface->PixelFree( feedTexels );
+        engineInterface->PixelFree( dstTexels );
 
         throw;
     }
 
-    // Free the feedTexture that was used as a proxy.
-    engineInterface->PixelFree( feedTexels );
-
     // Give parameters to the runtime.
-    dstWidthOut = outWidth;
-    dstHeightOut = outHeight;
-    dstTexelsOut = outTexels;
-    dstDataSizeOut = outTexelsDataSize;
+    dstWidthOut = compressWidth;
+    dstHeightOut = compressHeight;
+    dstTexelsOut = dstTexels;
+    dstDataSizeOut = dstDataSize;
 }
 
 void atcNativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInterface, void *objMem, const pixelDataTraversal& pixelsIn, acquireFeedback_t& feedbackOut )
@@ -653,19 +460,6 @@ void atcNativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInter
 
     // Do it.
     {
-        // Get the format that we will output the feed-in texture as.
-        eRasterFormat feedRasterFormat = RASTER_8888;
-        uint32 feedDepth = 32;
-        eColorOrdering feedColorOrder = COLOR_BGRA;
-
-        CMP_FORMAT srcTextureFormat;
-
-        getAMDTCFormatTargetParams( internalFormat, srcTextureFormat, feedRasterFormat, feedDepth, feedColorOrder );
-
-        CMP_FORMAT dstTextureFormat = getAMDTCFormatFromInternalFormat( internalFormat );
-
-        uint32 compressionBlockSize = getATCCompressionBlockSize( internalFormat );
-
         // Parse all mipmaps.
         size_t mipmapCount = pixelsIn.mipmaps.size();
 
@@ -688,12 +482,9 @@ void atcNativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInter
             uint32 dstDataSize = 0;
 
             CompressMipmapToATC(
-                engineInterface,
+                engineInterface, internalFormat,
                 mipWidth, mipHeight, srcTexels,
                 srcRasterFormat, srcDepth, srcRowAlignment, srcColorOrder, srcPaletteType, srcPaletteData, srcPaletteSize,
-                feedRasterFormat, feedDepth, feedColorOrder,
-                compressionBlockSize,
-                srcTextureFormat, dstTextureFormat,
                 compressWidth, compressHeight,
                 dstTexels, dstDataSize
             );
@@ -790,34 +581,21 @@ struct atcMipmapManager
         const void *srcTexels = mipLayer.texels;
         uint32 srcDataSize = mipLayer.dataSize;
 
-        // Decompress the texels into a good format.
+        // Decompress the texels into the format that our codec outputs.
         eRasterFormat targetRasterFormat = RASTER_8888;
         uint32 targetDepth = 32;
-        eColorOrdering targetColorOrder = COLOR_RGBA;
+        eColorOrdering targetColorOrder = COLOR_BGRA;
 
         uint32 targetRowAlignment = getATCExportTextureDataRowAlignment();
 
-        // We decompress the layer and give it as new texels.
-        eRasterFormat atcRasterFormat;
-        uint32 atcDepth;
-        eColorOrdering atcColorOrder;
-
-        CMP_FORMAT dstRasterATITCFormat;
-
-        getAMDTCFormatTargetParams( internalFormat, dstRasterATITCFormat, atcRasterFormat, atcDepth, atcColorOrder );
-
-        CMP_FORMAT srcRasterATITCFormat = getAMDTCFormatFromInternalFormat( internalFormat );
-
         // Perform it.
         void *dstTexels = NULL;
         uint32 dstDataSize = 0;
 
         DecompressATCMipmap(
-            engineInterface,
+            engineInterface, internalFormat,
             mipWidth, mipHeight, layerWidth, layerHeight, srcTexels, srcDataSize,
-            atcRasterFormat, atcDepth, atcColorOrder,
-            targetRasterFormat, targetDepth, targetRowAlignment, targetColorOrder,
-            srcRasterATITCFormat, dstRasterATITCFormat,
+            targetRowAlignment,
             dstTexels, dstDataSize
         );
 
@@ -904,19 +682,6 @@ struct atcMipmapManager
             srcTexelsNewlyAllocated = true;
         }
 
-        // Get the format that we will output the feed-in texture as.
-        eRasterFormat feedRasterFormat = RASTER_8888;
-        uint32 feedDepth = 32;
-        eColorOrdering feedColorOrder = COLOR_BGRA;
-
-        CMP_FORMAT srcTextureFormat;
-
-        getAMDTCFormatTargetParams( internalFormat, srcTextureFormat, feedRasterFormat, feedDepth, feedColorOrder );
-
-        CMP_FORMAT dstTextureFormat = getAMDTCFormatFromInternalFormat( internalFormat );
-
-        uint32 compressionBlockSize = getATCCompressionBlockSize( internalFormat );
-
         // Do it.
         uint32 compressedWidth, compressedHeight;
 
@@ -924,12 +689,9 @@ struct atcMipmapManager
         uint32 dstDataSize = 0;
 
         CompressMipmapToATC(
-            engineInterface,
+            engineInterface, internalFormat,
             width, height, srcTexels,
             rasterFormat, depth, rowAlignment, colorOrder, paletteType, paletteData, paletteSize,
-            feedRasterFormat, feedDepth, feedColorOrder,
-            compressionBlockSize,
-            srcTextureFormat, dstTextureFormat,
             compressedWidth, compressedHeight,
             dstTexels, dstDataSize
         );
@@ -967,6 +729,21 @@ bool atcNativeTextureTypeProvider::GetMipmapLayer( Interface *engineInterface, v
         );
 }
 
+bool atcNativeTextureTypeProvider::GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut )
+{
+    NativeTextureATC *nativeTex = (NativeTextureATC*)objMem;
+
+    atcMipmapManager mipMan( nativeTex );
+
+    return
+        virtualGetMipmapLayerSize(
+            mipMan,
+            mipIndex,
+            nativeTex->mipmaps,
+            widthOut, heightOut
+        );
+}
+
 bool atcNativeTextureTypeProvider::AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut )
 {
     NativeTextureATC *nativeTex = (NativeTextureATC*)objMem;
@@ -6,11 +6,6 @@
 
 #include "txdread.common.hxx"
 
-// AMDCompress does include windows.h
-#define WIN32_LEAN_AND_MEAN
-#define NOMINMAX
-#include <Compressonator.h>
-
 #define PLATFORM_ATC    11
 
 namespace rw
@@ -188,6 +183,7 @@ struct atcNativeTextureTypeProvider : public texNativeTypeProvider
     }
 
     bool GetMipmapLayer( Interface *engineInterface, void *objMem, uint32 mipIndex, rawMipmapLayer& layerOut );
+    bool GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut );
     bool AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut );
     void ClearMipmaps( Interface *engineInterface, void *objMem );
 
@@ -343,7 +343,7 @@ void Raster::compressCustom(eCompressionType targetCompressionType)
 
 bool Raster::isCompressed( void ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -366,7 +366,7 @@ bool Raster::isCompressed( void ) const
 
 eCompressionType Raster::getCompressionFormat( void ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -15,8 +15,12 @@
 
 #include "txdread.common.hxx"
 
+#include "txdread.raster.hxx"
+
 #include "rwserialize.hxx"
 
+#include "rwthreading.parallel.hxx"
+
 namespace rw
 {
 
@@ -58,6 +62,184 @@ const TexDictionary* texDictionaryStreamPlugin::ToConstTexDictionary( EngineInte
     return NULL;
 }
 
+// Puts a deserialized texture native into the dictionary or reports why that was not possible.
+static void AddDeserializedTextureToDictionary( EngineInterface *engineInterface, TexDictionary *txdObj, RwObject *rwObj, const std::string& errDebugMsg )
+{
+    if ( rwObj )
+    {
+        // If it is a texture, add it to our TXD.
+        bool hasBeenAddedToTXD = false;
+
+        GenericRTTI *rttiObj = RwTypeSystem::GetTypeStructFromObject( rwObj );
+
+        RwTypeSystem::typeInfoBase *typeInfo = RwTypeSystem::GetTypeInfoFromTypeStruct( rttiObj );
+
+        if ( engineInterface->typeSystem.IsTypeInheritingFrom( engineInterface->textureTypeInfo, typeInfo ) )
+        {
+            TextureBase *texture = (TextureBase*)rwObj;
+
+            texture->AddToDictionary( txdObj );
+
+            hasBeenAddedToTXD = true;
+        }
+
+        // If it has not been added, delete it.
+        if ( hasBeenAddedToTXD == false )
+        {
+            engineInterface->DeleteRwObject( rwObj );
+        }
+    }
+    else
+    {
+        std::string pushWarning;
+
+        if ( errDebugMsg.empty() == false )
+        {
+            pushWarning = "texture native reading failure: ";
+            pushWarning += errDebugMsg;
+        }
+        else
+        {
+            pushWarning = "failed to deserialize texture native block in texture dictionary";
+        }
+
+        engineInterface->PushWarning( pushWarning.c_str() );
+    }
+}
+
+// Decodes the texture native blocks of a dictionary on the worker threads.
+// The input stream can only be read by one thread, so every block is first copied into memory in stream order.
+// The textures are added to the dictionary in their original order and the warnings of each texture are
+// reported in that order aswell, so the result is the same as with sequential reading.
+static void DeserializeTextureBlocksParallel( EngineInterface *engineInterface, BlockProvider& inputProvider, TexDictionary *txdObj, uint32 textureBlockCount )
+{
+    struct textureBlockJob
+    {
+        inline textureBlockJob( void )
+        {
+            this->rwObj = NULL;
+        }
+
+        std::vector <char> blockData;   // including the block header
+
+        RwObject *rwObj;
+        std::string errDebugMsg;
+
+        nativeTextureStreamPlugin::QueuedWarningHandler warnings;
+    };
+
+    std::vector <textureBlockJob> jobs( textureBlockCount );
+
+    // 1. Index the blocks and fetch their data.
+    for ( uint32 n = 0; n < textureBlockCount; n++ )
+    {
+        textureBlockJob& job = jobs[ n ];
+
+        try
+        {
+            int64 blockStart = inputProvider.tell();
+
+            {
+                BlockProvider textureNativeBlock( &inputProvider );
+
+                textureNativeBlock.EnterContext();
+                textureNativeBlock.LeaveContext();
+            }
+
+            int64 blockEnd = inputProvider.tell();
+
+            inputProvider.seek( blockStart, RWSEEK_BEG );
+
+            job.blockData.resize( (size_t)( blockEnd - blockStart ) );
+
+            inputProvider.read( job.blockData.data(), job.blockData.size() );
+        }
+        catch( RwException& except )
+        {
+            // Like sequential reading, we skip broken blocks with a warning.
+            std::vector <char> ().swap( job.blockData );
+
+            job.errDebugMsg = except.message;
+        }
+    }
+
+    // 2. Decode every block from its own memory stream.
+    try
+    {
+        ParallelForEach( engineInterface, textureBlockCount,
+            [&]( size_t jobIndex )
+        {
+            textureBlockJob& job = jobs[ jobIndex ];
+
+            // Skip the blocks that could not be fetched.
+            if ( job.blockData.empty() )
+                return;
+
+            streamConstructionMemoryParam_t memParam( job.blockData.data(), job.blockData.size() );
+
+            Stream *blockStream = engineInterface->CreateStream( RWSTREAMTYPE_MEMORY, RWSTREAMMODE_READONLY, &memParam );
+
+            if ( !blockStream )
+            {
+                job.errDebugMsg = "failed to create memory stream for texture native block";
+                return;
+            }
+
+            GlobalPushWarningHandler( engineInterface, &job.warnings );
+
+            try
+            {
+                BlockProvider textureNativeBlock( blockStream, RWBLOCKMODE_READ );
+
+                job.rwObj = engineInterface->DeserializeBlock( textureNativeBlock );
+            }
+            catch( RwException& except )
+            {
+                job.rwObj = NULL;
+                job.errDebugMsg = except.message;
+            }
+            catch( ... )
+            {
+                GlobalPopWarningHandler( engineInterface );
+
+                engineInterface->DeleteStream( blockStream );
+                throw;
+            }
+
+            GlobalPopWarningHandler( engineInterface );
+
+            engineInterface->DeleteStream( blockStream );
+
+            // Free the raw data early.
+            std::vector <char> ().swap( job.blockData );
+        });
+    }
+    catch( ... )
+    {
+        // Do not leak the textures that did decode.
+        for ( textureBlockJob& job : jobs )
+        {
+            if ( RwObject *rwObj = job.rwObj )
+            {
+                engineInterface->DeleteRwObject( rwObj );
+            }
+        }
+
+        throw;
+    }
+
+    // 3. Assemble the dictionary in stream order.
+    for ( textureBlockJob& job : jobs )
+    {
+        for ( std::string& warning : job.warnings.message_list )
+        {
+            engineInterface->PushWarning( std::move( warning ) );
+        }
+
+        AddDeserializedTextureToDictionary( engineInterface, txdObj, job.rwObj, job.errDebugMsg );
+    }
+}
+
 void texDictionaryStreamPlugin::Deserialize( Interface *intf, BlockProvider& inputProvider, RwObject *objectToDeserialize ) const
 {
     EngineInterface *engineInterface = (EngineInterface*)intf;
@@ -116,74 +298,48 @@ void texDictionaryStreamPlugin::Deserialize( Interface *intf, BlockProvider& inp
 
         // Now follow multiple TEXTURENATIVE blocks.
         // Deserialize all of them.
-
-        for ( uint32 n = 0; n < textureBlockCount; n++ )
+        // Texture natives do not depend on each other, so if there are enough of them we decode them in parallel.
+        // Without trustworthy block regions we cannot find the block boundaries without parsing, so that case stays sequential.
+        bool deserializeInParallel =
+            ( textureBlockCount > 1 &&
+              inputProvider.doesIgnoreBlockRegions() == false &&
+              GetParallelWorkerCount( engineInterface ) > 1 );
+
+        if ( deserializeInParallel )
         {
-            BlockProvider textureNativeBlock( &inputProvider );
-
-            // Deserialize this block.
-            RwObject *rwObj = NULL;
-
-            std::string errDebugMsg;
-
-            try
-            {
-                rwObj = engineInterface->DeserializeBlock( textureNativeBlock );
-            }
-            catch( RwException& except )
-            {
-                // Catch the exception and try to continue.
-                rwObj = NULL;
-
-                if ( textureNativeBlock.doesIgnoreBlockRegions() )
-                {
-                    // If we failed any texture parsing in the "ignoreBlockRegions" parse mode,
-                    // there is no point in continuing, since the environment does not recover.
-                    throw;
-                }
-
-                errDebugMsg = except.message;
-            }
-
-            if ( rwObj )
+            DeserializeTextureBlocksParallel( engineInterface, inputProvider, txdObj, textureBlockCount );
+        }
+        else
+        {
+            for ( uint32 n = 0; n < textureBlockCount; n++ )
             {
-                // If it is a texture, add it to our TXD.
-                bool hasBeenAddedToTXD = false;
+                BlockProvider textureNativeBlock( &inputProvider );
 
-                GenericRTTI *rttiObj = RwTypeSystem::GetTypeStructFromObject( rwObj );
+                // Deserialize this block.
+                RwObject *rwObj = NULL;
 
-                RwTypeSystem::typeInfoBase *typeInfo = RwTypeSystem::GetTypeInfoFromTypeStruct( rttiObj );
+                std::string errDebugMsg;
 
-                if ( engineInterface->typeSystem.IsTypeInheritingFrom( engineInterface->textureTypeInfo, typeInfo ) )
+                try
                 {
-                    TextureBase *texture = (TextureBase*)rwObj;
-
-                    texture->AddToDictionary( txdObj );
-
-                    hasBeenAddedToTXD = true;
+                    rwObj = engineInterface->DeserializeBlock( textureNativeBlock );
                 }
-
-                // If it has not been added, delete it.
-                if ( hasBeenAddedToTXD == false )
+                catch( RwException& except )
                 {
-                    engineInterface->DeleteRwObject( rwObj );
-                }
-            }
-            else
-            {
-                std::string pushWarning;
+                    // Catch the exception and try to continue.
+                    rwObj = NULL;
 
-                if ( errDebugMsg.empty() == false )
-                {
-                    pushWarning = "texture native reading failure: ";
-                    pushWarning += errDebugMsg;
-                }
-                else
-                {
-                    pushWarning = "failed to deserialize texture native block in texture dictionary";
+                    if ( textureNativeBlock.doesIgnoreBlockRegions() )
+                    {
+                        // If we failed any texture parsing in the "ignoreBlockRegions" parse mode,
+                        // there is no point in continuing, since the environment does not recover.
+                        throw;
+                    }
+
+                    errDebugMsg = except.message;
                 }
 
-                engineInterface->PushWarning( pushWarning.c_str() );
+                AddDeserializedTextureToDictionary( engineInterface, txdObj, rwObj, errDebugMsg );
             }
         }
     }
@@ -492,6 +492,105 @@ inline uint32 getDXTRasterDataSize(uint32 dxtType, uint32 texUnitCount)
     return ( texBlockCount * blockSize );
 }
 
+// Compresses a 4x4 block of straight-alpha colors into the DXT surface.
+template <template <typename numberType> class endianness>
+inline void compressDXTBlock( uint32 dxtType, PixelFormat::pixeldata32bit colors[4][4], void *dxtArray, uint32 blockIndex )
+{
+    // Check whether we should premultiply.
+    bool isPremultiplied = ( dxtType == 2 || dxtType == 4 );
+
+    if ( isPremultiplied )
+    {
+        for ( uint32 y_iter = 0; y_iter != 4; y_iter++ )
+        {
+            for ( uint32 x_iter = 0; x_iter != 4; x_iter++ )
+            {
+                PixelFormat::pixeldata32bit& inColor = colors[ y_iter ][ x_iter ];
+
+                premultiplyByAlpha( inColor.red, inColor.green, inColor.blue, inColor.alpha, inColor.red, inColor.green, inColor.blue );
+            }
+        }
+    }
+
+    // Compress it using SQUISH.
+
+    // Since SQUISH only supports native-word DXT blocks, we will have to
+    // convert to the correct endianness after compression.
+    if ( dxtType == 1 )
+    {
+        struct native_dxt1_block
+        {
+            rgb565 col0;
+            rgb565 col1;
+
+            uint32 indexList;
+        };
+        native_dxt1_block compr_block;
+
+        squish::Compress( (const squish::u8*)colors, &compr_block, squish::kDxt1 );
+
+        // Write it into the texture in correct endianness.
+        dxt1_block <endianness> *dstBlock = (dxt1_block <endianness>*)dxtArray + blockIndex;
+
+        dstBlock->col0 = compr_block.col0;
+        dstBlock->col1 = compr_block.col1;
+        dstBlock->indexList = compr_block.indexList;
+    }
+    else if ( dxtType == 2 || dxtType == 3 )
+    {
+        struct native_dxt23_block
+        {
+            uint64 alphaList;
+
+            rgb565 col0;
+            rgb565 col1;
+
+            uint32 indexList;
+        };
+        native_dxt23_block compr_block;
+
+        squish::Compress( (const squish::u8*)colors, &compr_block, squish::kDxt3 );
+
+        // Write it in correct endianness to the texture.
+        dxt2_3_block <endianness> *dstBlock = (dxt2_3_block <endianness>*)dxtArray + blockIndex;
+
+        dstBlock->alphaList = compr_block.alphaList;
+        dstBlock->col0 = compr_block.col0;
+        dstBlock->col1 = compr_block.col1;
+        dstBlock->indexList = compr_block.indexList;
+    }
+    else if ( dxtType == 4 || dxtType == 5 )
+    {
+        struct native_dxt45_block
+        {
+            uint8 alphaPreMult[2];
+            uint48_t alphaList;
+
+            rgb565 col0;
+            rgb565 col1;
+
+            uint32 indexList;
+        };
+        native_dxt45_block compr_block;
+
+        squish::Compress( (const squish::u8*)colors, &compr_block, squish::kDxt5 );
+
+        // Write the destination block into the texture.
+        dxt4_5_block <endianness> *dstBlock = (dxt4_5_block <endianness>*)dxtArray + blockIndex;
+
+        dstBlock->alphaPreMult[0] = compr_block.alphaPreMult[0];
+        dstBlock->alphaPreMult[1] = compr_block.alphaPreMult[1];
+        dstBlock->alphaList = compr_block.alphaList;
+        dstBlock->col0 = compr_block.col0;
+        dstBlock->col1 = compr_block.col1;
+        dstBlock->indexList = compr_block.indexList;
+    }
+    else
+    {
+        assert( 0 );
+    }
+}
+
 template <template <typename numberType> class endianness>
 inline void compressTexelsUsingDXT(
     Interface *engineInterface,
@@ -538,9 +637,6 @@ inline void compressTexelsUsingDXT(
                 // Compress a 4x4 color block.
                 PixelFormat::pixeldata32bit colors[4][4];
 
-                // Check whether we should premultiply.
-                bool isPremultiplied = ( dxtType == 2 || dxtType == 4 );
-
                 for ( uint32 y_iter = 0; y_iter != 4; y_iter++ )
                 {
                     for ( uint32 x_iter = 0; x_iter != 4; x_iter++ )
@@ -562,11 +658,6 @@ inline void compressTexelsUsingDXT(
                             fetchSrcDispatch.getRGBA( rowData, targetX, r, g, b, a );
                         }
 
-                        if ( isPremultiplied )
-                        {
-                            premultiplyByAlpha( r, g, b, a, r, g, b );
-                        }
-
                         inColor.red = r;
                         inColor.green = g;
                         inColor.blue = b;
@@ -574,85 +665,129 @@ inline void compressTexelsUsingDXT(
                     }
                 }
 
-                // Compress it using SQUISH.
+                compressDXTBlock <endianness> ( dxtType, colors, dxtArray, compressedBlockCount );
 
-                // Since SQUISH only supports native-word DXT blocks, we will have to
-                // convert to the correct endianness after compression.
-                if ( dxtType == 1 )
-                {
-                    struct native_dxt1_block
-                    {
-                        rgb565 col0;
-                        rgb565 col1;
+                // Increment the block count.
+                compressedBlockCount++;
+            }
+        }
+    }
+    catch( ... )
+    {
+        engineInterface->PixelFree( dxtArray );
 
-                        uint32 indexList;
-                    };
-                    native_dxt1_block compr_block;
+        throw;
+    }
 
-                    squish::Compress( (const squish::u8*)colors, &compr_block, squish::kDxt1 );
+    // Give the new texels to the runtime, along with the data size.
+    texelsOut = dxtArray;
+    dataSizeOut = dxtDataSize;
 
-                    // Write it into the texture in correct endianness.
-                    dxt1_block <endianness> *dstBlock = (dxt1_block <endianness>*)dxtArray + compressedBlockCount;
+    realWidthOut = alignedMipWidth;
+    realHeightOut = alignedMipHeight;
+}
 
-                    dstBlock->col0 = compr_block.col0;
-                    dstBlock->col1 = compr_block.col1;
-                    dstBlock->indexList = compr_block.indexList;
-                }
-                else if ( dxtType == 2 || dxtType == 3 )
-                {
-                    struct native_dxt23_block
-                    {
-                        uint64 alphaList;
+// Converts a DXT surface into another DXT type, one block at a time.
+// The colors are passed through the given raw format, so the result is the same as decompressing
+// into that format and compressing again, but without the intermediate surface.
+template <template <typename numberType> class endianness>
+inline bool transcodeTexelsUsingDXT(
+    Interface *engineInterface, eDXTCompressionMethod dxtMethod,
+    uint32 srcDXTType, const void *srcTexels, uint32 srcWidth, uint32 srcHeight,
+    uint32 layerWidth, uint32 layerHeight,
+    eRasterFormat interRasterFormat, eColorOrdering interColorOrder, uint32 interDepth,
+    uint32 dstDXTType,
+    void*& texelsOut, uint32& dataSizeOut,
+    uint32& realWidthOut, uint32& realHeightOut
+)
+{
+    uint32 alignedMipWidth = ALIGN_SIZE( layerWidth, 4u );
+    uint32 alignedMipHeight = ALIGN_SIZE( layerHeight, 4u );
+
+    uint32 srcWidthBlocks = ( srcWidth / 4 );
+    uint32 srcHeightBlocks = ( srcHeight / 4 );
+
+    uint32 widthBlocks = alignedMipWidth / 4;
+    uint32 heightBlocks = alignedMipHeight / 4;
+
+    if ( widthBlocks > srcWidthBlocks || heightBlocks > srcHeightBlocks )
+    {
+        return false;
+    }
+
+    uint32 dxtDataSize = getDXTRasterDataSize( dstDXTType, ( alignedMipWidth * alignedMipHeight ) );
 
-                        rgb565 col0;
-                        rgb565 col1;
+    void *dxtArray = engineInterface->PixelAllocate( dxtDataSize );
 
-                        uint32 indexList;
-                    };
-                    native_dxt23_block compr_block;
+    if ( !dxtArray )
+    {
+        throw RwException( "failed to allocate DXT surface in transcoding routine" );
+    }
 
-                    squish::Compress( (const squish::u8*)colors, &compr_block, squish::kDxt3 );
+    bool successfullyTranscoded = true;
+
+    try
+    {
+        // 32bit RGBA keeps every color, so we can skip the round-trip.
+        bool isIntermediateLossless = ( interRasterFormat == RASTER_8888 && interDepth == 32 );
 
-                    // Write it in correct endianness to the texture.
-                    dxt2_3_block <endianness> *dstBlock = (dxt2_3_block <endianness>*)dxtArray + compressedBlockCount;
+        colorModelDispatcher interDispatch( interRasterFormat, interColorOrder, interDepth, NULL, 0, PALETTE_NONE );
 
-                    dstBlock->alphaList = compr_block.alphaList;
-                    dstBlock->col0 = compr_block.col0;
-                    dstBlock->col1 = compr_block.col1;
-                    dstBlock->indexList = compr_block.indexList;
+        uint32 compressedBlockCount = 0;
+
+        for ( uint32 y_block = 0; y_block < heightBlocks && successfullyTranscoded; y_block++ )
+        {
+            for ( uint32 x_block = 0; x_block < widthBlocks; x_block++ )
+            {
+                PixelFormat::pixeldata32bit colors[4][4];
+
+                bool couldDecompressBlock = decompressDXTBlock <endianness> ( dxtMethod, srcTexels, y_block * srcWidthBlocks + x_block, srcDXTType, colors );
+
+                if ( !couldDecompressBlock )
+                {
+                    successfullyTranscoded = false;
+                    break;
                 }
-                else if ( dxtType == 4 || dxtType == 5 )
+
+                for ( uint32 y_iter = 0; y_iter != 4; y_iter++ )
                 {
-                    struct native_dxt45_block
+                    for ( uint32 x_iter = 0; x_iter != 4; x_iter++ )
                     {
-                        uint8 alphaPreMult[2];
-                        uint48_t alphaList;
+                        PixelFormat::pixeldata32bit& color = colors[ y_iter ][ x_iter ];
 
-                        rgb565 col0;
-                        rgb565 col1;
+                        uint32 targetX = ( x_block * 4 + x_iter );
+                        uint32 targetY = ( y_block * 4 + y_iter );
 
-                        uint32 indexList;
-                    };
-                    native_dxt45_block compr_block;
+                        if ( targetX >= layerWidth || targetY >= layerHeight )
+                        {
+                            // The decompressed surface would not have had these texels.
+                            color.red = 0;
+                            color.green = 0;
+                            color.blue = 0;
+                            color.alpha = 0;
+                        }
+                        else if ( !isIntermediateLossless )
+                        {
+                            uint32 scratchTexel = 0;
 
-                    squish::Compress( (const squish::u8*)colors, &compr_block, squish::kDxt5 );
+                            uint8 r = 0;
+                            uint8 g = 0;
+                            uint8 b = 0;
+                            uint8 a = 0;
 
-                    // Write the destination block into the texture.
-                    dxt4_5_block <endianness> *dstBlock = (dxt4_5_block <endianness>*)dxtArray + compressedBlockCount;
+                            interDispatch.setRGBA( &scratchTexel, 0, color.red, color.green, color.blue, color.alpha );
+                            interDispatch.getRGBA( &scratchTexel, 0, r, g, b, a );
 
-                    dstBlock->alphaPreMult[0] = compr_block.alphaPreMult[0];
-                    dstBlock->alphaPreMult[1] = compr_block.alphaPreMult[1];
-                    dstBlock->alphaList = compr_block.alphaList;
-                    dstBlock->col0 = compr_block.col0;
-                    dstBlock->col1 = compr_block.col1;
-                    dstBlock->indexList = compr_block.indexList;
-                }
-                else
-                {
-                    assert( 0 );
+                            color.red = r;
+                            color.green = g;
+                            color.blue = b;
+                            color.alpha = a;
+                        }
+                    }
                 }
 
-                // Increment the block count.
+                compressDXTBlock <endianness> ( dstDXTType, colors, dxtArray, compressedBlockCount );
+
                 compressedBlockCount++;
             }
         }
@@ -664,12 +799,20 @@ inline void compressTexelsUsingDXT(
         throw;
     }
 
-    // Give the new texels to the runtime, along with the data size.
+    if ( !successfullyTranscoded )
+    {
+        engineInterface->PixelFree( dxtArray );
+
+        return false;
+    }
+
     texelsOut = dxtArray;
     dataSizeOut = dxtDataSize;
 
     realWidthOut = alignedMipWidth;
     realHeightOut = alignedMipHeight;
+
+    return true;
 }
 
 // Generic decompressor based on no fixed types.
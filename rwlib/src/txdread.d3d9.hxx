@@ -612,6 +612,7 @@ struct d3d9NativeTextureTypeProvider : public texNativeTypeProvider, d3dpublic::
     }
 
     bool GetMipmapLayer( Interface *engineInterface, void *objMem, uint32 mipIndex, rawMipmapLayer& layerOut ) override;
+    bool GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut ) override;
     bool AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut ) override;
     void ClearMipmaps( Interface *engineInterface, void *objMem ) override;
 
@@ -8,9 +8,9 @@ namespace rw
 {
 
 // Draws all mipmap layers onto a mipmap.
-bool DebugDrawMipmaps( Interface *engineInterface, Raster *debugRaster, Bitmap& bmpOut )
+bool DebugDrawMipmaps( Interface *engineInterface, const Raster *debugRaster, Bitmap& bmpOut )
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( debugRaster ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( debugRaster ) );
 
     // Only proceed if we have native data.
     PlatformTexture *platformTex = debugRaster->platformData;
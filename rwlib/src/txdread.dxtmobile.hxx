@@ -193,6 +193,7 @@ struct dxtMobileNativeTextureTypeProvider : public texNativeTypeProvider
     }
 
     bool GetMipmapLayer( Interface *engineInterface, void *objMem, uint32 mipIndex, rawMipmapLayer& layerOut );
+    bool GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut );
     bool AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut );
     void ClearMipmaps( Interface *engineInterface, void *objMem );
 
@@ -973,6 +973,21 @@ bool gamecubeNativeTextureTypeProvider::GetMipmapLayer( Interface *engineInterfa
         );
 }
 
+bool gamecubeNativeTextureTypeProvider::GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut )
+{
+    NativeTextureGC *nativeTex = (NativeTextureGC*)objMem;
+
+    gcMipmapManager mipMan( nativeTex );
+
+    return
+        virtualGetMipmapLayerSize(
+            mipMan,
+            mipIndex,
+            nativeTex->mipmaps,
+            widthOut, heightOut
+        );
+}
+
 bool gamecubeNativeTextureTypeProvider::AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, texNativeTypeProvider::acquireFeedback_t& feedbackOut )
 {
     NativeTextureGC *nativeTex = (NativeTextureGC*)objMem;
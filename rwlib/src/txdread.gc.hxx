@@ -757,7 +757,7 @@ private:
         {
             pixelRGB5A3_t dstPixel;
 
-            bool hasNoAlpha = ( alpha == 255 );
+            bool hasNoAlpha = ( alpha == color_defaults <colorNumberType>::one );
 
             if ( hasNoAlpha )
             {
@@ -1374,6 +1374,7 @@ struct gamecubeNativeTextureTypeProvider : public texNativeTypeProvider
     }
 
     bool GetMipmapLayer( Interface *engineInterface, void *objMem, uint32 mipIndex, rawMipmapLayer& layerOut );
+    bool GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut );
     bool AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut );
     void ClearMipmaps( Interface *engineInterface, void *objMem );
 
@@ -105,8 +105,451 @@ AINLINE void GCProcessTiledCoordsFromLinear(
     }
 }
 
+// Specialized tile kernels.
+// A swizzled GC surface whose dimensions are aligned to the tile (cluster) size is nothing but a
+// linear stream of tiles. If the framework format is the direct counterpart of the native format
+// we can walk the tiles in memory order and move each texel with a fixed operation, instead of
+// permuting every texel coordinate and going through the abstract color dispatchers.
+enum eGCTileKernel
+{
+    GCTILEKERNEL_NONE,
+    GCTILEKERNEL_I4,        // LUM_4BIT <-> RASTER_LUM 4bit
+    GCTILEKERNEL_I8,        // LUM_8BIT <-> RASTER_LUM 8bit (stored linear)
+    GCTILEKERNEL_IA4,       // LUM_4BIT_ALPHA <-> RASTER_LUM_ALPHA 8bit
+    GCTILEKERNEL_IA8,       // LUM_8BIT_ALPHA <-> RASTER_LUM_ALPHA 16bit
+    GCTILEKERNEL_RGB565,    // RGB565 <-> RASTER_565 16bit
+    GCTILEKERNEL_RGB5A3,    // RGB5A3 <-> RASTER_8888 32bit
+    GCTILEKERNEL_RGBA8,     // RGBA8888 <-> RASTER_8888 32bit, AR and GB planes in one pass
+    GCTILEKERNEL_PAL4,      // PAL_4BIT <-> PALETTE_4BIT_LSB indices
+    GCTILEKERNEL_PAL8       // PAL_8BIT <-> PALETTE_8BIT indices
+};
+
+inline eGCTileKernel GCGetTileKernel(
+    eGCNativeTextureFormat internalFormat,
+    eRasterFormat frmRasterFormat, uint32 frmDepth, eColorOrdering frmColorOrder, ePaletteType frmPaletteType
+)
+{
+    if ( internalFormat == GVRFMT_PAL_4BIT )
+    {
+        if ( frmPaletteType == PALETTE_4BIT_LSB && frmDepth == 4 )
+        {
+            return GCTILEKERNEL_PAL4;
+        }
+        return GCTILEKERNEL_NONE;
+    }
+    if ( internalFormat == GVRFMT_PAL_8BIT )
+    {
+        if ( frmPaletteType == PALETTE_8BIT && frmDepth == 8 )
+        {
+            return GCTILEKERNEL_PAL8;
+        }
+        return GCTILEKERNEL_NONE;
+    }
+
+    if ( frmPaletteType != PALETTE_NONE )
+        return GCTILEKERNEL_NONE;
+
+    bool isRGBAOrder = ( frmColorOrder == COLOR_RGBA || frmColorOrder == COLOR_BGRA );
+
+    if ( internalFormat == GVRFMT_LUM_4BIT && frmRasterFormat == RASTER_LUM && frmDepth == 4 )
+    {
+        return GCTILEKERNEL_I4;
+    }
+    if ( internalFormat == GVRFMT_LUM_8BIT && frmRasterFormat == RASTER_LUM && frmDepth == 8 )
+    {
+        return GCTILEKERNEL_I8;
+    }
+    if ( internalFormat == GVRFMT_LUM_4BIT_ALPHA && frmRasterFormat == RASTER_LUM_ALPHA && frmDepth == 8 )
+    {
+        return GCTILEKERNEL_IA4;
+    }
+    if ( internalFormat == GVRFMT_LUM_8BIT_ALPHA && frmRasterFormat == RASTER_LUM_ALPHA && frmDepth == 16 )
+    {
+        return GCTILEKERNEL_IA8;
+    }
+    if ( internalFormat == GVRFMT_RGB565 && frmRasterFormat == RASTER_565 && frmDepth == 16 && frmColorOrder == COLOR_RGBA )
+    {
+        return GCTILEKERNEL_RGB565;
+    }
+    if ( internalFormat == GVRFMT_RGB5A3 && frmRasterFormat == RASTER_8888 && frmDepth == 32 && isRGBAOrder )
+    {
+        return GCTILEKERNEL_RGB5A3;
+    }
+    if ( internalFormat == GVRFMT_RGBA8888 && frmRasterFormat == RASTER_8888 && frmDepth == 32 && isRGBAOrder )
+    {
+        return GCTILEKERNEL_RGBA8;
+    }
+
+    return GCTILEKERNEL_NONE;
+}
+
+// Returns true if the native surface can be walked as a plain stream of tiles.
+inline bool GCIsLinearTileStream( uint32 surfWidth, uint32 surfHeight, uint32 clusterWidth, uint32 clusterHeight, uint32 depth, uint32 rowSize )
+{
+    return
+        ( surfWidth % clusterWidth ) == 0 &&
+        ( surfHeight % clusterHeight ) == 0 &&
+        ( (uint64)rowSize * 8 == (uint64)surfWidth * depth );
+}
+
+// Per-texel operations of the tile kernels.
+// tileIndex is the index of the texel inside of its tile, x the column in the framework row.
+template <typename nibbleType>
+struct gcTileNibbleKernel
+{
+    static const uint32 depth = 4;
+
+    AINLINE static void decode( const void *tile, uint32 tileIndex, void *dstRow, uint32 x, bool swapRedBlue )
+    {
+        uint8 val;
+        ( (const nibbleType*)tile )->getvalue( tileIndex, val );
+
+        ( (nibbleType*)dstRow )->setvalue( x, val );
+    }
+
+    AINLINE static void encode( const void *srcRow, uint32 x, void *tile, uint32 tileIndex, bool swapRedBlue )
+    {
+        uint8 val;
+        ( (const nibbleType*)srcRow )->getvalue( x, val );
+
+        ( (nibbleType*)tile )->setvalue( tileIndex, val );
+    }
+};
+
+struct gcTileByteKernel
+{
+    static const uint32 depth = 8;
+
+    AINLINE static void decode( const void *tile, uint32 tileIndex, void *dstRow, uint32 x, bool swapRedBlue )
+    {
+        *( (uint8*)dstRow + x ) = *( (const uint8*)tile + tileIndex );
+    }
+
+    AINLINE static void encode( const void *srcRow, uint32 x, void *tile, uint32 tileIndex, bool swapRedBlue )
+    {
+        *( (uint8*)tile + tileIndex ) = *( (const uint8*)srcRow + x );
+    }
+};
+
+// Native 16bit texels are big-endian versions of the framework layout.
+template <typename pixelType>
+struct gcTileSwapKernel
+{
+    static const uint32 depth = 16;
+
+    AINLINE static void decode( const void *tile, uint32 tileIndex, void *dstRow, uint32 x, bool swapRedBlue )
+    {
+        *( (pixelType*)dstRow + x ) = *( (const endian::big_endian <pixelType>*)tile + tileIndex );
+    }
+
+    AINLINE static void encode( const void *srcRow, uint32 x, void *tile, uint32 tileIndex, bool swapRedBlue )
+    {
+        *( (endian::big_endian <pixelType>*)tile + tileIndex ) = *( (const pixelType*)srcRow + x );
+    }
+};
+
+struct gcLumAlpha16_t
+{
+    uint8 lum;
+    uint8 alpha;
+};
+
+struct gcRGB565_t
+{
+    uint16 r : 5;
+    uint16 g : 6;
+    uint16 b : 5;
+};
+
+struct gcRGBA32_t
+{
+    uint8 r, g, b, a;
+};
+
+struct gcTileRGB5A3Kernel
+{
+    static const uint32 depth = 16;
+
+    AINLINE static void decode( const void *tile, uint32 tileIndex, void *dstRow, uint32 x, bool swapRedBlue )
+    {
+        pixelRGB5A3_t srcData = *( (const endian::big_endian <pixelRGB5A3_t>*)tile + tileIndex );
+
+        uint8 r, g, b, a;
+
+        if ( !srcData.hasNoAlpha )
+        {
+            destscalecolor( srcData.with_alpha.r, 15, r );
+            destscalecolor( srcData.with_alpha.g, 15, g );
+            destscalecolor( srcData.with_alpha.b, 15, b );
+            destscalecolor( srcData.with_alpha.a, 7, a );
+        }
+        else
+        {
+            destscalecolor( srcData.no_alpha.r, 31, r );
+            destscalecolor( srcData.no_alpha.g, 31, g );
+            destscalecolor( srcData.no_alpha.b, 31, b );
+            a = 255;
+        }
+
+        gcRGBA32_t& dstTexel = *( (gcRGBA32_t*)dstRow + x );
+
+        dstTexel.r = ( swapRedBlue ? b : r );
+        dstTexel.g = g;
+        dstTexel.b = ( swapRedBlue ? r : b );
+        dstTexel.a = a;
+    }
+
+    AINLINE static void encode( const void *srcRow, uint32 x, void *tile, uint32 tileIndex, bool swapRedBlue )
+    {
+        const gcRGBA32_t& srcTexel = *( (const gcRGBA32_t*)srcRow + x );
+
+        uint8 r = ( swapRedBlue ? srcTexel.b : srcTexel.r );
+        uint8 g = srcTexel.g;
+        uint8 b = ( swapRedBlue ? srcTexel.r : srcTexel.b );
+        uint8 a = srcTexel.a;
+
+        pixelRGB5A3_t dstPixel;
+
+        bool hasNoAlpha = ( a == 255 );
+
+        if ( hasNoAlpha )
+        {
+            dstPixel.no_alpha.r = putscalecolor <uint8> ( r, 31 );
+            dstPixel.no_alpha.g = putscalecolor <uint8> ( g, 31 );
+            dstPixel.no_alpha.b = putscalecolor <uint8> ( b, 31 );
+        }
+        else
+        {
+            dstPixel.with_alpha.a = putscalecolor <uint8> ( a, 7 );
+            dstPixel.with_alpha.r = putscalecolor <uint8> ( r, 15 );
+            dstPixel.with_alpha.g = putscalecolor <uint8> ( g, 15 );
+            dstPixel.with_alpha.b = putscalecolor <uint8> ( b, 15 );
+        }
+
+        dstPixel.hasNoAlpha = hasNoAlpha;
+
+        *( (endian::big_endian <pixelRGB5A3_t>*)tile + tileIndex ) = dstPixel;
+    }
+};
+
+// RGBA8888 tiles store 16 alpha-red pairs followed by 16 green-blue pairs.
+struct gcTileRGBA8Kernel
+{
+    static const uint32 depth = 32;
+
+    static const uint32 planeOffset = ( 4 * 4 * 2 );
+
+    AINLINE static void decode( const void *tile, uint32 tileIndex, void *dstRow, uint32 x, bool swapRedBlue )
+    {
+        const uint8 *ar = ( (const uint8*)tile + tileIndex * 2 );
+        const uint8 *gb = ( (const uint8*)tile + planeOffset + tileIndex * 2 );
+
+        gcRGBA32_t& dstTexel = *( (gcRGBA32_t*)dstRow + x );
+
+        dstTexel.r = ( swapRedBlue ? gb[1] : ar[1] );
+        dstTexel.g = gb[0];
+        dstTexel.b = ( swapRedBlue ? ar[1] : gb[1] );
+        dstTexel.a = ar[0];
+    }
+
+    AINLINE static void encode( const void *srcRow, uint32 x, void *tile, uint32 tileIndex, bool swapRedBlue )
+    {
+        const gcRGBA32_t& srcTexel = *( (const gcRGBA32_t*)srcRow + x );
+
+        uint8 *ar = ( (uint8*)tile + tileIndex * 2 );
+        uint8 *gb = ( (uint8*)tile + planeOffset + tileIndex * 2 );
+
+        ar[0] = srcTexel.a;
+        ar[1] = ( swapRedBlue ? srcTexel.b : srcTexel.r );
+        gb[0] = srcTexel.g;
+        gb[1] = ( swapRedBlue ? srcTexel.r : srcTexel.b );
+    }
+};
+
+// Unswizzles a tile stream into a framework layer.
+// The native surface must cover the layer.
+template <typename kernelType>
+AINLINE void GCDecodeTileStream(
+    const void *nativeTexels, uint32 surfWidth, uint32 surfHeight, uint32 clusterWidth, uint32 clusterHeight,
+    void *dstTexels, uint32 layerWidth, uint32 layerHeight, uint32 dstRowSize,
+    bool swapRedBlue
+)
+{
+    uint32 tileByteSize = ( clusterWidth * clusterHeight * kernelType::depth / 8 );
+
+    uint32 tilesWidth = ( surfWidth / clusterWidth );
+    uint32 tilesHeight = ( surfHeight / clusterHeight );
+
+    const uint8 *tilePtr = (const uint8*)nativeTexels;
+
+    for ( uint32 tile_y = 0; tile_y < tilesHeight; tile_y++ )
+    {
+        uint32 base_y = ( tile_y * clusterHeight );
+
+        uint32 rowCount = ( base_y < layerHeight ? std::min( clusterHeight, layerHeight - base_y ) : 0 );
+
+        for ( uint32 tile_x = 0; tile_x < tilesWidth; tile_x++, tilePtr += tileByteSize )
+        {
+            uint32 base_x = ( tile_x * clusterWidth );
+
+            if ( base_x >= layerWidth )
+                continue;
+
+            uint32 colCount = std::min( clusterWidth, layerWidth - base_x );
+
+            for ( uint32 local_y = 0; local_y < rowCount; local_y++ )
+            {
+                void *dstRow = getTexelDataRow( dstTexels, dstRowSize, base_y + local_y );
+
+                uint32 tileIndex = ( local_y * clusterWidth );
+
+                for ( uint32 local_x = 0; local_x < colCount; local_x++ )
+                {
+                    kernelType::decode( tilePtr, tileIndex + local_x, dstRow, base_x + local_x, swapRedBlue );
+                }
+            }
+        }
+    }
+}
+
+// Swizzles a framework layer into a tile stream.
+// Texels outside of the layer are left alone, so clear the native surface beforehand.
+template <typename kernelType>
+AINLINE void GCEncodeTileStream(
+    const void *srcTexels, uint32 layerWidth, uint32 layerHeight, uint32 srcRowSize,
+    void *nativeTexels, uint32 surfWidth, uint32 surfHeight, uint32 clusterWidth, uint32 clusterHeight,
+    bool swapRedBlue
+)
+{
+    uint32 tileByteSize = ( clusterWidth * clusterHeight * kernelType::depth / 8 );
+
+    uint32 tilesWidth = ( surfWidth / clusterWidth );
+    uint32 tilesHeight = ( surfHeight / clusterHeight );
+
+    uint8 *tilePtr = (uint8*)nativeTexels;
+
+    for ( uint32 tile_y = 0; tile_y < tilesHeight; tile_y++ )
+    {
+        uint32 base_y = ( tile_y * clusterHeight );
+
+        uint32 rowCount = ( base_y < layerHeight ? std::min( clusterHeight, layerHeight - base_y ) : 0 );
+
+        for ( uint32 tile_x = 0; tile_x < tilesWidth; tile_x++, tilePtr += tileByteSize )
+        {
+            uint32 base_x = ( tile_x * clusterWidth );
+
+            if ( base_x >= layerWidth )
+                continue;
+
+            uint32 colCount = std::min( clusterWidth, layerWidth - base_x );
+
+            for ( uint32 local_y = 0; local_y < rowCount; local_y++ )
+            {
+                const void *srcRow = getConstTexelDataRow( srcTexels, srcRowSize, base_y + local_y );
+
+                uint32 tileIndex = ( local_y * clusterWidth );
+
+                for ( uint32 local_x = 0; local_x < colCount; local_x++ )
+                {
+                    kernelType::encode( srcRow, base_x + local_x, tilePtr, tileIndex + local_x, swapRedBlue );
+                }
+            }
+        }
+    }
+}
+
+// Runs the decode or encode direction of a tile kernel.
+// Returns false if the kernel cannot process this surface, in which case nothing was touched.
+inline bool GCTransferTileKernel(
+    eGCTileKernel kernel, bool isDecoding,
+    void *nativeTexels, uint32 surfWidth, uint32 surfHeight, uint32 nativeRowSize,
+    uint32 nativeDepth, uint32 clusterWidth, uint32 clusterHeight,
+    void *frmTexels, uint32 layerWidth, uint32 layerHeight, uint32 frmRowSize, eColorOrdering frmColorOrder
+)
+{
+    if ( kernel == GCTILEKERNEL_NONE )
+        return false;
+
+    if ( surfWidth < layerWidth || surfHeight < layerHeight )
+        return false;
+
+    if ( kernel == GCTILEKERNEL_I8 )
+    {
+        // Not swizzled at all, so just move the rows.
+        for ( uint32 row = 0; row < layerHeight; row++ )
+        {
+            void *nativeRow = getTexelDataRow( nativeTexels, nativeRowSize, row );
+            void *frmRow = getTexelDataRow( frmTexels, frmRowSize, row );
+
+            if ( isDecoding )
+            {
+                memcpy( frmRow, nativeRow, layerWidth );
+            }
+            else
+            {
+                memcpy( nativeRow, frmRow, layerWidth );
+            }
+        }
+
+        return true;
+    }
+
+    if ( !GCIsLinearTileStream( surfWidth, surfHeight, clusterWidth, clusterHeight, nativeDepth, nativeRowSize ) )
+        return false;
+
+    bool swapRedBlue = ( frmColorOrder == COLOR_BGRA );
+
+#define GC_RUN_TILE_KERNEL( kernelType ) \
+    if ( isDecoding ) \
+    { \
+        GCDecodeTileStream <kernelType> ( \
+            nativeTexels, surfWidth, surfHeight, clusterWidth, clusterHeight, \
+            frmTexels, layerWidth, layerHeight, frmRowSize, swapRedBlue \
+        ); \
+    } \
+    else \
+    { \
+        GCEncodeTileStream <kernelType> ( \
+            frmTexels, layerWidth, layerHeight, frmRowSize, \
+            nativeTexels, surfWidth, surfHeight, clusterWidth, clusterHeight, swapRedBlue \
+        ); \
+    }
+
+    switch( kernel )
+    {
+    case GCTILEKERNEL_I4:       GC_RUN_TILE_KERNEL( gcTileNibbleKernel <PixelFormat::palette4bit> ); break;
+    case GCTILEKERNEL_PAL4:     GC_RUN_TILE_KERNEL( gcTileNibbleKernel <PixelFormat::palette4bit_lsb> ); break;
+    case GCTILEKERNEL_IA4:
+    case GCTILEKERNEL_PAL8:     GC_RUN_TILE_KERNEL( gcTileByteKernel ); break;
+    case GCTILEKERNEL_IA8:      GC_RUN_TILE_KERNEL( gcTileSwapKernel <gcLumAlpha16_t> ); break;
+    case GCTILEKERNEL_RGB565:   GC_RUN_TILE_KERNEL( gcTileSwapKernel <gcRGB565_t> ); break;
+    case GCTILEKERNEL_RGB5A3:   GC_RUN_TILE_KERNEL( gcTileRGB5A3Kernel ); break;
+    case GCTILEKERNEL_RGBA8:    GC_RUN_TILE_KERNEL( gcTileRGBA8Kernel ); break;
+    default:
+        return false;
+    }
+
+#undef GC_RUN_TILE_KERNEL
+
+    return true;
+}
+
 inline void DXTIndexListInverseCopy( uint32& dstIndexList, uint32 srcIndexList, uint32 blockPixelWidth, uint32 blockPixelHeight )
 {
+    if ( blockPixelWidth == 4 && blockPixelHeight == 4 )
+    {
+        // Flipping a 4x4 block in both directions reverses the order of its 16 2bit indices.
+        uint32 v = srcIndexList;
+
+        v = ( ( v >> 2 ) & 0x33333333 ) | ( ( v & 0x33333333 ) << 2 );
+        v = ( ( v >> 4 ) & 0x0F0F0F0F ) | ( ( v & 0x0F0F0F0F ) << 4 );
+        v = ( ( v >> 8 ) & 0x00FF00FF ) | ( ( v & 0x00FF00FF ) << 8 );
+        v = ( v >> 16 ) | ( v << 16 );
+
+        dstIndexList = v;
+        return;
+    }
+
     dstIndexList = 0;
 
     for ( uint32 local_y = 0; local_y < blockPixelHeight; local_y++ )
@@ -233,6 +676,12 @@ inline void ConvertGCMipmapToRasterFormat(
     void*& dstTexelDataOut, uint32& dstDataSizeOut
 )
 {
+    // The GC tile kernels unswizzle while they decode.
+    profilingScope profile( engineInterface, PROFSTAGE_SWIZZLE );
+
+    profile.AddTexels( (uint64)layerWidth * layerHeight );
+    profile.AddBytes( dataSize );
+
     // Check if we are a raw format that can be converted on a per-sample basis.
     if ( isGVRNativeFormatRawSample( internalFormat ) )
     {
@@ -272,7 +721,22 @@ inline void ConvertGCMipmapToRasterFormat(
         {
             uint32 srcRowSize = getGCRasterDataRowSize( mipWidth, srcDepth );
 
-            if ( internalFormat == GVRFMT_PAL_4BIT || internalFormat == GVRFMT_PAL_8BIT )
+            // Common format pairs are moved tile by tile.
+            eGCTileKernel tileKernel = GCGetTileKernel( internalFormat, dstRasterFormat, dstDepth, dstColorOrder, paletteType );
+
+            bool hasUsedTileKernel =
+                GCTransferTileKernel(
+                    tileKernel, true,
+                    texelSource, mipWidth, mipHeight, srcRowSize,
+                    srcDepth, clusterWidth, clusterHeight,
+                    dstTexels, layerWidth, layerHeight, dstRowSize, dstColorOrder
+                );
+
+            if ( hasUsedTileKernel )
+            {
+                // Nothing else to do.
+            }
+            else if ( internalFormat == GVRFMT_PAL_4BIT || internalFormat == GVRFMT_PAL_8BIT )
             {
                 assert( paletteType != PALETTE_NONE );
 
@@ -549,6 +1013,12 @@ inline void TranscodeIntoNativeGCLayer(
     void*& dstTexelsOut, uint32& dstDataSizeOut
 )
 {
+    // Same for encoding, the texels are swizzled while they are written.
+    profilingScope profile( engineInterface, PROFSTAGE_SWIZZLE );
+
+    profile.AddTexels( (uint64)layerWidth * layerHeight );
+    profile.AddBytes( srcDataSize );
+
     // We once again decide logic by the native format.
     // One could decide by source format, but I think that the native format is what we care most
     // about. Also, we are most flexible about the framework formats.
@@ -597,7 +1067,30 @@ inline void TranscodeIntoNativeGCLayer(
             // Process the layer.
             uint32 srcRowSize = getRasterDataRowSize( mipWidth, srcDepth, srcRowAlignment );
 
-            if ( internalFormat == GVRFMT_PAL_4BIT || internalFormat == GVRFMT_PAL_8BIT )
+            // Common format pairs are moved tile by tile.
+            // The kernels skip texels outside of the layer, which have to be cleared.
+            eGCTileKernel tileKernel = GCGetTileKernel( internalFormat, srcRasterFormat, srcDepth, srcColorOrder, srcPaletteType );
+
+            bool hasUsedTileKernel = false;
+
+            if ( tileKernel != GCTILEKERNEL_NONE )
+            {
+                memset( gcTexels, 0, gcDataSize );
+
+                hasUsedTileKernel =
+                    GCTransferTileKernel(
+                        tileKernel, false,
+                        gcTexels, gcSurfWidth, gcSurfHeight, gcRowSize,
+                        nativeDepth, clusterWidth, clusterHeight,
+                        (void*)srcTexels, layerWidth, layerHeight, srcRowSize, srcColorOrder
+                    );
+            }
+
+            if ( hasUsedTileKernel )
+            {
+                // Nothing else to do.
+            }
+            else if ( internalFormat == GVRFMT_PAL_4BIT || internalFormat == GVRFMT_PAL_8BIT )
             {
                 assert( srcPaletteType != PALETTE_NONE );
 
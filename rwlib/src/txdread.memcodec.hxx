@@ -770,6 +770,11 @@ struct genericMemoryEncoder
             
             if (permutationData_primCol != NULL && permutationData_secCol != NULL)
             {
+                profilingScope profile( engineInterface, PROFSTAGE_SWIZZLE );
+
+                profile.AddTexels( (uint64)rawWidth * rawHeight );
+                profile.AddBytes( dstDataSize );
+
                 // Permute!
                 permutationUtilities::permuteArray(
                     srcToBeTransformed, rawWidth, rawHeight, rawDepth, rawColumnWidth, rawColumnHeight,
@@ -8,7 +8,7 @@ namespace rw
 
 uint32 Raster::getMipmapCount( void ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     uint32 mipmapCount = 0;
 
@@ -190,9 +190,13 @@ inline void ensurePutIntoArray( dataType dataToPut, containerType& container, ui
 
 void Raster::generateMipmaps( uint32 maxMipmapCount, eMipmapGenerationMode mipGenMode )
 {
+    profilingScope profile( this->engineInterface, PROFSTAGE_MIPGEN );
+
     // Grab the bitmap of this texture, so we can generate mipmaps.
     Bitmap textureBitmap = this->getBitmap();
 
+    profile.AddTexels( (uint64)textureBitmap.getWidth() * textureBitmap.getHeight() );
+
     scoped_rwlock_writer <rwlock> rasterConsistency( GetRasterLock( this ) );
 
     // Make sure we are mutable.
@@ -59,6 +59,23 @@ struct d3dMipmapManager
 };
 #endif
 
+// Returns the real dimensions of a mipmap layer without fetching its texels.
+template <typename mipListType, typename mipManagerType>
+inline bool virtualGetMipmapLayerSize(
+    mipManagerType& mipManager,
+    uint32 mipIndex,
+    const mipListType& mipmaps,
+    uint32& widthOut, uint32& heightOut
+)
+{
+    if ( mipIndex >= mipmaps.size() )
+        return false;
+
+    mipManager.GetLayerDimensions( mipmaps[ mipIndex ], widthOut, heightOut );
+
+    return true;
+}
+
 template <typename mipDataType, typename mipListType, typename mipManagerType>
 inline bool virtualGetMipmapLayer(
     Interface *engineInterface, mipManagerType& mipManager,
@@ -15,7 +15,31 @@ namespace rw
 // Compatibility routines to make sure that pixel data can be properly pushed to
 // native textures.
 
-inline void CompatibilityTransformPixelData( Interface *engineInterface, pixelDataTraversal& pixelData, const texNativeTypeProvider *capsProvider )
+// Returns true if every mipmap layer can keep its texel buffer in the destination format.
+// For palette rasters this only looks at the index buffers.
+inline bool CanReuseMipmapBuffers( const pixelDataTraversal& pixelData, const pixelFormat& dstFormat )
+{
+    for ( const pixelDataTraversal::mipmapResource& mipLayer : pixelData.mipmaps )
+    {
+        bool needsConversion =
+            doesRawMipmapBufferNeedFullConversion(
+                mipLayer.width,
+                pixelData.rasterFormat, pixelData.depth, pixelData.rowAlignment, pixelData.colorOrder, pixelData.paletteType,
+                dstFormat.rasterFormat, dstFormat.depth, dstFormat.rowAlignment, dstFormat.colorOrder, dstFormat.paletteType
+            );
+
+        if ( needsConversion )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Decides the pixel format that the native texture needs and the cheapest way to get pixelData there.
+// This can be passthrough, palette only, repack or transcode.
+inline eRasterConversionPlan DecideCompatibilityPixelFormat( Interface *engineInterface, const pixelDataTraversal& pixelData, const texNativeTypeProvider *capsProvider, pixelFormat& dstFormatOut )
 {
     // Get the general capabilities struct that we have to obey.
     pixelCapabilities pixelCaps;
@@ -30,12 +54,9 @@ inline void CompatibilityTransformPixelData( Interface *engineInterface, pixelDa
     uint32 srcRowAlignment = pixelData.rowAlignment;
     eColorOrdering srcColorOrder = pixelData.colorOrder;
     ePaletteType srcPaletteType = pixelData.paletteType;
-    void *srcPaletteData = pixelData.paletteData;
     uint32 srcPaletteSize = pixelData.paletteSize;
     eCompressionType srcCompressionType = pixelData.compressionType;
 
-    uint32 srcMipmapCount = (uint32)pixelData.mipmaps.size();
-
     // Now decide the target format depending on the capabilities.
     eRasterFormat dstRasterFormat;
     uint32 dstDepth;
@@ -45,13 +66,12 @@ inline void CompatibilityTransformPixelData( Interface *engineInterface, pixelDa
     uint32 dstPaletteSize;
     eCompressionType dstCompressionType;
 
-    bool wantsUpdate =
-        TransformDestinationRasterFormat(
-            engineInterface,
-            srcRasterFormat, srcDepth, srcRowAlignment, srcColorOrder, srcPaletteType, srcPaletteSize, srcCompressionType,
-            dstRasterFormat, dstDepth, dstRowAlignment, dstColorOrder, dstPaletteType, dstPaletteSize, dstCompressionType,
-            pixelCaps, pixelData.hasAlpha
-        );
+    TransformDestinationRasterFormat(
+        engineInterface,
+        srcRasterFormat, srcDepth, srcRowAlignment, srcColorOrder, srcPaletteType, srcPaletteSize, srcCompressionType,
+        dstRasterFormat, dstDepth, dstRowAlignment, dstColorOrder, dstPaletteType, dstPaletteSize, dstCompressionType,
+        pixelCaps, pixelData.hasAlpha
+    );
 
     // Now the destination transformation is definately compatible with the native texture specification,
     // but there may be pitfalls due to ambiguity in raster format transformations.
@@ -71,36 +91,132 @@ inline void CompatibilityTransformPixelData( Interface *engineInterface, pixelDa
             if ( hasRecDepth )
             {
                 dstDepth = recDepth;
-
-                wantsUpdate = true;
             }
 
             if ( hasRecColorOrder )
             {
                 dstColorOrder = recColorOrder;
-
-                wantsUpdate = true;
             }
         }
     }
 
-    if ( wantsUpdate )
+    dstFormatOut.rasterFormat = dstRasterFormat;
+    dstFormatOut.depth = dstDepth;
+    dstFormatOut.rowAlignment = dstRowAlignment;
+    dstFormatOut.colorOrder = dstColorOrder;
+    dstFormatOut.paletteType = dstPaletteType;
+    dstFormatOut.compressionType = dstCompressionType;
+
+    // Changing the compression means decoding and/or encoding every texel.
+    if ( srcCompressionType != dstCompressionType )
     {
-        // Convert the pixels now.
-        bool hasUpdated;
+        return RASTERCONV_TRANSCODE;
+    }
+
+    // Compressed blocks (DXT between Direct3D, XBOX and mobile) do not care about any other property.
+    if ( srcCompressionType != RWCOMPRESS_NONE )
+    {
+        return RASTERCONV_PASSTHROUGH;
+    }
+
+    // Palettizing or reducing the palette has to look at every texel.
+    if ( dstPaletteType != PALETTE_NONE && dstPaletteType != srcPaletteType )
+    {
+        if ( srcPaletteType == PALETTE_NONE || srcPaletteType == PALETTE_8BIT )
         {
-            // Create a destination format struct.
-            pixelFormat dstPixelFormat;
+            return RASTERCONV_TRANSCODE;
+        }
+    }
+
+    if ( !CanReuseMipmapBuffers( pixelData, dstFormatOut ) )
+    {
+        return RASTERCONV_REPACK;
+    }
 
-            dstPixelFormat.rasterFormat = dstRasterFormat;
-            dstPixelFormat.depth = dstDepth;
-            dstPixelFormat.rowAlignment = dstRowAlignment;
-            dstPixelFormat.colorOrder = dstColorOrder;
-            dstPixelFormat.paletteType = dstPaletteType;
-            dstPixelFormat.compressionType = dstCompressionType;
+    // The index buffers stay, so only the palette colors might need work.
+    if ( srcPaletteType != PALETTE_NONE )
+    {
+        bool needsPaletteConversion =
+            doPaletteBuffersNeedConversion(
+                srcRasterFormat, srcColorOrder,
+                dstRasterFormat, dstColorOrder
+            );
 
-            hasUpdated = ConvertPixelData( engineInterface, pixelData, dstPixelFormat );
+        if ( needsPaletteConversion )
+        {
+            return RASTERCONV_PALETTE_ONLY;
         }
+    }
+
+    return RASTERCONV_PASSTHROUGH;
+}
+
+// Converts only the palette colors; the index buffers are kept as they are.
+inline void TransformPaletteColorsOnly( Interface *engineInterface, pixelDataTraversal& pixelData, const pixelFormat& dstFormat )
+{
+    profilingScope profile( engineInterface, PROFSTAGE_PIXELCONVERT );
+
+    eRasterFormat srcRasterFormat = pixelData.rasterFormat;
+    void *srcPaletteData = pixelData.paletteData;
+
+    uint32 dstPaletteSize = getPaletteItemCount( dstFormat.paletteType );
+
+    void *dstPaletteData = NULL;
+
+    TransformPaletteData(
+        engineInterface,
+        srcPaletteData,
+        pixelData.paletteSize, dstPaletteSize,
+        srcRasterFormat, pixelData.colorOrder,
+        dstFormat.rasterFormat, dstFormat.colorOrder,
+        true,
+        dstPaletteData
+    );
+
+    if ( dstPaletteData != srcPaletteData )
+    {
+        engineInterface->PixelFree( srcPaletteData );
+
+        pixelData.paletteData = dstPaletteData;
+    }
+
+    profile.AddTexels( dstPaletteSize );
+
+    pixelData.paletteSize = dstPaletteSize;
+    pixelData.rasterFormat = dstFormat.rasterFormat;
+    pixelData.colorOrder = dstFormat.colorOrder;
+    pixelData.rowAlignment = dstFormat.rowAlignment;
+
+    // Reordering the color channels cannot change the alpha, so only a new color format
+    // needs a look at the texels.
+    if ( srcRasterFormat != dstFormat.rasterFormat )
+    {
+        pixelData.hasAlpha = calculateHasAlpha( pixelData );
+    }
+}
+
+inline eRasterConversionPlan CompatibilityTransformPixelData( Interface *engineInterface, pixelDataTraversal& pixelData, const texNativeTypeProvider *capsProvider )
+{
+    pixelFormat dstPixelFormat;
+
+    eRasterConversionPlan plan = DecideCompatibilityPixelFormat( engineInterface, pixelData, capsProvider, dstPixelFormat );
+
+    if ( plan == RASTERCONV_PASSTHROUGH )
+    {
+        // The texel buffers fit the destination as they are.
+        if ( pixelData.compressionType == RWCOMPRESS_NONE )
+        {
+            pixelData.rowAlignment = dstPixelFormat.rowAlignment;
+        }
+    }
+    else if ( plan == RASTERCONV_PALETTE_ONLY )
+    {
+        TransformPaletteColorsOnly( engineInterface, pixelData, dstPixelFormat );
+    }
+    else
+    {
+        // Convert the pixels now.
+        bool hasUpdated = ConvertPixelData( engineInterface, pixelData, dstPixelFormat );
 
         // If we have updated at all, apply changes.
         if ( hasUpdated )
@@ -108,9 +224,11 @@ inline void CompatibilityTransformPixelData( Interface *engineInterface, pixelDa
             // We must have the correct parameters.
             // Here we verify problematic parameters only.
             // Params like rasterFormat are expected to be handled properly no matter what.
-            assert( pixelData.compressionType == dstCompressionType );
+            assert( pixelData.compressionType == dstPixelFormat.compressionType );
         }
     }
+
+    return plan;
 }
 
 static inline void TruncateMipmapLayer(
@@ -170,6 +170,53 @@ struct nativeTextureSizeRules
     }
 };
 
+// For native textures that do not store an alpha flag and have to scan their texels for it.
+// Remembers the result until the texels change; may be queried by many readers at once.
+struct cachedAlphaFlag
+{
+    inline cachedAlphaFlag( void ) : state( ALPHA_UNKNOWN )
+    {
+        return;
+    }
+
+    inline cachedAlphaFlag( const cachedAlphaFlag& right ) : state( right.state.load() )
+    {
+        return;
+    }
+
+    inline bool Get( bool& hasAlphaOut ) const
+    {
+        uint8 curState = this->state.load();
+
+        if ( curState == ALPHA_UNKNOWN )
+            return false;
+
+        hasAlphaOut = ( curState == ALPHA_TRANSPARENT );
+        return true;
+    }
+
+    inline void Set( bool hasAlpha ) const
+    {
+        this->state.store( hasAlpha ? ALPHA_TRANSPARENT : ALPHA_OPAQUE );
+    }
+
+    // Has to be called whenever the texels or the palette change.
+    inline void Invalidate( void )
+    {
+        this->state.store( ALPHA_UNKNOWN );
+    }
+
+private:
+    enum : uint8
+    {
+        ALPHA_UNKNOWN,
+        ALPHA_OPAQUE,
+        ALPHA_TRANSPARENT
+    };
+
+    mutable std::atomic <uint8> state;
+};
+
 struct texNativeTypeProvider abstract
 {
     inline texNativeTypeProvider( void )
@@ -225,6 +272,7 @@ struct texNativeTypeProvider abstract
 
     // Mipmap manipulation API.
     virtual bool            GetMipmapLayer( Interface *engineInterface, void *objMem, uint32 mipIndex, rawMipmapLayer& layerOut ) = 0;
+    virtual bool            GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut ) = 0;
     virtual bool            AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut ) = 0;
     virtual void            ClearMipmaps( Interface *engineInterface, void *objMem ) = 0;
 
@@ -10,6 +10,8 @@
 
 #include "txdread.palette.hxx"
 
+#include "txdread.palette.mediancut.hxx"
+
 #include "txdread.raster.hxx"
 
 #ifdef RWLIB_INCLUDE_LIBIMAGEQUANT
@@ -93,55 +95,85 @@ inline void nativePaletteRemap(
 }
 
 #ifdef RWLIB_INCLUDE_LIBIMAGEQUANT
-struct _fetch_texel_libquant_traverse
+// Returns the texels of a layer as tightly packed RGBA, which libimagequant can read without callbacks.
+// If the layer is not stored like that already, a converted copy is allocated into bufferOut.
+// That way every texel is converted only once, even though libimagequant reads the image more than once.
+static const void* _get_libquant_rgba_texels(
+    Interface *engineInterface,
+    const void *texelSource, uint32 width, uint32 height,
+    eRasterFormat rasterFormat, eColorOrdering colorOrder, uint32 itemDepth, uint32 rowAlignment,
+    ePaletteType paletteType, const void *paletteData, uint32 paletteSize,
+    void*& bufferOut
+)
 {
-    pixelDataTraversal *pixelData;
+    uint32 srcRowSize = getRasterDataRowSize( width, itemDepth, rowAlignment );
 
-    uint32 mipIndex;
-};
+    uint32 rgbaRowSize = ( width * sizeof(liq_color) );
 
-static void _fetch_image_data_libquant(liq_color row_out[], int row_index, int width, void *user_info)
-{
-    _fetch_texel_libquant_traverse *info = (_fetch_texel_libquant_traverse*)user_info;
+    bufferOut = NULL;
 
-    pixelDataTraversal *pixelData = info->pixelData;
+    if ( rasterFormat == RASTER_8888 && itemDepth == 32 && colorOrder == COLOR_RGBA &&
+         paletteType == PALETTE_NONE && srcRowSize == rgbaRowSize )
+    {
+        return texelSource;
+    }
+
+    void *rgbaTexels = engineInterface->PixelAllocate( rgbaRowSize * height );
 
-    // Fetch the color row.
-    pixelDataTraversal::mipmapResource& mipLayer = pixelData->mipmaps[ info->mipIndex ];
+    if ( rgbaTexels == NULL )
+    {
+        throw RwException( "failed to allocate libimagequant color buffer" );
+    }
 
-    const void *texelSource = mipLayer.texels;
+    try
+    {
+        EngineInterface *rwEngine = (EngineInterface*)engineInterface;
 
-    eRasterFormat rasterFormat = pixelData->rasterFormat;
-    ePaletteType paletteType = pixelData->paletteType;
+        colorModelDispatcher fetchDispatch( rasterFormat, colorOrder, itemDepth, paletteData, paletteSize, paletteType );
 
-    uint32 itemDepth = pixelData->depth;
+        uint32 bandHeight = GetParallelBandHeight( height, GetParallelWorkerCount( rwEngine ) );
 
-    eColorOrdering colorOrder = pixelData->colorOrder;
+        uint32 bandCount = ( bandHeight != 0 ? ( ( height + bandHeight - 1 ) / bandHeight ) : 0 );
 
-    void *palColors = pixelData->paletteData;
-    uint32 palColorCount = pixelData->paletteSize;
+        ParallelForEach( rwEngine, bandCount,
+            [&]( size_t bandIndex )
+        {
+            uint32 startRow = (uint32)( bandIndex * bandHeight );
+            uint32 endRow = std::min( height, startRow + bandHeight );
 
-    // Get the row of colors.
-    uint32 srcRowSize = getRasterDataRowSize( mipLayer.layerWidth, itemDepth, pixelData->rowAlignment );
-    
-    const void *srcRow = getConstTexelDataRow( texelSource, srcRowSize, row_index );
+            for ( uint32 row = startRow; row < endRow; row++ )
+            {
+                const void *srcRow = getConstTexelDataRow( texelSource, srcRowSize, row );
 
-    colorModelDispatcher fetchDispatch( rasterFormat, colorOrder, itemDepth, palColors, palColorCount, paletteType );
+                liq_color *dstRow = (liq_color*)getTexelDataRow( rgbaTexels, rgbaRowSize, row );
 
-    for (int n = 0; n < width; n++)
-    {
-        // Fetch the color.
-        uint8 r, g, b, a;
+                for ( uint32 col = 0; col < width; col++ )
+                {
+                    liq_color& outColor = dstRow[ col ];
 
-        fetchDispatch.getRGBA( srcRow, n, r, g, b, a );
+                    bool hasColor = fetchDispatch.getRGBA( srcRow, col, outColor.r, outColor.g, outColor.b, outColor.a );
 
-        // Store the color.
-        liq_color& outColor = row_out[ n ];
-        outColor.r = r;
-        outColor.g = g;
-        outColor.b = b;
-        outColor.a = a;
+                    if ( !hasColor )
+                    {
+                        outColor.r = 0;
+                        outColor.g = 0;
+                        outColor.b = 0;
+                        outColor.a = 0;
+                    }
+                }
+            }
+        });
     }
+    catch( ... )
+    {
+        engineInterface->PixelFree( rgbaTexels );
+
+        throw;
+    }
+
+    bufferOut = rgbaTexels;
+
+    return rgbaTexels;
 }
 #endif //RWLIB_INCLUDE_LIBIMAGEQUANT
 
@@ -169,6 +201,10 @@ void PalettizePixelData( Interface *engineInterface, pixelDataTraversal& pixelDa
     if (srcPaletteType == convPaletteFormat)
         return;
 
+    profilingScope profile( engineInterface, PROFSTAGE_PALETTIZE );
+
+    profile.AddPixelData( pixelData );
+
     // Get the source format.
     eRasterFormat srcRasterFormat = pixelData.rasterFormat;
     eColorOrdering srcColorOrder = pixelData.colorOrder;
@@ -340,6 +376,78 @@ void PalettizePixelData( Interface *engineInterface, pixelDataTraversal& pixelDa
             pixelData.paletteData = conv.makepalette(engineInterface, dstRasterFormat, dstColorOrder);
             pixelData.paletteSize = (uint32)conv.texelElimData.size();
 
+            palettizeSuccess = true;
+        }
+        else if (useRuntime == PALRUNTIME_MEDIANCUT)
+        {
+            medianCutPalettizer conv;
+
+            // Build the color histogram of the first texture.
+            if ( mipmapCount > 0 )
+            {
+                pixelDataTraversal::mipmapResource& mainLayer = pixelData.mipmaps[ 0 ];
+
+                uint32 srcRowSize = getRasterDataRowSize( mainLayer.width, srcDepth, srcRowAlignment );
+
+                conv.buildhistogram(
+                    engineInterface,
+                    mainLayer.texels, mainLayer.layerWidth, mainLayer.layerHeight, srcRowSize,
+                    srcRasterFormat, srcColorOrder, srcDepth,
+                    srcPaletteType, srcPaletteData, srcPaletteCount
+                );
+            }
+
+            conv.constructpalette(engineInterface, maxPaletteEntries);
+
+            // We need the palette before the old mipmap data goes away.
+            void *newPaletteData = conv.makepalette(engineInterface, dstRasterFormat, dstColorOrder);
+
+            try
+            {
+                for (uint32 n = 0; n < mipmapCount; n++)
+                {
+                    pixelDataTraversal::mipmapResource& mipLayer = pixelData.mipmaps[ n ];
+
+                    void *texelSource = mipLayer.texels;
+
+                    uint32 dataSize = 0;
+                    void *newTexelData = NULL;
+
+                    medianCutPalettizer::remaplayer(
+                        engineInterface,
+                        conv.paletteColors, convPaletteFormat, dstDepth,
+                        texelSource, mipLayer.width, mipLayer.height,
+                        srcPaletteType, srcPaletteData, srcPaletteCount, srcRasterFormat, srcColorOrder, srcDepth,
+                        srcRowAlignment, dstRowAlignment,
+                        newTexelData, dataSize
+                    );
+
+                    if ( texelSource )
+                    {
+                        engineInterface->PixelFree( texelSource );
+                    }
+
+                    mipLayer.texels = newTexelData;
+                    mipLayer.dataSize = dataSize;
+                }
+            }
+            catch( ... )
+            {
+                engineInterface->PixelFree( newPaletteData );
+
+                throw;
+            }
+
+            if (srcPaletteData != NULL)
+            {
+                engineInterface->PixelFree( srcPaletteData );
+
+                pixelData.paletteData = NULL;
+            }
+
+            pixelData.paletteData = newPaletteData;
+            pixelData.paletteSize = (uint32)conv.paletteColors.size();
+
             palettizeSuccess = true;
         }
 #ifdef RWLIB_INCLUDE_LIBIMAGEQUANT
@@ -356,21 +464,32 @@ void PalettizePixelData( Interface *engineInterface, pixelDataTraversal& pixelDa
             {
                 liq_set_max_colors(quant_attr, maxPaletteEntries);
 
-                _fetch_texel_libquant_traverse main_traverse;
+                pixelDataTraversal::mipmapResource& mainLayer = pixelData.mipmaps[ 0 ];
 
-                main_traverse.pixelData = &pixelData;
-                main_traverse.mipIndex = 0;
+                // The main layer is read for quantization and remapping, so convert it just once.
+                void *mainRGBABuffer = NULL;
 
-                pixelDataTraversal::mipmapResource& mainLayer = pixelData.mipmaps[ 0 ];
+                const void *mainRGBATexels = _get_libquant_rgba_texels(
+                    engineInterface,
+                    mainLayer.texels, mainLayer.width, mainLayer.height,
+                    srcRasterFormat, srcColorOrder, srcDepth, srcRowAlignment,
+                    srcPaletteType, srcPaletteData, srcPaletteCount,
+                    mainRGBABuffer
+                );
 
-                liq_image *quant_image = liq_image_create_custom(
-                    quant_attr, _fetch_image_data_libquant, &main_traverse,
+                liq_image *quant_image = liq_image_create_rgba(
+                    quant_attr, (void*)mainRGBATexels,
                     mainLayer.width, mainLayer.height,
                     1.0
                 );
 
                 if ( quant_image == NULL )
                 {
+                    if ( mainRGBABuffer )
+                    {
+                        engineInterface->PixelFree( mainRGBABuffer );
+                    }
+
                     throw RwException( "failed to allocate libimagequant image struct for palettization" );
                 }
 
@@ -411,7 +530,7 @@ void PalettizePixelData( Interface *engineInterface, pixelDataTraversal& pixelDa
                                 liq_image *srcImage = NULL;
                                 bool newImage = false;
 
-                                _fetch_texel_libquant_traverse thisTraverse;
+                                void *mipRGBABuffer = NULL;
 
                                 if ( n == 0 )
                                 {
@@ -420,17 +539,28 @@ void PalettizePixelData( Interface *engineInterface, pixelDataTraversal& pixelDa
                                 else
                                 {
                                     // Create a new image.
-                                    thisTraverse.pixelData = &pixelData;
-                                    thisTraverse.mipIndex = n;
+                                    // The quantization result of the main layer is reused for it.
+                                    const void *mipRGBATexels = _get_libquant_rgba_texels(
+                                        engineInterface,
+                                        mipLayer.texels, mipWidth, mipHeight,
+                                        srcRasterFormat, srcColorOrder, srcDepth, srcRowAlignment,
+                                        srcPaletteType, srcPaletteData, srcPaletteCount,
+                                        mipRGBABuffer
+                                    );
 
-                                    srcImage = liq_image_create_custom(
-                                        quant_attr, _fetch_image_data_libquant, &thisTraverse,
+                                    srcImage = liq_image_create_rgba(
+                                        quant_attr, (void*)mipRGBATexels,
                                         mipWidth, mipHeight,
                                         1.0
                                     );
 
                                     if ( srcImage == NULL )
                                     {
+                                        if ( mipRGBABuffer )
+                                        {
+                                            engineInterface->PixelFree( mipRGBABuffer );
+                                        }
+
                                         throw RwException( "failed to allocate libimagequant image handle for palettization" );
                                     }
 
@@ -455,6 +585,11 @@ void PalettizePixelData( Interface *engineInterface, pixelDataTraversal& pixelDa
                                         liq_image_destroy( srcImage );
                                     }
 
+                                    if ( mipRGBABuffer )
+                                    {
+                                        engineInterface->PixelFree( mipRGBABuffer );
+                                    }
+
                                     throw;
                                 }
 
@@ -464,6 +599,11 @@ void PalettizePixelData( Interface *engineInterface, pixelDataTraversal& pixelDa
                                     liq_image_destroy( srcImage );
                                 }
 
+                                if ( mipRGBABuffer )
+                                {
+                                    engineInterface->PixelFree( mipRGBABuffer );
+                                }
+
                                 // Update the texels.
                                 engineInterface->PixelFree( mipLayer.texels );
 
@@ -598,10 +738,20 @@ void PalettizePixelData( Interface *engineInterface, pixelDataTraversal& pixelDa
                 {
                     liq_image_destroy( quant_image );
 
+                    if ( mainRGBABuffer )
+                    {
+                        engineInterface->PixelFree( mainRGBABuffer );
+                    }
+
                     throw;
                 }
 
                 liq_image_destroy( quant_image );
+
+                if ( mainRGBABuffer )
+                {
+                    engineInterface->PixelFree( mainRGBABuffer );
+                }
             }
             catch( ... )
             {
@@ -810,7 +960,7 @@ void Raster::convertToPalette( ePaletteType paletteType, eRasterFormat newRaster
 
 ePaletteType Raster::getPaletteType( void ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -831,46 +981,6 @@ ePaletteType Raster::getPaletteType( void ) const
     return texProvider->GetTexturePaletteType( platformTex );
 }
 
-struct liq_mipmap
-{
-    const void *texelSource;
-    uint32 rowSize;
-
-    eRasterFormat rasterFormat;
-    eColorOrdering colorOrder;
-    uint32 depth;
-    uint32 rowAlignment;
-
-    ePaletteType paletteType;
-    const void *paletteData;
-    uint32 paletteSize;
-};
-
-static void liq_single_mip_rgba_fetch_callback( liq_color row_out[], int row, int width, void *ud )
-{
-    const liq_mipmap *imgData = (const liq_mipmap*)ud;
-
-    const void *texelSource = imgData->texelSource;
-
-    colorModelDispatcher fetchDispatch(
-        imgData->rasterFormat, imgData->colorOrder, imgData->depth,
-        imgData->paletteData, imgData->paletteSize, imgData->paletteType
-    );
-
-    uint32 srcRowSize = imgData->rowSize;
-
-    const void *srcRowData = getConstTexelDataRow( texelSource, srcRowSize, row );
-
-    for ( int col = 0; col < width; col++ )
-    {
-        liq_color& colorOut = row_out[ col ];
-
-        fetchDispatch.getRGBA(
-            srcRowData, col, colorOut.r, colorOut.g, colorOut.b, colorOut.a
-        );
-    }
-}
-
 void RemapMipmapLayer(
     Interface *engineInterface,
     eRasterFormat palRasterFormat, eColorOrdering palColorOrder,
@@ -939,6 +1049,34 @@ void RemapMipmapLayer(
             dstTexelsOut, dstTexelDataSizeOut
         );
     }
+    else if ( palRuntimeType == PALRUNTIME_MEDIANCUT )
+    {
+        medianCutPalettizer::paletteContainer_t paletteColors( paletteSize );
+
+        for ( uint32 n = 0; n < paletteSize; n++ )
+        {
+            medianCutPalettizer::color_t& palColor = paletteColors[ n ];
+
+            bool hasColor = fetchPalDispatch.getRGBA( paletteData, n, palColor.red, palColor.green, palColor.blue, palColor.alpha );
+
+            if ( !hasColor )
+            {
+                palColor.red = 0;
+                palColor.green = 0;
+                palColor.blue = 0;
+                palColor.alpha = 0;
+            }
+        }
+
+        medianCutPalettizer::remaplayer(
+            engineInterface,
+            paletteColors, convPaletteType, convItemDepth,
+            mipTexels, mipWidth, mipHeight, mipPaletteType, mipPaletteData, mipPaletteSize,
+            mipRasterFormat, mipColorOrder, mipDepth,
+            srcRowAlignment, dstRowAlignment,
+            dstTexelsOut, dstTexelDataSizeOut
+        );
+    }
     else if ( palRuntimeType == PALRUNTIME_PNGQUANT )
     {
         liq_attr *liq_attr = liq_attr_create();
@@ -953,6 +1091,9 @@ void RemapMipmapLayer(
         void *newtexels = NULL;
         uint32 dstDataSize = 0;
 
+        // Converted colors of the mipmap layer, if it was not RGBA already.
+        void *mipRGBABuffer = NULL;
+
         try
         {
             // Disallow libimagequant from sorting our colors.
@@ -960,20 +1101,17 @@ void RemapMipmapLayer(
 
             // Since we want to remap an image, we want to create an image handle.
             // Then we want to copy palette into the library's memory and use it to search for colors.
-            liq_mipmap mipData;
-            mipData.texelSource = mipTexels;
-            mipData.rowSize = getRasterDataRowSize( mipWidth, mipDepth, srcRowAlignment );
-            mipData.rasterFormat = mipRasterFormat;
-            mipData.depth = mipDepth;
-            mipData.rowAlignment = srcRowAlignment;
-            mipData.colorOrder = mipColorOrder;
-            mipData.paletteType = mipPaletteType;
-            mipData.paletteData = mipPaletteData;
-            mipData.paletteSize = mipPaletteSize;
-        
+            const void *mipRGBATexels = _get_libquant_rgba_texels(
+                engineInterface,
+                mipTexels, mipWidth, mipHeight,
+                mipRasterFormat, mipColorOrder, mipDepth, srcRowAlignment,
+                mipPaletteType, mipPaletteData, mipPaletteSize,
+                mipRGBABuffer
+            );
+
             liq_image *liq_mip_layer =
-                liq_image_create_custom(
-                    liq_attr, liq_single_mip_rgba_fetch_callback, &mipData,
+                liq_image_create_rgba(
+                    liq_attr, (void*)mipRGBATexels,
                     mipWidth, mipHeight,
                     1.0
                 );
@@ -1139,11 +1277,21 @@ void RemapMipmapLayer(
                 engineInterface->PixelFree( newtexels );
             }
 
+            if ( mipRGBABuffer )
+            {
+                engineInterface->PixelFree( mipRGBABuffer );
+            }
+
             liq_attr_destroy( liq_attr );
 
             throw;
         }
 
+        if ( mipRGBABuffer )
+        {
+            engineInterface->PixelFree( mipRGBABuffer );
+        }
+
         liq_attr_destroy( liq_attr );
 
         assert( newtexels != NULL && dstDataSize != 0 );
@@ -0,0 +1,846 @@
+// Parallel median-cut palettizer (PALRUNTIME_MEDIANCUT).
+// The color histogram of the source image is built in row bands on the worker threads, over rows
+// that are read as packed RGBA, and merged in bucket order. Median-cut splits it into palette boxes
+// which are then refined by a few k-means passes over the histogram.
+// Remapping is done band by band again, with a small color cache per band.
+
+#ifndef _RENDERWARE_PALETTE_MEDIANCUT_
+#define _RENDERWARE_PALETTE_MEDIANCUT_
+
+#include "pixelformat.hxx"
+
+#include "rwthreading.parallel.hxx"
+
+#include <vector>
+#include <algorithm>
+
+namespace rw
+{
+
+struct medianCutPalettizer
+{
+    struct color_t
+    {
+        uint8 red;
+        uint8 green;
+        uint8 blue;
+        uint8 alpha;
+    };
+
+    typedef std::vector <color_t> paletteContainer_t;
+
+    // Texels are bucketed by the upper 5 bits of each channel, so there are only 2^20 buckets.
+    // Each bucket keeps the sums of its real colors so the palette does not lose precision.
+    struct histEntry_t
+    {
+        uint32 key;
+        uint32 count;
+        uint64 sums[4];
+        uint8 avg[4];
+    };
+
+    typedef std::vector <histEntry_t> histogram_t;
+
+    histogram_t histogram;
+
+    paletteContainer_t paletteColors;
+
+    static AINLINE uint32 packcolor( uint8 red, uint8 green, uint8 blue, uint8 alpha )
+    {
+        return ( (uint32)red << 24 ) | ( (uint32)green << 16 ) | ( (uint32)blue << 8 ) | (uint32)alpha;
+    }
+
+    static const uint32 bucketKeyCount = ( 1u << 20 );
+
+    static AINLINE uint32 getbucketkey( uint8 red, uint8 green, uint8 blue, uint8 alpha )
+    {
+        return ( (uint32)( red >> 3 ) << 15 ) | ( (uint32)( green >> 3 ) << 10 ) | ( (uint32)( blue >> 3 ) << 5 ) | (uint32)( alpha >> 3 );
+    }
+
+    // Histogram of a single band.
+    // Most bands only touch a few of the buckets, so they are found through a small hash table
+    // that grows with the number of used buckets instead of taking a slot for each of them.
+    struct bandHistogram
+    {
+        inline bandHistogram( void )
+        {
+            this->slotBits = 10;
+            this->slots.resize( 1u << this->slotBits, 0 );
+        }
+
+        AINLINE uint32 getslot( uint32 key ) const
+        {
+            return ( ( key * 2654435761u ) >> ( 32 - this->slotBits ) );
+        }
+
+        inline void growslots( void )
+        {
+            this->slotBits++;
+
+            this->slots.assign( 1u << this->slotBits, 0 );
+
+            uint32 slotMask = ( ( 1u << this->slotBits ) - 1 );
+
+            for ( size_t n = 0; n < this->entries.size(); n++ )
+            {
+                uint32 slot = getslot( this->entries[ n ].key );
+
+                while ( this->slots[ slot ] != 0 )
+                {
+                    slot = ( ( slot + 1 ) & slotMask );
+                }
+
+                this->slots[ slot ] = (uint32)( n + 1 );
+            }
+        }
+
+        AINLINE void addcolor( uint8 red, uint8 green, uint8 blue, uint8 alpha )
+        {
+            uint32 key = getbucketkey( red, green, blue, alpha );
+
+            uint32 slotMask = ( ( 1u << this->slotBits ) - 1 );
+
+            uint32 slot = getslot( key );
+
+            while ( true )
+            {
+                uint32 entryIndex = this->slots[ slot ];
+
+                if ( entryIndex == 0 )
+                {
+                    break;
+                }
+
+                histEntry_t& entry = this->entries[ entryIndex - 1 ];
+
+                if ( entry.key == key )
+                {
+                    entry.count++;
+                    entry.sums[0] += red;
+                    entry.sums[1] += green;
+                    entry.sums[2] += blue;
+                    entry.sums[3] += alpha;
+                    return;
+                }
+
+                slot = ( ( slot + 1 ) & slotMask );
+            }
+
+            histEntry_t newEntry;
+            newEntry.key = key;
+            newEntry.count = 1;
+            newEntry.sums[0] = red;
+            newEntry.sums[1] = green;
+            newEntry.sums[2] = blue;
+            newEntry.sums[3] = alpha;
+
+            this->entries.push_back( newEntry );
+
+            this->slots[ slot ] = (uint32)this->entries.size();
+
+            // Keep the table at most half full.
+            if ( this->entries.size() * 2 > this->slots.size() )
+            {
+                growslots();
+            }
+        }
+
+        uint32 slotBits;
+        std::vector <uint32> slots;     // entry index + 1, zero if free
+        histogram_t entries;
+    };
+
+    // Reads whole rows of a layer as RGBA colors, so that the loops over the texels do not
+    // go through the color dispatcher for every texel. 8888 texels are read directly and
+    // palette colors are decoded only once; anything else is fetched through the dispatcher.
+    struct rgbaRowReader
+    {
+        inline rgbaRowReader(
+            eRasterFormat srcRasterFormat, eColorOrdering srcColorOrder, uint32 srcItemDepth,
+            ePaletteType srcPaletteType, const void *srcPaletteData, uint32 srcPaletteCount
+        ) : fetchDispatch( srcRasterFormat, srcColorOrder, srcItemDepth, srcPaletteData, srcPaletteCount, srcPaletteType )
+        {
+            this->srcColorOrder = srcColorOrder;
+            this->srcItemDepth = srcItemDepth;
+            this->srcPaletteType = srcPaletteType;
+            this->srcPaletteCount = srcPaletteCount;
+
+            this->isDirect =
+                ( srcPaletteType == PALETTE_NONE && srcRasterFormat == RASTER_8888 && srcItemDepth == 32 &&
+                  ( srcColorOrder == COLOR_RGBA || srcColorOrder == COLOR_BGRA ) );
+
+            if ( srcPaletteType != PALETTE_NONE )
+            {
+                colorModelDispatcher palDispatch( srcRasterFormat, srcColorOrder, Bitmap::getRasterFormatDepth( srcRasterFormat ), NULL, 0, PALETTE_NONE );
+
+                this->paletteColors.resize( srcPaletteCount );
+
+                for ( uint32 n = 0; n < srcPaletteCount; n++ )
+                {
+                    color_t& palColor = this->paletteColors[ n ];
+
+                    if ( !palDispatch.getRGBA( srcPaletteData, n, palColor.red, palColor.green, palColor.blue, palColor.alpha ) )
+                    {
+                        palColor.red = 0;
+                        palColor.green = 0;
+                        palColor.blue = 0;
+                        palColor.alpha = 0;
+                    }
+                }
+            }
+        }
+
+        // Texels without a color are returned as zero with a cleared flag.
+        AINLINE void readrow( const void *srcRow, uint32 width, color_t *colorsOut, uint8 *hasColorOut )
+        {
+            if ( this->isDirect )
+            {
+                const PixelFormat::pixeldata32bit *srcTexels = (const PixelFormat::pixeldata32bit*)srcRow;
+
+                bool isBGRA = ( this->srcColorOrder == COLOR_BGRA );
+
+                for ( uint32 col = 0; col < width; col++ )
+                {
+                    const PixelFormat::pixeldata32bit& srcTexel = srcTexels[ col ];
+
+                    color_t& color = colorsOut[ col ];
+
+                    color.red = ( isBGRA ? srcTexel.blue : srcTexel.red );
+                    color.green = srcTexel.green;
+                    color.blue = ( isBGRA ? srcTexel.red : srcTexel.blue );
+                    color.alpha = srcTexel.alpha;
+
+                    hasColorOut[ col ] = true;
+                }
+            }
+            else if ( this->srcPaletteType != PALETTE_NONE )
+            {
+                for ( uint32 col = 0; col < width; col++ )
+                {
+                    uint8 paletteIndex;
+
+                    bool hasIndex = getpaletteindex( srcRow, this->srcPaletteType, this->srcPaletteCount, this->srcItemDepth, col, paletteIndex );
+
+                    if ( hasIndex )
+                    {
+                        colorsOut[ col ] = this->paletteColors[ paletteIndex ];
+                    }
+                    else
+                    {
+                        colorsOut[ col ] = color_t();
+                    }
+
+                    hasColorOut[ col ] = hasIndex;
+                }
+            }
+            else
+            {
+                for ( uint32 col = 0; col < width; col++ )
+                {
+                    color_t& color = colorsOut[ col ];
+
+                    bool hasColor = this->fetchDispatch.getRGBA( srcRow, col, color.red, color.green, color.blue, color.alpha );
+
+                    if ( !hasColor )
+                    {
+                        color = color_t();
+                    }
+
+                    hasColorOut[ col ] = hasColor;
+                }
+            }
+        }
+
+    private:
+        colorModelDispatcher fetchDispatch;
+
+        eColorOrdering srcColorOrder;
+        uint32 srcItemDepth;
+        ePaletteType srcPaletteType;
+        uint32 srcPaletteCount;
+
+        bool isDirect;
+
+        paletteContainer_t paletteColors;
+    };
+
+    // Builds the color histogram of an image layer.
+    // Every band fills its own histogram so that the workers never share memory.
+    inline void buildhistogram(
+        Interface *engineInterface,
+        const void *texelSource, uint32 layerWidth, uint32 layerHeight, uint32 srcRowSize,
+        eRasterFormat srcRasterFormat, eColorOrdering srcColorOrder, uint32 srcItemDepth,
+        ePaletteType srcPaletteType, const void *srcPaletteData, uint32 srcPaletteCount
+    )
+    {
+        EngineInterface *rwEngine = (EngineInterface*)engineInterface;
+
+        uint32 bandHeight = GetParallelBandHeight( layerHeight, GetParallelWorkerCount( rwEngine ) );
+
+        if ( bandHeight == 0 )
+            return;
+
+        uint32 bandCount = ( ( layerHeight + bandHeight - 1 ) / bandHeight );
+
+        std::vector <bandHistogram> bandHistograms( bandCount );
+
+        rgbaRowReader rowReader( srcRasterFormat, srcColorOrder, srcItemDepth, srcPaletteType, srcPaletteData, srcPaletteCount );
+
+        ParallelForEach( rwEngine, bandCount,
+            [&]( size_t bandIndex )
+        {
+            uint32 startRow = (uint32)( bandIndex * bandHeight );
+            uint32 endRow = std::min( layerHeight, startRow + bandHeight );
+
+            bandHistogram& bandHist = bandHistograms[ bandIndex ];
+
+            std::vector <color_t> rowColors( layerWidth );
+            std::vector <uint8> rowHasColor( layerWidth );
+
+            for ( uint32 row = startRow; row < endRow; row++ )
+            {
+                const void *srcRow = getConstTexelDataRow( texelSource, srcRowSize, row );
+
+                rowReader.readrow( srcRow, layerWidth, rowColors.data(), rowHasColor.data() );
+
+                for ( uint32 col = 0; col < layerWidth; col++ )
+                {
+                    if ( rowHasColor[ col ] )
+                    {
+                        const color_t& color = rowColors[ col ];
+
+                        bandHist.addcolor( color.red, color.green, color.blue, color.alpha );
+                    }
+                }
+            }
+
+            // The lookup table is not needed anymore.
+            std::vector <uint32> ().swap( bandHist.slots );
+        });
+
+        // The buckets are stored in key order, so that the palette does not depend on the band layout.
+        histogram.clear();
+
+        size_t bandEntryCount = 0;
+
+        for ( const bandHistogram& bandHist : bandHistograms )
+        {
+            bandEntryCount += bandHist.entries.size();
+        }
+
+        if ( bandEntryCount < bucketKeyCount / 16 )
+        {
+            // Small images only use a few buckets, so sorting them is cheaper than
+            // clearing a table of all buckets.
+            histogram_t bandEntries;
+            bandEntries.reserve( bandEntryCount );
+
+            for ( bandHistogram& bandHist : bandHistograms )
+            {
+                bandEntries.insert( bandEntries.end(), bandHist.entries.begin(), bandHist.entries.end() );
+
+                histogram_t ().swap( bandHist.entries );
+            }
+
+            std::sort( bandEntries.begin(), bandEntries.end(),
+                []( const histEntry_t& left, const histEntry_t& right )
+            {
+                return ( left.key < right.key );
+            });
+
+            for ( const histEntry_t& entry : bandEntries )
+            {
+                if ( !histogram.empty() && histogram.back().key == entry.key )
+                {
+                    histEntry_t& mergedEntry = histogram.back();
+
+                    mergedEntry.count += entry.count;
+
+                    for ( uint32 c = 0; c < 4; c++ )
+                    {
+                        mergedEntry.sums[c] += entry.sums[c];
+                    }
+                }
+                else
+                {
+                    histogram.push_back( entry );
+                }
+            }
+        }
+        else
+        {
+            // Merge the band histograms through a direct table of all buckets.
+            std::vector <uint32> mergedIndices( bucketKeyCount, 0 );
+
+            histogram_t mergedEntries;
+
+            for ( bandHistogram& bandHist : bandHistograms )
+            {
+                for ( const histEntry_t& entry : bandHist.entries )
+                {
+                    uint32& mergedIndex = mergedIndices[ entry.key ];
+
+                    if ( mergedIndex == 0 )
+                    {
+                        mergedEntries.push_back( entry );
+
+                        mergedIndex = (uint32)mergedEntries.size();
+                    }
+                    else
+                    {
+                        histEntry_t& mergedEntry = mergedEntries[ mergedIndex - 1 ];
+
+                        mergedEntry.count += entry.count;
+
+                        for ( uint32 c = 0; c < 4; c++ )
+                        {
+                            mergedEntry.sums[c] += entry.sums[c];
+                        }
+                    }
+                }
+
+                histogram_t ().swap( bandHist.entries );
+            }
+
+            histogram.reserve( mergedEntries.size() );
+
+            for ( uint32 key = 0; key < bucketKeyCount; key++ )
+            {
+                if ( uint32 mergedIndex = mergedIndices[ key ] )
+                {
+                    histogram.push_back( mergedEntries[ mergedIndex - 1 ] );
+                }
+            }
+        }
+
+        for ( histEntry_t& entry : histogram )
+        {
+            for ( uint32 c = 0; c < 4; c++ )
+            {
+                entry.avg[c] = (uint8)( entry.sums[c] / entry.count );
+            }
+        }
+    }
+
+    struct colorBox
+    {
+        size_t first, last;
+        uint64 texelCount;
+        uint32 splitChannel;
+        uint32 channelRange;
+    };
+
+    inline void measurebox( colorBox& box ) const
+    {
+        uint8 minColor[4] = { 255, 255, 255, 255 };
+        uint8 maxColor[4] = { 0, 0, 0, 0 };
+
+        box.texelCount = 0;
+
+        for ( size_t n = box.first; n < box.last; n++ )
+        {
+            const histEntry_t& entry = histogram[ n ];
+
+            box.texelCount += entry.count;
+
+            for ( uint32 c = 0; c < 4; c++ )
+            {
+                minColor[c] = std::min( minColor[c], entry.avg[c] );
+                maxColor[c] = std::max( maxColor[c], entry.avg[c] );
+            }
+        }
+
+        box.splitChannel = 0;
+        box.channelRange = 0;
+
+        for ( uint32 c = 0; c < 4; c++ )
+        {
+            uint32 range = (uint32)( maxColor[c] - minColor[c] );
+
+            if ( range > box.channelRange )
+            {
+                box.splitChannel = c;
+                box.channelRange = range;
+            }
+        }
+    }
+
+    static AINLINE uint32 colordistance( const uint8 *left, const color_t& right )
+    {
+        int dr = (int)left[0] - right.red;
+        int dg = (int)left[1] - right.green;
+        int db = (int)left[2] - right.blue;
+        int da = (int)left[3] - right.alpha;
+
+        return (uint32)( dr * dr + dg * dg + db * db + da * da );
+    }
+
+    static AINLINE uint32 findclosestcolor( const paletteContainer_t& palColors, const uint8 *color )
+    {
+        uint32 closestIndex = 0;
+        uint32 closestDist = 0xFFFFFFFF;
+
+        uint32 palCount = (uint32)palColors.size();
+
+        for ( uint32 n = 0; n < palCount; n++ )
+        {
+            uint32 dist = colordistance( color, palColors[ n ] );
+
+            if ( dist < closestDist )
+            {
+                closestIndex = n;
+                closestDist = dist;
+
+                if ( dist == 0 )
+                    break;
+            }
+        }
+
+        return closestIndex;
+    }
+
+    // Moves every palette color to the weighted center of the histogram entries closest to it.
+    inline void refinepalette( Interface *engineInterface, uint32 iterations )
+    {
+        EngineInterface *rwEngine = (EngineInterface*)engineInterface;
+
+        const size_t chunkSize = 4096;
+
+        size_t chunkCount = ( ( histogram.size() + chunkSize - 1 ) / chunkSize );
+
+        uint32 palCount = (uint32)paletteColors.size();
+
+        if ( chunkCount == 0 || palCount == 0 )
+            return;
+
+        struct clusterSum
+        {
+            uint64 count;
+            uint64 sums[4];
+        };
+
+        std::vector <clusterSum> chunkSums( chunkCount * palCount );
+
+        for ( uint32 iter = 0; iter < iterations; iter++ )
+        {
+            ParallelForEach( rwEngine, chunkCount,
+                [&]( size_t chunkIndex )
+            {
+                clusterSum *sums = &chunkSums[ chunkIndex * palCount ];
+
+                memset( sums, 0, sizeof( clusterSum ) * palCount );
+
+                size_t first = ( chunkIndex * chunkSize );
+                size_t last = std::min( histogram.size(), first + chunkSize );
+
+                for ( size_t n = first; n < last; n++ )
+                {
+                    const histEntry_t& entry = histogram[ n ];
+
+                    clusterSum& cluster = sums[ findclosestcolor( paletteColors, entry.avg ) ];
+
+                    cluster.count += entry.count;
+
+                    for ( uint32 c = 0; c < 4; c++ )
+                    {
+                        cluster.sums[c] += entry.sums[c];
+                    }
+                }
+            });
+
+            bool hasChanged = false;
+
+            for ( uint32 p = 0; p < palCount; p++ )
+            {
+                clusterSum total = { 0 };
+
+                for ( size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++ )
+                {
+                    const clusterSum& chunkCluster = chunkSums[ chunkIndex * palCount + p ];
+
+                    total.count += chunkCluster.count;
+
+                    for ( uint32 c = 0; c < 4; c++ )
+                    {
+                        total.sums[c] += chunkCluster.sums[c];
+                    }
+                }
+
+                // Unused palette colors stay where they are.
+                if ( total.count == 0 )
+                    continue;
+
+                color_t newColor;
+                newColor.red = (uint8)( total.sums[0] / total.count );
+                newColor.green = (uint8)( total.sums[1] / total.count );
+                newColor.blue = (uint8)( total.sums[2] / total.count );
+                newColor.alpha = (uint8)( total.sums[3] / total.count );
+
+                color_t& palColor = paletteColors[ p ];
+
+                if ( memcmp( &palColor, &newColor, sizeof( color_t ) ) != 0 )
+                {
+                    palColor = newColor;
+
+                    hasChanged = true;
+                }
+            }
+
+            if ( !hasChanged )
+                break;
+        }
+    }
+
+    // Splits the histogram into at most maxentries boxes and turns each of them into a palette color.
+    inline void constructpalette( Interface *engineInterface, uint32 maxentries )
+    {
+        paletteColors.clear();
+
+        if ( histogram.empty() )
+        {
+            // Keep at least one color so that remapping has something to point to.
+            color_t blackColor = { 0, 0, 0, 0 };
+
+            paletteColors.push_back( blackColor );
+            return;
+        }
+
+        std::vector <colorBox> boxes;
+        boxes.reserve( maxentries );
+
+        colorBox mainBox;
+        mainBox.first = 0;
+        mainBox.last = histogram.size();
+
+        measurebox( mainBox );
+
+        boxes.push_back( mainBox );
+
+        while ( boxes.size() < maxentries )
+        {
+            // Split the box that covers the most texels over the widest color range.
+            size_t bestBox = 0;
+            uint64 bestScore = 0;
+
+            for ( size_t n = 0; n < boxes.size(); n++ )
+            {
+                const colorBox& box = boxes[ n ];
+
+                if ( box.last - box.first < 2 )
+                    continue;
+
+                uint64 score = ( box.texelCount * box.channelRange );
+
+                if ( score > bestScore )
+                {
+                    bestBox = n;
+                    bestScore = score;
+                }
+            }
+
+            if ( bestScore == 0 )
+                break;
+
+            colorBox& splitBox = boxes[ bestBox ];
+
+            uint32 channel = splitBox.splitChannel;
+
+            std::sort( histogram.begin() + splitBox.first, histogram.begin() + splitBox.last,
+                [channel]( const histEntry_t& left, const histEntry_t& right )
+            {
+                return ( left.avg[channel] < right.avg[channel] );
+            });
+
+            // Find the weighted median.
+            uint64 halfCount = ( splitBox.texelCount / 2 );
+            uint64 countSoFar = 0;
+
+            size_t splitIndex = splitBox.first + 1;
+
+            for ( size_t n = splitBox.first; n < splitBox.last - 1; n++ )
+            {
+                countSoFar += histogram[ n ].count;
+
+                splitIndex = ( n + 1 );
+
+                if ( countSoFar >= halfCount )
+                    break;
+            }
+
+            colorBox upperBox;
+            upperBox.first = splitIndex;
+            upperBox.last = splitBox.last;
+
+            splitBox.last = splitIndex;
+
+            measurebox( splitBox );
+            measurebox( upperBox );
+
+            boxes.push_back( upperBox );
+        }
+
+        for ( const colorBox& box : boxes )
+        {
+            uint64 sums[4] = { 0, 0, 0, 0 };
+
+            for ( size_t n = box.first; n < box.last; n++ )
+            {
+                for ( uint32 c = 0; c < 4; c++ )
+                {
+                    sums[c] += histogram[ n ].sums[c];
+                }
+            }
+
+            color_t boxColor;
+            boxColor.red = (uint8)( sums[0] / box.texelCount );
+            boxColor.green = (uint8)( sums[1] / box.texelCount );
+            boxColor.blue = (uint8)( sums[2] / box.texelCount );
+            boxColor.alpha = (uint8)( sums[3] / box.texelCount );
+
+            paletteColors.push_back( boxColor );
+        }
+
+        refinepalette( engineInterface, 2 );
+    }
+
+    inline void* makepalette( Interface *engineInterface, eRasterFormat rasterFormat, eColorOrdering colorOrder ) const
+    {
+        uint32 palDepth = Bitmap::getRasterFormatDepth( rasterFormat );
+
+        uint32 palItemCount = (uint32)paletteColors.size();
+
+        uint32 palDataSize = getPaletteDataSize( palItemCount, palDepth );
+
+        void *paletteData = engineInterface->PixelAllocate( palDataSize );
+
+        if ( !paletteData )
+        {
+            throw RwException( "failed to allocate palette buffer in median-cut palettizer" );
+        }
+
+        colorModelDispatcher putDispatch( rasterFormat, colorOrder, palDepth, NULL, 0, PALETTE_NONE );
+
+        for ( uint32 n = 0; n < palItemCount; n++ )
+        {
+            const color_t& palColor = paletteColors[ n ];
+
+            putDispatch.setRGBA( paletteData, n, palColor.red, palColor.green, palColor.blue, palColor.alpha );
+        }
+
+        return paletteData;
+    }
+
+    // Maps every texel of a layer to its closest palette color.
+    // Rows are split into bands for the workers; each band remembers the colors it has looked up recently.
+    static inline void remaplayer(
+        Interface *engineInterface,
+        const paletteContainer_t& palColors, ePaletteType convPaletteFormat, uint32 convItemDepth,
+        const void *texelSource, uint32 mipWidth, uint32 mipHeight,
+        ePaletteType srcPaletteType, const void *srcPaletteData, uint32 srcPaletteCount,
+        eRasterFormat srcRasterFormat, eColorOrdering srcColorOrder, uint32 srcItemDepth,
+        uint32 srcRowAlignment, uint32 dstRowAlignment,
+        void*& texelsOut, uint32& dataSizeOut
+    )
+    {
+        if ( convItemDepth != 4 && convItemDepth != 8 )
+        {
+            throw RwException( "unsupported palette item depth in median-cut palette remapping" );
+        }
+
+        if ( palColors.empty() )
+        {
+            throw RwException( "cannot remap texels to an empty palette" );
+        }
+
+        EngineInterface *rwEngine = (EngineInterface*)engineInterface;
+
+        uint32 srcRowSize = getRasterDataRowSize( mipWidth, srcItemDepth, srcRowAlignment );
+
+        uint32 dstRowSize = getRasterDataRowSize( mipWidth, convItemDepth, dstRowAlignment );
+
+        uint32 dstDataSize = getRasterDataSizeByRowSize( dstRowSize, mipHeight );
+
+        void *newTexelData = engineInterface->PixelAllocate( dstDataSize );
+
+        if ( !newTexelData )
+        {
+            throw RwException( "failed to allocate destination texel buffer in median-cut palette remapping" );
+        }
+
+        try
+        {
+            rgbaRowReader rowReader( srcRasterFormat, srcColorOrder, srcItemDepth, srcPaletteType, srcPaletteData, srcPaletteCount );
+
+            uint32 bandHeight = GetParallelBandHeight( mipHeight, GetParallelWorkerCount( rwEngine ) );
+
+            uint32 bandCount = ( bandHeight != 0 ? ( ( mipHeight + bandHeight - 1 ) / bandHeight ) : 0 );
+
+            ParallelForEach( rwEngine, bandCount,
+                [&]( size_t bandIndex )
+            {
+                // Images usually repeat colors a lot, so cache the last lookups.
+                const uint32 cacheSize = 1024;
+
+                uint32 cachedColors[ cacheSize ];
+                uint8 cachedIndices[ cacheSize ];
+                bool cacheValid[ cacheSize ] = { false };
+
+                uint32 startRow = (uint32)( bandIndex * bandHeight );
+                uint32 endRow = std::min( mipHeight, startRow + bandHeight );
+
+                std::vector <color_t> rowColors( mipWidth );
+                std::vector <uint8> rowHasColor( mipWidth );
+
+                for ( uint32 row = startRow; row < endRow; row++ )
+                {
+                    const void *srcRow = getConstTexelDataRow( texelSource, srcRowSize, row );
+                    void *dstRow = getTexelDataRow( newTexelData, dstRowSize, row );
+
+                    rowReader.readrow( srcRow, mipWidth, rowColors.data(), rowHasColor.data() );
+
+                    for ( uint32 col = 0; col < mipWidth; col++ )
+                    {
+                        const color_t& rowColor = rowColors[ col ];
+
+                        uint8 color[4] = { rowColor.red, rowColor.green, rowColor.blue, rowColor.alpha };
+
+                        uint32 packed = packcolor( color[0], color[1], color[2], color[3] );
+
+                        uint32 cacheSlot = ( ( packed * 2654435761u ) >> 22 );
+
+                        uint32 paletteIndex;
+
+                        if ( cacheValid[ cacheSlot ] && cachedColors[ cacheSlot ] == packed )
+                        {
+                            paletteIndex = cachedIndices[ cacheSlot ];
+                        }
+                        else
+                        {
+                            paletteIndex = findclosestcolor( palColors, color );
+
+                            cachedColors[ cacheSlot ] = packed;
+                            cachedIndices[ cacheSlot ] = (uint8)paletteIndex;
+                            cacheValid[ cacheSlot ] = true;
+                        }
+
+                        // Bands are made of whole rows, so 4bit indices never share a byte across workers.
+                        setpaletteindex( dstRow, col, convItemDepth, convPaletteFormat, paletteIndex );
+                    }
+                }
+            });
+        }
+        catch( ... )
+        {
+            engineInterface->PixelFree( newTexelData );
+
+            throw;
+        }
+
+        texelsOut = newTexelData;
+        dataSizeOut = dstDataSize;
+    }
+};
+
+};
+
+#endif //_RENDERWARE_PALETTE_MEDIANCUT_
@@ -18,6 +18,10 @@ bool genericDecompressDXTNative(
     eRasterFormat dstRasterFormat, uint32 dstDepth, uint32 dstRowAlignment, eColorOrdering dstColorOrder
 )
 {
+    profilingScope profile( engineInterface, PROFSTAGE_DECOMPRESS );
+
+    profile.AddPixelData( pixelData );
+
     eDXTCompressionMethod dxtMethod = engineInterface->GetDXTRuntime();
 
     // We must have stand-alone pixel data.
@@ -96,6 +100,81 @@ bool genericDecompressDXTNative(
     return conversionSuccessful;
 }
 
+// Sets the format fields of pixel data that was just compressed to DXT.
+static void setDXTCompressedPixelFormat( pixelDataTraversal& pixelData, uint32 dxtType )
+{
+    // Set a virtual raster format.
+    // This is what is done by the R* DXT output system.
+    {
+        eRasterFormat rasterFormat = pixelData.rasterFormat;
+        uint32 itemDepth = pixelData.depth;
+
+        uint32 newDepth = itemDepth;
+        eRasterFormat virtualRasterFormat = RASTER_8888;
+
+        if ( dxtType == 1 )
+        {
+            newDepth = 16;
+
+            if ( pixelData.hasAlpha )
+            {
+                virtualRasterFormat = RASTER_1555;
+            }
+            else
+            {
+                virtualRasterFormat = RASTER_565;
+            }
+        }
+        else if ( dxtType == 2 || dxtType == 3 || dxtType == 4 || dxtType == 5 )
+        {
+            newDepth = 16;
+
+            virtualRasterFormat = RASTER_4444;
+        }
+
+        if ( rasterFormat != virtualRasterFormat )
+        {
+            pixelData.rasterFormat = virtualRasterFormat;
+        }
+
+        if ( newDepth != itemDepth )
+        {
+            pixelData.depth = newDepth;
+        }
+    }
+
+    // We are now successfully compressed, so set the correct compression type.
+    eCompressionType targetCompressionType = RWCOMPRESS_NONE;
+
+    if ( dxtType == 1 )
+    {
+        targetCompressionType = RWCOMPRESS_DXT1;
+    }
+    else if ( dxtType == 2 )
+    {
+        targetCompressionType = RWCOMPRESS_DXT2;
+    }
+    else if ( dxtType == 3 )
+    {
+        targetCompressionType = RWCOMPRESS_DXT3;
+    }
+    else if ( dxtType == 4 )
+    {
+        targetCompressionType = RWCOMPRESS_DXT4;
+    }
+    else if ( dxtType == 5 )
+    {
+        targetCompressionType = RWCOMPRESS_DXT5;
+    }
+    else
+    {
+        throw RwException( "runtime fault: unknown compression type request in DXT compressor" );
+    }
+
+    pixelData.rowAlignment = 0; // we are not raw anymore, so we do not have a row alignment.
+    pixelData.compressionType = targetCompressionType;
+}
+
 void genericCompressDXTNative( Interface *engineInterface, pixelDataTraversal& pixelData, uint32 dxtType )
 {
     // We must get data in raw format.
@@ -104,6 +183,10 @@ void genericCompressDXTNative( Interface *engineInterface, pixelDataTraversal& p
         throw RwException( "runtime fault: attempting to compress an already compressed texture" );
     }
 
+    profilingScope profile( engineInterface, PROFSTAGE_COMPRESS );
+
+    profile.AddPixelData( pixelData );
+
     // We must have stand-alone pixel data.
     // Otherwise we could mess up pretty badly!
     assert( pixelData.isNewlyAllocated == true );
@@ -177,73 +260,70 @@ void genericCompressDXTNative( Interface *engineInterface, pixelDataTraversal& p
         pixelData.paletteSize = 0;
     }
 
-    // Set a virtual raster format.
-    // This is what is done by the R* DXT output system.
+    setDXTCompressedPixelFormat( pixelData, dxtType );
+}
+
+bool genericTranscodeDXTNative(
+    Interface *engineInterface, pixelDataTraversal& pixelData, uint32 srcDXTType, uint32 dstDXTType,
+    eRasterFormat interRasterFormat, eColorOrdering interColorOrder
+)
+{
+    profilingScope profile( engineInterface, PROFSTAGE_COMPRESS );
+
+    profile.AddPixelData( pixelData );
+
+    eDXTCompressionMethod dxtMethod = engineInterface->GetDXTRuntime();
+
+    // We must have stand-alone pixel data.
+    // Otherwise we could mess up pretty badly!
+    assert( pixelData.isNewlyAllocated == true );
+
+    uint32 interDepth = Bitmap::getRasterFormatDepth( interRasterFormat );
+
+    size_t mipmapCount = pixelData.mipmaps.size();
+
+    for ( size_t n = 0; n < mipmapCount; n++ )
     {
-        uint32 newDepth = itemDepth;
-        eRasterFormat virtualRasterFormat = RASTER_8888;
+        pixelDataTraversal::mipmapResource& mipLayer = pixelData.mipmaps[ n ];
 
-        if ( dxtType == 1 )
-        {
-            newDepth = 16;
+        void *srcTexels = mipLayer.texels;
 
-            if ( pixelData.hasAlpha )
-            {
-                virtualRasterFormat = RASTER_1555;
-            }
-            else
-            {
-                virtualRasterFormat = RASTER_565;
-            }
-        }
-        else if ( dxtType == 2 || dxtType == 3 || dxtType == 4 || dxtType == 5 )
-        {
-            newDepth = 16;
+        void *dxtArray = NULL;
+        uint32 dxtDataSize = 0;
 
-            virtualRasterFormat = RASTER_4444;
-        }
+        uint32 realMipWidth, realMipHeight;
 
-        if ( rasterFormat != virtualRasterFormat )
-        {
-            pixelData.rasterFormat = virtualRasterFormat;
-        }
+        bool couldTranscode =
+            transcodeTexelsUsingDXT <endian::little_endian> (
+                engineInterface, dxtMethod,
+                srcDXTType, srcTexels, mipLayer.width, mipLayer.height,
+                mipLayer.layerWidth, mipLayer.layerHeight,
+                interRasterFormat, interColorOrder, interDepth,
+                dstDXTType,
+                dxtArray, dxtDataSize,
+                realMipWidth, realMipHeight
+            );
 
-        if ( newDepth != itemDepth )
+        if ( !couldTranscode )
         {
-            pixelData.depth = newDepth;
+            // Mipmaps are all-or-nothing, so only the first one may fail.
+            assert( n == 0 );
+
+            return false;
         }
-    }
 
-    // We are now successfully compressed, so set the correct compression type.
-    eCompressionType targetCompressionType = RWCOMPRESS_NONE;
+        engineInterface->PixelFree( srcTexels );
 
-    if ( dxtType == 1 )
-    {
-        targetCompressionType = RWCOMPRESS_DXT1;
-    }
-    else if ( dxtType == 2 )
-    {
-        targetCompressionType = RWCOMPRESS_DXT2;
-    }
-    else if ( dxtType == 3 )
-    {
-        targetCompressionType = RWCOMPRESS_DXT3;
-    }
-    else if ( dxtType == 4 )
-    {
-        targetCompressionType = RWCOMPRESS_DXT4;
-    }
-    else if ( dxtType == 5 )
-    {
-        targetCompressionType = RWCOMPRESS_DXT5;
-    }
-    else
-    {
-        throw RwException( "runtime fault: unknown compression type request in DXT compressor" );
+        mipLayer.texels = dxtArray;
+        mipLayer.dataSize = dxtDataSize;
+
+        mipLayer.width = realMipWidth;
+        mipLayer.height = realMipHeight;
     }
 
-    pixelData.rowAlignment = 0; // we are not raw anymore, so we do not have a row alignment.
-    pixelData.compressionType = targetCompressionType;
+    setDXTCompressedPixelFormat( pixelData, dstDXTType );
+
+    return true;
 }
 
 AINLINE void _copyPaletteDepth_internal(
@@ -1128,6 +1208,10 @@ inline bool isPaletteTypeBigger( ePaletteType left, ePaletteType right )
 
 bool ConvertPixelData( Interface *engineInterface, pixelDataTraversal& pixelsToConvert, const pixelFormat pixFormat )
 {
+    profilingScope profile( engineInterface, PROFSTAGE_PIXELCONVERT );
+
+    profile.AddPixelData( pixelsToConvert );
+
     // We must have stand-alone pixel data.
     // Otherwise we could mess up pretty badly!
     assert( pixelsToConvert.isNewlyAllocated == true );
@@ -1154,12 +1238,33 @@ bool ConvertPixelData( Interface *engineInterface, pixelDataTraversal& pixelsToC
             bool compressionSuccess = false;
             bool decompressionSuccess = false;
 
-            if ( isSrcDXTCompressed )
+            if ( isSrcDXTCompressed && isDstDXTCompressed )
+            {
+                // Go from block to block, so we never need the decompressed surface.
+                bool transcodeSuccess =
+                    genericTranscodeDXTNative(
+                        engineInterface, pixelsToConvert, srcDXTType, dstDXTType,
+                        pixFormat.rasterFormat, pixFormat.colorOrder
+                    );
+
+                compressionSuccess = transcodeSuccess;
+                decompressionSuccess = transcodeSuccess;
+            }
+            else if ( isSrcDXTCompressed )
             {
+                // If we want a raw color format, decompress right into its depth.
+                // Then there is nothing left to convert afterwards.
+                uint32 decompressDepth = Bitmap::getRasterFormatDepth( pixFormat.rasterFormat );
+
+                if ( pixFormat.paletteType == PALETTE_NONE )
+                {
+                    decompressDepth = pixFormat.depth;
+                }
+
                 decompressionSuccess =
                     genericDecompressDXTNative(
                         engineInterface, pixelsToConvert, srcDXTType,
-                        pixFormat.rasterFormat, Bitmap::getRasterFormatDepth( pixFormat.rasterFormat ),
+                        pixFormat.rasterFormat, decompressDepth,
                         pixFormat.rowAlignment, pixFormat.colorOrder
                     );
             }
@@ -1169,7 +1274,7 @@ bool ConvertPixelData( Interface *engineInterface, pixelDataTraversal& pixelsToC
                 decompressionSuccess = true;
             }
 
-            if ( decompressionSuccess )
+            if ( decompressionSuccess && !compressionSuccess )
             {
                 // If we have to compress, do it.
                 if ( isDstDXTCompressed )
@@ -897,9 +897,13 @@ void ps2NativeTextureTypeProvider::DeserializeTexture( TextureBase *theTexture,
 
 static PluginDependantStructRegister <ps2NativeTextureTypeProvider, RwInterfaceFactory_t> ps2NativeTexturePlugin;
 
+extern void registerPS2GSAllocationCache( void );
+
 void registerPS2NativePlugin( void )
 {
     ps2NativeTexturePlugin.RegisterPlugin( engineFactory );
+
+    registerPS2GSAllocationCache();
 }
 
 inline void* TruncateMipmapLayerPS2(
@@ -1455,6 +1459,8 @@ void ps2NativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInter
     // Cast to our native format.
     NativeTexturePS2 *ps2tex = (NativeTexturePS2*)objMem;
 
+    ps2tex->alphaCache.Invalidate();
+
     // Verify mipmap dimensions.
     {
         nativeTextureSizeRules sizeRules;
@@ -1672,6 +1678,8 @@ void ps2NativeTextureTypeProvider::UnsetPixelDataFromTexture( Interface *engineI
 {
     NativeTexturePS2 *nativeTex = (NativeTexturePS2*)objMem;
 
+    nativeTex->alphaCache.Invalidate();
+
     if ( deallocate )
     {
         size_t mipmapCount = nativeTex->mipmaps.size();
@@ -1965,10 +1973,27 @@ bool ps2NativeTextureTypeProvider::GetMipmapLayer( Interface *engineInterface, v
         );
 }
 
+bool ps2NativeTextureTypeProvider::GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut )
+{
+    NativeTexturePS2 *nativeTex = (NativeTexturePS2*)objMem;
+
+    ps2MipmapManager <false> mipMan( nativeTex );
+
+    return
+        virtualGetMipmapLayerSize(
+            mipMan,
+            mipIndex,
+            nativeTex->mipmaps,
+            widthOut, heightOut
+        );
+}
+
 bool ps2NativeTextureTypeProvider::AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut )
 {
     NativeTexturePS2 *nativeTex = (NativeTexturePS2*)objMem;
 
+    nativeTex->alphaCache.Invalidate();
+
     ps2MipmapManager <false> mipMan( nativeTex );
 
     return
@@ -1996,6 +2021,15 @@ bool ps2NativeTextureTypeProvider::DoesTextureHaveAlpha( const void *objMem )
     // The PS2 native texture does not store the alpha status, because it uses alpha blending all the time.
     // Hence we have to calculate the alpha flag if the framework wants it.
     // This is an expensive operation, actually, because we have to decode the texture.
+    // So we only do it once until the texels change.
+    {
+        bool cachedHasAlpha;
+
+        if ( nativeTex->alphaCache.Get( cachedHasAlpha ) )
+        {
+            return cachedHasAlpha;
+        }
+    }
 
     // Let's just use the methods we already wrote.
     ps2MipmapManager <true> mipMan( nativeTex );
@@ -2042,6 +2076,8 @@ bool ps2NativeTextureTypeProvider::DoesTextureHaveAlpha( const void *objMem )
         engineInterface->PixelFree( rawLayer.mipData.texels );
     }
 
+    nativeTex->alphaCache.Set( hasAlpha );
+
     return hasAlpha;
 }
 
@@ -817,6 +817,9 @@ struct NativeTexturePS2
 
     eColorOrdering colorOrdering;
 
+    // The PS2 format does not store whether it has alpha, so we remember what we calculated.
+    cachedAlphaFlag alphaCache;
+
     struct gsParams_t
     {
         // Unique PS2 configuration.
@@ -838,6 +841,14 @@ struct NativeTexturePS2
     eFormatEncodingType getHardwareRequiredEncoding(LibraryVersion version) const;
 
 private:
+    bool calculateTextureMemoryAllocation(
+        uint32 mipmapBasePointer[], uint32 mipmapBufferWidth[], uint32 mipmapMemorySize[], ps2MipmapTransmissionData mipmapTransData[], uint32 maxMipmaps,
+        eMemoryLayoutType& pixelMemLayoutTypeOut,
+        uint32& clutBasePointer, uint32& clutMemSize, ps2MipmapTransmissionData& clutTransData,
+        uint32& maxBuffHeight
+    ) const;
+
+    // Same as above, but remembers the results per texture layout.
     bool allocateTextureMemoryNative(
         uint32 mipmapBasePointer[], uint32 mipmapBufferWidth[], uint32 mipmapMemorySize[], ps2MipmapTransmissionData mipmapTransData[], uint32 maxMipmaps,
         eMemoryLayoutType& pixelMemLayoutTypeOut,
@@ -947,6 +958,7 @@ struct ps2NativeTextureTypeProvider : public texNativeTypeProvider
     }
 
     bool GetMipmapLayer( Interface *engineInterface, void *objMem, uint32 mipIndex, rawMipmapLayer& layerOut );
+    bool GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut );
     bool AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut );
     void ClearMipmaps( Interface *engineInterface, void *objMem );
 
@@ -6,6 +6,8 @@
 
 #include "txdread.ps2gsman.hxx"
 
+#include <map>
+
 namespace rw
 {
 
@@ -1179,7 +1181,7 @@ struct singleMemLayoutGSAllocator
     }
 };
 
-bool NativeTexturePS2::allocateTextureMemoryNative(
+bool NativeTexturePS2::calculateTextureMemoryAllocation(
     uint32 mipmapBasePointer[], uint32 mipmapBufferWidth[], uint32 mipmapMemorySize[], ps2MipmapTransmissionData mipmapTransData[], uint32 maxMipmaps,
     eMemoryLayoutType& pixelMemLayoutTypeOut,
     uint32& clutBasePointerOut, uint32& clutMemSizeOut, ps2MipmapTransmissionData& clutTransDataOut,
@@ -1431,6 +1433,181 @@ bool NativeTexturePS2::allocateTextureMemoryNative(
     return true;
 }
 
+// The GS allocation only depends on the layout of a texture and not on its texels.
+// TXDs usually share a handful of layouts among all their textures, so we remember the results.
+static const uint32 ps2GSAllocationCacheMaxMipmaps = 7;
+
+struct ps2GSAllocationKey
+{
+    inline ps2GSAllocationKey( void )
+    {
+        // Clear the padding too, because we compare by memory.
+        memset( this, 0, sizeof( *this ) );
+    }
+
+    inline bool operator < ( const ps2GSAllocationKey& right ) const
+    {
+        return ( memcmp( this, &right, sizeof( *this ) ) < 0 );
+    }
+
+    eFormatEncodingType encodingMemLayout;
+    eFormatEncodingType encodingPixelMemLayoutType;
+    ePaletteType paletteType;
+    uint32 maxMipmaps;
+    uint32 mipmapCount;
+    uint32 mipmapWidth[ ps2GSAllocationCacheMaxMipmaps ];
+    uint32 mipmapHeight[ ps2GSAllocationCacheMaxMipmaps ];
+    uint32 clutWidth, clutHeight;
+};
+
+struct ps2GSAllocationResult
+{
+    bool success;
+
+    eMemoryLayoutType pixelMemLayoutType;
+
+    uint32 mipmapBasePointer[ ps2GSAllocationCacheMaxMipmaps ];
+    uint32 mipmapBufferWidth[ ps2GSAllocationCacheMaxMipmaps ];
+    uint32 mipmapMemorySize[ ps2GSAllocationCacheMaxMipmaps ];
+    ps2MipmapTransmissionData mipmapTransData[ ps2GSAllocationCacheMaxMipmaps ];
+
+    uint32 clutBasePointer;
+    uint32 clutMemSize;
+    ps2MipmapTransmissionData clutTransData;
+
+    uint32 maxBuffHeight;
+};
+
+struct ps2GSAllocationCacheEnv
+{
+    inline void Initialize( EngineInterface *engineInterface )
+    {
+        this->lockCache = CreateReadWriteLock( engineInterface );
+    }
+
+    inline void Shutdown( EngineInterface *engineInterface )
+    {
+        if ( rwlock *theLock = this->lockCache )
+        {
+            CloseReadWriteLock( engineInterface, theLock );
+        }
+    }
+
+    // Layouts are few, but let us not grow without bounds in long running tools.
+    static const size_t maxCacheEntries = 1024;
+
+    rwlock *lockCache;
+
+    typedef std::map <ps2GSAllocationKey, ps2GSAllocationResult> cacheMap_t;
+
+    cacheMap_t cache;
+};
+
+static PluginDependantStructRegister <ps2GSAllocationCacheEnv, RwInterfaceFactory_t> ps2GSAllocationCacheRegister;
+
+void registerPS2GSAllocationCache( void )
+{
+    ps2GSAllocationCacheRegister.RegisterPlugin( engineFactory );
+}
+
+bool NativeTexturePS2::allocateTextureMemoryNative(
+    uint32 mipmapBasePointer[], uint32 mipmapBufferWidth[], uint32 mipmapMemorySize[], ps2MipmapTransmissionData mipmapTransData[], uint32 maxMipmaps,
+    eMemoryLayoutType& pixelMemLayoutTypeOut,
+    uint32& clutBasePointerOut, uint32& clutMemSizeOut, ps2MipmapTransmissionData& clutTransDataOut,
+    uint32& maxBuffHeightOut
+) const
+{
+    ps2GSAllocationCacheEnv *cacheEnv = ps2GSAllocationCacheRegister.GetPluginStruct( (EngineInterface*)this->engineInterface );
+
+    size_t mipmapCount = this->mipmaps.size();
+
+    if ( cacheEnv == NULL || cacheEnv->lockCache == NULL ||
+         maxMipmaps > ps2GSAllocationCacheMaxMipmaps || mipmapCount > ps2GSAllocationCacheMaxMipmaps )
+    {
+        return calculateTextureMemoryAllocation(
+            mipmapBasePointer, mipmapBufferWidth, mipmapMemorySize, mipmapTransData, maxMipmaps,
+            pixelMemLayoutTypeOut,
+            clutBasePointerOut, clutMemSizeOut, clutTransDataOut,
+            maxBuffHeightOut
+        );
+    }
+
+    // Build the description of our layout.
+    ps2GSAllocationKey layoutKey;
+    layoutKey.encodingMemLayout = this->swizzleEncodingType;
+    layoutKey.encodingPixelMemLayoutType = getFormatEncodingFromRasterFormat( this->rasterFormat, this->paletteType );
+    layoutKey.paletteType = this->paletteType;
+    layoutKey.maxMipmaps = maxMipmaps;
+    layoutKey.mipmapCount = (uint32)mipmapCount;
+
+    for ( size_t n = 0; n < mipmapCount; n++ )
+    {
+        const GSTexture& gsTex = this->mipmaps[ n ];
+
+        layoutKey.mipmapWidth[ n ] = gsTex.swizzleWidth;
+        layoutKey.mipmapHeight[ n ] = gsTex.swizzleHeight;
+    }
+
+    layoutKey.clutWidth = this->paletteTex.swizzleWidth;
+    layoutKey.clutHeight = this->paletteTex.swizzleHeight;
+
+    ps2GSAllocationResult result;
+
+    bool hasCachedResult = false;
+    {
+        scoped_rwlock_reader <rwlock> lock( cacheEnv->lockCache );
+
+        ps2GSAllocationCacheEnv::cacheMap_t::const_iterator iter = cacheEnv->cache.find( layoutKey );
+
+        if ( iter != cacheEnv->cache.end() )
+        {
+            result = iter->second;
+
+            hasCachedResult = true;
+        }
+    }
+
+    if ( !hasCachedResult )
+    {
+        result.success = calculateTextureMemoryAllocation(
+            result.mipmapBasePointer, result.mipmapBufferWidth, result.mipmapMemorySize, result.mipmapTransData, maxMipmaps,
+            result.pixelMemLayoutType,
+            result.clutBasePointer, result.clutMemSize, result.clutTransData,
+            result.maxBuffHeight
+        );
+
+        scoped_rwlock_writer <rwlock> lock( cacheEnv->lockCache );
+
+        if ( cacheEnv->cache.size() >= ps2GSAllocationCacheEnv::maxCacheEntries )
+        {
+            cacheEnv->cache.clear();
+        }
+
+        cacheEnv->cache[ layoutKey ] = result;
+    }
+
+    if ( !result.success )
+        return false;
+
+    for ( uint32 n = 0; n < maxMipmaps; n++ )
+    {
+        mipmapBasePointer[ n ] = result.mipmapBasePointer[ n ];
+        mipmapBufferWidth[ n ] = result.mipmapBufferWidth[ n ];
+        mipmapMemorySize[ n ] = result.mipmapMemorySize[ n ];
+        mipmapTransData[ n ] = result.mipmapTransData[ n ];
+    }
+
+    pixelMemLayoutTypeOut = result.pixelMemLayoutType;
+
+    clutBasePointerOut = result.clutBasePointer;
+    clutMemSizeOut = result.clutMemSize;
+    clutTransDataOut = result.clutTransData;
+
+    maxBuffHeightOut = result.maxBuffHeight;
+
+    return true;
+}
+
 bool NativeTexturePS2::allocateTextureMemory(
     uint32 mipmapBasePointer[], uint32 mipmapBufferWidth[], uint32 mipmapMemorySize[], ps2MipmapTransmissionData mipmapTransData[], uint32 maxMipmaps,
     eMemoryLayoutType& pixelMemLayoutTypeOut,
@@ -226,6 +226,11 @@ static bool clut(
 
             const uint32 clutRequiredRowAlignment = 1;
 
+            profilingScope profile( engineInterface, PROFSTAGE_SWIZZLE );
+
+            profile.AddTexels( (uint64)clutWidth * clutHeight );
+            profile.AddBytes( clutDataSize );
+
             // Perform the permutation.
             memcodec::permutationUtilities::permuteArray(
                 srcTexels, clutWidth, clutHeight, itemDepth, permuteWidth, permuteHeight,
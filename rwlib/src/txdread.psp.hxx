@@ -371,6 +371,9 @@ struct NativeTexturePSP
 
     // Unknowns.
     uint32 unk;
+
+    // No alpha flag is stored, so we remember what we calculated.
+    cachedAlphaFlag alphaCache;
 };
 
 static inline void getPSPNativeTextureSizeRules( nativeTextureSizeRules& rulesOut )
@@ -449,6 +452,7 @@ struct pspNativeTextureTypeProvider : public texNativeTypeProvider
     }
 
     bool GetMipmapLayer( Interface *engineInterface, void *objMem, uint32 mipIndex, rawMipmapLayer& layerOut ) override;
+    bool GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut ) override;
     bool AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut ) override;
     void ClearMipmaps( Interface *engineInterface, void *objMem ) override;
 
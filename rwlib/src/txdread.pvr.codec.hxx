@@ -0,0 +1,730 @@
+// PowerVR texture compression (PVRTC) codec.
+// Decodes and encodes the version 1 PVRTC 2bpp and 4bpp formats. Every texel is blended from the colors
+// of the four closest blocks, so the encoder does two passes over the block rows: the first picks the block
+// colors, the second fits the modulation against the blended colors of the finished neighbourhood.
+
+#ifndef _RENDERWARE_PVR_CODEC_
+#define _RENDERWARE_PVR_CODEC_
+
+#include "pixelformat.hxx"
+
+#include "rwthreading.parallel.hxx"
+
+namespace rw
+{
+
+// Texel layout of decoded blocks, which is RASTER_8888 with COLOR_RGBA.
+struct pvrtcTexel
+{
+    uint8 red;
+    uint8 green;
+    uint8 blue;
+    uint8 alpha;
+};
+static_assert( sizeof( pvrtcTexel ) == 4, "PVRTC texel must be 4 bytes in size!" );
+
+#pragma pack(push, 1)
+struct pvrtc_block
+{
+    // Modulation values, row by row.
+    // 4bpp blocks store 2bit per texel, 2bpp blocks either 1bit per texel or 2bit per every second texel.
+    endian::little_endian <uint32> modulationData;
+
+    // Bit 0 selects the modulation mode, bits 1 to 15 store color A and bits 16 to 31 color B.
+    endian::little_endian <uint32> colorData;
+};
+static_assert( sizeof( pvrtc_block ) == 8, "PVRTC block must be 8 bytes in size!" );
+#pragma pack(pop)
+
+#define PVRTC_MODULATION_MODE_BIT   0x00000001
+#define PVRTC_COLOR_A_OPAQUE_BIT    0x00008000
+#define PVRTC_COLOR_B_OPAQUE_BIT    0x80000000
+
+// Unpacked block color, with 5bit color channels and a 4bit alpha channel.
+struct pvrtcColor
+{
+    int32 red;
+    int32 green;
+    int32 blue;
+    int32 alpha;
+};
+
+enum ePVRTCInterpolationMode
+{
+    PVRTC_INTERP_HV,
+    PVRTC_INTERP_H,
+    PVRTC_INTERP_V
+};
+
+AINLINE uint32 getPVRTCBlockWidth( bool is2bpp )
+{
+    return ( is2bpp ? 8u : 4u );
+}
+
+AINLINE uint32 getPVRTCBlockHeight( bool is2bpp )
+{
+    return 4u;
+}
+
+AINLINE bool isPVRTCSurfaceDimension( uint32 dimension )
+{
+    return ( dimension != 0 && ( dimension & ( dimension - 1 ) ) == 0 );
+}
+
+// PVRTC surfaces have to be power-of-two and at least two blocks wide and high.
+AINLINE uint32 getPVRTCSurfaceDimension( uint32 dimension, uint32 minimum )
+{
+    uint32 surfDimension = minimum;
+
+    while ( surfDimension < dimension )
+    {
+        surfDimension <<= 1;
+    }
+
+    return surfDimension;
+}
+
+// Blocks are stored in morton order, with the y coordinate in the lower bit of every pair.
+// If the surface is not square, the remaining bits of the bigger dimension are put on top.
+AINLINE uint32 getPVRTCBlockIndex( uint32 block_x, uint32 block_y, uint32 widthBlocks, uint32 heightBlocks )
+{
+    uint32 minDimension = std::min( widthBlocks, heightBlocks );
+
+    uint32 blockIndex = 0;
+    uint32 shiftCount = 0;
+
+    for ( uint32 bit = 1; bit < minDimension; bit <<= 1, shiftCount++ )
+    {
+        if ( block_y & bit )
+        {
+            blockIndex |= ( 1u << ( shiftCount * 2 ) );
+        }
+
+        if ( block_x & bit )
+        {
+            blockIndex |= ( 1u << ( shiftCount * 2 + 1 ) );
+        }
+    }
+
+    uint32 remainder = ( widthBlocks > heightBlocks ? block_x : block_y );
+
+    blockIndex |= ( ( remainder >> shiftCount ) << ( shiftCount * 2 ) );
+
+    return blockIndex;
+}
+
+AINLINE void getPVRTCColorA( uint32 colorData, pvrtcColor& colorOut )
+{
+    if ( colorData & PVRTC_COLOR_A_OPAQUE_BIT )
+    {
+        // Stored as RGB554.
+        colorOut.red = ( colorData >> 10 ) & 0x1F;
+        colorOut.green = ( colorData >> 5 ) & 0x1F;
+        colorOut.blue = ( colorData & 0x1E ) | ( ( colorData & 0x1E ) >> 4 );
+        colorOut.alpha = 0xF;
+    }
+    else
+    {
+        // Stored as ARGB3443.
+        colorOut.red = ( ( colorData & 0xF00 ) >> 7 ) | ( ( colorData & 0xF00 ) >> 11 );
+        colorOut.green = ( ( colorData & 0xF0 ) >> 3 ) | ( ( colorData & 0xF0 ) >> 7 );
+        colorOut.blue = ( ( colorData & 0xE ) << 1 ) | ( ( colorData & 0xE ) >> 2 );
+        colorOut.alpha = ( colorData & 0x7000 ) >> 11;
+    }
+}
+
+AINLINE void getPVRTCColorB( uint32 colorData, pvrtcColor& colorOut )
+{
+    if ( colorData & PVRTC_COLOR_B_OPAQUE_BIT )
+    {
+        // Stored as RGB555.
+        colorOut.red = ( colorData >> 26 ) & 0x1F;
+        colorOut.green = ( colorData >> 21 ) & 0x1F;
+        colorOut.blue = ( colorData >> 16 ) & 0x1F;
+        colorOut.alpha = 0xF;
+    }
+    else
+    {
+        // Stored as ARGB3444.
+        colorOut.red = ( ( colorData & 0xF000000 ) >> 23 ) | ( ( colorData & 0xF000000 ) >> 27 );
+        colorOut.green = ( ( colorData & 0xF00000 ) >> 19 ) | ( ( colorData & 0xF00000 ) >> 23 );
+        colorOut.blue = ( ( colorData & 0xF0000 ) >> 15 ) | ( ( colorData & 0xF0000 ) >> 19 );
+        colorOut.alpha = ( colorData & 0x70000000 ) >> 27;
+    }
+}
+
+AINLINE uint32 pvrtcQuantize( uint32 val, uint32 maxVal )
+{
+    return ( ( val * maxVal + 127 ) / 255 );
+}
+
+// The translucent modes store 3bit alpha which is expanded to 4bit with a zero at the bottom.
+AINLINE uint32 pvrtcQuantizeAlpha( uint32 alpha )
+{
+    return std::min( ( alpha + 17 ) / 34, 7u );
+}
+
+// Texels that are almost opaque are better off with the extra color precision of the opaque modes.
+#define PVRTC_OPAQUE_ALPHA_THRESHOLD    247
+
+AINLINE uint32 pvrtcPackColorA( const uint8 rgba[4] )
+{
+    if ( rgba[3] >= PVRTC_OPAQUE_ALPHA_THRESHOLD )
+    {
+        return ( PVRTC_COLOR_A_OPAQUE_BIT |
+                 ( pvrtcQuantize( rgba[0], 31 ) << 10 ) |
+                 ( pvrtcQuantize( rgba[1], 31 ) << 5 ) |
+                 ( pvrtcQuantize( rgba[2], 15 ) << 1 ) );
+    }
+
+    return ( ( pvrtcQuantizeAlpha( rgba[3] ) << 12 ) |
+             ( pvrtcQuantize( rgba[0], 15 ) << 8 ) |
+             ( pvrtcQuantize( rgba[1], 15 ) << 4 ) |
+             ( pvrtcQuantize( rgba[2], 7 ) << 1 ) );
+}
+
+AINLINE uint32 pvrtcPackColorB( const uint8 rgba[4] )
+{
+    if ( rgba[3] >= PVRTC_OPAQUE_ALPHA_THRESHOLD )
+    {
+        return ( PVRTC_COLOR_B_OPAQUE_BIT |
+                 ( pvrtcQuantize( rgba[0], 31 ) << 26 ) |
+                 ( pvrtcQuantize( rgba[1], 31 ) << 21 ) |
+                 ( pvrtcQuantize( rgba[2], 31 ) << 16 ) );
+    }
+
+    return ( ( pvrtcQuantizeAlpha( rgba[3] ) << 28 ) |
+             ( pvrtcQuantize( rgba[0], 15 ) << 24 ) |
+             ( pvrtcQuantize( rgba[1], 15 ) << 20 ) |
+             ( pvrtcQuantize( rgba[2], 15 ) << 16 ) );
+}
+
+// Unpacked colors of the 3x3 blocks around the block that is being processed, as [row][column].
+struct pvrtcNeighbourhood
+{
+    const pvrtc_block *blocks[3][3];
+
+    pvrtcColor colorsA[3][3];
+    pvrtcColor colorsB[3][3];
+
+    inline void Fetch( const pvrtc_block *srcBlocks, uint32 block_x, uint32 block_y, uint32 widthBlocks, uint32 heightBlocks )
+    {
+        for ( uint32 row = 0; row < 3; row++ )
+        {
+            uint32 neighbour_y = ( block_y + heightBlocks + row - 1 ) % heightBlocks;
+
+            for ( uint32 column = 0; column < 3; column++ )
+            {
+                uint32 neighbour_x = ( block_x + widthBlocks + column - 1 ) % widthBlocks;
+
+                const pvrtc_block *block = ( srcBlocks + getPVRTCBlockIndex( neighbour_x, neighbour_y, widthBlocks, heightBlocks ) );
+
+                uint32 colorData = block->colorData;
+
+                this->blocks[ row ][ column ] = block;
+
+                getPVRTCColorA( colorData, this->colorsA[ row ][ column ] );
+                getPVRTCColorB( colorData, this->colorsB[ row ][ column ] );
+            }
+        }
+    }
+};
+
+// Returns the colors A and B of a texel of the center block, bilinearly blended from the four closest block centers.
+inline void getPVRTCBlendedColors(
+    const pvrtcNeighbourhood& neighbourhood, bool is2bpp, uint32 x, uint32 y,
+    pvrtcTexel& colorAOut, pvrtcTexel& colorBOut
+)
+{
+    int32 blockWidth = (int32)getPVRTCBlockWidth( is2bpp );
+    int32 blockHeight = (int32)getPVRTCBlockHeight( is2bpp );
+
+    int32 fracX = (int32)x - blockWidth / 2;
+    int32 fracY = (int32)y - blockHeight / 2;
+
+    uint32 column = 1;
+    uint32 row = 1;
+
+    if ( fracX < 0 )
+    {
+        fracX += blockWidth;
+        column = 0;
+    }
+
+    if ( fracY < 0 )
+    {
+        fracY += blockHeight;
+        row = 0;
+    }
+
+    int32 weightP = ( blockWidth - fracX ) * ( blockHeight - fracY );
+    int32 weightQ = fracX * ( blockHeight - fracY );
+    int32 weightR = ( blockWidth - fracX ) * fracY;
+    int32 weightS = fracX * fracY;
+
+    // The weights sum up to 16 (4bpp) or 32 (2bpp).
+    uint32 weightShift = ( is2bpp ? 5 : 4 );
+
+    auto blendChannels = [&]( const pvrtcColor colors[3][3], pvrtcTexel& texelOut )
+    {
+        const pvrtcColor& P = colors[ row ][ column ];
+        const pvrtcColor& Q = colors[ row ][ column + 1 ];
+        const pvrtcColor& R = colors[ row + 1 ][ column ];
+        const pvrtcColor& S = colors[ row + 1 ][ column + 1 ];
+
+        int32 red = ( P.red * weightP + Q.red * weightQ + R.red * weightR + S.red * weightS );
+        int32 green = ( P.green * weightP + Q.green * weightQ + R.green * weightR + S.green * weightS );
+        int32 blue = ( P.blue * weightP + Q.blue * weightQ + R.blue * weightR + S.blue * weightS );
+        int32 alpha = ( P.alpha * weightP + Q.alpha * weightQ + R.alpha * weightR + S.alpha * weightS );
+
+        // Expand the 5bit colors and 4bit alpha to 8bit.
+        texelOut.red = (uint8)( ( red >> ( weightShift + 2 ) ) + ( red >> ( weightShift - 3 ) ) );
+        texelOut.green = (uint8)( ( green >> ( weightShift + 2 ) ) + ( green >> ( weightShift - 3 ) ) );
+        texelOut.blue = (uint8)( ( blue >> ( weightShift + 2 ) ) + ( blue >> ( weightShift - 3 ) ) );
+        texelOut.alpha = (uint8)( ( alpha >> weightShift ) + ( alpha >> ( weightShift - 4 ) ) );
+    };
+
+    blendChannels( neighbourhood.colorsA, colorAOut );
+    blendChannels( neighbourhood.colorsB, colorBOut );
+}
+
+// Modulation weights in eighths of color B.
+static const int32 pvrtcModulationWeights[4] = { 0, 3, 5, 8 };
+static const int32 pvrtcPunchThroughWeights[4] = { 0, 4, 4, 8 };
+
+// Bits 0 and 20 of interpolated 2bpp blocks double as mode flags, so their values are taken from the bits above.
+AINLINE uint32 getPVRTCInterpolatedModulationData( uint32 modulationData, ePVRTCInterpolationMode& interpModeOut )
+{
+    ePVRTCInterpolationMode interpMode = PVRTC_INTERP_HV;
+
+    if ( modulationData & 0x1 )
+    {
+        interpMode = ( ( modulationData & ( 1u << 20 ) ) ? PVRTC_INTERP_V : PVRTC_INTERP_H );
+
+        if ( modulationData & ( 1u << 21 ) )
+        {
+            modulationData |= ( 1u << 20 );
+        }
+        else
+        {
+            modulationData &= ~( 1u << 20 );
+        }
+    }
+
+    if ( modulationData & 0x2 )
+    {
+        modulationData |= 0x1;
+    }
+    else
+    {
+        modulationData &= ~0x1u;
+    }
+
+    interpModeOut = interpMode;
+
+    return modulationData;
+}
+
+// Returns the weight of a 2bpp texel that is stored inside of its block.
+// In interpolated blocks these are the texels where x and y are both odd or both even.
+AINLINE int32 getPVRTC2bppStoredWeight( const pvrtc_block& block, uint32 x, uint32 y )
+{
+    uint32 modulationData = block.modulationData;
+
+    if ( ( block.colorData & PVRTC_MODULATION_MODE_BIT ) == 0 )
+    {
+        return ( ( modulationData >> ( y * 8 + x ) ) & 0x1 ) ? 8 : 0;
+    }
+
+    ePVRTCInterpolationMode interpMode;
+
+    modulationData = getPVRTCInterpolatedModulationData( modulationData, interpMode );
+
+    return pvrtcModulationWeights[ ( modulationData >> ( ( y * 4 + x / 2 ) * 2 ) ) & 0x3 ];
+}
+
+// Fetches a stored 2bpp weight relative to the center block, crossing into the neighbouring blocks.
+AINLINE int32 getPVRTC2bppNeighbourWeight( const pvrtcNeighbourhood& neighbourhood, int32 x, int32 y )
+{
+    uint32 column = 1;
+    uint32 row = 1;
+
+    if ( x < 0 )
+    {
+        x += 8;
+        column = 0;
+    }
+    else if ( x >= 8 )
+    {
+        x -= 8;
+        column = 2;
+    }
+
+    if ( y < 0 )
+    {
+        y += 4;
+        row = 0;
+    }
+    else if ( y >= 4 )
+    {
+        y -= 4;
+        row = 2;
+    }
+
+    return getPVRTC2bppStoredWeight( *neighbourhood.blocks[ row ][ column ], (uint32)x, (uint32)y );
+}
+
+// Decodes the center block of a neighbourhood into RGBA texels, row by row.
+inline void decodePVRTCBlock( const pvrtcNeighbourhood& neighbourhood, bool is2bpp, pvrtcTexel texelsOut[32] )
+{
+    const pvrtc_block& block = *neighbourhood.blocks[ 1 ][ 1 ];
+
+    uint32 blockWidth = getPVRTCBlockWidth( is2bpp );
+    uint32 blockHeight = getPVRTCBlockHeight( is2bpp );
+
+    uint32 modulationData = block.modulationData;
+
+    bool modulationMode = ( block.colorData & PVRTC_MODULATION_MODE_BIT ) != 0;
+
+    ePVRTCInterpolationMode interpMode = PVRTC_INTERP_HV;
+
+    if ( is2bpp && modulationMode )
+    {
+        modulationData = getPVRTCInterpolatedModulationData( modulationData, interpMode );
+    }
+
+    for ( uint32 y = 0; y < blockHeight; y++ )
+    {
+        for ( uint32 x = 0; x < blockWidth; x++ )
+        {
+            int32 weight;
+            bool punchThrough = false;
+
+            if ( is2bpp )
+            {
+                if ( !modulationMode )
+                {
+                    weight = ( ( modulationData >> ( y * 8 + x ) ) & 0x1 ) ? 8 : 0;
+                }
+                else if ( ( ( x ^ y ) & 1 ) == 0 )
+                {
+                    weight = pvrtcModulationWeights[ ( modulationData >> ( ( y * 4 + x / 2 ) * 2 ) ) & 0x3 ];
+                }
+                else
+                {
+                    int32 ix = (int32)x;
+                    int32 iy = (int32)y;
+
+                    if ( interpMode == PVRTC_INTERP_H )
+                    {
+                        weight = ( getPVRTC2bppNeighbourWeight( neighbourhood, ix - 1, iy ) + getPVRTC2bppNeighbourWeight( neighbourhood, ix + 1, iy ) + 1 ) / 2;
+                    }
+                    else if ( interpMode == PVRTC_INTERP_V )
+                    {
+                        weight = ( getPVRTC2bppNeighbourWeight( neighbourhood, ix, iy - 1 ) + getPVRTC2bppNeighbourWeight( neighbourhood, ix, iy + 1 ) + 1 ) / 2;
+                    }
+                    else
+                    {
+                        weight = ( getPVRTC2bppNeighbourWeight( neighbourhood, ix - 1, iy ) + getPVRTC2bppNeighbourWeight( neighbourhood, ix + 1, iy ) +
+                                   getPVRTC2bppNeighbourWeight( neighbourhood, ix, iy - 1 ) + getPVRTC2bppNeighbourWeight( neighbourhood, ix, iy + 1 ) + 2 ) / 4;
+                    }
+                }
+            }
+            else
+            {
+                uint32 modIndex = ( modulationData >> ( ( y * 4 + x ) * 2 ) ) & 0x3;
+
+                if ( modulationMode )
+                {
+                    weight = pvrtcPunchThroughWeights[ modIndex ];
+
+                    punchThrough = ( modIndex == 2 );
+                }
+                else
+                {
+                    weight = pvrtcModulationWeights[ modIndex ];
+                }
+            }
+
+            pvrtcTexel colorA, colorB;
+
+            getPVRTCBlendedColors( neighbourhood, is2bpp, x, y, colorA, colorB );
+
+            pvrtcTexel& texelOut = texelsOut[ y * blockWidth + x ];
+
+            texelOut.red = (uint8)( ( colorA.red * ( 8 - weight ) + colorB.red * weight ) / 8 );
+            texelOut.green = (uint8)( ( colorA.green * ( 8 - weight ) + colorB.green * weight ) / 8 );
+            texelOut.blue = (uint8)( ( colorA.blue * ( 8 - weight ) + colorB.blue * weight ) / 8 );
+            texelOut.alpha = ( punchThrough ? 0 : (uint8)( ( colorA.alpha * ( 8 - weight ) + colorB.alpha * weight ) / 8 ) );
+        }
+    }
+}
+
+// Decodes a compressed PVRTC surface straight into the destination row layout.
+// surfWidth and surfHeight are the dimensions of the compressed surface, while only
+// the layerWidth x layerHeight area is written into the destination.
+inline void decompressPVRTCTexels(
+    Interface *engineInterface, bool is2bpp,
+    uint32 surfWidth, uint32 surfHeight, const void *srcTexels, uint32 srcDataSize,
+    uint32 layerWidth, uint32 layerHeight, void *dstTexels, uint32 dstRowSize,
+    eRasterFormat dstRasterFormat, uint32 dstDepth, eColorOrdering dstColorOrder
+)
+{
+    uint32 blockWidth = getPVRTCBlockWidth( is2bpp );
+    uint32 blockHeight = getPVRTCBlockHeight( is2bpp );
+
+    if ( !isPVRTCSurfaceDimension( surfWidth ) || !isPVRTCSurfaceDimension( surfHeight ) ||
+         surfWidth < blockWidth || surfHeight < blockHeight )
+    {
+        throw RwException( "invalid PVRTC surface dimensions (must be power-of-two)" );
+    }
+
+    uint32 widthBlocks = ( surfWidth / blockWidth );
+    uint32 heightBlocks = ( surfHeight / blockHeight );
+
+    if ( srcDataSize < widthBlocks * heightBlocks * sizeof( pvrtc_block ) )
+    {
+        throw RwException( "PVRTC mipmap data is too small for its dimensions" );
+    }
+
+    // 32bit RGBA and BGRA targets are written directly, everything else goes through the color model.
+    bool isDirectTarget =
+        ( dstDepth == 32 && ( dstRasterFormat == RASTER_8888 || dstRasterFormat == RASTER_888 ) &&
+          ( dstColorOrder == COLOR_RGBA || dstColorOrder == COLOR_BGRA ) );
+
+    bool swapRedBlue = ( dstColorOrder == COLOR_BGRA );
+
+    colorModelDispatcher putDispatch( dstRasterFormat, dstColorOrder, dstDepth, NULL, 0, PALETTE_NONE );
+
+    const pvrtc_block *srcBlocks = (const pvrtc_block*)srcTexels;
+
+    uint32 processBlocksX = std::min( widthBlocks, ALIGN_SIZE( layerWidth, blockWidth ) / blockWidth );
+    uint32 processBlocksY = std::min( heightBlocks, ALIGN_SIZE( layerHeight, blockHeight ) / blockHeight );
+
+    ParallelForEach( (EngineInterface*)engineInterface, processBlocksY,
+        [&]( size_t block_y )
+        {
+            uint32 y = (uint32)( block_y * blockHeight );
+
+            uint32 rowCount = std::min( blockHeight, layerHeight - y );
+
+            for ( uint32 block_x = 0; block_x < processBlocksX; block_x++ )
+            {
+                pvrtcNeighbourhood neighbourhood;
+                neighbourhood.Fetch( srcBlocks, block_x, (uint32)block_y, widthBlocks, heightBlocks );
+
+                pvrtcTexel decoded[32];
+
+                decodePVRTCBlock( neighbourhood, is2bpp, decoded );
+
+                uint32 x = ( block_x * blockWidth );
+
+                uint32 columnCount = std::min( blockWidth, layerWidth - x );
+
+                for ( uint32 row = 0; row < rowCount; row++ )
+                {
+                    void *dstRow = getTexelDataRow( dstTexels, dstRowSize, y + row );
+
+                    const pvrtcTexel *srcRow = ( decoded + row * blockWidth );
+
+                    if ( isDirectTarget )
+                    {
+                        pvrtcTexel *dstTexelRow = ( (pvrtcTexel*)dstRow + x );
+
+                        if ( !swapRedBlue )
+                        {
+                            memcpy( dstTexelRow, srcRow, columnCount * sizeof( pvrtcTexel ) );
+                        }
+                        else
+                        {
+                            for ( uint32 column = 0; column < columnCount; column++ )
+                            {
+                                const pvrtcTexel& srcTexel = srcRow[ column ];
+                                pvrtcTexel& dstTexel = dstTexelRow[ column ];
+
+                                dstTexel.red = srcTexel.blue;
+                                dstTexel.green = srcTexel.green;
+                                dstTexel.blue = srcTexel.red;
+                                dstTexel.alpha = srcTexel.alpha;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        for ( uint32 column = 0; column < columnCount; column++ )
+                        {
+                            const pvrtcTexel& srcTexel = srcRow[ column ];
+
+                            putDispatch.setRGBA( dstRow, x + column, srcTexel.red, srcTexel.green, srcTexel.blue, srcTexel.alpha );
+                        }
+                    }
+                }
+            }
+        }
+    );
+}
+
+// Picks the modulation of every texel of the center block against the blended colors of its neighbourhood.
+inline uint32 fitPVRTCModulation( const pvrtcNeighbourhood& neighbourhood, bool is2bpp, const pvrtcTexel texels[32] )
+{
+    uint32 blockWidth = getPVRTCBlockWidth( is2bpp );
+    uint32 blockHeight = getPVRTCBlockHeight( is2bpp );
+
+    // 2bpp blocks use the direct mode, which selects either color A or color B.
+    uint32 numCandidates = ( is2bpp ? 2 : 4 );
+    uint32 candidateStep = ( is2bpp ? 3 : 1 );
+
+    uint32 modulationData = 0;
+
+    for ( uint32 y = 0; y < blockHeight; y++ )
+    {
+        for ( uint32 x = 0; x < blockWidth; x++ )
+        {
+            pvrtcTexel colorA, colorB;
+
+            getPVRTCBlendedColors( neighbourhood, is2bpp, x, y, colorA, colorB );
+
+            const pvrtcTexel& texel = texels[ y * blockWidth + x ];
+
+            uint32 bestIndex = 0;
+            int32 bestError = 0;
+
+            for ( uint32 candidate = 0; candidate < numCandidates; candidate++ )
+            {
+                int32 weight = pvrtcModulationWeights[ candidate * candidateStep ];
+
+                int32 diffRed = (int32)texel.red - ( colorA.red * ( 8 - weight ) + colorB.red * weight ) / 8;
+                int32 diffGreen = (int32)texel.green - ( colorA.green * ( 8 - weight ) + colorB.green * weight ) / 8;
+                int32 diffBlue = (int32)texel.blue - ( colorA.blue * ( 8 - weight ) + colorB.blue * weight ) / 8;
+                int32 diffAlpha = (int32)texel.alpha - ( colorA.alpha * ( 8 - weight ) + colorB.alpha * weight ) / 8;
+
+                int32 error = ( diffRed * diffRed + diffGreen * diffGreen + diffBlue * diffBlue + diffAlpha * diffAlpha );
+
+                if ( candidate == 0 || error < bestError )
+                {
+                    bestIndex = candidate;
+                    bestError = error;
+                }
+            }
+
+            if ( is2bpp )
+            {
+                modulationData |= ( bestIndex << ( y * 8 + x ) );
+            }
+            else
+            {
+                modulationData |= ( bestIndex << ( ( y * 4 + x ) * 2 ) );
+            }
+        }
+    }
+
+    return modulationData;
+}
+
+// Encodes texels of any framework format into a compressed PVRTC surface of surfWidth x surfHeight.
+// Texels outside of the mipmap are filled up by repeating the border.
+template <typename srcDispatchType>
+inline void compressPVRTCTexels(
+    Interface *engineInterface, bool is2bpp,
+    uint32 mipWidth, uint32 mipHeight, const void *srcTexels, uint32 srcRowSize,
+    srcDispatchType& fetchDispatch,
+    uint32 surfWidth, uint32 surfHeight, void *dstBlocks
+)
+{
+    uint32 blockWidth = getPVRTCBlockWidth( is2bpp );
+    uint32 blockHeight = getPVRTCBlockHeight( is2bpp );
+
+    uint32 widthBlocks = ( surfWidth / blockWidth );
+    uint32 heightBlocks = ( surfHeight / blockHeight );
+
+    pvrtc_block *blocks = (pvrtc_block*)dstBlocks;
+
+    auto fetchBlockTexels = [&]( uint32 block_x, uint32 block_y, pvrtcTexel texelsOut[32] )
+    {
+        for ( uint32 n = 0; n < blockWidth * blockHeight; n++ )
+        {
+            uint32 x = std::min( block_x * blockWidth + ( n % blockWidth ), mipWidth - 1 );
+            uint32 y = std::min( block_y * blockHeight + ( n / blockWidth ), mipHeight - 1 );
+
+            const void *srcRow = getConstTexelDataRow( srcTexels, srcRowSize, y );
+
+            uint8 r, g, b, a;
+
+            bool gotColor = fetchDispatch.getRGBA( srcRow, x, r, g, b, a );
+
+            if ( !gotColor )
+            {
+                r = 0;
+                g = 0;
+                b = 0;
+                a = 0;
+            }
+
+            pvrtcTexel& texel = texelsOut[ n ];
+
+            texel.red = r;
+            texel.green = g;
+            texel.blue = b;
+            texel.alpha = a;
+        }
+    };
+
+    // First pass: the bounding box of every block gives its colors.
+    ParallelForEach( (EngineInterface*)engineInterface, heightBlocks,
+        [&]( size_t block_y )
+        {
+            for ( uint32 block_x = 0; block_x < widthBlocks; block_x++ )
+            {
+                pvrtcTexel texels[32];
+
+                fetchBlockTexels( block_x, (uint32)block_y, texels );
+
+                uint8 minColor[4] = { 255, 255, 255, 255 };
+                uint8 maxColor[4] = { 0, 0, 0, 0 };
+
+                for ( uint32 n = 0; n < blockWidth * blockHeight; n++ )
+                {
+                    const uint8 channels[4] = { texels[n].red, texels[n].green, texels[n].blue, texels[n].alpha };
+
+                    for ( uint32 channel = 0; channel < 4; channel++ )
+                    {
+                        minColor[ channel ] = std::min( minColor[ channel ], channels[ channel ] );
+                        maxColor[ channel ] = std::max( maxColor[ channel ], channels[ channel ] );
+                    }
+                }
+
+                pvrtc_block& block = blocks[ getPVRTCBlockIndex( block_x, (uint32)block_y, widthBlocks, heightBlocks ) ];
+
+                block.modulationData = 0;
+                block.colorData = ( pvrtcPackColorA( minColor ) | pvrtcPackColorB( maxColor ) );
+            }
+        }
+    );
+
+    // Second pass: the colors are final, so the modulation can be fitted against them.
+    // Only the modulation words are written here, which the other threads do not read.
+    ParallelForEach( (EngineInterface*)engineInterface, heightBlocks,
+        [&]( size_t block_y )
+        {
+            for ( uint32 block_x = 0; block_x < widthBlocks; block_x++ )
+            {
+                pvrtcTexel texels[32];
+
+                fetchBlockTexels( block_x, (uint32)block_y, texels );
+
+                pvrtcNeighbourhood neighbourhood;
+                neighbourhood.Fetch( blocks, block_x, (uint32)block_y, widthBlocks, heightBlocks );
+
+                uint32 modulationData = fitPVRTCModulation( neighbourhood, is2bpp, texels );
+
+                pvrtc_block& block = blocks[ getPVRTCBlockIndex( block_x, (uint32)block_y, widthBlocks, heightBlocks ) ];
+
+                block.modulationData = modulationData;
+            }
+        }
+    );
+}
+
+};
+
+#endif //_RENDERWARE_PVR_CODEC_
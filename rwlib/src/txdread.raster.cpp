@@ -125,7 +125,7 @@ void DeleteRaster( Raster *theRaster )
 
 Raster::Raster( const Raster& right )
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( &right ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( &right ) );
 
     // Copy raster specifics.
     this->engineInterface = right.engineInterface;
@@ -143,6 +143,8 @@ Raster::Raster( const Raster& right )
     // Cloned rasters are stand-alone. Thus we reset reference counts to default.
     this->refCount = 1;
     this->constRefCount = 0;
+    this->frozen = false;
+    this->revision = 0;
 }
 
 Raster::~Raster( void )
@@ -196,7 +198,7 @@ void Raster::SetEngineVersion( LibraryVersion version )
 
 LibraryVersion Raster::GetEngineVersion( void ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -263,7 +265,7 @@ void Raster::clearNativeData( void )
 
 bool Raster::hasNativeDataOfType( const char *typeName ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -281,7 +283,7 @@ bool Raster::hasNativeDataOfType( const char *typeName ) const
 
 const char* Raster::getNativeDataTypeName( void ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -305,7 +307,7 @@ void Raster::addConstRef( void )
     //  Reader-activity does not harm the runtime, because it is immutable anyway.
     //  When using a reader-lock, we now have a sense for constRefCount being an atomic variable!
 
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     // When the raster has a const ref count != 0, then it is classified as immutable.
     // Immutable rasters cannot be modified in any way.
@@ -317,7 +319,7 @@ void Raster::addConstRef( void )
 
 void Raster::remConstRef( void )
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     if ( this->constRefCount == 0 )
     {
@@ -330,18 +332,125 @@ void Raster::remConstRef( void )
 
 bool Raster::isImmutable( void ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     return NativeIsRasterImmutable( this );
 }
 
+void Raster::freeze( void )
+{
+    // Taking the writer-lock makes sure that no writer is active while we flip the flag.
+    // Every writer checks for mutability under the lock, so after this point nobody can
+    // change the raster anymore and readers are free to skip the lock.
+    {
+        scoped_rwlock_writer <rwlock> rasterConsistency( GetRasterLock( this ) );
+
+        this->frozen.store( true, std::memory_order_release );
+    }
+}
+
+bool Raster::isFrozen( void ) const
+{
+    return this->frozen.load( std::memory_order_acquire );
+}
+
+uint32 Raster::getRevision( void ) const
+{
+    return this->revision.load( std::memory_order_acquire );
+}
+
+// Shared read handles.
+RasterReadHandle::RasterReadHandle( Raster *theRaster )
+{
+    this->theRaster = AcquireRaster( theRaster );
+    this->hasConstRef = false;
+
+    // Frozen rasters are immutable anyway.
+    if ( theRaster && theRaster->isFrozen() == false )
+    {
+        try
+        {
+            theRaster->addConstRef();
+        }
+        catch( ... )
+        {
+            DeleteRaster( theRaster );
+
+            throw;
+        }
+
+        this->hasConstRef = true;
+    }
+}
+
+RasterReadHandle::RasterReadHandle( const RasterReadHandle& right ) : RasterReadHandle( right.theRaster )
+{
+    // Every copy holds its own references.
+}
+
+RasterReadHandle::RasterReadHandle( RasterReadHandle&& right )
+{
+    this->theRaster = right.theRaster;
+    this->hasConstRef = right.hasConstRef;
+
+    right.theRaster = NULL;
+    right.hasConstRef = false;
+}
+
+RasterReadHandle::~RasterReadHandle( void )
+{
+    this->release();
+}
+
+RasterReadHandle& RasterReadHandle::operator = ( const RasterReadHandle& right )
+{
+    if ( this != &right )
+    {
+        *this = RasterReadHandle( right );
+    }
+
+    return *this;
+}
+
+RasterReadHandle& RasterReadHandle::operator = ( RasterReadHandle&& right )
+{
+    if ( this != &right )
+    {
+        this->release();
+
+        this->theRaster = right.theRaster;
+        this->hasConstRef = right.hasConstRef;
+
+        right.theRaster = NULL;
+        right.hasConstRef = false;
+    }
+
+    return *this;
+}
+
+void RasterReadHandle::release( void )
+{
+    if ( Raster *theRaster = this->theRaster )
+    {
+        if ( this->hasConstRef )
+        {
+            theRaster->remConstRef();
+        }
+
+        DeleteRaster( theRaster );
+
+        this->theRaster = NULL;
+        this->hasConstRef = false;
+    }
+}
+
 void* Raster::getNativeInterface( void )
 {
     // The native interface offers a direct way of access to the native texture.
     // Those are to be used with extreme caution, because security measures of the Raster object are disabled.
     // Be careful.
 
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -360,7 +469,7 @@ void* Raster::getNativeInterface( void )
 
 void* Raster::getDriverNativeInterface( void )
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -3,6 +3,8 @@
 
 #include "txdread.raster.hxx"
 
+#include "pixelformat.hxx"
+
 namespace rw
 {
 
@@ -189,10 +191,28 @@ inline bool GetNativeTextureRawBitmapData(
     return fetchSuccessful;
 }
 
-bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
+const char* GetRasterConversionPlanName( eRasterConversionPlan plan )
+{
+    switch( plan )
+    {
+    case RASTERCONV_NONE:           return "none";
+    case RASTERCONV_SAME_TYPE:      return "same type";
+    case RASTERCONV_PASSTHROUGH:    return "passthrough";
+    case RASTERCONV_SWIZZLE_ONLY:   return "swizzle only";
+    case RASTERCONV_PALETTE_ONLY:   return "palette only";
+    case RASTERCONV_REPACK:         return "repack";
+    case RASTERCONV_TRANSCODE:      return "transcode";
+    }
+
+    return "unknown";
+}
+
+bool ConvertRasterTo( Raster *theRaster, const char *nativeName, eRasterConversionPlan *planOut )
 {
     bool conversionSuccess = false;
 
+    eRasterConversionPlan plan = RASTERCONV_NONE;
+
     EngineInterface *engineInterface = (EngineInterface*)theRaster->engineInterface;
 
     // First get the native texture environment.
@@ -207,6 +227,8 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
         // Make sure the raster is mutable.
         if ( NativeIsRasterImmutable( theRaster ) == false )
         {
+            NativeNotifyRasterChange( theRaster );
+
             // Only convert if the raster has image data.
             if ( PlatformTexture *nativeTex = theRaster->platformData )
             {
@@ -223,6 +245,8 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
                     // If the destination type and the source type match, we are finished.
                     if ( engineInterface->typeSystem.IsSameType( origTypeInfo, dstTypeInfo ) )
                     {
+                        plan = RASTERCONV_SAME_TYPE;
+
                         conversionSuccess = true;
                     }
                     else
@@ -248,6 +272,9 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
                             // 1. Fetch the pixel data.
                             origTypeProvider->GetPixelDataFromTexture( engineInterface, nativeTex, pixelStore );
 
+                            // If the source texture had to give us a copy, it has redone its native layout (unswizzled).
+                            bool didSourceRelayout = pixelStore.isNewlyAllocated;
+
                             try
                             {
                                 // 2. detach the pixel data from the texture and free it.
@@ -262,6 +289,8 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
 
                                 if ( newNativeTex )
                                 {
+                                    eRasterConversionPlan chosenPlan;
+
                                     try
                                     {
                                         // Transfer the version of the raster.
@@ -274,11 +303,36 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
                                         // 4. make pixels compatible for the target format.
                                         // *  First decide what pixel format we have to deduce from the capabilities
                                         //    and then call the "ConvertPixelData" function to do the job.
-                                        CompatibilityTransformPixelData( engineInterface, pixelStore, dstTypeProvider );
+                                        //    Texel buffers that the destination accepts as they are do not go through the converter.
+                                        chosenPlan = CompatibilityTransformPixelData( engineInterface, pixelStore, dstTypeProvider );
 
                                         // The texels have to obey size rules of the destination native texture.
                                         // So let us check what size rules we need, right?
-                                        AdjustPixelDataDimensionsByFormat( engineInterface, dstTypeProvider, pixelStore );
+                                        {
+                                            size_t prevMipmapCount = pixelStore.mipmaps.size();
+
+                                            uint32 prevBaseWidth = 0;
+                                            uint32 prevBaseHeight = 0;
+
+                                            if ( prevMipmapCount != 0 )
+                                            {
+                                                prevBaseWidth = pixelStore.mipmaps[ 0 ].layerWidth;
+                                                prevBaseHeight = pixelStore.mipmaps[ 0 ].layerHeight;
+                                            }
+
+                                            AdjustPixelDataDimensionsByFormat( engineInterface, dstTypeProvider, pixelStore );
+
+                                            // Truncated layers are new texel buffers.
+                                            if ( prevMipmapCount != 0 && chosenPlan < RASTERCONV_REPACK )
+                                            {
+                                                const pixelDataTraversal::mipmapResource& baseLayer = pixelStore.mipmaps[ 0 ];
+
+                                                if ( baseLayer.layerWidth != prevBaseWidth || baseLayer.layerHeight != prevBaseHeight )
+                                                {
+                                                    chosenPlan = RASTERCONV_REPACK;
+                                                }
+                                            }
+                                        }
 
                                         // 5. Put the texels into our texture.
                                         //    Throwing an exception here means that the texture did not apply any of the pixel
@@ -287,6 +341,16 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
 
                                         dstTypeProvider->SetPixelDataToTexture( engineInterface, newNativeTex, pixelStore, acquireFeedback );
 
+                                        // If the texels kept their format but either texture had to redo its
+                                        // native layout, then the move was only a (un)swizzle.
+                                        if ( chosenPlan == RASTERCONV_PASSTHROUGH )
+                                        {
+                                            if ( didSourceRelayout || acquireFeedback.hasDirectlyAcquired == false )
+                                            {
+                                                chosenPlan = RASTERCONV_SWIZZLE_ONLY;
+                                            }
+                                        }
+
                                         if ( acquireFeedback.hasDirectlyAcquired == false )
                                         {
                                             // We need to release the pixels from the storage.
@@ -313,6 +377,8 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
                                     theRaster->platformData = newNativeTex;
 
                                     // We are successful!
+                                    plan = chosenPlan;
+
                                     conversionSuccess = true;
                                 }
                                 else
@@ -340,6 +406,11 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
         }
     }
 
+    if ( planOut )
+    {
+        *planOut = plan;
+    }
+
     return conversionSuccess;
 }
 
@@ -434,7 +505,7 @@ void Raster::convertToFormat(eRasterFormat newFormat)
 
 eRasterFormat Raster::getRasterFormat( void ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -457,7 +528,7 @@ eRasterFormat Raster::getRasterFormat( void ) const
 
 Bitmap Raster::getBitmap(void) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     Interface *engineInterface = this->engineInterface;
 
@@ -520,6 +591,322 @@ Bitmap Raster::getBitmap(void) const
     return resultBitmap;
 }
 
+bool Raster::getMipmapSize( uint32 mipIndex, uint32& width, uint32& height ) const
+{
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
+
+    PlatformTexture *platformTex = this->platformData;
+
+    if ( !platformTex )
+    {
+        throw RwException( "no native data" );
+    }
+
+    Interface *engineInterface = this->engineInterface;
+
+    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+
+    if ( !texProvider )
+    {
+        throw RwException( "invalid native data" );
+    }
+
+    // The native texture knows the real layer dimensions, which do not have to be
+    // the halved base dimensions (non-power-of-two or padded layers).
+    return texProvider->GetMipmapLayerSize( engineInterface, platformTex, mipIndex, width, height );
+}
+
+void Raster::readMipmapBGRA( uint32 mipIndex, uint32 dstWidth, uint32 dstHeight, void *dstTexels, uint32 dstStride ) const
+{
+    if ( dstWidth == 0 || dstHeight == 0 )
+        return;
+
+    if ( dstTexels == NULL || dstStride < dstWidth * sizeof( uint32 ) )
+    {
+        throw RwException( "invalid destination buffer for mipmap read" );
+    }
+
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
+
+    PlatformTexture *platformTex = this->platformData;
+
+    if ( !platformTex )
+    {
+        throw RwException( "no native data" );
+    }
+
+    Interface *engineInterface = this->engineInterface;
+
+    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+
+    if ( !texProvider )
+    {
+        throw RwException( "invalid native data" );
+    }
+
+    // We keep the palette so that we do not allocate an expanded copy of the texels.
+    rawBitmapFetchResult rawBitmap;
+
+    bool gotPixelData = GetNativeTextureRawBitmapData( engineInterface, platformTex, texProvider, mipIndex, true, rawBitmap );
+
+    if ( !gotPixelData )
+    {
+        throw RwException( "failed to fetch mipmap layer for reading" );
+    }
+
+    try
+    {
+        const void *srcTexels = rawBitmap.texelData;
+
+        uint32 srcWidth = rawBitmap.width;
+        uint32 srcHeight = rawBitmap.height;
+
+        uint32 srcRowSize = getRasterDataRowSize( srcWidth, rawBitmap.depth, rawBitmap.rowAlignment );
+
+        eRasterFormat srcFormat = rawBitmap.rasterFormat;
+        eColorOrdering srcOrder = rawBitmap.colorOrder;
+        uint32 srcDepth = rawBitmap.depth;
+
+        if ( srcWidth == dstWidth && srcHeight == dstHeight &&
+             srcFormat == RASTER_8888 && srcOrder == COLOR_BGRA && srcDepth == 32 &&
+             rawBitmap.paletteType == PALETTE_NONE )
+        {
+            // The layer is already in the requested layout, so we can just copy the rows.
+            size_t dstRowDataSize = ( dstWidth * sizeof( uint32 ) );
+
+            for ( uint32 row = 0; row < dstHeight; row++ )
+            {
+                const void *srcRow = getConstTexelDataRow( srcTexels, srcRowSize, row );
+                void *dstRow = getTexelDataRow( dstTexels, dstStride, row );
+
+                memcpy( dstRow, srcRow, dstRowDataSize );
+            }
+        }
+        else
+        {
+            colorModelDispatcher fetchDispatch(
+                srcFormat, srcOrder, srcDepth,
+                rawBitmap.paletteData, rawBitmap.paletteSize, rawBitmap.paletteType
+            );
+
+            // Downscaling averages each source footprint, upscaling picks the nearest texel.
+            for ( uint32 dst_y = 0; dst_y < dstHeight; dst_y++ )
+            {
+                uint32 src_start_y = (uint32)( (uint64)dst_y * srcHeight / dstHeight );
+                uint32 src_end_y = (uint32)( (uint64)( dst_y + 1 ) * srcHeight / dstHeight );
+
+                if ( src_end_y <= src_start_y )
+                {
+                    src_end_y = src_start_y + 1;
+                }
+
+                uint8 *dstRow = (uint8*)getTexelDataRow( dstTexels, dstStride, dst_y );
+
+                for ( uint32 dst_x = 0; dst_x < dstWidth; dst_x++ )
+                {
+                    uint32 src_start_x = (uint32)( (uint64)dst_x * srcWidth / dstWidth );
+                    uint32 src_end_x = (uint32)( (uint64)( dst_x + 1 ) * srcWidth / dstWidth );
+
+                    if ( src_end_x <= src_start_x )
+                    {
+                        src_end_x = src_start_x + 1;
+                    }
+
+                    // Wide sums, because a footprint can cover millions of texels.
+                    uint64 redSum = 0;
+                    uint64 greenSum = 0;
+                    uint64 blueSum = 0;
+                    uint64 alphaSum = 0;
+
+                    for ( uint32 src_y = src_start_y; src_y < src_end_y; src_y++ )
+                    {
+                        const void *srcRow = getConstTexelDataRow( srcTexels, srcRowSize, src_y );
+
+                        for ( uint32 src_x = src_start_x; src_x < src_end_x; src_x++ )
+                        {
+                            uint8 r, g, b, a;
+
+                            bool gotColor = fetchDispatch.getRGBA( srcRow, src_x, r, g, b, a );
+
+                            if ( !gotColor )
+                            {
+                                r = 0;
+                                g = 0;
+                                b = 0;
+                                a = 0;
+                            }
+
+                            redSum += r;
+                            greenSum += g;
+                            blueSum += b;
+                            alphaSum += a;
+                        }
+                    }
+
+                    uint64 sampleCount = (uint64)( src_end_x - src_start_x ) * ( src_end_y - src_start_y );
+                    uint64 roundBias = ( sampleCount / 2 );
+
+                    uint8 *dstTexel = ( dstRow + dst_x * sizeof( uint32 ) );
+
+                    dstTexel[0] = (uint8)( ( blueSum + roundBias ) / sampleCount );
+                    dstTexel[1] = (uint8)( ( greenSum + roundBias ) / sampleCount );
+                    dstTexel[2] = (uint8)( ( redSum + roundBias ) / sampleCount );
+                    dstTexel[3] = (uint8)( ( alphaSum + roundBias ) / sampleCount );
+                }
+            }
+        }
+    }
+    catch( ... )
+    {
+        if ( rawBitmap.isNewlyAllocated )
+        {
+            rawBitmap.FreePixels( engineInterface );
+        }
+
+        throw;
+    }
+
+    if ( rawBitmap.isNewlyAllocated )
+    {
+        rawBitmap.FreePixels( engineInterface );
+    }
+}
+
+// Hashes texel data with two unrelated 64bit functions at once.
+// The primary one is FNV-1a style mixing on a whole word at a time, the check one
+// is multiply-rotate mixing, so that data which collides in one does not collide in the other.
+struct texelDataHasher
+{
+    inline texelDataHasher( void )
+    {
+        this->primary = 14695981039346656037ull;
+        this->check = 0x243F6A8885A308D3ull;
+    }
+
+    AINLINE void mixWord( uint64 value )
+    {
+        this->primary ^= value;
+        this->primary *= 1099511628211ull;
+        this->primary ^= ( this->primary >> 29 );
+
+        uint64 check = ( this->check ^ ( value * 0x9E3779B97F4A7C15ull ) );
+        check = ( ( check << 31 ) | ( check >> 33 ) );
+        this->check = ( check * 0xC2B2AE3D27D4EB4Full );
+    }
+
+    inline void mixData( const void *data, size_t dataSize )
+    {
+        const uint8 *bytes = (const uint8*)data;
+
+        size_t wordCount = ( dataSize / sizeof( uint64 ) );
+
+        for ( size_t n = 0; n < wordCount; n++ )
+        {
+            uint64 word;
+            memcpy( &word, bytes + n * sizeof( uint64 ), sizeof( uint64 ) );
+
+            mixWord( word );
+        }
+
+        // Mix in the trailing bytes together with the length.
+        uint64 tailWord = 0;
+        memcpy( &tailWord, bytes + wordCount * sizeof( uint64 ), dataSize % sizeof( uint64 ) );
+
+        mixWord( tailWord );
+        mixWord( (uint64)dataSize );
+    }
+
+    uint64 primary;
+    uint64 check;
+};
+
+uint64 Raster::getTexelDataHash( uint64 *dataSizeOut, uint64 *checkHashOut ) const
+{
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
+
+    PlatformTexture *platformTex = this->platformData;
+
+    if ( !platformTex )
+    {
+        throw RwException( "no native data" );
+    }
+
+    Interface *engineInterface = this->engineInterface;
+
+    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+
+    if ( !texProvider )
+    {
+        throw RwException( "invalid native data" );
+    }
+
+    pixelDataTraversal pixelData;
+
+    texProvider->GetPixelDataFromTexture( engineInterface, platformTex, pixelData );
+
+    texelDataHasher hasher;
+    uint64 totalDataSize = 0;
+
+    try
+    {
+        // The format decides how the texels are interpreted.
+        hasher.mixWord( pixelData.rasterFormat );
+        hasher.mixWord( pixelData.depth );
+        hasher.mixWord( pixelData.rowAlignment );
+        hasher.mixWord( pixelData.colorOrder );
+        hasher.mixWord( pixelData.paletteType );
+        hasher.mixWord( pixelData.compressionType );
+        hasher.mixWord( pixelData.mipmaps.size() );
+
+        for ( const pixelDataTraversal::mipmapResource& mipLayer : pixelData.mipmaps )
+        {
+            hasher.mixWord( ( (uint64)mipLayer.width << 32 ) | mipLayer.height );
+            hasher.mixWord( ( (uint64)mipLayer.layerWidth << 32 ) | mipLayer.layerHeight );
+
+            hasher.mixData( mipLayer.texels, mipLayer.dataSize );
+
+            totalDataSize += mipLayer.dataSize;
+        }
+
+        if ( pixelData.paletteType != PALETTE_NONE )
+        {
+            uint32 palRasterDepth = Bitmap::getRasterFormatDepth( pixelData.rasterFormat );
+
+            size_t palDataSize = getPaletteDataSize( pixelData.paletteSize, palRasterDepth );
+
+            hasher.mixData( pixelData.paletteData, palDataSize );
+
+            totalDataSize += palDataSize;
+        }
+    }
+    catch( ... )
+    {
+        if ( pixelData.isNewlyAllocated )
+        {
+            pixelData.FreePixels( engineInterface );
+        }
+
+        throw;
+    }
+
+    if ( pixelData.isNewlyAllocated )
+    {
+        pixelData.FreePixels( engineInterface );
+    }
+
+    if ( dataSizeOut )
+    {
+        *dataSizeOut = totalDataSize;
+    }
+
+    if ( checkHashOut )
+    {
+        *checkHashOut = hasher.check;
+    }
+
+    return hasher.primary;
+}
+
 void Raster::setImageData(const Bitmap& srcImage)
 {
     scoped_rwlock_writer <rwlock> rasterConsistency( GetRasterLock( this ) );
@@ -744,10 +744,17 @@ inline RwTypeSystem::typeInfoBase* GetNativeTextureType( Interface *intf, const
 // Only call these functions under the raster consistency lock.
 inline bool NativeIsRasterImmutable( const Raster *raster )
 {
-    return ( raster->constRefCount != 0 );
+    return ( raster->constRefCount != 0 || raster->frozen );
 }
 
-inline void NativeCheckRasterMutable( const Raster *raster )
+// Call this before changing the native data.
+// Whoever caches things about the raster is told through its revision.
+inline void NativeNotifyRasterChange( Raster *raster )
+{
+    raster->revision++;
+}
+
+inline void NativeCheckRasterMutable( Raster *raster )
 {
     bool isImmutable = NativeIsRasterImmutable( raster );
 
@@ -755,6 +762,8 @@ inline void NativeCheckRasterMutable( const Raster *raster )
     {
         throw RwException( "cannot modify raster because immutable" );
     }
+
+    NativeNotifyRasterChange( raster );
 }
 
 }
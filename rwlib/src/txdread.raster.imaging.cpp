@@ -18,7 +18,7 @@ inline bool IsNativeTextureSupportedNativeImagingFormat( Interface *engineInterf
 
 bool Raster::supportsImageMethod( const char *method ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     Interface *engineInterface = this->engineInterface;
 
@@ -56,7 +56,7 @@ bool Raster::supportsImageMethod( const char *method ) const
 
 void Raster::writeImage(Stream *outputStream, const char *method)
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     Interface *engineInterface = this->engineInterface;
 
@@ -8,7 +8,7 @@ namespace rw
 
 void Raster::getSizeRules( rasterSizeRules& rulesOut ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     // We need to fetch that from the native texture.
     PlatformTexture *platformTex = this->platformData;
@@ -67,7 +67,7 @@ void rasterSizeRules::adjustDimensions( uint32 width, uint32 height, uint32& new
 
 void Raster::getFormatString( char *buf, size_t bufSize, size_t& lengthOut ) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     // Ask the native platform texture to deliver us a format string.
     PlatformTexture *platformTex = this->platformData;
@@ -40,6 +40,18 @@ inline rwlock* GetRasterLock( const rw::Raster *ras )
     return NULL;
 }
 
+// Lock for read-only access to a raster.
+// Frozen rasters cannot be written to anymore, so reading them needs no lock.
+inline rwlock* GetRasterReadLock( const rw::Raster *ras )
+{
+    if ( ras->frozen.load( std::memory_order_acquire ) )
+    {
+        return NULL;
+    }
+
+    return GetRasterLock( ras );
+}
+
 };
 
 #endif //_RENDERWARE_RASTER_INTERNALS_
\ No newline at end of file
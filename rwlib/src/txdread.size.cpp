@@ -82,6 +82,10 @@ bool UnregisterResizeFiltering( EngineInterface *engineInterface, rasterResizeFi
 
 void Raster::resize(uint32 newWidth, uint32 newHeight, const char *downsampleMode, const char *upscaleMode)
 {
+    profilingScope profile( this->engineInterface, PROFSTAGE_RESIZE );
+
+    profile.AddTexels( (uint64)newWidth * newHeight );
+
     scoped_rwlock_writer <rwlock> rasterConsistency( GetRasterLock( this ) );
 
     // Make sure we are mutable.
@@ -375,7 +379,7 @@ void Raster::resize(uint32 newWidth, uint32 newHeight, const char *downsampleMod
 
 void Raster::getSize(uint32& width, uint32& height) const
 {
-    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( this ) );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -0,0 +1,224 @@
+// Cheap thumbnail extraction from serialized texture dictionaries.
+// Used by previews (shell extension, texture lists) that only need one small image per archive.
+#include "StdInc.h"
+
+namespace rw
+{
+
+// Deserializes a texture native block, returning NULL if it could not be read as a texture.
+static TextureBase* DeserializeThumbnailTexture( EngineInterface *engineInterface, BlockProvider& texNativeBlock, const char *textureName )
+{
+    RwObject *rwObj = NULL;
+
+    try
+    {
+        rwObj = engineInterface->DeserializeBlock( texNativeBlock );
+    }
+    catch( RwException& )
+    {
+        // If the block regions are not trusted then we cannot skip a broken block.
+        if ( texNativeBlock.doesIgnoreBlockRegions() )
+        {
+            throw;
+        }
+
+        return NULL;
+    }
+
+    if ( !rwObj )
+        return NULL;
+
+    TextureBase *texHandle = ToTexture( engineInterface, rwObj );
+
+    if ( texHandle && textureName != NULL )
+    {
+        if ( stricmp( texHandle->GetName().c_str(), textureName ) != 0 )
+        {
+            texHandle = NULL;
+        }
+    }
+
+    if ( !texHandle )
+    {
+        engineInterface->DeleteRwObject( rwObj );
+    }
+
+    return texHandle;
+}
+
+static void MakeTextureThumbnail( TextureBase *texHandle, uint32 maxWidth, uint32 maxHeight, textureThumbnail& thumbOut )
+{
+    Raster *texRaster = texHandle->GetRaster();
+
+    if ( !texRaster )
+    {
+        throw RwException( "cannot make thumbnail of texture without raster" );
+    }
+
+    // Nobody else knows this raster, so we can freeze it and read it without locking.
+    texRaster->freeze();
+
+    uint32 baseWidth, baseHeight;
+
+    bool gotBaseSize = texRaster->getMipmapSize( 0, baseWidth, baseHeight );
+
+    if ( !gotBaseSize || baseWidth == 0 || baseHeight == 0 )
+    {
+        throw RwException( "cannot make thumbnail of empty texture" );
+    }
+
+    // Fit into the requested box, keeping the aspect ratio.
+    uint32 thumbWidth = baseWidth;
+    uint32 thumbHeight = baseHeight;
+
+    if ( maxWidth != 0 && thumbWidth > maxWidth )
+    {
+        thumbHeight = std::max( 1u, (uint32)( (uint64)thumbHeight * maxWidth / thumbWidth ) );
+        thumbWidth = maxWidth;
+    }
+
+    if ( maxHeight != 0 && thumbHeight > maxHeight )
+    {
+        thumbWidth = std::max( 1u, (uint32)( (uint64)thumbWidth * maxHeight / thumbHeight ) );
+        thumbHeight = maxHeight;
+    }
+
+    // Pick the smallest mipmap level that still covers the thumbnail.
+    uint32 mipmapCount = texRaster->getMipmapCount();
+
+    uint32 srcMipIndex = 0;
+
+    for ( uint32 n = 1; n < mipmapCount; n++ )
+    {
+        uint32 mipWidth, mipHeight;
+
+        if ( !texRaster->getMipmapSize( n, mipWidth, mipHeight ) )
+            break;
+
+        if ( mipWidth < thumbWidth || mipHeight < thumbHeight )
+            break;
+
+        srcMipIndex = n;
+    }
+
+    uint32 thumbStride = ( thumbWidth * sizeof( uint32 ) );
+
+    thumbOut.textureName = texHandle->GetName();
+    thumbOut.baseWidth = baseWidth;
+    thumbOut.baseHeight = baseHeight;
+    thumbOut.width = thumbWidth;
+    thumbOut.height = thumbHeight;
+    thumbOut.texels.resize( (size_t)thumbStride * thumbHeight );
+
+    texRaster->readMipmapBGRA( srcMipIndex, thumbWidth, thumbHeight, thumbOut.texels.data(), thumbStride );
+
+    bool hasAlpha = false;
+
+    for ( size_t n = 3; n < thumbOut.texels.size(); n += 4 )
+    {
+        if ( thumbOut.texels[ n ] != 255 )
+        {
+            hasAlpha = true;
+            break;
+        }
+    }
+
+    thumbOut.hasAlpha = hasAlpha;
+}
+
+bool ReadTextureThumbnail( Interface *intf, Stream *inputStream, uint32 maxWidth, uint32 maxHeight, textureThumbnail& thumbOut, const char *textureName )
+{
+    EngineInterface *engineInterface = (EngineInterface*)intf;
+
+    TextureBase *foundTexture = NULL;
+
+    BlockProvider mainBlock( inputStream, RWBLOCKMODE_READ );
+
+    mainBlock.EnterContext();
+
+    try
+    {
+        uint32 chunkID = mainBlock.getBlockID();
+
+        if ( chunkID == CHUNK_TEXTURENATIVE )
+        {
+            // Just a single texture.
+            foundTexture = DeserializeThumbnailTexture( engineInterface, mainBlock, textureName );
+        }
+        else if ( chunkID == CHUNK_TEXDICTIONARY )
+        {
+            uint32 textureBlockCount = 0;
+            {
+                BlockProvider texDictMetaStructBlock( &mainBlock );
+
+                texDictMetaStructBlock.EnterContext();
+
+                try
+                {
+                    if ( texDictMetaStructBlock.getBlockID() == CHUNK_STRUCT )
+                    {
+                        LibraryVersion libVer = texDictMetaStructBlock.getBlockVersion();
+
+                        if (libVer.rwLibMajor <= 2 || libVer.rwLibMajor == 3 && libVer.rwLibMinor <= 5)
+                        {
+                            textureBlockCount = texDictMetaStructBlock.readUInt32();
+                        }
+                        else
+                        {
+                            textureBlockCount = texDictMetaStructBlock.readUInt16();
+                        }
+                    }
+                }
+                catch( ... )
+                {
+                    texDictMetaStructBlock.LeaveContext();
+
+                    throw;
+                }
+
+                texDictMetaStructBlock.LeaveContext();
+            }
+
+            // Stop at the first texture that matches; the rest of the archive is never parsed.
+            for ( uint32 n = 0; n < textureBlockCount && foundTexture == NULL; n++ )
+            {
+                BlockProvider textureNativeBlock( &mainBlock );
+
+                foundTexture = DeserializeThumbnailTexture( engineInterface, textureNativeBlock, textureName );
+            }
+        }
+    }
+    catch( ... )
+    {
+        mainBlock.LeaveContext();
+
+        if ( foundTexture )
+        {
+            engineInterface->DeleteRwObject( foundTexture );
+        }
+
+        throw;
+    }
+
+    mainBlock.LeaveContext();
+
+    if ( !foundTexture )
+        return false;
+
+    try
+    {
+        MakeTextureThumbnail( foundTexture, maxWidth, maxHeight, thumbOut );
+    }
+    catch( ... )
+    {
+        engineInterface->DeleteRwObject( foundTexture );
+
+        throw;
+    }
+
+    engineInterface->DeleteRwObject( foundTexture );
+
+    return true;
+}
+
+};
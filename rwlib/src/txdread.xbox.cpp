@@ -665,6 +665,21 @@ bool xboxNativeTextureTypeProvider::GetMipmapLayer( Interface *engineInterface,
         );
 }
 
+bool xboxNativeTextureTypeProvider::GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut )
+{
+    NativeTextureXBOX *nativeTex = (NativeTextureXBOX*)objMem;
+
+    xboxMipmapManager mipMan( nativeTex );
+
+    return
+        virtualGetMipmapLayerSize(
+            mipMan,
+            mipIndex,
+            nativeTex->mipmaps,
+            widthOut, heightOut
+        );
+}
+
 bool xboxNativeTextureTypeProvider::AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut )
 {
     NativeTextureXBOX *nativeTex = (NativeTextureXBOX*)objMem;
@@ -428,12 +428,19 @@ void NativeTextureXBOX::swizzleMipmap( Interface *engineInterface, swizzleMipmap
     const void *srcTexels = pixelData.texels;
 
     // Do the permutation.
-    performXBOXSwizzle(
-        srcTexels, newtexels,
-        mipWidth, mipHeight,
-        depth, rowAlignment,
-        false
-    );
+    {
+        profilingScope profile( engineInterface, PROFSTAGE_SWIZZLE );
+
+        profile.AddTexels( (uint64)mipWidth * mipHeight );
+        profile.AddBytes( dataSize );
+
+        performXBOXSwizzle(
+            srcTexels, newtexels,
+            mipWidth, mipHeight,
+            depth, rowAlignment,
+            false
+        );
+    }
 
     // Give new stuff to the runtime.
     pixelData.newWidth = mipWidth;
@@ -460,12 +467,19 @@ void NativeTextureXBOX::unswizzleMipmap( Interface *engineInterface, swizzleMipm
     const void *srcTexels = pixelData.texels;
 
     // Do the permutation.
-    performXBOXSwizzle(
-        srcTexels, newtexels,
-        mipWidth, mipHeight,
-        depth, rowAlignment,
-        true
-    );
+    {
+        profilingScope profile( engineInterface, PROFSTAGE_SWIZZLE );
+
+        profile.AddTexels( (uint64)mipWidth * mipHeight );
+        profile.AddBytes( dataSize );
+
+        performXBOXSwizzle(
+            srcTexels, newtexels,
+            mipWidth, mipHeight,
+            depth, rowAlignment,
+            true
+        );
+    }
 
     // Give new stuff to the runtime.
     pixelData.newWidth = mipWidth;
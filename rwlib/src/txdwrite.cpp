@@ -8,6 +8,8 @@
 
 #include "txdread.raster.hxx"
 
+#include "rwthreading.parallel.hxx"
+
 namespace rw
 {
 
@@ -81,7 +83,7 @@ uint16 GetTexDictionaryRecommendedDriverID( Interface *engineInterface, const Te
 
                 if ( texRaster )
                 {
-                    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( texRaster ) );
+                    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterReadLock( texRaster ) );
 
                     // We can only determine the recommended platform if we have native data.
                     void *nativeObj = texRaster->platformData;
@@ -150,6 +152,102 @@ uint16 GetTexDictionaryRecommendedDriverID( Interface *engineInterface, const Te
     return recommendedPlatform;
 }
 
+// Encodes the texture natives of a dictionary on the worker threads.
+// Every texture is written into its own memory stream and the blocks are appended in dictionary order afterwards.
+static void SerializeTextureBlocksParallel( EngineInterface *engineInterface, BlockProvider& outputProvider, const TexDictionary *txdObj )
+{
+    struct textureBlockJob
+    {
+        TextureBase *texture;
+        Stream *blockStream;
+
+        nativeTextureStreamPlugin::QueuedWarningHandler warnings;
+    };
+
+    std::vector <textureBlockJob> jobs;
+    jobs.reserve( txdObj->numTextures );
+
+    LIST_FOREACH_BEGIN( TextureBase, txdObj->textures.root, texDictNode )
+
+        textureBlockJob job;
+        job.texture = item;
+        job.blockStream = NULL;
+
+        jobs.push_back( job );
+
+    LIST_FOREACH_END
+
+    try
+    {
+        ParallelForEach( engineInterface, jobs.size(),
+            [&]( size_t jobIndex )
+        {
+            textureBlockJob& job = jobs[ jobIndex ];
+
+            Stream *blockStream = engineInterface->CreateStream( RWSTREAMTYPE_MEMORY, RWSTREAMMODE_CREATE, NULL );
+
+            if ( !blockStream )
+            {
+                throw RwException( "failed to create memory stream for texture native block" );
+            }
+
+            job.blockStream = blockStream;
+
+            GlobalPushWarningHandler( engineInterface, &job.warnings );
+
+            try
+            {
+                BlockProvider texNativeBlock( blockStream, RWBLOCKMODE_WRITE );
+
+                engineInterface->SerializeBlock( job.texture, texNativeBlock );
+            }
+            catch( ... )
+            {
+                GlobalPopWarningHandler( engineInterface );
+                throw;
+            }
+
+            GlobalPopWarningHandler( engineInterface );
+        });
+
+        // Append the blocks in order.
+        std::vector <char> blockData;
+
+        for ( textureBlockJob& job : jobs )
+        {
+            for ( std::string& warning : job.warnings.message_list )
+            {
+                engineInterface->PushWarning( std::move( warning ) );
+            }
+
+            Stream *blockStream = job.blockStream;
+
+            blockData.resize( (size_t)blockStream->size() );
+
+            blockStream->seek( 0, RWSEEK_BEG );
+            blockStream->read( blockData.data(), blockData.size() );
+
+            outputProvider.write( blockData.data(), blockData.size() );
+
+            engineInterface->DeleteStream( blockStream );
+
+            job.blockStream = NULL;
+        }
+    }
+    catch( ... )
+    {
+        for ( textureBlockJob& job : jobs )
+        {
+            if ( Stream *blockStream = job.blockStream )
+            {
+                engineInterface->DeleteStream( blockStream );
+            }
+        }
+
+        throw;
+    }
+}
+
 void texDictionaryStreamPlugin::Serialize( Interface *intf, BlockProvider& outputProvider, RwObject *objectToSerialize ) const
 {
     EngineInterface *engineInterface = (EngineInterface*)intf;
@@ -210,16 +308,23 @@ void texDictionaryStreamPlugin::Serialize( Interface *intf, BlockProvider& outpu
 
     // Serialize all textures of this TXD.
     // This is done by appending the textures after the meta block.
-    LIST_FOREACH_BEGIN( TextureBase, txdObj->textures.root, texDictNode )
+    if ( numTextures > 1 && GetParallelWorkerCount( engineInterface ) > 1 )
+    {
+        SerializeTextureBlocksParallel( engineInterface, outputProvider, txdObj );
+    }
+    else
+    {
+        LIST_FOREACH_BEGIN( TextureBase, txdObj->textures.root, texDictNode )
 
-        TextureBase *texture = item;
+            TextureBase *texture = item;
 
-        // Put it into a sub block.
-        BlockProvider texNativeBlock( &outputProvider );
+            // Put it into a sub block.
+            BlockProvider texNativeBlock( &outputProvider );
 
-        engineInterface->SerializeBlock( texture, texNativeBlock );
+            engineInterface->SerializeBlock( texture, texNativeBlock );
 
-    LIST_FOREACH_END
+        LIST_FOREACH_END
+    }
 
     // Write extensions.
     engineInterface->SerializeExtensions( txdObj, outputProvider );
@@ -365,6 +365,21 @@ bool d3d8NativeTextureTypeProvider::GetMipmapLayer( Interface *engineInterface,
         );
 }
 
+bool d3d8NativeTextureTypeProvider::GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut )
+{
+    NativeTextureD3D8 *nativeTex = (NativeTextureD3D8*)objMem;
+
+    d3d8MipmapManager mipMan( nativeTex );
+
+    return
+        virtualGetMipmapLayerSize(
+            mipMan,
+            mipIndex,
+            nativeTex->mipmaps,
+            widthOut, heightOut
+        );
+}
+
 bool d3d8NativeTextureTypeProvider::AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut )
 {
     NativeTextureD3D8 *nativeTex = (NativeTextureD3D8*)objMem;
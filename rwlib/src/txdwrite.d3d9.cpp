@@ -480,6 +480,21 @@ bool d3d9NativeTextureTypeProvider::GetMipmapLayer( Interface *engineInterface,
         );
 }
 
+bool d3d9NativeTextureTypeProvider::GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut )
+{
+    NativeTextureD3D9 *nativeTex = (NativeTextureD3D9*)objMem;
+
+    d3d9MipmapManager mipMan( nativeTex );
+
+    return
+        virtualGetMipmapLayerSize(
+            mipMan,
+            mipIndex,
+            nativeTex->mipmaps,
+            widthOut, heightOut
+        );
+}
+
 bool d3d9NativeTextureTypeProvider::AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut )
 {
     NativeTextureD3D9 *nativeTex = (NativeTextureD3D9*)objMem;
@@ -481,6 +481,21 @@ bool dxtMobileNativeTextureTypeProvider::GetMipmapLayer( Interface *engineInterf
         );
 }
 
+bool dxtMobileNativeTextureTypeProvider::GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut )
+{
+    NativeTextureMobileDXT *nativeTex = (NativeTextureMobileDXT*)objMem;
+
+    dxtMobileMipmapManager mipMan( nativeTex );
+
+    return
+        virtualGetMipmapLayerSize(
+            mipMan,
+            mipIndex,
+            nativeTex->mipmaps,
+            widthOut, heightOut
+        );
+}
+
 bool dxtMobileNativeTextureTypeProvider::AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut )
 {
     NativeTextureMobileDXT *nativeTex = (NativeTextureMobileDXT*)objMem;
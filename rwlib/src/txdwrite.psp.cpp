@@ -169,6 +169,105 @@ void pspNativeTextureTypeProvider::SerializeTexture( TextureBase *theTexture, Pl
     engineInterface->SerializeExtensions( theTexture, inputProvider );
 }
 
+// Block-copy kernel for the PSP 32bit permutation.
+// The packed buffer is a linear stream of 1x8 line clusters: every cluster is eight 16-byte
+// lines stacked vertically in the raw plane, and clusters are stored row-major. Instead of
+// moving every line through the generic tile processor we walk both buffers with pointers.
+// Only valid if the plane height is cluster-aligned, otherwise use the generic path.
+inline bool PermutePSPTex32Lines(
+    Interface *engineInterface,
+    uint32 paneWidth, uint32 paneHeight, const void *srcTexels,
+    uint32 srcRowAlignment, uint32 dstRowAlignment,
+    bool doSwizzleOrUnswizzle,
+    void*& dstTexelsOut, uint32& dstDataSizeOut
+)
+{
+    const uint32 lineDepth = 128;
+    const uint32 lineSize = ( lineDepth / 8 );
+    const uint32 clusterHeight = 8;
+
+    if ( ( paneHeight % clusterHeight ) != 0 )
+        return false;
+
+    uint32 dstRowSize = getRasterDataRowSize( paneWidth, lineDepth, dstRowAlignment );
+
+    uint32 dstDataSize = getRasterDataSizeByRowSize( dstRowSize, paneHeight );
+
+    void *dstTexels = engineInterface->PixelAllocate( dstDataSize );
+
+    if ( !dstTexels )
+    {
+        return false;
+    }
+
+    uint32 srcRowSize = getRasterDataRowSize( paneWidth, lineDepth, srcRowAlignment );
+
+    // Figure out which side is the raw plane and which is the packed stream.
+    const char *planeSrc = NULL;
+    char *planeDst = NULL;
+    const char *packedSrc = NULL;
+    char *packedDst = NULL;
+    uint32 planeRowSize, packedRowSize;
+
+    if ( doSwizzleOrUnswizzle )
+    {
+        planeSrc = (const char*)srcTexels;
+        planeRowSize = srcRowSize;
+
+        packedDst = (char*)dstTexels;
+        packedRowSize = dstRowSize;
+    }
+    else
+    {
+        packedSrc = (const char*)srcTexels;
+        packedRowSize = srcRowSize;
+
+        planeDst = (char*)dstTexels;
+        planeRowSize = dstRowSize;
+    }
+
+    uint32 packed_x = 0;
+    uint32 packed_y = 0;
+
+    uint32 cols_height = ( paneHeight / clusterHeight );
+
+    for ( uint32 colY = 0; colY < cols_height; colY++ )
+    {
+        uint32 planeRowOff = ( colY * clusterHeight * planeRowSize );
+
+        for ( uint32 colX = 0; colX < paneWidth; colX++ )
+        {
+            uint32 planeOff = ( planeRowOff + colX * lineSize );
+
+            for ( uint32 line = 0; line < clusterHeight; line++ )
+            {
+                uint32 packedOff = ( packed_y * packedRowSize + packed_x * lineSize );
+
+                if ( doSwizzleOrUnswizzle )
+                {
+                    memcpy( packedDst + packedOff, planeSrc + planeOff, lineSize );
+                }
+                else
+                {
+                    memcpy( planeDst + planeOff, packedSrc + packedOff, lineSize );
+                }
+
+                planeOff += planeRowSize;
+
+                if ( ++packed_x == paneWidth )
+                {
+                    packed_x = 0;
+                    packed_y++;
+                }
+            }
+        }
+    }
+
+    dstTexelsOut = dstTexels;
+    dstDataSizeOut = dstDataSize;
+    return true;
+}
+
 inline bool TranscodePermutePSPMipmapLayer_native(
     Interface *engineInterface,
     uint32 layerWidth, uint32 layerHeight, const void *srcTexels,
@@ -188,6 +287,10 @@ inline bool TranscodePermutePSPMipmapLayer_native(
     {
         assert( itemDepth == 32 );
 
+        profilingScope profile( engineInterface, PROFSTAGE_SWIZZLE );
+
+        profile.AddTexels( (uint64)layerWidth * layerHeight );
+
         // TODO: we can generalize this routine into a pixel-block-unpacker algorithm based on little-data.
 
         // In contrast to the Graphics Synthesizer memory encoding, the PSP appears to have a mixture
@@ -204,15 +307,27 @@ inline bool TranscodePermutePSPMipmapLayer_native(
         const uint32 psmct32_permCluster_width = 1;
         const uint32 psmct32_permCluster_height = 8;
 
+        // Try moving whole lines first.
         success =
-            memcodec::permutationUtilities::TranscodeTextureLayerTiles(
+            PermutePSPTex32Lines(
                 engineInterface, permutePane_width, permutePane_height, srcTexels,
-                permDepth,
                 srcRowAlignment, dstRowAlignment,
-                psmct32_permCluster_width, psmct32_permCluster_height,
                 doSwizzleOrUnswizzle,
                 dstTexels, dstDataSize
             );
+
+        if ( !success )
+        {
+            success =
+                memcodec::permutationUtilities::TranscodeTextureLayerTiles(
+                    engineInterface, permutePane_width, permutePane_height, srcTexels,
+                    permDepth,
+                    srcRowAlignment, dstRowAlignment,
+                    psmct32_permCluster_width, psmct32_permCluster_height,
+                    doSwizzleOrUnswizzle,
+                    dstTexels, dstDataSize
+                );
+        }
     }
     // Otherwise we have encountered an unknown permutation strategy.
     // Should not happen, but we handle it safely in case.
@@ -857,6 +972,8 @@ void pspNativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInter
 
     NativeTexturePSP *nativeTex = (NativeTexturePSP*)objMem;
 
+    nativeTex->alphaCache.Invalidate();
+
     eRasterFormat srcRasterFormat = pixelsIn.rasterFormat;
     uint32 srcDepth = pixelsIn.depth;
     uint32 srcRowAlignment = pixelsIn.rowAlignment;
@@ -1045,6 +1162,8 @@ void pspNativeTextureTypeProvider::UnsetPixelDataFromTexture( Interface *engineI
 
     NativeTexturePSP *nativeTex = (NativeTexturePSP*)objMem;
 
+    nativeTex->alphaCache.Invalidate();
+
     if ( deallocate )
     {
         // Request to delete all color memory from this native texture.
@@ -1383,10 +1502,27 @@ bool pspNativeTextureTypeProvider::GetMipmapLayer( Interface *engineInterface, v
     );
 }
 
+bool pspNativeTextureTypeProvider::GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut )
+{
+    NativeTexturePSP *nativeTex = (NativeTexturePSP*)objMem;
+
+    pspMipmapManager <false> mipMan( nativeTex );
+
+    return
+        virtualGetMipmapLayerSize(
+            mipMan,
+            mipIndex,
+            nativeTex->mipmaps,
+            widthOut, heightOut
+        );
+}
+
 bool pspNativeTextureTypeProvider::AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut )
 {
     NativeTexturePSP *nativeTex = (NativeTexturePSP*)objMem;
 
+    nativeTex->alphaCache.Invalidate();
+
     pspMipmapManager <false> mipMan( nativeTex );
 
     return virtualAddMipmapLayer
@@ -1421,9 +1557,19 @@ bool pspNativeTextureTypeProvider::DoesTextureHaveAlpha( const void *objMem )
 {
     // Just like in the PS2 native texture, this operation is expensive.
     // No alpha flag is being stored in the native texture, after all.
+    // So we only do it once until the texels change.
 
     const NativeTexturePSP *nativeTex = (const NativeTexturePSP*)objMem;
 
+    {
+        bool cachedHasAlpha;
+
+        if ( nativeTex->alphaCache.Get( cachedHasAlpha ) )
+        {
+            return cachedHasAlpha;
+        }
+    }
+
     Interface *engineInterface = nativeTex->engineInterface;
 
     pspMipmapManager <true> mipMan( nativeTex );
@@ -1470,6 +1616,8 @@ bool pspNativeTextureTypeProvider::DoesTextureHaveAlpha( const void *objMem )
         engineInterface->PixelFree( rawLayer.mipData.texels );
     }
 
+    nativeTex->alphaCache.Set( hasAlpha );
+
     return hasAlpha;
 }
 
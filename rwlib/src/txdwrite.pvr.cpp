@@ -143,106 +143,51 @@ void pvrNativeTextureTypeProvider::SerializeTexture( TextureBase *theTexture, Pl
 }
 
 void pvrNativeTextureTypeProvider::DecompressPVRMipmap(
-    Interface *engineInterface,
-    uint32 mipWidth, uint32 mipHeight, uint32 layerWidth, uint32 layerHeight, const void *srcTexels,
-    eRasterFormat pvrRasterFormat, uint32 pvrDepth, eColorOrdering pvrColorOrder,
+    Interface *engineInterface, ePVRInternalFormat internalFormat,
+    uint32 mipWidth, uint32 mipHeight, uint32 layerWidth, uint32 layerHeight, const void *srcTexels, uint32 srcDataSize,
     eRasterFormat targetRasterFormat, uint32 targetDepth, uint32 targetRowAlignment, eColorOrdering targetColorOrder,
-    PVRPixelType pvrSrcPixelType, PVRPixelType pvrDstPixelType,
     void*& dstTexelsOut, uint32& dstDataSizeOut
 )
 {
-    // Create a PVR texture.
-    PVRTextureHeader pvrHeader = PVRTextureHeaderCreate( PVRPixelTypeGetID( pvrSrcPixelType ), mipHeight, mipWidth );
+    profilingScope profile( engineInterface, PROFSTAGE_DECOMPRESS );
 
-    if ( !pvrHeader )
-    {
-        throw RwException( "failed to create PVRTexLib texture header" );
-    }
-
-    try
-    {
-        PVRTexture pvrSourceTexture = PVRTextureCreate( pvrHeader, srcTexels );
-
-        if ( !pvrSourceTexture )
-        {
-            throw RwException( "failed to create PVRTexLib texture" );
-        }
-        
-        try
-        {
-            // Decompress it.
-            bool transcodeSuccess =
-                PVRTranscode( pvrSourceTexture, pvrDstPixelType, ePVRTVarTypeUnsignedByteNorm, ePVRTCSpacelRGB );
-
-            if ( transcodeSuccess == false )
-            {
-                throw RwException( "failed to decompress PVRTC compressed data using PVRTexLib" );
-            }
-
-            // Create a new raw texture of the layer dimensions.
-            uint32 dstRowSize = getRasterDataRowSize( layerWidth, targetDepth, targetRowAlignment );
-
-            uint32 dstDataSize = getRasterDataSizeByRowSize( dstRowSize, layerHeight );
-
-            uint32 pvrWidth = mipWidth;
-            uint32 pvrHeight = mipHeight;
-
-            uint32 pvrRowSize = getRasterDataRowSize( pvrWidth, pvrDepth, getPVRToolTextureDataRowAlignment() );
-
-            const void *srcTexelPtr = PVRTextureGetDataPtr( pvrSourceTexture );
-
-            // Allocate new texels.
-            void *dstTexels = engineInterface->PixelAllocate( dstDataSize );
+    profile.AddTexels( (uint64)layerWidth * layerHeight );
+    profile.AddBytes( srcDataSize );
 
-            if ( !dstTexels )
-            {
-                throw RwException( "failed to allocate destination surface for decompressed PowerVR native texture data" );
-            }
-
-            try
-            {
-                colorModelDispatcher fetchDispatch( pvrRasterFormat, pvrColorOrder, pvrDepth, NULL, 0, PALETTE_NONE );
-                colorModelDispatcher putDispatch( targetRasterFormat, targetColorOrder, targetDepth, NULL, 0, PALETTE_NONE );
-
-                copyTexelDataBounded(
-                    srcTexelPtr, dstTexels,
-                    fetchDispatch, putDispatch,
-                    pvrWidth, pvrHeight,
-                    layerWidth, layerHeight,
-                    0, 0,
-                    0, 0,
-                    pvrRowSize, dstRowSize
-                );
-            }
-            catch( ... )
-            {
-                // If anything went wrong in the pixel fetching, we free our data.
-                engineInterface->PixelFree( dstTexels );
+    // Create a new raw texture of the layer dimensions.
+    uint32 dstRowSize = getRasterDataRowSize( layerWidth, targetDepth, targetRowAlignment );
 
-                throw;
-            }
+    uint32 dstDataSize = getRasterDataSizeByRowSize( dstRowSize, layerHeight );
 
-            // Give things to the runtime.
-            dstTexelsOut = dstTexels;
-            dstDataSizeOut = dstDataSize;
-        }
-        catch( ... )
-        {
-            PVRTextureDelete( pvrSourceTexture );
+    // Allocate new texels.
+    void *dstTexels = engineInterface->PixelAllocate( dstDataSize );
 
-            throw;
-        }
+    if ( !dstTexels )
+    {
+        throw RwException( "failed to allocate destination surface for decompressed PowerVR native texture data" );
+    }
 
-        PVRTextureDelete( pvrSourceTexture );
+    try
+    {
+        // The codec writes straight into the target row layout.
+        decompressPVRTCTexels(
+            engineInterface, ( getDepthByPVRFormat( internalFormat ) == 2 ),
+            mipWidth, mipHeight, srcTexels, srcDataSize,
+            layerWidth, layerHeight, dstTexels, dstRowSize,
+            targetRasterFormat, targetDepth, targetColorOrder
+        );
     }
     catch( ... )
     {
-        PVRTextureHeaderDelete( pvrHeader );
+        // If anything went wrong in the decompression, we free our data.
+        engineInterface->PixelFree( dstTexels );
 
         throw;
     }
 
-    PVRTextureHeaderDelete( pvrHeader );
+    // Give things to the runtime.
+    dstTexelsOut = dstTexels;
+    dstDataSizeOut = dstDataSize;
 }
 
 inline void getPVRTargetRasterFormat( ePVRInternalFormat internalFormat, eRasterFormat& targetRasterFormat, uint32& targetDepth, eColorOrdering& targetColorOrder )
@@ -287,17 +232,6 @@ void pvrNativeTextureTypeProvider::GetPixelDataFromTexture( Interface *engineInt
 
     pixelsOut.mipmaps.resize( mipmapCount );
     {
-        // Create source of the pixel type descriptor.
-        PVRPixelType pvrSrcPixelType = PVRGetCachedPixelType( internalFormat );
-
-        if ( !pvrSrcPixelType )
-        {
-            throw RwException( "failed to decompress PVRTC due to unknown internalFormat" );
-        }
-
-        // We need a pixel type for the decompressed format.
-        PVRPixelType pvrDstPixelType = this->pvrPixelType_rgba8888;
-
         for ( size_t n = 0; n < mipmapCount; n++ )
         {
             // Get parameters of this mipmap layer.
@@ -316,11 +250,9 @@ void pvrNativeTextureTypeProvider::GetPixelDataFromTexture( Interface *engineInt
             uint32 dstDataSize = 0;
 
             DecompressPVRMipmap(
-                engineInterface,
-                mipWidth, mipHeight, layerWidth, layerHeight, srcTexels,
-                RASTER_8888, 32, COLOR_RGBA,
+                engineInterface, internalFormat,
+                mipWidth, mipHeight, layerWidth, layerHeight, srcTexels, mipLayer.dataSize,
                 targetRasterFormat, targetDepth, targetRowAlignment, targetColorOrder,
-                pvrSrcPixelType, pvrDstPixelType,
                 dstTexels, dstDataSize
             );
 
@@ -415,29 +347,6 @@ void pvrNativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInter
 
     // Compress mipmap layers.
     {
-        // Determine the source pixel format.
-        PVRPixelType pvrSrcPixelType = this->pvrPixelType_rgba8888;
-
-        // Transform the internal format into a pvrtexlib parameter.
-        PVRPixelType pvrDstPixelType = PVRGetCachedPixelType( internalFormat );
-
-        if ( !pvrDstPixelType )
-        {
-            throw RwException( "failed to compress PVRTC due to unknown internalFormat" );
-        }
-
-        // Determine the block dimensions of the PVR destination texture.
-        uint32 pvrBlockWidth, pvrBlockHeight;
-
-        uint32 pvrDepth = getDepthByPVRFormat( internalFormat );
-
-        bool gotDimms = getPVRCompressionBlockDimensions( pvrDepth, pvrBlockWidth, pvrBlockHeight );
-
-        if ( !gotDimms )
-        {
-            throw RwException( "failed to get PVR block compression dimensions in PVR native texture texel acquisition" );
-        }
-
         // Pre-allocate the mipmap array.
         pvrTex->mipmaps.resize( mipmapCount );
 
@@ -462,13 +371,9 @@ void pvrNativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInter
             uint32 dstDataSize = 0;
 
             CompressMipmapToPVR(
-                engineInterface,
+                engineInterface, internalFormat,
                 mipWidth, mipHeight, srcTexels,
                 srcRasterFormat, srcDepth, srcRowAlignment, srcColorOrder, srcPaletteType, paletteData, paletteSize,
-                RASTER_8888, 32, COLOR_RGBA,
-                pvrSrcPixelType, pvrDstPixelType,
-                pvrBlockWidth, pvrBlockHeight,
-                pvrDepth,
                 compressedWidth, compressedHeight,
                 dstTexels, dstDataSize
             );
@@ -567,27 +472,14 @@ struct pvrMipmapManager
 
         getPVRTargetRasterFormat( internalFormat, targetRasterFormat, targetDepth, targetColorOrder );
 
-        // Create source of the pixel type descriptor.
-        pvrNativeTextureTypeProvider::PVRPixelType pvrSrcPixelType = typeProv->PVRGetCachedPixelType( internalFormat );
-
-        if ( !pvrSrcPixelType )
-        {
-            throw RwException( "failed to decompress PVRTC due to unknown internalFormat" );
-        }
-
-        // We need a pixel type for the decompressed format.
-        pvrNativeTextureTypeProvider::PVRPixelType pvrDstPixelType = typeProv->pvrPixelType_rgba8888;
-
         // Do the decompression.
         void *dstTexels = NULL;
         uint32 dstDataSize = 0;
 
         typeProv->DecompressPVRMipmap(
-            engineInterface,
-            mipWidth, mipHeight, layerWidth, layerHeight, srcTexels,
-            RASTER_8888, 32, COLOR_RGBA,
+            engineInterface, internalFormat,
+            mipWidth, mipHeight, layerWidth, layerHeight, srcTexels, mipLayer.dataSize,
             targetRasterFormat, targetDepth, targetRowAlignment, targetColorOrder,
-            pvrSrcPixelType, pvrDstPixelType,
             dstTexels, dstDataSize
         );
 
@@ -674,29 +566,6 @@ struct pvrMipmapManager
             srcTexelsNewlyAllocated = true;
         }
 
-        // Determine the source pixel format.
-        pvrNativeTextureTypeProvider::PVRPixelType pvrSrcPixelType = typeProv->pvrPixelType_rgba8888;
-
-        // Transform the internal format into a pvrtexlib parameter.
-        pvrNativeTextureTypeProvider::PVRPixelType pvrDstPixelType = typeProv->PVRGetCachedPixelType( internalFormat );
-
-        if ( !pvrDstPixelType )
-        {
-            throw RwException( "failed to compress PVRTC due to unknown internalFormat" );
-        }
-
-        // Determine the block dimensions of the PVR destination texture.
-        uint32 pvrBlockWidth, pvrBlockHeight;
-
-        uint32 pvrDepth = getDepthByPVRFormat( internalFormat );
-
-        bool gotDimms = getPVRCompressionBlockDimensions( pvrDepth, pvrBlockWidth, pvrBlockHeight );
-
-        if ( gotDimms )
-        {
-            throw RwException( "failed to get PVR native texture block compression dimensions in mipmap texel acquisition" );
-        }
-
         // Do the compression.
         uint32 compressedWidth, compressedHeight;
 
@@ -704,13 +573,9 @@ struct pvrMipmapManager
         uint32 dstDataSize = 0;
 
         typeProv->CompressMipmapToPVR(
-            engineInterface,
+            engineInterface, internalFormat,
             width, height, srcTexels,
             rasterFormat, depth, rowAlignment, colorOrder, paletteType, paletteData, paletteSize,
-            RASTER_8888, 32, COLOR_RGBA,
-            pvrSrcPixelType, pvrDstPixelType,
-            pvrBlockWidth, pvrBlockHeight,
-            pvrDepth,
             compressedWidth, compressedHeight,
             dstTexels, dstDataSize
         );
@@ -750,6 +615,21 @@ bool pvrNativeTextureTypeProvider::GetMipmapLayer( Interface *engineInterface, v
         );
 }
 
+bool pvrNativeTextureTypeProvider::GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut )
+{
+    NativeTexturePVR *nativeTex = (NativeTexturePVR*)objMem;
+
+    pvrMipmapManager mipMan( this, nativeTex );
+
+    return
+        virtualGetMipmapLayerSize(
+            mipMan,
+            mipIndex,
+            nativeTex->mipmaps,
+            widthOut, heightOut
+        );
+}
+
 bool pvrNativeTextureTypeProvider::AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut )
 {
     NativeTexturePVR *nativeTex = (NativeTexturePVR*)objMem;
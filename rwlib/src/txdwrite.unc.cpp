@@ -414,6 +414,21 @@ bool uncNativeTextureTypeProvider::GetMipmapLayer( Interface *engineInterface, v
         );
 }
 
+bool uncNativeTextureTypeProvider::GetMipmapLayerSize( Interface *engineInterface, void *objMem, uint32 mipIndex, uint32& widthOut, uint32& heightOut )
+{
+    NativeTextureMobileUNC *nativeTex = (NativeTextureMobileUNC*)objMem;
+
+    uncMipmapManager mipMan( nativeTex );
+
+    return
+        virtualGetMipmapLayerSize(
+            mipMan,
+            mipIndex,
+            nativeTex->mipmaps,
+            widthOut, heightOut
+        );
+}
+
 bool uncNativeTextureTypeProvider::AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut )
 {
     NativeTextureMobileUNC *nativeTex = (NativeTextureMobileUNC*)objMem;
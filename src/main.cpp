@@ -137,6 +137,7 @@ extern void InitializeMassExportToolEnvironment( void );
 extern void InitializeMassBuildEnvironment( void );
 extern void InitializeGUISerialization(void);
 extern void InitializeStreamCompressionEnvironment( void );
+extern void InitializeTexturePreviewCacheEnvironment( void );
 
 static defaultMemAlloc _factMemAlloc;
 
@@ -157,6 +158,7 @@ int main(int argc, char *argv[])
     InitializeMassBuildEnvironment();
     InitializeGUISerialization();
     InitializeStreamCompressionEnvironment();
+    InitializeTexturePreviewCacheEnvironment();
 
     int iRet = -1;
 
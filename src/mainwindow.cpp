@@ -18,6 +18,7 @@
 #include <QDragLeaveEvent>
 #include <QDropEvent>
 #include <qmimedata.h>
+#include <QThread>
 
 #include "styles.h"
 #include "rwversiondialog.h"
@@ -55,6 +56,7 @@ MainWindow::MainWindow(QString appPath, rw::Interface *engineInterface, CFileSys
     this->currentTXD = NULL;
     this->txdNameLabel = NULL;
     this->currentSelectedTexture = NULL;
+    this->viewedPreviewRaster = NULL;
     this->txdLog = NULL;
     this->verDlg = NULL;
     this->texNameDlg = NULL;
@@ -1152,6 +1154,11 @@ void MainWindow::setCurrentTXD( rw::TexDictionary *txdObj )
 
         this->currentSelectedTexture = NULL;
 
+        // The cached previews keep the rasters alive.
+        InvalidateTexturePreviews( this );
+
+        this->thumbnailItems.clear();
+
         this->rwEngine->DeleteRwObject( this->currentTXD );
 
         this->currentTXD = NULL;
@@ -1207,6 +1214,8 @@ void MainWindow::updateTextureList( bool selectLastItemInList )
 
         if (texInfoToSelect)
             listWidget->setCurrentItem(texInfoToSelect->listItem);
+
+        this->updateTexturePreviews();
     }
 }
 
@@ -1540,6 +1549,25 @@ void MainWindow::adjustDimensionsByViewport( void )
     // TODO.
 }
 
+eTexPreviewType MainWindow::getTextureViewPreviewType( rw::Raster *raster ) const
+{
+    if ( this->drawMipmapLayers && raster->getMipmapCount() > 1 )
+    {
+        return eTexPreviewType::FULL_MIPMAPS;
+    }
+
+    return eTexPreviewType::FULL;
+}
+
+void MainWindow::showTextureViewPixmap( rw::Raster *raster, const QPixmap& pixmap )
+{
+    imageWidget->setPixmap(pixmap);
+    this->updateTextureViewport();
+    imageWidget->show();
+
+    this->viewedPreviewRaster = raster;
+}
+
 void MainWindow::updateTextureView( void )
 {
     TexInfoWidget *texItem = this->currentSelectedTexture;
@@ -1551,37 +1579,137 @@ void MainWindow::updateTextureView( void )
 		rw::Raster *rasterData = theTexture->GetRaster();
 		if (rasterData)
 		{
-            try
+            // Previews are decoded in the background. If it is not ready yet, then
+            // we are notified once it is.
+            QPixmap texPixmap;
+
+            if ( GetTexturePreview( this, rasterData, this->getTextureViewPreviewType( rasterData ), texPixmap ) )
             {
-			    // Get a bitmap to the raster.
-			    // This is a 2D color component surface.
-			    rw::Bitmap rasterBitmap( this->rwEngine, 32, rw::RASTER_8888, rw::COLOR_BGRA );
+                this->showTextureViewPixmap( rasterData, texPixmap );
+            }
+            else if ( this->viewedPreviewRaster != rasterData )
+            {
+                // Do not keep showing another texture.
+                this->clearViewImage();
+            }
 
-                if ( this->drawMipmapLayers && rasterData->getMipmapCount() > 1 )
-                {
-                    rasterBitmap.setBgColor( 1.0, 1.0, 1.0, 0.0 );
+            // Prepare the neighbouring textures, so that browsing through the list is instant.
+            QListWidget *texListWidget = this->textureListWidget;
 
-                    rw::DebugDrawMipmaps( this->rwEngine, rasterData, rasterBitmap );
-                }
-                else
+            int curRow = texListWidget->row( texItem->listItem );
+
+            for ( int row = curRow - 1; row <= curRow + 1; row += 2 )
+            {
+                if ( row < 0 || row >= texListWidget->count() )
+                    continue;
+
+                TexInfoWidget *neighbour = dynamic_cast <TexInfoWidget*> ( texListWidget->itemWidget( texListWidget->item( row ) ) );
+
+                if ( neighbour )
                 {
-                    rasterBitmap = rasterData->getBitmap();
+                    if ( rw::Raster *neighbourRaster = neighbour->GetTextureHandle()->GetRaster() )
+                    {
+                        PrefetchTexturePreview( this, neighbourRaster, this->getTextureViewPreviewType( neighbourRaster ) );
+                    }
                 }
+            }
+		}
+    }
+}
+
+void MainWindow::updateTexturePreviews( void )
+{
+    // Schedule the pictures of the texture list.
+    QListWidget *textureList = this->textureListWidget;
+
+    int rowCount = textureList->count();
+
+    this->thumbnailItems.clear();
+
+    std::set <rw::Raster*> usedRasters;
 
-			    QImage texImage = convertRWBitmapToQImage( rasterBitmap );
+    for ( int row = 0; row < rowCount; row++ )
+    {
+        TexInfoWidget *texInfo = dynamic_cast <TexInfoWidget*> ( textureList->itemWidget( textureList->item( row ) ) );
+
+        if ( texInfo )
+        {
+            rw::TextureBase *texHandle = texInfo->GetTextureHandle();
+
+            rw::Raster *rasterData = ( texHandle ? texHandle->GetRaster() : NULL );
+
+            if ( rasterData )
+            {
+                this->thumbnailItems.insert( std::make_pair( rasterData, texInfo ) );
 
-			    imageWidget->setPixmap(QPixmap::fromImage(texImage));
-                this->updateTextureViewport();
-			    imageWidget->show();
+                usedRasters.insert( rasterData );
             }
-            catch( rw::RwException& except )
+
+            QPixmap thumbnail;
+
+            if ( rasterData && GetTexturePreview( this, rasterData, eTexPreviewType::THUMBNAIL, thumbnail, false ) )
             {
-				this->txdLog->addLogMessage(QString("failed to get bitmap from texture: ") + except.message.c_str(), LOGMSG_WARNING);
+                texInfo->SetPreview( thumbnail );
+            }
+        }
+    }
 
-                // We hide the image widget.
-                this->clearViewImage();
+    // Replaced and deleted rasters do not need their previews anymore.
+    PruneTexturePreviews( this, usedRasters );
+
+    // The viewport has priority over the list.
+    this->updateTextureView();
+}
+
+void MainWindow::onTexturePreviewReady( rw::Raster *raster, eTexPreviewType type, const QPixmap& pixmap )
+{
+    if ( type == eTexPreviewType::THUMBNAIL )
+    {
+        auto itemRange = this->thumbnailItems.equal_range( raster );
+
+        for ( auto iter = itemRange.first; iter != itemRange.second; iter++ )
+        {
+            TexInfoWidget *texInfo = iter->second;
+
+            rw::TextureBase *texHandle = texInfo->GetTextureHandle();
+
+            if ( texHandle && texHandle->GetRaster() == raster )
+            {
+                texInfo->SetPreview( pixmap );
             }
-		}
+        }
+
+        return;
+    }
+
+    // Is it the preview that the viewport is waiting for?
+    if ( TexInfoWidget *texItem = this->currentSelectedTexture )
+    {
+        rw::Raster *rasterData = texItem->GetTextureHandle()->GetRaster();
+
+        if ( rasterData == raster && this->getTextureViewPreviewType( rasterData ) == type )
+        {
+            this->showTextureViewPixmap( rasterData, pixmap );
+        }
+    }
+}
+
+void MainWindow::onTexturePreviewFailed( rw::Raster *raster, eTexPreviewType type, const QString& errorMessage )
+{
+    if ( type == eTexPreviewType::THUMBNAIL )
+        return;
+
+    if ( TexInfoWidget *texItem = this->currentSelectedTexture )
+    {
+        rw::Raster *rasterData = texItem->GetTextureHandle()->GetRaster();
+
+        if ( rasterData == raster && this->getTextureViewPreviewType( rasterData ) == type )
+        {
+            this->txdLog->addLogMessage(errorMessage, LOGMSG_WARNING);
+
+            // We hide the image widget.
+            this->clearViewImage();
+        }
     }
 }
 
@@ -2474,6 +2602,8 @@ void MainWindow::clearViewImage()
 	imageWidget->clear();
     imageWidget->setFixedSize(1, 1);
 	imageWidget->hide();
+
+    this->viewedPreviewRaster = NULL;
 }
 
 void MainWindow::NotifyChange( void )
@@ -2482,6 +2612,9 @@ void MainWindow::NotifyChange( void )
     if ( this->currentTXD == NULL )
         return;
 
+    // Changed rasters have got a new revision, so only their previews are decoded again.
+    this->updateTexturePreviews();
+
     bool isTXDChanged = this->wasTXDModified;
 
     if ( isTXDChanged )
@@ -2510,6 +2643,68 @@ void MainWindow::ClearModifiedState( void )
     this->updateWindowTitle();
 }
 
+// Carries the warnings of a worker thread to the GUI thread.
+struct rwWorkerWarningsEvent : public QEvent
+{
+    inline rwWorkerWarningsEvent( void ) : QEvent( QEvent::User )
+    {
+        return;
+    }
+
+    std::list <std::string> messages;
+};
+
+void MainWindow::rwWorkerWarningQueue::PostToWindow( MainWindow *mainWnd )
+{
+    rwWorkerWarningsEvent *evt = new rwWorkerWarningsEvent();
+    {
+        std::lock_guard <std::mutex> lockMessages( this->lock );
+
+        evt->messages = std::move( this->messages );
+
+        this->messages.clear();
+    }
+
+    if ( evt->messages.empty() )
+    {
+        delete evt;
+        return;
+    }
+
+    QCoreApplication::postEvent( mainWnd, evt );
+}
+
+void MainWindow::rwPublicWarningDispatcher::OnWarning( std::string&& msg )
+{
+    // Parallel work of the GUI thread can warn from the worker pool.
+    if ( QThread::currentThread() != this->mainWnd->thread() )
+    {
+        rwWorkerWarningsEvent *evt = new rwWorkerWarningsEvent();
+
+        evt->messages.push_back( std::move( msg ) );
+
+        QCoreApplication::postEvent( this->mainWnd, evt );
+        return;
+    }
+
+    this->mainWnd->txdLog->addLogMessage( ansi_to_qt( msg ), LOGMSG_WARNING );
+}
+
+void MainWindow::customEvent( QEvent *evt )
+{
+    if ( rwWorkerWarningsEvent *warnEvt = dynamic_cast <rwWorkerWarningsEvent*> ( evt ) )
+    {
+        for ( std::string& msg : warnEvt->messages )
+        {
+            this->rwWarnMan.OnWarning( std::move( msg ) );
+        }
+
+        return;
+    }
+
+    QMainWindow::customEvent( evt );
+}
+
 void MainWindow::closeEvent( QCloseEvent *evt )
 {
     // Maybe we have to do some save changes before closing.
@@ -10,6 +10,22 @@ inline QImage convertRWBitmapToQImage( const rw::Bitmap& rasterBitmap )
 
 	QImage texImage(width, height, QImage::Format::Format_ARGB32);
 
+    // Packed BGRA is what ARGB32 looks like in memory on little endian machines, so we can copy rows.
+    if ( Q_BYTE_ORDER == Q_LITTLE_ENDIAN &&
+         rasterBitmap.getFormat() == rw::RASTER_8888 && rasterBitmap.getColorOrder() == rw::COLOR_BGRA && rasterBitmap.getDepth() == 32 )
+    {
+        const char *srcTexels = (const char*)rasterBitmap.getTexelsData();
+
+        rw::uint32 srcRowSize = rw::getRasterDataRowSize( width, 32, rasterBitmap.getRowAlignment() );
+
+        for ( rw::uint32 y = 0; y < height; y++ )
+        {
+            memcpy( texImage.scanLine( y ), srcTexels + srcRowSize * y, width * sizeof( QRgb ) );
+        }
+
+        return texImage;
+    }
+
 	// Copy scanline by scanline.
 	for (int y = 0; y < height; y++)
 	{
@@ -32,6 +48,38 @@ inline QImage convertRWBitmapToQImage( const rw::Bitmap& rasterBitmap )
     return texImage;
 }
 
+// Decodes a mipmap layer of a raster straight into the memory of a new image.
+// If the requested size is smaller than the layer, it is box-filtered down by rwlib.
+inline QImage convertRWRasterMipmapToQImage( const rw::Raster *raster, rw::uint32 mipIndex, rw::uint32 width, rw::uint32 height )
+{
+    QImage texImage( width, height, QImage::Format::Format_ARGB32 );
+
+    if ( texImage.isNull() )
+        return texImage;
+
+    raster->readMipmapBGRA( mipIndex, width, height, texImage.bits(), texImage.bytesPerLine() );
+
+    // On big endian machines ARGB32 is stored in reverse byte order.
+    if ( Q_BYTE_ORDER != Q_LITTLE_ENDIAN )
+    {
+        for ( rw::uint32 y = 0; y < height; y++ )
+        {
+            uchar *scanLineContent = texImage.scanLine( y );
+
+            QRgb *colorItems = (QRgb*)scanLineContent;
+
+            for ( rw::uint32 x = 0; x < width; x++ )
+            {
+                const uchar *bgra = ( scanLineContent + x * sizeof( QRgb ) );
+
+                colorItems[ x ] = qRgba( bgra[2], bgra[1], bgra[0], bgra[3] );
+            }
+        }
+    }
+
+    return texImage;
+}
+
 inline QPixmap convertRWBitmapToQPixmap( const rw::Bitmap& rasterBitmap )
 {
 	return QPixmap::fromImage(
@@ -8,6 +8,11 @@
 
 #include "texnameutils.hxx"
 
+#include <QCoreApplication>
+#include <QEvent>
+
+#include <algorithm>
+
 #ifdef _DEBUG
 static const bool _lockdownPlatform = false;        // SET THIS TO TRUE FOR RELEASE.
 #else
@@ -16,6 +21,9 @@ static const bool _lockdownPlatform = true;         // WE ARE RELEASING SOON.
 static const size_t _recommendedPlatformMaxName = 32;
 static const bool _enableMaskName = false;
 
+// Rasters bigger than this are previewed at a reduced size first.
+#define TEXADD_PREVIEW_PROXY_SIZE   256
+
 inline QString calculateImageBaseName(QString fileName)
 {
     // Determine the texture name.
@@ -151,6 +159,9 @@ void TexAddDialog::loadPlatformOriginal(void)
     // If we have a converted raster, release it.
     this->releaseConvRaster();
 
+    // Conversions of the previous original are obsolete.
+    this->convEnv->CancelConversion();
+
     bool hasPreview = false;
 
     try
@@ -302,168 +313,460 @@ void TexAddDialog::updatePreviewWidget(void)
 {
 }
 
-void TexAddDialog::createRasterForConfiguration(void)
+void TexAddDialog::getRasterConfiguration(rasterConfig& cfgOut)
 {
-    if (this->hasPlatformOriginal == false)
-        return;
+    // Reads the configuration that the user has selected in the dialog.
+    rw::eCompressionType compressionType = rw::RWCOMPRESS_NONE;
 
-    // This function prepares the raster that will be given to the texture dictionary.
+    rw::eRasterFormat rasterFormat = rw::RASTER_DEFAULT;
+    rw::ePaletteType paletteType = rw::PALETTE_NONE;
 
-    bool hasConfiguredRaster = false;
+    bool keepOriginal = this->platformOriginalToggle->isChecked();
 
-    try
+    if (!keepOriginal)
     {
-        rw::eCompressionType compressionType = rw::RWCOMPRESS_NONE;
-
-        rw::eRasterFormat rasterFormat = rw::RASTER_DEFAULT;
-        rw::ePaletteType paletteType = rw::PALETTE_NONE;
+        // Now for the properties.
+        if (this->platformCompressionToggle->isChecked())
+        {
+            // We are a compressed format, so determine what we actually are.
+            QString selectedCompression = this->platformCompressionSelectProp->currentText();
 
-        bool keepOriginal = this->platformOriginalToggle->isChecked();
+            if (selectedCompression == "DXT1")
+            {
+                compressionType = rw::RWCOMPRESS_DXT1;
+            }
+            else if (selectedCompression == "DXT2")
+            {
+                compressionType = rw::RWCOMPRESS_DXT2;
+            }
+            else if (selectedCompression == "DXT3")
+            {
+                compressionType = rw::RWCOMPRESS_DXT3;
+            }
+            else if (selectedCompression == "DXT4")
+            {
+                compressionType = rw::RWCOMPRESS_DXT4;
+            }
+            else if (selectedCompression == "DXT5")
+            {
+                compressionType = rw::RWCOMPRESS_DXT5;
+            }
+            else
+            {
+                throw std::exception("invalid compression type selected");
+            }
 
-        if (!keepOriginal)
+            rasterFormat = rw::RASTER_DEFAULT;
+            paletteType = rw::PALETTE_NONE;
+        }
+        else
         {
-            // Now for the properties.
-            if (this->platformCompressionToggle->isChecked())
+            compressionType = rw::RWCOMPRESS_NONE;
+
+            // Now we have a valid raster format selected in the pixel format combo box.
+            // We kinda need one.
+            if (this->enablePixelFormatSelect)
             {
-                // We are a compressed format, so determine what we actually are.
-                QString selectedCompression = this->platformCompressionSelectProp->currentText();
+                QString formatName = this->platformPixelFormatSelectProp->currentText();
 
-                if (selectedCompression == "DXT1")
-                {
-                    compressionType = rw::RWCOMPRESS_DXT1;
-                }
-                else if (selectedCompression == "DXT2")
-                {
-                    compressionType = rw::RWCOMPRESS_DXT2;
-                }
-                else if (selectedCompression == "DXT3")
+                std::string ansiFormatName = qt_to_ansi( formatName );
+
+                rasterFormat = rw::FindRasterFormatByName(ansiFormatName.c_str());
+
+                if (rasterFormat == rw::RASTER_DEFAULT)
                 {
-                    compressionType = rw::RWCOMPRESS_DXT3;
+                    throw std::exception("invalid pixel format selected");
                 }
-                else if (selectedCompression == "DXT4")
+            }
+
+            // And then we need to know whether it should be a palette or not.
+            if (this->platformPaletteToggle->isChecked())
+            {
+                // Alright, then we have to fetch a valid palette type.
+                QString paletteName = this->platformPaletteSelectProp->currentText();
+
+                if (paletteName == "PAL4")
                 {
-                    compressionType = rw::RWCOMPRESS_DXT4;
+                    // TODO: some archictures might prefer the MSB version.
+                    // we should detect that automatically!
+
+                    paletteType = rw::PALETTE_4BIT;
                 }
-                else if (selectedCompression == "DXT5")
+                else if (paletteName == "PAL8")
                 {
-                    compressionType = rw::RWCOMPRESS_DXT5;
+                    paletteType = rw::PALETTE_8BIT;
                 }
                 else
                 {
-                    throw std::exception("invalid compression type selected");
+                    throw std::exception("invalid palette type selected");
                 }
-
-                rasterFormat = rw::RASTER_DEFAULT;
-                paletteType = rw::PALETTE_NONE;
             }
             else
             {
-                compressionType = rw::RWCOMPRESS_NONE;
+                paletteType = rw::PALETTE_NONE;
+            }
+        }
+    }
 
-                // Now we have a valid raster format selected in the pixel format combo box.
-                // We kinda need one.
-                if (this->enablePixelFormatSelect)
-                {
-                    QString formatName = this->platformPixelFormatSelectProp->currentText();
+    cfgOut.platformName = qt_to_ansi( this->GetCurrentPlatform() );
+    cfgOut.compressionType = compressionType;
+    cfgOut.rasterFormat = rasterFormat;
+    cfgOut.paletteType = paletteType;
+}
 
-                    std::string ansiFormatName = qt_to_ansi( formatName );
+void TexAddDialog::applyRasterConfiguration(rw::Raster *convRaster, const rasterConfig& cfg)
+{
+    // May be called from the conversion worker thread.
 
-                    rasterFormat = rw::FindRasterFormatByName(ansiFormatName.c_str());
+    // We must make sure that our raster is in the correct platform.
+    rw::ConvertRasterTo(convRaster, cfg.platformName.c_str());
 
-                    if (rasterFormat == rw::RASTER_DEFAULT)
-                    {
-                        throw std::exception("invalid pixel format selected");
-                    }
-                }
+    // Format the raster appropriately.
+    if (cfg.compressionType != rw::RWCOMPRESS_NONE)
+    {
+        // If the raster is already compressed, we want to decompress it.
+        // Very, very bad practice, but we allow it.
+        {
+            rw::eCompressionType curCompressionType = convRaster->getCompressionFormat();
 
-                // And then we need to know whether it should be a palette or not.
-                if (this->platformPaletteToggle->isChecked())
-                {
-                    // Alright, then we have to fetch a valid palette type.
-                    QString paletteName = this->platformPaletteSelectProp->currentText();
+            if ( curCompressionType != rw::RWCOMPRESS_NONE )
+            {
+                convRaster->convertToFormat( rw::RASTER_8888 );
+            }
+        }
 
-                    if (paletteName == "PAL4")
-                    {
-                        // TODO: some archictures might prefer the MSB version.
-                        // we should detect that automatically!
+        // Just compress it.
+        convRaster->compressCustom(cfg.compressionType);
+    }
+    else if (cfg.rasterFormat != rw::RASTER_DEFAULT)
+    {
+        // We want a specialized format.
+        // Go ahead.
+        if (cfg.paletteType != rw::PALETTE_NONE)
+        {
+            // Palettize.
+            convRaster->convertToPalette(cfg.paletteType, cfg.rasterFormat);
+        }
+        else
+        {
+            // Let us convert to another format.
+            convRaster->convertToFormat(cfg.rasterFormat);
+        }
+    }
+}
 
-                        paletteType = rw::PALETTE_4BIT;
-                    }
-                    else if (paletteName == "PAL8")
-                    {
-                        paletteType = rw::PALETTE_8BIT;
-                    }
-                    else
-                    {
-                        throw std::exception("invalid palette type selected");
-                    }
-                }
-                else
-                {
-                    paletteType = rw::PALETTE_NONE;
-                }
+// Sent from the conversion worker to the dialog once a stage of the conversion has finished.
+struct texAddConversionEvent : public QEvent
+{
+    inline texAddConversionEvent( unsigned int generation, bool isProxy ) : QEvent( QEvent::User )
+    {
+        this->generation = generation;
+        this->isProxy = isProxy;
+        this->raster = NULL;
+    }
+
+    inline ~texAddConversionEvent( void )
+    {
+        if ( rw::Raster *raster = this->raster )
+        {
+            rw::DeleteRaster( raster );
+        }
+    }
+
+    unsigned int generation;
+    bool isProxy;
+
+    rw::Raster *raster;     // the converted raster, only for the full resolution stage.
+    QImage image;
+    QString errorMessage;
+};
+
+struct TexAddDialog::conversionEnv
+{
+    inline conversionEnv( TexAddDialog *dialog )
+    {
+        this->dialog = dialog;
+
+        this->lockJobs = rw::CreateReadWriteLock( dialog->mainWnd->GetEngine() );
+        this->hasPendingJob = false;
+        this->workerThread = NULL;
+        this->isTerminating = false;
+        this->generation = 0;
+        this->isRasterPending = false;
+    }
+
+    inline ~conversionEnv( void )
+    {
+        rw::Interface *rwEngine = this->dialog->mainWnd->GetEngine();
+
+        {
+            rw::scoped_rwlock_writer <> jobsConsistency( this->lockJobs );
+
+            this->isTerminating = true;
+
+            this->ClearPendingJob();
+        }
+
+        this->WaitForWorker();
+
+        rw::CloseReadWriteLock( rwEngine, this->lockJobs );
+    }
+
+    struct conversionJob
+    {
+        rw::Raster *srcRaster;
+        rasterConfig config;
+        unsigned int generation;
+    };
+
+    inline void ClearPendingJob( void )
+    {
+        // Requires lockJobs writer access.
+        if ( this->hasPendingJob )
+        {
+            rw::DeleteRaster( this->pendingJob.srcRaster );
+
+            this->hasPendingJob = false;
+        }
+    }
+
+    inline void CancelConversion( void )
+    {
+        rw::scoped_rwlock_writer <> jobsConsistency( this->lockJobs );
+
+        // Results that are still underway are ignored.
+        this->generation++;
+
+        this->ClearPendingJob();
+
+        this->isRasterPending = false;
+    }
+
+    inline void RequestConversion( rw::Raster *srcRaster, const rasterConfig& config )
+    {
+        rw::scoped_rwlock_writer <> jobsConsistency( this->lockJobs );
+
+        if ( this->isTerminating )
+            return;
+
+        // There is only one configuration that matters, the latest.
+        this->generation++;
+
+        this->ClearPendingJob();
+
+        this->pendingJob.srcRaster = rw::AcquireRaster( srcRaster );
+        this->pendingJob.config = config;
+        this->pendingJob.generation = this->generation;
+        this->hasPendingJob = true;
+
+        this->isRasterPending = true;
+
+        // Spawn a worker if there is none running.
+        if ( this->workerThread == NULL )
+        {
+            rw::Interface *rwEngine = this->dialog->mainWnd->GetEngine();
+
+            rw::thread_t workerThread = rw::MakeThread( rwEngine, WorkerEntry, this );
+
+            this->workerThread = workerThread;
+
+            rw::ResumeThread( rwEngine, workerThread );
+        }
+    }
+
+    inline void WaitForWorker( void )
+    {
+        rw::Interface *rwEngine = this->dialog->mainWnd->GetEngine();
+
+        rw::thread_t worker = NULL;
+        {
+            rw::scoped_rwlock_writer <> jobsConsistency( this->lockJobs );
+
+            if ( rw::thread_t workerThread = this->workerThread )
+            {
+                worker = rw::AcquireThread( rwEngine, workerThread );
             }
         }
 
-        // Create the raster.
-        try
+        if ( worker )
         {
-            // Clear previous image data.
-            this->releaseConvRaster();
+            rw::JoinThread( rwEngine, worker );
 
-            rw::Raster *convRaster = rw::CloneRaster(this->platformOrigRaster);
+            rw::CloseThread( rwEngine, worker );
+        }
+    }
 
-            this->convRaster = convRaster;
+    static void WorkerEntry( rw::thread_t threadHandle, rw::Interface *engineInterface, void *ud )
+    {
+        ((conversionEnv*)ud)->WorkerMain( threadHandle, engineInterface );
+    }
 
-            // We must make sure that our raster is in the correct platform.
+    void WorkerMain( rw::thread_t threadHandle, rw::Interface *engineInterface );
+
+    TexAddDialog *dialog;
+
+    rw::rwlock *lockJobs;
+    bool hasPendingJob;
+    conversionJob pendingJob;
+    volatile rw::thread_t workerThread;
+    bool isTerminating;
+
+    volatile unsigned int generation;
+
+    bool isRasterPending;       // GUI thread only.
+};
+
+void TexAddDialog::conversionEnv::WorkerMain( rw::thread_t threadHandle, rw::Interface *engineInterface )
+{
+    MainWindow *mainWnd = this->dialog->mainWnd;
+
+    // Warnings of the conversion are logged by the GUI thread.
+    MainWindow::rwWorkerWarningQueue warningQueue;
+
+    rw::AssignThreadedRuntimeConfig( engineInterface );
+
+    engineInterface->SetWarningManager( &warningQueue );
+
+    while ( true )
+    {
+        warningQueue.PostToWindow( mainWnd );
+
+        conversionJob job;
+        {
+            rw::scoped_rwlock_writer <> jobsConsistency( this->lockJobs );
+
+            if ( this->hasPendingJob == false )
             {
-                std::string currentPlatform = qt_to_ansi( this->GetCurrentPlatform() );
+                // Nothing left to do, so we quit.
+                // The next request spawns a new worker.
+                this->workerThread = NULL;
+
+                rw::ReleaseThreadedRuntimeConfig( engineInterface );
 
-                rw::ConvertRasterTo(convRaster, currentPlatform.c_str());
+                rw::CloseThread( engineInterface, threadHandle );
+                return;
             }
 
-            // Format the raster appropriately.
+            // We now own the raster reference.
+            job = this->pendingJob;
+
+            this->hasPendingJob = false;
+        }
+
+        rw::uint32 width, height;
+        job.srcRaster->getSize( width, height );
+
+        // Big rasters are first converted at a reduced size, so that the user gets a quick look at the result.
+        // The size is halved so that dimension requirements of the native texture stay fulfilled.
+        if ( std::max( width, height ) > TEXADD_PREVIEW_PROXY_SIZE && job.generation == this->generation )
+        {
+            rw::uint32 proxyWidth = width;
+            rw::uint32 proxyHeight = height;
+
+            while ( std::max( proxyWidth, proxyHeight ) > TEXADD_PREVIEW_PROXY_SIZE )
             {
-                if (compressionType != rw::RWCOMPRESS_NONE)
-                {
-                    // If the raster is already compressed, we want to decompress it.
-                    // Very, very bad practice, but we allow it.
-                    {
-                        rw::eCompressionType curCompressionType = convRaster->getCompressionFormat();
+                proxyWidth = std::max( 1u, proxyWidth / 2 );
+                proxyHeight = std::max( 1u, proxyHeight / 2 );
+            }
 
-                        if ( curCompressionType != rw::RWCOMPRESS_NONE )
-                        {
-                            convRaster->convertToFormat( rw::RASTER_8888 );
-                        }
-                    }
+            texAddConversionEvent *evt = new texAddConversionEvent( job.generation, true );
 
-                    // Just compress it.
-                    convRaster->compressCustom(compressionType);
-                }
-                else if (rasterFormat != rw::RASTER_DEFAULT)
+            try
+            {
+                rw::Raster *proxyRaster = rw::CloneRaster( job.srcRaster );
+
+                try
                 {
-                    // We want a specialized format.
-                    // Go ahead.
-                    if (paletteType != rw::PALETTE_NONE)
-                    {
-                        // Palettize.
-                        convRaster->convertToPalette(paletteType, rasterFormat);
-                    }
-                    else
+                    proxyRaster->clearMipmaps();
+                    proxyRaster->resize( proxyWidth, proxyHeight );
+
+                    TexAddDialog::applyRasterConfiguration( proxyRaster, job.config );
+
+                    if ( proxyRaster->getMipmapSize( 0, proxyWidth, proxyHeight ) )
                     {
-                        // Let us convert to another format.
-                        convRaster->convertToFormat(rasterFormat);
+                        evt->image = convertRWRasterMipmapToQImage( proxyRaster, 0, proxyWidth, proxyHeight );
                     }
                 }
+                catch( ... )
+                {
+                    rw::DeleteRaster( proxyRaster );
+
+                    throw;
+                }
+
+                rw::DeleteRaster( proxyRaster );
+            }
+            catch( ... )
+            {
+                // The proxy is just a convenience.
+                // Errors are reported by the full resolution conversion.
             }
 
-            // Success!
-            hasConfiguredRaster = true;
+            if ( evt->image.isNull() )
+            {
+                delete evt;
+            }
+            else
+            {
+                QCoreApplication::postEvent( this->dialog, evt );
+            }
+        }
+
+        // Rasterlib conversions cannot be interrupted, but we do not start on superseded configurations.
+        if ( job.generation != this->generation )
+        {
+            rw::DeleteRaster( job.srcRaster );
+            continue;
+        }
+
+        texAddConversionEvent *evt = new texAddConversionEvent( job.generation, false );
+
+        try
+        {
+            rw::Raster *convRaster = rw::CloneRaster( job.srcRaster );
+
+            evt->raster = convRaster;
+
+            TexAddDialog::applyRasterConfiguration( convRaster, job.config );
+
+            rw::uint32 convWidth, convHeight;
+
+            if ( convRaster->getMipmapSize( 0, convWidth, convHeight ) )
+            {
+                evt->image = convertRWRasterMipmapToQImage( convRaster, 0, convWidth, convHeight );
+            }
+        }
+        catch( rw::RwException& except )
+        {
+            evt->errorMessage = ansi_to_qt( except.message );
         }
-        catch (rw::RwException& except)
+        catch( std::exception& except )
         {
-            this->mainWnd->txdLog->showError(QString("failed to create raster: ") + ansi_to_qt(except.message));
+            evt->errorMessage = except.what();
         }
+
+        rw::DeleteRaster( job.srcRaster );
+
+        QCoreApplication::postEvent( this->dialog, evt );
+    }
+}
+
+void TexAddDialog::createRasterForConfiguration(void)
+{
+    if (this->hasPlatformOriginal == false)
+        return;
+
+    // This function prepares the raster that will be given to the texture dictionary.
+    // The conversion runs in the background, so that the dialog stays responsive.
+    rasterConfig config;
+
+    bool hasConfig = false;
+
+    try
+    {
+        this->getRasterConfiguration(config);
+
+        hasConfig = true;
     }
     catch (std::exception& except)
     {
@@ -471,14 +774,78 @@ void TexAddDialog::createRasterForConfiguration(void)
         this->mainWnd->txdLog->showError(QString("failed to create raster: ") + except.what());
     }
 
-    // If we do not need a configured raster anymore, release it.
-    if (!hasConfiguredRaster)
+    // Clear previous image data.
+    this->releaseConvRaster();
+
+    if (hasConfig)
     {
+        // The current preview stays visible until the new one has arrived.
+        this->convEnv->RequestConversion(this->platformOrigRaster, config);
+    }
+    else
+    {
+        this->convEnv->CancelConversion();
+
+        this->UpdatePreview();
+    }
+}
+
+void TexAddDialog::waitForConfiguredRaster(void)
+{
+    if (this->convEnv->isRasterPending == false)
+        return;
+
+    this->convEnv->WaitForWorker();
+
+    // Deliver the finished conversion.
+    QCoreApplication::sendPostedEvents(this, QEvent::User);
+}
+
+void TexAddDialog::customEvent(QEvent *evt)
+{
+    if ( texAddConversionEvent *convEvt = dynamic_cast <texAddConversionEvent*> ( evt ) )
+    {
+        // Ignore conversions of configurations that have changed since.
+        if ( convEvt->generation != this->convEnv->generation )
+            return;
+
+        if ( convEvt->isProxy )
+        {
+            rw::Raster *origRaster = this->platformOrigRaster;
+
+            if ( origRaster == NULL )
+                return;
+
+            // Stretch the proxy to the size of the actual raster.
+            rw::uint32 w, h;
+            origRaster->getSize(w, h);
+
+            this->SetPreviewPixmap(QPixmap::fromImage(convEvt->image), w, h, true);
+            return;
+        }
+
+        this->convEnv->isRasterPending = false;
+
+        if ( convEvt->errorMessage.isEmpty() == false )
+        {
+            this->mainWnd->txdLog->showError(QString("failed to create raster: ") + convEvt->errorMessage);
+
+            this->UpdatePreview();
+            return;
+        }
+
+        // Take over the converted raster.
         this->releaseConvRaster();
+
+        this->convRaster = convEvt->raster;
+
+        convEvt->raster = NULL;
+
+        this->SetPreviewPixmap(QPixmap::fromImage(convEvt->image), convEvt->image.width(), convEvt->image.height(), false);
+        return;
     }
 
-    // Update the preview.
-    this->UpdatePreview();
+    QDialog::customEvent(evt);
 }
 
 QComboBox* TexAddDialog::createPlatformSelectComboBox(MainWindow *mainWnd)
@@ -548,6 +915,10 @@ TexAddDialog::TexAddDialog(MainWindow *mainWnd, const dialogCreateParams& create
     this->platformOrigRaster = NULL;
     this->texHandle = NULL;
     this->convRaster = NULL;
+    this->isPreviewProxy = false;
+
+    // Configured rasters are converted in the background.
+    this->convEnv = new conversionEnv( this );
 
     if (this->dialog_type == CREATE_IMGPATH)
     {
@@ -857,6 +1228,9 @@ TexAddDialog::~TexAddDialog(void)
 {
     // Remove the raster that we created.
     // Remember that it is reference counted.
+    // Wait for the conversion worker to stop.
+    delete this->convEnv;
+
     this->clearTextureOriginal();
 
     this->releaseConvRaster();
@@ -869,29 +1243,15 @@ void TexAddDialog::UpdatePreview() {
     rw::Raster *previewRaster = this->GetDisplayRaster();
     if (previewRaster) {
         try {
-            int w, h;
-            {
-                // Put the contents of the platform original into the preview widget.
-                // We want to transform the raster into a bitmap, basically.
-                QPixmap pixmap = convertRWBitmapToQPixmap( previewRaster->getBitmap() );
-
-                w = pixmap.width(), h = pixmap.height();
-
-                this->previewLabel->setPixmap(pixmap);
-            }
+            rw::uint32 w, h;
+            if (previewRaster->getMipmapSize(0, w, h)) {
+                // Put the contents of the raster into the preview widget.
+                QPixmap pixmap = QPixmap::fromImage( convertRWRasterMipmapToQImage( previewRaster, 0, w, h ) );
 
-            if (scaledPreviewCheckBox->isChecked()) {
-                int maxLen = w > h ? w : h;
-                if (maxLen > 300 || fillPreviewCheckBox->isChecked()) {
-                    float factor = 300.0f / maxLen;
-                    w = (float)w * factor;
-                    h = (float)h * factor;
-                }
-                this->previewLabel->setScaledContents(true);
+                this->SetPreviewPixmap(pixmap, w, h, false);
             }
             else
-                this->previewLabel->setScaledContents(false);
-            this->previewLabel->setFixedSize(w, h);
+                this->ClearPreview();
         }
         catch (rw::RwException& except) {
             this->mainWnd->txdLog->showError(QString("failed to create preview: ") + ansi_to_qt(except.message));
@@ -903,6 +1263,26 @@ void TexAddDialog::UpdatePreview() {
         ClearPreview();
 }
 
+void TexAddDialog::SetPreviewPixmap(const QPixmap& pixmap, int w, int h, bool isProxy) {
+    this->previewLabel->setPixmap(pixmap);
+
+    // A proxy preview is stretched to the size of the actual raster.
+    this->isPreviewProxy = isProxy;
+
+    if (scaledPreviewCheckBox->isChecked()) {
+        int maxLen = w > h ? w : h;
+        if (maxLen > 300 || fillPreviewCheckBox->isChecked()) {
+            float factor = 300.0f / maxLen;
+            w = (float)w * factor;
+            h = (float)h * factor;
+        }
+        this->previewLabel->setScaledContents(true);
+    }
+    else
+        this->previewLabel->setScaledContents(isProxy);
+    this->previewLabel->setFixedSize(w, h);
+}
+
 void TexAddDialog::ClearPreview() {
     this->previewLabel->clear();
     this->previewLabel->setFixedSize(300, 300);
@@ -1380,6 +1760,9 @@ void TexAddDialog::OnTextureAddRequest(bool checked)
     // This is where we want to go.
     // Decide the format that the runtime has requested.
 
+    // The configured raster might still be converting in the background.
+    this->waitForConfiguredRaster();
+
     rw::Raster *displayRaster = this->GetDisplayRaster();
 
     if (displayRaster)
@@ -1473,7 +1856,7 @@ void TexAddDialog::OnScalePreviewStateChanged(int state) {
             previewRaster->getSize(w, h);
             if (state == Qt::Unchecked) {
                 this->previewLabel->setFixedSize(w, h);
-                this->previewLabel->setScaledContents(false);
+                this->previewLabel->setScaledContents(this->isPreviewProxy);
             }
             else {
                 int maxLen = w > h ? w : h;
@@ -1500,7 +1883,7 @@ void TexAddDialog::OnFillPreviewStateChanged(int state) {
             previewRaster->getSize(w, h);
             if (!this->scaledPreviewCheckBox->isChecked()) {
                 this->previewLabel->setFixedSize(w, h);
-                this->previewLabel->setScaledContents(false);
+                this->previewLabel->setScaledContents(this->isPreviewProxy);
             }
             else {
                 int maxLen = w > h ? w : h;
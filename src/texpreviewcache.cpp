@@ -0,0 +1,690 @@
+#include "mainwindow.h"
+
+#include <sdk/PluginHelpers.h>
+
+#include "qtrwutils.hxx"
+
+#include <QCoreApplication>
+#include <QEvent>
+
+#include <map>
+#include <set>
+#include <iterator>
+
+// Size of the pictures in the texture list.
+#define TEXPREVIEW_THUMBNAIL_SIZE       44
+
+// Amount of pixel memory that the cached previews may take.
+#define TEXPREVIEW_CACHE_MEMORY_BUDGET  ( 128 * 1024 * 1024 )
+
+struct texPreviewKey
+{
+    rw::Raster *raster;
+    eTexPreviewType type;
+
+    inline bool operator == ( const texPreviewKey& right ) const
+    {
+        return ( this->raster == right.raster && this->type == right.type );
+    }
+
+    inline bool operator < ( const texPreviewKey& right ) const
+    {
+        if ( this->raster != right.raster )
+        {
+            return ( this->raster < right.raster );
+        }
+
+        return ( this->type < right.type );
+    }
+};
+
+// Sent from the worker thread to the GUI thread once a preview has been decoded.
+// It owns a reference to the raster.
+struct texPreviewReadyEvent : public QEvent
+{
+    inline texPreviewReadyEvent( texPreviewKey key, rw::uint32 revision, unsigned int generation ) : QEvent( QEvent::User )
+    {
+        this->key = key;
+        this->revision = revision;
+        this->generation = generation;
+    }
+
+    inline ~texPreviewReadyEvent( void )
+    {
+        if ( rw::Raster *raster = this->key.raster )
+        {
+            rw::DeleteRaster( raster );
+        }
+    }
+
+    texPreviewKey key;
+    rw::uint32 revision;
+    unsigned int generation;
+
+    QImage image;
+    QString errorMessage;
+};
+
+struct texPreviewEnv;
+
+// Receives the decoded previews on the GUI thread.
+struct texPreviewEventReceiver : public QObject
+{
+    inline texPreviewEventReceiver( texPreviewEnv *env )
+    {
+        this->env = env;
+    }
+
+    void customEvent( QEvent *evt ) override;
+
+    texPreviewEnv *env;
+};
+
+static void texPreviewWorkerEntry( rw::thread_t threadHandle, rw::Interface *engineInterface, void *ud );
+
+struct texPreviewEnv
+{
+    inline void Initialize( MainWindow *mainWnd )
+    {
+        this->mainWnd = mainWnd;
+
+        this->lockJobs = rw::CreateReadWriteLock( mainWnd->GetEngine() );
+        this->workerThread = NULL;
+        this->isTerminating = false;
+        this->generation = 0;
+
+        this->cacheMemSize = 0;
+
+        this->receiver = new texPreviewEventReceiver( this );
+    }
+
+    inline void Shutdown( MainWindow *mainWnd )
+    {
+        rw::Interface *rwEngine = mainWnd->GetEngine();
+
+        // Stop the worker and wait for it to finish its current item.
+        rw::thread_t worker = NULL;
+        {
+            rw::scoped_rwlock_writer <> jobsConsistency( this->lockJobs );
+
+            this->isTerminating = true;
+
+            this->ClearPendingJobs();
+
+            if ( rw::thread_t workerThread = this->workerThread )
+            {
+                worker = rw::AcquireThread( rwEngine, workerThread );
+            }
+        }
+
+        if ( worker )
+        {
+            rw::JoinThread( rwEngine, worker );
+
+            rw::CloseThread( rwEngine, worker );
+        }
+
+        // Any undelivered preview is deleted with the receiver.
+        delete this->receiver;
+
+        this->ClearCache();
+
+        rw::CloseReadWriteLock( rwEngine, this->lockJobs );
+    }
+
+    // Worker thread management.
+    // The worker decodes from a frozen copy of the raster that it makes itself, so the editor can
+    // keep changing the original while a preview is being made, and the GUI thread never copies texels.
+    // All previews of a raster revision are decoded from the same copy.
+    struct decodeJob
+    {
+        texPreviewKey key;
+        rw::uint32 revision;
+        unsigned int generation;
+    };
+
+    inline void ClearPendingJobs( void )
+    {
+        // Requires lockJobs writer access.
+        for ( decodeJob& job : this->pendingJobs )
+        {
+            rw::DeleteRaster( job.key.raster );
+        }
+
+        this->pendingJobs.clear();
+    }
+
+    // Returns whether a preview is still up to date.
+    // Every change to a raster gives it a new revision, so we do not have to be told about it.
+    // Requires lockJobs access.
+    inline bool IsPreviewCurrent( const rw::Raster *raster, rw::uint32 revision, unsigned int generation ) const
+    {
+        return ( generation == this->generation && raster->getRevision() == revision );
+    }
+
+    inline void RequestDecode( rw::Raster *raster, eTexPreviewType type, bool isUrgent )
+    {
+        rw::uint32 revision = raster->getRevision();
+
+        rw::scoped_rwlock_writer <> jobsConsistency( this->lockJobs );
+
+        if ( this->isTerminating )
+            return;
+
+        // If we already wait for this preview, we might have to give it priority.
+        for ( jobList_t::iterator iter = this->pendingJobs.begin(); iter != this->pendingJobs.end(); iter++ )
+        {
+            decodeJob& job = *iter;
+
+            if ( job.key.raster == raster && job.key.type == type )
+            {
+                if ( job.revision != revision )
+                {
+                    // The raster has changed since, so this job is of no use.
+                    rw::DeleteRaster( job.key.raster );
+
+                    this->pendingJobs.erase( iter );
+                    break;
+                }
+
+                if ( isUrgent )
+                {
+                    this->pendingJobs.splice( this->pendingJobs.begin(), this->pendingJobs, iter );
+                }
+
+                return;
+            }
+        }
+
+        decodeJob newJob;
+        newJob.key.raster = rw::AcquireRaster( raster );
+        newJob.key.type = type;
+        newJob.revision = revision;
+        newJob.generation = this->generation;
+
+        if ( isUrgent )
+        {
+            this->pendingJobs.push_front( newJob );
+        }
+        else
+        {
+            this->pendingJobs.push_back( newJob );
+        }
+
+        // Spawn a worker if there is none running.
+        if ( this->workerThread == NULL )
+        {
+            rw::Interface *rwEngine = this->mainWnd->GetEngine();
+
+            rw::thread_t workerThread = rw::MakeThread( rwEngine, texPreviewWorkerEntry, this );
+
+            this->workerThread = workerThread;
+
+            rw::ResumeThread( rwEngine, workerThread );
+        }
+    }
+
+    // Cache management (GUI thread only).
+    struct cacheEntry
+    {
+        texPreviewKey key;
+        rw::uint32 revision;
+        QPixmap pixmap;
+        size_t memSize;
+    };
+
+    typedef std::list <cacheEntry> lruList_t;
+
+    inline bool GetCached( const texPreviewKey& key, QPixmap& pixmapOut )
+    {
+        lruLookup_t::iterator foundIter = this->lruLookup.find( key );
+
+        if ( foundIter == this->lruLookup.end() )
+            return false;
+
+        lruList_t::iterator entryIter = foundIter->second;
+
+        // Outdated previews are dropped right away.
+        if ( entryIter->revision != key.raster->getRevision() )
+        {
+            this->RemoveEntry( entryIter );
+            return false;
+        }
+
+        // Mark as most recently used.
+        this->lruList.splice( this->lruList.begin(), this->lruList, entryIter );
+
+        pixmapOut = entryIter->pixmap;
+        return true;
+    }
+
+    inline void PutCached( texPreviewKey& key, rw::uint32 revision, const QPixmap& pixmap )
+    {
+        size_t memSize = ( (size_t)pixmap.width() * pixmap.height() * 4 );
+
+        lruLookup_t::iterator foundIter = this->lruLookup.find( key );
+
+        if ( foundIter != this->lruLookup.end() )
+        {
+            // Has been decoded twice, so keep the newer.
+            cacheEntry& entry = *foundIter->second;
+
+            this->cacheMemSize -= entry.memSize;
+
+            entry.revision = revision;
+            entry.pixmap = pixmap;
+            entry.memSize = memSize;
+
+            this->lruList.splice( this->lruList.begin(), this->lruList, foundIter->second );
+        }
+        else
+        {
+            cacheEntry newEntry;
+            newEntry.key = key;
+            newEntry.revision = revision;
+            newEntry.pixmap = pixmap;
+            newEntry.memSize = memSize;
+
+            // Take over the raster reference.
+            key.raster = NULL;
+
+            this->lruList.push_front( std::move( newEntry ) );
+
+            this->lruLookup[ this->lruList.front().key ] = this->lruList.begin();
+        }
+
+        this->cacheMemSize += memSize;
+
+        // Drop the least recently used previews, but never the one we just added.
+        while ( this->cacheMemSize > TEXPREVIEW_CACHE_MEMORY_BUDGET && this->lruList.size() > 1 )
+        {
+            this->RemoveEntry( std::prev( this->lruList.end() ) );
+        }
+    }
+
+    inline lruList_t::iterator RemoveEntry( lruList_t::iterator iter )
+    {
+        cacheEntry& entry = *iter;
+
+        this->cacheMemSize -= entry.memSize;
+
+        this->lruLookup.erase( entry.key );
+
+        rw::DeleteRaster( entry.key.raster );
+
+        return this->lruList.erase( iter );
+    }
+
+    // Drops the previews of rasters that are not used anymore, because the cache
+    // would keep them alive otherwise.
+    // The jobs of such rasters are not needed either.
+    inline void PruneCached( const std::set <rw::Raster*>& usedRasters )
+    {
+        {
+            rw::scoped_rwlock_writer <> jobsConsistency( this->lockJobs );
+
+            for ( jobList_t::iterator iter = this->pendingJobs.begin(); iter != this->pendingJobs.end(); )
+            {
+                if ( usedRasters.find( iter->key.raster ) == usedRasters.end() )
+                {
+                    rw::DeleteRaster( iter->key.raster );
+
+                    iter = this->pendingJobs.erase( iter );
+                }
+                else
+                {
+                    iter++;
+                }
+            }
+        }
+
+        for ( lruList_t::iterator iter = this->lruList.begin(); iter != this->lruList.end(); )
+        {
+            if ( usedRasters.find( iter->key.raster ) == usedRasters.end() )
+            {
+                iter = this->RemoveEntry( iter );
+            }
+            else
+            {
+                iter++;
+            }
+        }
+    }
+
+    inline void ClearCache( void )
+    {
+        for ( cacheEntry& entry : this->lruList )
+        {
+            rw::DeleteRaster( entry.key.raster );
+        }
+
+        this->lruList.clear();
+        this->lruLookup.clear();
+        this->cacheMemSize = 0;
+    }
+
+    inline void OnPreviewReady( texPreviewReadyEvent *evt )
+    {
+        // Ignore previews of rasters that have changed since.
+        {
+            rw::scoped_rwlock_reader <> jobsConsistency( this->lockJobs );
+
+            if ( this->IsPreviewCurrent( evt->key.raster, evt->revision, evt->generation ) == false )
+                return;
+        }
+
+        rw::Raster *raster = evt->key.raster;
+        eTexPreviewType type = evt->key.type;
+
+        if ( evt->errorMessage.isEmpty() == false )
+        {
+            this->mainWnd->onTexturePreviewFailed( raster, type, evt->errorMessage );
+            return;
+        }
+
+        QPixmap pixmap = QPixmap::fromImage( evt->image );
+
+        this->PutCached( evt->key, evt->revision, pixmap );
+
+        this->mainWnd->onTexturePreviewReady( raster, type, pixmap );
+    }
+
+    MainWindow *mainWnd;
+
+    typedef std::list <decodeJob> jobList_t;
+
+    rw::rwlock *lockJobs;
+    jobList_t pendingJobs;
+    volatile rw::thread_t workerThread;
+    bool isTerminating;
+
+    // Previews requested before an invalidation are thrown away.
+    unsigned int generation;
+
+    typedef std::map <texPreviewKey, lruList_t::iterator> lruLookup_t;
+
+    lruList_t lruList;
+    lruLookup_t lruLookup;
+    size_t cacheMemSize;
+
+    texPreviewEventReceiver *receiver;
+};
+
+static PluginDependantStructRegister <texPreviewEnv, mainWindowFactory_t> texPreviewEnvRegister;
+
+void texPreviewEventReceiver::customEvent( QEvent *evt )
+{
+    if ( texPreviewReadyEvent *readyEvt = dynamic_cast <texPreviewReadyEvent*> ( evt ) )
+    {
+        this->env->OnPreviewReady( readyEvt );
+
+        return;
+    }
+}
+
+static QImage decodeTexturePreview( rw::Interface *rwEngine, const rw::Raster *raster, eTexPreviewType type )
+{
+    if ( type == eTexPreviewType::FULL_MIPMAPS && raster->getMipmapCount() > 1 )
+    {
+        // Get a bitmap to the raster.
+        // This is a 2D color component surface.
+        rw::Bitmap rasterBitmap( rwEngine, 32, rw::RASTER_8888, rw::COLOR_BGRA );
+
+        rasterBitmap.setBgColor( 1.0, 1.0, 1.0, 0.0 );
+
+        rw::DebugDrawMipmaps( rwEngine, raster, rasterBitmap );
+
+        return convertRWBitmapToQImage( rasterBitmap );
+    }
+
+    // Single layer previews are decoded straight into the image memory.
+    rw::uint32 width, height;
+
+    if ( raster->getMipmapSize( 0, width, height ) == false )
+    {
+        return QImage();
+    }
+
+    rw::uint32 mipIndex = 0;
+
+    if ( type == eTexPreviewType::THUMBNAIL )
+    {
+        // Fit into the thumbnail box, keeping the aspect ratio.
+        // Small textures are not blown up.
+        rw::uint32 maxDimm = std::max( width, height );
+
+        if ( maxDimm > TEXPREVIEW_THUMBNAIL_SIZE )
+        {
+            width = std::max( 1u, (rw::uint32)( (rw::uint64)width * TEXPREVIEW_THUMBNAIL_SIZE / maxDimm ) );
+            height = std::max( 1u, (rw::uint32)( (rw::uint64)height * TEXPREVIEW_THUMBNAIL_SIZE / maxDimm ) );
+        }
+
+        // Decode the smallest mipmap layer that still covers the thumbnail.
+        rw::uint32 mipmapCount = raster->getMipmapCount();
+
+        for ( rw::uint32 n = 1; n < mipmapCount; n++ )
+        {
+            rw::uint32 mipWidth, mipHeight;
+
+            if ( raster->getMipmapSize( n, mipWidth, mipHeight ) == false )
+                break;
+
+            if ( mipWidth < width || mipHeight < height )
+                break;
+
+            mipIndex = n;
+        }
+    }
+
+    return convertRWRasterMipmapToQImage( raster, mipIndex, width, height );
+}
+
+// Makes a frozen copy of the raster, so that we can decode it without locking.
+// Returns false if the raster has been changed past revision, because then
+// the copy could be of newer texels than the previews were requested for.
+static bool takeRasterSnapshot( rw::Raster *raster, rw::uint32 revision, rw::RasterReadHandle& snapshotOut )
+{
+    rw::Raster *rasterCopy = rw::CloneRaster( raster );
+
+    if ( !rasterCopy )
+    {
+        throw rw::RwException( "failed to copy raster" );
+    }
+
+    try
+    {
+        rasterCopy->freeze();
+
+        snapshotOut = rw::RasterReadHandle( rasterCopy );
+    }
+    catch( ... )
+    {
+        rw::DeleteRaster( rasterCopy );
+
+        throw;
+    }
+
+    rw::DeleteRaster( rasterCopy );
+
+    return ( raster->getRevision() == revision );
+}
+
+static void texPreviewWorkerEntry( rw::thread_t threadHandle, rw::Interface *engineInterface, void *ud )
+{
+    texPreviewEnv *env = (texPreviewEnv*)ud;
+
+    // Decoding can warn, but only the GUI thread may write to the log.
+    MainWindow::rwWorkerWarningQueue warningQueue;
+
+    rw::AssignThreadedRuntimeConfig( engineInterface );
+
+    engineInterface->SetWarningManager( &warningQueue );
+
+    while ( true )
+    {
+        warningQueue.PostToWindow( env->mainWnd );
+
+        texPreviewEnv::jobList_t batch;
+        bool isCurrent;
+        {
+            rw::scoped_rwlock_writer <> jobsConsistency( env->lockJobs );
+
+            if ( env->pendingJobs.empty() )
+            {
+                // Nothing left to do, so we quit.
+                // The next request spawns a new worker.
+                env->workerThread = NULL;
+
+                rw::ReleaseThreadedRuntimeConfig( engineInterface );
+
+                rw::CloseThread( engineInterface, threadHandle );
+                return;
+            }
+
+            batch.splice( batch.begin(), env->pendingJobs, env->pendingJobs.begin() );
+
+            const texPreviewEnv::decodeJob& firstJob = batch.front();
+
+            // Take the other previews of this raster along, so that they share the copy.
+            for ( texPreviewEnv::jobList_t::iterator iter = env->pendingJobs.begin(); iter != env->pendingJobs.end(); )
+            {
+                texPreviewEnv::jobList_t::iterator curIter = iter++;
+
+                if ( curIter->key.raster == firstJob.key.raster && curIter->revision == firstJob.revision )
+                {
+                    batch.splice( batch.end(), env->pendingJobs, curIter );
+                }
+            }
+
+            isCurrent = env->IsPreviewCurrent( firstJob.key.raster, firstJob.revision, firstJob.generation );
+        }
+
+        rw::RasterReadHandle snapshot;
+        QString snapshotError;
+
+        if ( isCurrent )
+        {
+            const texPreviewEnv::decodeJob& firstJob = batch.front();
+
+            try
+            {
+                isCurrent = takeRasterSnapshot( firstJob.key.raster, firstJob.revision, snapshot );
+            }
+            catch( rw::RwException& except )
+            {
+                snapshotError = QString( "failed to get bitmap from texture: " ) + except.message.c_str();
+            }
+            catch( ... )
+            {
+                snapshotError = "failed to get bitmap from texture";
+            }
+        }
+
+        for ( const texPreviewEnv::decodeJob& job : batch )
+        {
+            // The reference to the raster is now owned by the event.
+            texPreviewReadyEvent *evt = new texPreviewReadyEvent( job.key, job.revision, job.generation );
+
+            if ( !isCurrent )
+            {
+                delete evt;
+                continue;
+            }
+
+            if ( !snapshot )
+            {
+                evt->errorMessage = snapshotError;
+            }
+            else
+            {
+                try
+                {
+                    evt->image = decodeTexturePreview( engineInterface, snapshot.get(), job.key.type );
+                }
+                catch( rw::RwException& except )
+                {
+                    evt->errorMessage = QString( "failed to get bitmap from texture: " ) + except.message.c_str();
+                }
+                catch( ... )
+                {
+                    evt->errorMessage = "failed to get bitmap from texture";
+                }
+            }
+
+            QCoreApplication::postEvent( env->receiver, evt );
+        }
+    }
+}
+
+bool GetTexturePreview( MainWindow *mainWnd, rw::Raster *raster, eTexPreviewType type, QPixmap& pixmapOut, bool isUrgent )
+{
+    texPreviewEnv *env = texPreviewEnvRegister.GetPluginStruct( mainWnd );
+
+    if ( !env )
+        return false;
+
+    texPreviewKey key;
+    key.raster = raster;
+    key.type = type;
+
+    if ( env->GetCached( key, pixmapOut ) )
+    {
+        return true;
+    }
+
+    env->RequestDecode( raster, type, isUrgent );
+
+    return false;
+}
+
+void PrefetchTexturePreview( MainWindow *mainWnd, rw::Raster *raster, eTexPreviewType type )
+{
+    texPreviewEnv *env = texPreviewEnvRegister.GetPluginStruct( mainWnd );
+
+    if ( !env )
+        return;
+
+    texPreviewKey key;
+    key.raster = raster;
+    key.type = type;
+
+    QPixmap cachedPixmap;
+
+    if ( env->GetCached( key, cachedPixmap ) )
+        return;
+
+    env->RequestDecode( raster, type, false );
+}
+
+void InvalidateTexturePreviews( MainWindow *mainWnd )
+{
+    texPreviewEnv *env = texPreviewEnvRegister.GetPluginStruct( mainWnd );
+
+    if ( !env )
+        return;
+
+    {
+        rw::scoped_rwlock_writer <> jobsConsistency( env->lockJobs );
+
+        env->generation++;
+
+        env->ClearPendingJobs();
+    }
+
+    env->ClearCache();
+}
+
+void PruneTexturePreviews( MainWindow *mainWnd, const std::set <rw::Raster*>& usedRasters )
+{
+    texPreviewEnv *env = texPreviewEnvRegister.GetPluginStruct( mainWnd );
+
+    if ( !env )
+        return;
+
+    env->PruneCached( usedRasters );
+}
+
+void InitializeTexturePreviewCacheEnvironment( void )
+{
+    texPreviewEnvRegister.RegisterPlugin( mainWindowFactory );
+}
@@ -1,5 +1,9 @@
 #include "shared.h"
 
+#include <chrono>
+#include <mutex>
+#include <vector>
+
 template <typename sentryType>
 struct gtaFileProcessor
 {
@@ -27,8 +31,26 @@ struct gtaFileProcessor
         traverse.sentry = theSentry;
         traverse.reconstruct_archives = this->reconstruct_archives;
         traverse.use_compressed_img_archives = this->use_compressed_img_archives;
+        traverse.lockFileSystem = &this->lockFileSystem;
+
+        // Files on disk do not depend on each other, so we collect them and let the module
+        // decide how to run them. Files inside of archives share the archive stream, so they
+        // are processed in order during the scan.
+        std::vector <_deferredFile> deferredFiles;
+
+        if ( fileSystem->GetArchiveTranslator( discHandle ) == NULL &&
+             fileSystem->GetArchiveTranslator( buildRoot ) == NULL )
+        {
+            traverse.deferredFiles = &deferredFiles;
+        }
 
         discHandle->ScanDirectory( "@", "*", true, NULL, _discFileCallback, &traverse );
+
+        _deferredWork work;
+        work.info = &traverse;
+        work.files = &deferredFiles;
+
+        this->module->ProcessWorkItems( deferredFiles.size(), _deferredFileCallback, &work );
     }
 
     inline void setArchiveReconstruction( bool doReconstruct )
@@ -41,15 +63,28 @@ struct gtaFileProcessor
         this->use_compressed_img_archives = doUse;
     }
 
+    // Guards the translators, since files may be processed on more than one thread.
+    // Sentries have to take it for anything they do with the roots.
+    std::mutex lockFileSystem;
+
 private:
     bool reconstruct_archives;
     bool use_compressed_img_archives;
 
+    struct _deferredFile
+    {
+        filePath discFilePathAbs;
+        filePath relPathFromRoot;
+        filePath fileName;
+        filePath extention;
+    };
+
     struct _discFileTraverse
     {
         inline _discFileTraverse( void )
         {
             this->anyWork = false;
+            this->deferredFiles = NULL;
         }
 
         MessageReceiver *module;
@@ -64,8 +99,101 @@ private:
         bool use_compressed_img_archives;
 
         sentryType *sentry;
+
+        std::mutex *lockFileSystem;
+        std::vector <_deferredFile> *deferredFiles;
+    };
+
+    struct _deferredWork
+    {
+        _discFileTraverse *info;
+        std::vector <_deferredFile> *files;
     };
 
+    static void _deferredFileCallback( void *ud, size_t fileIndex )
+    {
+        _deferredWork *work = (_deferredWork*)ud;
+
+        const _deferredFile& file = (*work->files)[ fileIndex ];
+
+        _discFileTraverse *info = work->info;
+
+        bool anyWork = _processSingletonFile( info, file.discFilePathAbs, file.relPathFromRoot, file.fileName, file.extention );
+
+        if ( anyWork )
+        {
+            std::lock_guard <std::mutex> ctxFileSystem( *info->lockFileSystem );
+
+            info->anyWork = true;
+        }
+    }
+
+    static bool _processSingletonFile(
+        _discFileTraverse *info,
+        const filePath& discFilePathAbs, const filePath& relPathFromRoot, const filePath& fileName, const filePath& extention
+    )
+    {
+        MessageReceiver *module = info->module;
+
+        bool anyWork = false;
+
+        // Do special logic for certain files.
+        // Copy all files into the build root.
+        CFile *sourceStream = NULL;
+        {
+            std::lock_guard <std::mutex> ctxFileSystem( *info->lockFileSystem );
+
+            sourceStream = info->discHandle->Open( discFilePathAbs, L"rb" );
+        }
+
+        if ( sourceStream )
+        {
+            try
+            {
+                sourceStream = module->WrapStreamCodec( sourceStream );
+            }
+            catch( ... )
+            {
+                delete sourceStream;
+
+                throw;
+            }
+        }
+                
+        if ( sourceStream )
+        {
+            try
+            {
+                auto timeStart = std::chrono::steady_clock::now();
+
+                // Execute the sentry.
+                bool hasDoneAnyWork = info->sentry->OnSingletonFile(
+                    info->discHandle, info->buildRoot, relPathFromRoot, fileName, extention, sourceStream, info->isInArchive,
+                    *info->lockFileSystem
+                );
+
+                std::chrono::duration <double> timeTaken = ( std::chrono::steady_clock::now() - timeStart );
+
+                module->OnFileProcessed( relPathFromRoot, timeTaken.count(), hasDoneAnyWork );
+
+                if ( hasDoneAnyWork )
+                {
+                    anyWork = true;
+                }
+            }
+            catch( ... )
+            {
+                delete sourceStream;
+
+                throw;
+            }
+
+            delete sourceStream;
+        }
+
+        return anyWork;
+    }
+
     static void _discFileCallback( const filePath& discFilePathAbs, void *userdata )
     {
         _discFileTraverse *info = (_discFileTraverse*)userdata;
@@ -199,6 +327,7 @@ private:
                                     traverse.sentry = info->sentry;
                                     traverse.reconstruct_archives = info->reconstruct_archives;
                                     traverse.use_compressed_img_archives = info->use_compressed_img_archives;
+                                    traverse.lockFileSystem = info->lockFileSystem;
 
                                     srcIMGRoot->ScanDirectory( "@", "*", true, NULL, _discFileCallback, &traverse );
 
@@ -262,47 +391,20 @@ private:
 
             if ( !hasPreprocessedFile )
             {
-                // Do special logic for certain files.
-                // Copy all files into the build root.
-                CFile *sourceStream = NULL;
-                {
-                    sourceStream = info->discHandle->Open( discFilePathAbs, L"rb" );
-                }
-
-                if ( sourceStream )
+                if ( std::vector <_deferredFile> *deferredFiles = info->deferredFiles )
                 {
-                    try
-                    {
-                        sourceStream = module->WrapStreamCodec( sourceStream );
-                    }
-                    catch( ... )
-                    {
-                        delete sourceStream;
-
-                        throw;
-                    }
+                    // Processed once the scan is done.
+                    _deferredFile file;
+                    file.discFilePathAbs = discFilePathAbs;
+                    file.relPathFromRoot = relPathFromRoot;
+                    file.fileName = fileName;
+                    file.extention = extention;
+
+                    deferredFiles->push_back( std::move( file ) );
                 }
-                
-                if ( sourceStream )
+                else if ( _processSingletonFile( info, discFilePathAbs, relPathFromRoot, fileName, extention ) )
                 {
-                    try
-                    {
-                        // Execute the sentry.
-                        bool hasDoneAnyWork = info->sentry->OnSingletonFile( info->discHandle, buildRoot, relPathFromRoot, fileName, extention, sourceStream, info->isInArchive );
-
-                        if ( hasDoneAnyWork )
-                        {
-                            anyWork = true;
-                        }
-                    }
-                    catch( ... )
-                    {
-                        delete sourceStream;
-
-                        throw;
-                    }
-
-                    delete sourceStream;
+                    anyWork = true;
                 }
             }
         }
@@ -6,6 +6,23 @@ struct MessageReceiver abstract
     virtual void OnMessage( const std::wstring& msg ) = 0;
 
     virtual CFile* WrapStreamCodec( CFile *compressed ) = 0;
+
+    // Called after each file that a tool has finished with, along with the time it took.
+    // Front-ends that want progress or timing reports can hook this; by default it is ignored.
+    virtual void OnFileProcessed( const filePath& relPath, double seconds, bool hasDoneAnyWork )
+    {
+        return;
+    }
+
+    // Runs independent work items of a tool, like the files of a directory.
+    // Front-ends with spare threads can spread them; by default they are processed in order.
+    virtual void ProcessWorkItems( size_t itemCount, rw::parallelWorkItemCallback_t cb, void *ud )
+    {
+        for ( size_t n = 0; n < itemCount; n++ )
+        {
+            cb( ud, n );
+        }
+    }
 };
 
 // Shared utilities for human-friendly RenderWare operations.
@@ -275,8 +275,8 @@ inline void PutVersionOnObject( rw::RwObject *rwObj, rwkind::eTargetPlatform gui
     }
 }
 
-void BuildSingleTexture(
-    rw::Interface *rwEngine, rw::TexDictionary *texDict,
+rw::TextureBase* BuildSingleTexture(
+    rw::Interface *rwEngine,
     const filePath& texturePath, rw::Stream *imgStream,
     TxdBuildModule *module, const TxdBuildModule::run_config& config, const filePath& extention,
     const ConfigNode& cfgParent
@@ -387,9 +387,6 @@ void BuildSingleTexture(
 
             // ;)
             imgTex->fixFiltering();
-
-            // Add our texture to the dictionary!
-            imgTex->AddToDictionary( texDict );
         }
         catch( ... )
         {
@@ -400,6 +397,8 @@ void BuildSingleTexture(
             throw;
         }
     }
+
+    return imgTex;
 }
 
 inline void InstrumentConfigKeys( rw::Interface *rwEngine, TxdBuildModule *module, ConfigNode& txdConfigNode, CINI::Entry *entry )
@@ -666,262 +665,447 @@ void ReadConfigurationBlock(
     }
 }
 
-void BuildTXDArchives(
-    rw::Interface *rwEngine,
-    TxdBuildModule *module, CFileTranslator *gameRoot, CFileTranslator *outputRoot,
-    const TxdBuildModule::run_config& config, const ConfigNode& cfgNode
-)
+// Textures of a TXD directory are built on the worker threads.
+// File system access is serialized, while decoding and processing of the images runs in parallel.
+struct txdBuildTextureJob
 {
-    // Process things.
-    auto dir_callback = [&]( const filePath& dirPath )
+    filePath texturePath;
+    filePath extention;
+
+    rw::TextureBase *builtTexture;
+};
+
+struct txdBuildDirectoryContext
+{
+    rw::Interface *rwEngine;
+    TxdBuildModule *module;
+    CFileTranslator *gameRoot;
+    const TxdBuildModule::run_config *config;
+    const ConfigNode *txdConfigNode;
+
+    rw::rwlock *lockFileSystem;
+
+    std::vector <txdBuildTextureJob> jobs;
+};
+
+static void BuildTextureJob( void *ud, size_t jobIndex )
+{
+    txdBuildDirectoryContext *ctx = (txdBuildDirectoryContext*)ud;
+
+    rw::Interface *rwEngine = ctx->rwEngine;
+    TxdBuildModule *module = ctx->module;
+    CFileTranslator *gameRoot = ctx->gameRoot;
+
+    txdBuildTextureJob& job = ctx->jobs[ jobIndex ];
+
+    const filePath& texturePath = job.texturePath;
+
+    // Load configuration for this texture.
+    ConfigNode textureCfgNode;
+    textureCfgNode.SetParent( ctx->txdConfigNode );
+
+    // Fetch the (decompressed) image file into memory.
+    std::vector <char> imgData;
+    bool hasImageData = false;
     {
+        rw::scoped_rwlock_writer <> ctxFileSystem( ctx->lockFileSystem );
+
+        // We have to parse the path to this texture.
+        filePath pathToTexture;
+
+        bool gotPath = gameRoot->GetRelativePathFromRoot( texturePath, false, pathToTexture );
+
+        if ( !gotPath )
+            return;
+
+        CFile *fsImgStream = gameRoot->Open( texturePath, L"rb" );
+
+        if ( fsImgStream )
+        {
+            try
+            {
+                // Decompress if we find compressed things. ;)
+                fsImgStream = module->WrapStreamCodec( fsImgStream );
+            }
+            catch( ... )
+            {
+                delete fsImgStream;
+
+                throw;
+            }
+        }
+
+        if ( fsImgStream )
+        {
+            try
+            {
+                imgData.resize( fsImgStream->GetSize() );
+
+                size_t readCount = fsImgStream->Read( imgData.data(), 1, imgData.size() );
+
+                imgData.resize( readCount );
+            }
+            catch( ... )
+            {
+                delete fsImgStream;
+
+                throw;
+            }
+
+            delete fsImgStream;
+
+            hasImageData = true;
+        }
+        else
+        {
+            module->OnMessage( std::wstring( L"failed to open texture: " ) + texturePath.convert_unicode() + L'\n' );
+        }
+
+        if ( hasImageData )
+        {
+            filePath fileNameItem = FileSystem::GetFileNameItem( texturePath, false );
+
+            filePath texIniPath = ( pathToTexture + fileNameItem + L".ini" );
+
+            ReadConfigurationBlock(
+                rwEngine,
+                gameRoot, std::move( texIniPath ),
+                textureCfgNode,
+                module
+            );
+        }
+    }
+
+    if ( hasImageData )
+    {
+        // Try to turn this file into a texture.
         try
         {
-            // Prepare the TXD write path.
-            filePath txdWritePath;
+            rw::streamConstructionMemoryParam_t memParam( imgData.data(), imgData.size() );
 
-            bool hasTXDWritePath = gameRoot->GetRelativePathFromRoot( dirPath, false, txdWritePath );
+            rw::Stream *imgStream = rwEngine->CreateStream( rw::RWSTREAMTYPE_MEMORY, rw::RWSTREAMMODE_READONLY, &memParam );
 
-            if ( hasTXDWritePath )
+            if ( imgStream )
             {
-                // Trimm off the slash, if it exists.
+                try
+                {
+                    // We got all streams prepared!
+                    // Try turning it into a texture now.
+                    job.builtTexture = BuildSingleTexture(
+                        rwEngine,
+                        texturePath, imgStream,
+                        module, *ctx->config, job.extention,
+                        textureCfgNode
+                    );
+                }
+                catch( ... )
                 {
-                    size_t outPathLen = txdWritePath.size();
+                    rwEngine->DeleteStream( imgStream );
 
-                    if ( outPathLen > 0 )
-                    {
-                        txdWritePath.resize( outPathLen - 1 );  // Here cannot be encoding issues as long as the character is a traditional slash.
-                    }
+                    throw;
                 }
 
-                txdWritePath += L".txd";
+                rwEngine->DeleteStream( imgStream );
             }
-            
-            // We can only continue if we actually have a valid location to write our TXD to.
-            if ( hasTXDWritePath )
-            {
-                // Send a status message about our build process.
-                module->OnMessage( std::wstring( L"building '" ) + txdWritePath.convert_unicode() + L"'...\n" );
+        }
+        catch( rw::RwException& except )
+        {
+            // Tell the runtime about any errors.
+            module->OnMessage( std::string( "failed to build texture: " ) + except.message + '\n' );
 
-                rw::TexDictionary *texDict = rw::CreateTexDictionary( rwEngine );
+            // Continue. This is just one of many textures.
+        }
+    }
+
+    // Termination of the build thread is checked by the worker pool between textures,
+    // since the workers themselves never receive the request.
+}
 
-                if ( !texDict )
+struct txdBuildContext
+{
+    rw::Interface *rwEngine;
+    TxdBuildModule *module;
+    CFileTranslator *gameRoot;
+    CFileTranslator *outputRoot;
+    const TxdBuildModule::run_config *config;
+    const ConfigNode *cfgNode;
+
+    // Shared by all TXDs, since the module may build them at the same time.
+    rw::rwlock *lockFileSystem;
+
+    std::vector <filePath> dirPaths;
+};
+
+static void BuildTXDArchive( void *ud, size_t dirIndex )
+{
+    txdBuildContext *ctx = (txdBuildContext*)ud;
+
+    rw::Interface *rwEngine = ctx->rwEngine;
+    TxdBuildModule *module = ctx->module;
+    CFileTranslator *gameRoot = ctx->gameRoot;
+    CFileTranslator *outputRoot = ctx->outputRoot;
+    const TxdBuildModule::run_config& config = *ctx->config;
+    const ConfigNode& cfgNode = *ctx->cfgNode;
+
+    const filePath& dirPath = ctx->dirPaths[ dirIndex ];
+
+    try
+    {
+        // Prepare the TXD write path.
+        filePath txdWritePath;
+        bool hasTXDWritePath;
+        {
+            rw::scoped_rwlock_writer <> ctxFileSystem( ctx->lockFileSystem );
+
+            hasTXDWritePath = gameRoot->GetRelativePathFromRoot( dirPath, false, txdWritePath );
+        }
+
+        if ( hasTXDWritePath )
+        {
+            // Trimm off the slash, if it exists.
+            {
+                size_t outPathLen = txdWritePath.size();
+
+                if ( outPathLen > 0 )
                 {
-                    throw rw::RwException( "failed to allocate texture dictionary object" );
+                    txdWritePath.resize( outPathLen - 1 );  // Here cannot be encoding issues as long as the character is a traditional slash.
                 }
+            }
+
+            txdWritePath += L".txd";
+        }
         
-                try
+        // We can only continue if we actually have a valid location to write our TXD to.
+        if ( hasTXDWritePath )
+        {
+            // Send a status message about our build process.
+            module->OnMessage( std::wstring( L"building '" ) + txdWritePath.convert_unicode() + L"'...\n" );
+
+            auto timeStart = std::chrono::steady_clock::now();
+
+            bool hasWrittenTXD = false;
+
+            rw::TexDictionary *texDict = rw::CreateTexDictionary( rwEngine );
+
+            if ( !texDict )
+            {
+                throw rw::RwException( "failed to allocate texture dictionary object" );
+            }
+    
+            try
+            {
+                // Load configuration for this TXD.
+                ConfigNode txdConfigNode;
+                txdConfigNode.SetParent( &cfgNode );
                 {
-                    // Load configuration for this TXD.
-                    ConfigNode txdConfigNode;
-                    txdConfigNode.SetParent( &cfgNode );
-                    {
-                        filePath iniPath = dirPath + L"_build.ini";
-
-                        ReadConfigurationBlock(
-                            rwEngine,
-                            gameRoot, std::move( iniPath ),
-                            txdConfigNode,
-                            module
-                        );
-                    }
+                    rw::scoped_rwlock_writer <> ctxFileSystem( ctx->lockFileSystem );
 
-                    // Add all textures to this TXD.
+                    filePath iniPath = dirPath + L"_build.ini";
+
+                    ReadConfigurationBlock(
+                        rwEngine,
+                        gameRoot, std::move( iniPath ),
+                        txdConfigNode,
+                        module
+                    );
+                }
+
+                // Add all textures to this TXD.
+                {
+                    txdBuildDirectoryContext dirCtx;
+                    dirCtx.rwEngine = rwEngine;
+                    dirCtx.module = module;
+                    dirCtx.gameRoot = gameRoot;
+                    dirCtx.config = &config;
+                    dirCtx.txdConfigNode = &txdConfigNode;
+                    dirCtx.lockFileSystem = ctx->lockFileSystem;
+
+                    try
                     {
+                        // Collect the textures in directory order, which is the order they will have in the TXD.
                         auto per_dir_file_cb = [&]( const filePath& texturePath )
                         {
-                            // We first have to establish a stream to the file.
-                            CFile *fsImgStream = gameRoot->Open( texturePath, L"rb" );
+                            filePath extOut;
+
+                            FileSystem::GetFileNameItem( texturePath, false, NULL, &extOut );
 
-                            if ( fsImgStream )
+                            // Ignore some extensions.
+                            // Those are used for meta-properties of textures.
+                            if ( extOut != L"ini" )
                             {
-                                try
-                                {
-                                    // Decompress if we find compressed things. ;)
-                                    fsImgStream = module->WrapStreamCodec( fsImgStream );
-                                }
-                                catch( ... )
-                                {
-                                    delete fsImgStream;
+                                txdBuildTextureJob job;
+                                job.texturePath = texturePath;
+                                job.extention = std::move( extOut );
+                                job.builtTexture = NULL;
 
-                                    throw;
-                                }
+                                dirCtx.jobs.push_back( std::move( job ) );
                             }
+                        };
 
-                            if ( fsImgStream )
-                            {
-                                try
-                                {
-                                    // Try to turn this file into a texture.
-                                    try
-                                    {
-                                        rw::Stream *imgStream = RwStreamCreateTranslated( rwEngine, fsImgStream );
-
-                                        if ( imgStream )
-                                        {
-                                            try
-                                            {
-                                                // We have to parse the path to this texture.
-                                                filePath pathToTexture;
-                                                    
-                                                bool gotPath = gameRoot->GetRelativePathFromRoot( texturePath, false, pathToTexture );
-
-                                                if ( gotPath )
-                                                {
-                                                    filePath extOut;
-
-                                                    filePath fileNameItem = FileSystem::GetFileNameItem( texturePath, false, NULL, &extOut );
-
-                                                    // Ignore some extensions.
-                                                    // Those are used for meta-properties of textures.
-                                                    if ( extOut != L"ini" )
-                                                    {
-                                                        // Alright, this is a candidate for a valid texture!
-                                                        // Let process this entry.
-
-                                                        // Load configuration for this texture.
-                                                        ConfigNode textureCfgNode;
-                                                        textureCfgNode.SetParent( &txdConfigNode );
-                                                        {
-                                                            filePath texIniPath = ( pathToTexture + fileNameItem + L".ini" );
-
-                                                            ReadConfigurationBlock(
-                                                                rwEngine,
-                                                                gameRoot, std::move( texIniPath ),
-                                                                textureCfgNode,
-                                                                module
-                                                            );
-                                                        }
-
-                                                        // We got all streams prepared!
-                                                        // Try turning it into a texture now.
-                                                        BuildSingleTexture(
-                                                            rwEngine, texDict,
-                                                            texturePath, imgStream,
-                                                            module, config, extOut,
-                                                            textureCfgNode
-                                                        );
-                                                    }
-                                                }
-                                            }
-                                            catch( ... )
-                                            {
-                                                rwEngine->DeleteStream( imgStream );
-
-                                                throw;
-                                            }
-
-                                            rwEngine->DeleteStream( imgStream );
-                                        }
-                                    }
-                                    catch( rw::RwException& except )
-                                    {
-                                        // Tell the runtime about any errors.
-                                        module->OnMessage( std::string( "failed to build texture: " ) + except.message + '\n' );
-
-                                        // Continue. This is just one of many textures.
-                                    }
-                                }
-                                catch( ... )
-                                {
-                                    delete fsImgStream;
+                        {
+                            rw::scoped_rwlock_writer <> ctxFileSystem( ctx->lockFileSystem );
 
-                                    throw;
-                                }
+                            gameRoot->ScanDirectory( dirPath, "*", false, NULL, std::move( per_dir_file_cb ), NULL );
+                        }
+
+                        rw::ParallelForEachItem( rwEngine, dirCtx.jobs.size(), BuildTextureJob, &dirCtx );
 
-                                delete fsImgStream;
+                        // Add the textures that did build.
+                        for ( txdBuildTextureJob& job : dirCtx.jobs )
+                        {
+                            if ( rw::TextureBase *builtTexture = job.builtTexture )
+                            {
+                                builtTexture->AddToDictionary( texDict );
+
+                                job.builtTexture = NULL;
                             }
-                            else
+                        }
+                    }
+                    catch( ... )
+                    {
+                        for ( txdBuildTextureJob& job : dirCtx.jobs )
+                        {
+                            if ( rw::TextureBase *builtTexture = job.builtTexture )
                             {
-                                module->OnMessage( std::wstring( L"failed to open texture: " ) + texturePath.convert_unicode() + L'\n' );
+                                rwEngine->DeleteRwObject( builtTexture );
                             }
+                        }
 
-                            // Allow termination per texture.
-                            rw::CheckThreadHazards( rwEngine );
-                        };
-
-                        gameRoot->ScanDirectory( dirPath, "*", false, NULL, std::move( per_dir_file_cb ), NULL );
+                        throw;
                     }
+                }
 
-                    // If we have at least one texture in this texture dictionary, we can initialize it and write away.
-                    if ( texDict->GetTextureCount() != 0 )
-                    {
-                        // We give this TXD the version of the first texture inside, for good measure.
-                        rw::TextureBase *firstTex = texDict->GetTextureIterator().Resolve();
+                // If we have at least one texture in this texture dictionary, we can initialize it and write away.
+                if ( texDict->GetTextureCount() != 0 )
+                {
+                    // We give this TXD the version of the first texture inside, for good measure.
+                    rw::TextureBase *firstTex = texDict->GetTextureIterator().Resolve();
+
+                    texDict->SetEngineVersion( firstTex->GetEngineVersion() );
 
-                        texDict->SetEngineVersion( firstTex->GetEngineVersion() );
+                    // Maybe the config has a better version.
+                    PutVersionOnObject( texDict, config.targetPlatform, config.targetGame, txdConfigNode );
 
-                        // Maybe the config has a better version.
-                        PutVersionOnObject( texDict, config.targetPlatform, config.targetGame, txdConfigNode );
+                    // Now write it to disk.
+                    // We want to write it with the same name as the directory had.
+                    // Here we can use a trick: trimm of the last character of the directory path, always a slash, and replace it with ".txd" !
+                    // The path has to be relative, as we want to write it into the output root.
 
-                        // Now write it to disk.
-                        // We want to write it with the same name as the directory had.
-                        // Here we can use a trick: trimm of the last character of the directory path, always a slash, and replace it with ".txd" !
-                        // The path has to be relative, as we want to write it into the output root.
+                    // Now establish the stream and push it!
+                    CFile *fsTXDStream;
+                    {
+                        rw::scoped_rwlock_writer <> ctxFileSystem( ctx->lockFileSystem );
 
-                        // Now establish the stream and push it!
-                        CFile *fsTXDStream = outputRoot->Open( txdWritePath, L"wb" );
+                        fsTXDStream = outputRoot->Open( txdWritePath, L"wb" );
+                    }
 
-                        if ( fsTXDStream )
+                    if ( fsTXDStream )
+                    {
+                        try
                         {
-                            try
-                            {
-                                rw::Stream *txdStream = RwStreamCreateTranslated( rwEngine, fsTXDStream );
+                            rw::Stream *txdStream = RwStreamCreateTranslated( rwEngine, fsTXDStream );
 
-                                if ( txdStream )
+                            if ( txdStream )
+                            {
+                                try
                                 {
-                                    try
-                                    {
-                                        // Finally, get to write this thing.
-                                        rwEngine->Serialize( texDict, txdStream );
-                                    }
-                                    catch( ... )
-                                    {
-                                        rwEngine->DeleteStream( txdStream );
-
-                                        throw;
-                                    }
+                                    // Finally, get to write this thing.
+                                    rwEngine->Serialize( texDict, txdStream );
 
+                                    hasWrittenTXD = true;
+                                }
+                                catch( ... )
+                                {
                                     rwEngine->DeleteStream( txdStream );
+
+                                    throw;
                                 }
-                            }
-                            catch( ... )
-                            {
-                                delete fsTXDStream;
 
-                                throw;
+                                rwEngine->DeleteStream( txdStream );
                             }
-
-                            delete fsTXDStream;
                         }
-                        else
+                        catch( ... )
                         {
-                            module->OnMessage( std::wstring( L"failed to open TXD for writing\n" ) );
+                            delete fsTXDStream;
+
+                            throw;
                         }
-                    }
-                }
-                catch( ... )
-                {
-                    rwEngine->DeleteRwObject( texDict );
 
-                    throw;
+                        delete fsTXDStream;
+                    }
+                    else
+                    {
+                        module->OnMessage( std::wstring( L"failed to open TXD for writing\n" ) );
+                    }
                 }
-
+            }
+            catch( ... )
+            {
                 rwEngine->DeleteRwObject( texDict );
+
+                throw;
             }
 
-            // Allow termination per TXD archive.
-            rw::CheckThreadHazards( rwEngine );
-        }
-        catch( rw::RwException& except )
-        {
-            // Ignore any errors we encounter at processing a TXD, so other TXDs can try processing.
-            module->OnMessage( std::string( "failed to build TXD: " ) + except.message + '\n' );
+            rwEngine->DeleteRwObject( texDict );
+
+            std::chrono::duration <double> timeTaken = ( std::chrono::steady_clock::now() - timeStart );
+
+            module->OnFileProcessed( txdWritePath, timeTaken.count(), hasWrittenTXD );
         }
+
+        // Allow termination per TXD archive.
+        rw::CheckThreadHazards( rwEngine );
+    }
+    catch( rw::RwException& except )
+    {
+        // Ignore any errors we encounter at processing a TXD, so other TXDs can try processing.
+        module->OnMessage( std::string( "failed to build TXD: " ) + except.message + '\n' );
+    }
+}
+
+void BuildTXDArchives(
+    rw::Interface *rwEngine,
+    TxdBuildModule *module, CFileTranslator *gameRoot, CFileTranslator *outputRoot,
+    const TxdBuildModule::run_config& config, const ConfigNode& cfgNode
+)
+{
+    txdBuildContext ctx;
+    ctx.rwEngine = rwEngine;
+    ctx.module = module;
+    ctx.gameRoot = gameRoot;
+    ctx.outputRoot = outputRoot;
+    ctx.config = &config;
+    ctx.cfgNode = &cfgNode;
+
+    // Every directory becomes a TXD.
+    auto dir_callback = [&]( const filePath& dirPath )
+    {
+        ctx.dirPaths.push_back( dirPath );
     };
 
     // Let us use the kickass C++11 lambdas :)
     gameRoot->ScanDirectory( "@", "*", true, std::move( dir_callback ), NULL, NULL );
+
+    ctx.lockFileSystem = rw::CreateReadWriteLock( rwEngine );
+
+    if ( !ctx.lockFileSystem )
+    {
+        throw rw::RwException( "failed to create file system lock for TXD build" );
+    }
+
+    try
+    {
+        // The TXDs do not depend on each other, so the module may build them in parallel.
+        module->ProcessWorkItems( ctx.dirPaths.size(), BuildTXDArchive, &ctx );
+    }
+    catch( ... )
+    {
+        rw::CloseReadWriteLock( rwEngine, ctx.lockFileSystem );
+
+        throw;
+    }
+
+    rw::CloseReadWriteLock( rwEngine, ctx.lockFileSystem );
 }
 
 bool TxdBuildModule::RunApplication( const run_config& config )
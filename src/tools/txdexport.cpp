@@ -3,6 +3,13 @@
 
 #include "dirtools.h"
 
+#include <map>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+
+#include <wctype.h>
+
 static rw::TexDictionary* RwTexDictionaryStreamRead( rw::Interface *rwEngine, CFile *stream )
 {
     rw::TexDictionary *resultDict = NULL;
@@ -47,14 +54,182 @@ static rw::TexDictionary* RwTexDictionaryStreamRead( rw::Interface *rwEngine, CF
     return resultDict;
 }
 
+// Game data shares the same textures across many dictionaries.
+// We remember where each distinct texture has been exported to, so that repeated ones
+// are copied from that file instead of being decoded and encoded again.
+struct texExportCache
+{
+    struct texKey
+    {
+        std::string nativeTypeName;
+        rw::uint64 texelHash;
+
+        inline bool operator < ( const texKey& right ) const
+        {
+            if ( this->texelHash != right.texelHash )
+            {
+                return ( this->texelHash < right.texelHash );
+            }
+
+            return ( this->nativeTypeName < right.nativeTypeName );
+        }
+    };
+
+    // The hash alone could collide, so we also remember what the image looked like.
+    struct storedFile
+    {
+        filePath fileName;
+        rw::eRasterFormat rasterFormat;
+        rw::uint32 width, height;
+        rw::uint32 mipmapCount;
+        rw::uint64 dataSize;
+        rw::uint64 checkHash;   // second texel hash, independent of the key hash
+
+        inline bool isSameImage( const storedFile& right ) const
+        {
+            return
+                ( this->rasterFormat == right.rasterFormat &&
+                  this->width == right.width &&
+                  this->height == right.height &&
+                  this->mipmapCount == right.mipmapCount &&
+                  this->dataSize == right.dataSize &&
+                  this->checkHash == right.checkHash );
+        }
+    };
+
+    std::map <texKey, storedFile> storedFiles;
+
+    // Which image each file holds, so that we can forget it quickly.
+    // File names are case insensitive.
+    std::map <std::wstring, texKey> storedFileKeys;
+
+    static inline std::wstring GetFileKeyName( const filePath& fileName )
+    {
+        std::wstring keyName = fileName.convert_unicode();
+
+        std::transform( keyName.begin(), keyName.end(), keyName.begin(), ::towlower );
+
+        return keyName;
+    }
+
+    inline void StoreFile( const texKey& key, const storedFile& fileInfo )
+    {
+        auto oldIter = this->storedFiles.find( key );
+
+        if ( oldIter != this->storedFiles.end() )
+        {
+            this->storedFileKeys.erase( GetFileKeyName( oldIter->second.fileName ) );
+        }
+
+        this->storedFiles[ key ] = fileInfo;
+        this->storedFileKeys[ GetFileKeyName( fileInfo.fileName ) ] = key;
+    }
+
+    // Called before a file is (re)written, since it then no longer holds the image that was stored in it.
+    inline void ForgetStoredFile( const filePath& fileName )
+    {
+        auto keyIter = this->storedFileKeys.find( GetFileKeyName( fileName ) );
+
+        if ( keyIter != this->storedFileKeys.end() )
+        {
+            this->storedFiles.erase( keyIter->second );
+            this->storedFileKeys.erase( keyIter );
+        }
+    }
+
+    // Files are written outside of the file system lock, so others that want
+    // the same file have to wait until it is done.
+    std::set <std::wstring> filesInWork;
+    std::condition_variable fileFinished;
+
+    inline void WaitForFile( std::unique_lock <std::mutex>& ctxFileSystem, const std::wstring& keyName )
+    {
+        while ( this->filesInWork.find( keyName ) != this->filesInWork.end() )
+        {
+            this->fileFinished.wait( ctxFileSystem );
+        }
+    }
+
+    inline void FinishFile( const std::wstring& keyName )
+    {
+        this->filesInWork.erase( keyName );
+
+        this->fileFinished.notify_all();
+    }
+
+    // Maps each exported texture to the file that holds its image.
+    CFile *manifestStream = NULL;
+
+    inline void WriteManifestEntry( const filePath& texFileName, const filePath& storedFileName )
+    {
+        if ( CFile *manifestStream = this->manifestStream )
+        {
+            std::string entry = texFileName.convert_ansi();
+            entry += " = ";
+            entry += storedFileName.convert_ansi();
+            entry += "\n";
+
+            manifestStream->Write( entry.c_str(), 1, entry.size() );
+        }
+    }
+};
+
+static bool WriteTextureToStream(
+    rw::TextureBase *texHandle, rw::Raster *texRaster, CFile *targetStream, const std::string& imgFormat
+)
+{
+    rw::Interface *rwEngine = texHandle->GetEngine();
+
+    bool hasWritten = false;
+
+    rw::Stream *rwStream = RwStreamCreateTranslated( rwEngine, targetStream );
+
+    if ( rwStream )
+    {
+        try
+        {
+            // Write it!
+            try
+            {
+                if ( stricmp( imgFormat.c_str(), "RWTEX" ) == 0 )
+                {
+                    rwEngine->Serialize( texHandle, rwStream );
+                }
+                else
+                {
+                    texRaster->writeImage( rwStream, imgFormat.c_str() );
+                }
+
+                hasWritten = true;
+            }
+            catch( rw::RwException& )
+            {
+                // If we failed to write it, just live with it.
+            }
+        }
+        catch( ... )
+        {
+            rwEngine->DeleteStream( rwStream );
+
+            throw;
+        }
+
+        rwEngine->DeleteStream( rwStream );
+    }
+
+    return hasWritten;
+}
+
 static void ExportImagesFromDictionary(
     rw::TexDictionary *texDict, CFileTranslator *outputRoot,
     const filePath& txdFileName, const filePath& relPathFromRoot,
     MassExportModule::eOutputType outputType,
-    const std::string& imgFormat
+    const std::string& imgFormat,
+    texExportCache& exportCache, std::mutex& lockFileSystem
 )
 {
-    rw::Interface *rwEngine = texDict->GetEngine();
+    // Serialized textures carry their name, so only plain images can be shared.
+    bool canShareImages = ( stricmp( imgFormat.c_str(), "RWTEX" ) != 0 );
 
     for ( rw::TexDictionary::texIter_t iter( texDict->GetTextureIterator() ); !iter.IsEnd(); iter.Increment() )
     {
@@ -62,6 +237,10 @@ static void ExportImagesFromDictionary(
 
         if ( rw::Raster *texRaster = texHandle->GetRaster() )
         {
+            // We own this dictionary and only read from it, so the raster can be frozen.
+            // Hashing and writing then read it without taking its lock.
+            texRaster->freeze();
+
             // Construct the target filename.
             filePath targetFileName = relPathFromRoot;
 
@@ -90,54 +269,112 @@ static void ExportImagesFromDictionary(
 
             targetFileName += lower_ext;
 
-            // Create the target stream.
-            CFile *targetStream = outputRoot->Open( targetFileName, "wb" );
+            // Look whether we have already exported the same image.
+            texExportCache::texKey texKey;
+            texExportCache::storedFile texInfo;
+            bool hasTexKey = false;
 
-            if ( targetStream )
+            if ( canShareImages )
             {
                 try
                 {
-                    rw::Stream *rwStream = RwStreamCreateTranslated( rwEngine, targetStream );
+                    if ( const char *nativeTypeName = texRaster->getNativeDataTypeName() )
+                    {
+                        texKey.nativeTypeName = nativeTypeName;
+                        texKey.texelHash = texRaster->getTexelDataHash( &texInfo.dataSize, &texInfo.checkHash );
 
-                    if ( rwStream )
+                        texInfo.fileName = targetFileName;
+                        texInfo.rasterFormat = texRaster->getRasterFormat();
+                        texRaster->getSize( texInfo.width, texInfo.height );
+                        texInfo.mipmapCount = texRaster->getMipmapCount();
+
+                        hasTexKey = true;
+                    }
+                }
+                catch( rw::RwException& )
+                {
+                    // Then we just export it on its own.
+                }
+            }
+
+            std::wstring targetKeyName = texExportCache::GetFileKeyName( targetFileName );
+
+            CFile *targetStream = NULL;
+            {
+                std::unique_lock <std::mutex> ctxFileSystem( lockFileSystem );
+
+                // Another dictionary could be writing the same file right now.
+                exportCache.WaitForFile( ctxFileSystem, targetKeyName );
+
+                if ( hasTexKey )
+                {
+                    auto foundIter = exportCache.storedFiles.find( texKey );
+
+                    if ( foundIter != exportCache.storedFiles.end() && foundIter->second.isSameImage( texInfo ) )
                     {
-                        try
+                        // Copy the path, because forgetting the target file could erase this entry.
+                        filePath storedFileName = foundIter->second.fileName;
+
+                        if ( storedFileName.equals( targetFileName, false ) )
                         {
-                            // Write it!
-                            try
-                            {
-                                if ( stricmp( imgFormat.c_str(), "RWTEX" ) == 0 )
-                                {
-                                    rwEngine->Serialize( texHandle, rwStream );
-                                }
-                                else
-                                {
-                                    texRaster->writeImage( rwStream, imgFormat.c_str() );
-                                }
-                            }
-                            catch( rw::RwException& )
-                            {
-                                // If we failed to write it, just live with it.
-                            }
+                            // The target already holds this image.
+                            exportCache.WriteManifestEntry( targetFileName, storedFileName );
+                            continue;
                         }
-                        catch( ... )
-                        {
-                            rwEngine->DeleteStream( rwStream );
 
-                            throw;
-                        }
+                        exportCache.ForgetStoredFile( targetFileName );
 
-                        rwEngine->DeleteStream( rwStream );
+                        if ( outputRoot->Copy( storedFileName, targetFileName ) )
+                        {
+                            exportCache.WriteManifestEntry( targetFileName, storedFileName );
+                            continue;
+                        }
                     }
                 }
-                catch( ... )
-                {
-                    delete targetStream;
 
-                    throw;
-                }
+                // Whatever was stored in the target file before is overwritten now.
+                exportCache.ForgetStoredFile( targetFileName );
+
+                targetStream = outputRoot->Open( targetFileName, "wb" );
+
+                if ( targetStream == NULL )
+                    continue;
 
+                exportCache.filesInWork.insert( targetKeyName );
+            }
+
+            // Encoding is the expensive part, so it runs without the lock.
+            bool hasWritten = false;
+
+            try
+            {
+                hasWritten = WriteTextureToStream( texHandle, texRaster, targetStream, imgFormat );
+            }
+            catch( ... )
+            {
                 delete targetStream;
+
+                std::lock_guard <std::mutex> ctxFileSystem( lockFileSystem );
+
+                exportCache.FinishFile( targetKeyName );
+
+                throw;
+            }
+
+            delete targetStream;
+
+            std::lock_guard <std::mutex> ctxFileSystem( lockFileSystem );
+
+            exportCache.FinishFile( targetKeyName );
+
+            if ( hasWritten )
+            {
+                if ( hasTexKey )
+                {
+                    exportCache.StoreFile( texKey, texInfo );
+                }
+
+                exportCache.WriteManifestEntry( targetFileName, targetFileName );
             }
         }
     }
@@ -147,11 +384,12 @@ struct _discFileSentry_txdexport
 {
     MassExportModule *module;
     const MassExportModule::run_config *config;
+    texExportCache *exportCache;
 
     inline bool OnSingletonFile(
         CFileTranslator *sourceRoot, CFileTranslator *buildRoot, const filePath& relPathFromRoot,
         const filePath& fileName, const filePath& extention, CFile *sourceStream,
-        bool isInArchive
+        bool isInArchive, std::mutex& lockFileSystem
     )
     {
         rw::Interface *rwEngine = module->GetEngine();
@@ -182,8 +420,11 @@ struct _discFileSentry_txdexport
 
                 // Get the relative path to the file without the filename.
                 filePath relPathFromRootWithoutFile;
+                {
+                    std::lock_guard <std::mutex> ctxFileSystem( lockFileSystem );
 
-                buildRoot->GetRelativePathFromRoot( relPathFromRoot, false, relPathFromRootWithoutFile );
+                    buildRoot->GetRelativePathFromRoot( relPathFromRoot, false, relPathFromRootWithoutFile );
+                }
 
                 // For each texture that we find, export it as raw image.
                 rw::TexDictionary *texDict = RwTexDictionaryStreamRead( rwEngine, sourceStream );
@@ -195,7 +436,7 @@ struct _discFileSentry_txdexport
                         // Export everything inside of this.
                         ExportImagesFromDictionary(
                             texDict, buildRoot, fileName, relPathFromRootWithoutFile, config->outputType,
-                            config->recImgFormat
+                            config->recImgFormat, *exportCache, lockFileSystem
                         );
 
                         anyWork = true;
@@ -256,11 +497,26 @@ bool MassExportModule::ApplicationMain( const run_config& cfg )
                 fileProc.setUseCompressedIMGArchives( true );
                 fileProc.setArchiveReconstruction( false );
 
-                _discFileSentry_txdexport sentry;
-                sentry.module = this;
-                sentry.config = &cfg;
+                texExportCache exportCache;
+                exportCache.manifestStream = outputRootTranslator->Open( "export_manifest.txt", "wb" );
+
+                try
+                {
+                    _discFileSentry_txdexport sentry;
+                    sentry.module = this;
+                    sentry.config = &cfg;
+                    sentry.exportCache = &exportCache;
+
+                    fileProc.process( &sentry, gameRootTranslator, outputRootTranslator );
+                }
+                catch( ... )
+                {
+                    delete exportCache.manifestStream;
+
+                    throw;
+                }
 
-                fileProc.process( &sentry, gameRootTranslator, outputRootTranslator );
+                delete exportCache.manifestStream;
             }
         }
         catch( ... )
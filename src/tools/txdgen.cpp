@@ -27,7 +27,7 @@ bool TxdGenModule::ProcessTXDArchive(
     bool generateMipmaps, rw::eMipmapGenerationMode mipGenMode, rw::uint32 mipGenMaxLevel,
     bool improveFiltering,
     bool doCompress, float compressionQuality,
-    bool outputDebug, CFileTranslator *debugRoot,
+    bool outputDebug, CFileTranslator *debugRoot, std::mutex& lockFileSystem,
     const rw::LibraryVersion& gameVersion,
     std::string& errMsg
 ) const
@@ -137,8 +137,12 @@ bool TxdGenModule::ProcessTXDArchive(
                                     std::wstring srcPath = srcStream->GetPath().convert_unicode();
 
                                     filePath relSrcPath;
+                                    bool hasRelSrcPath;
+                                    {
+                                        std::lock_guard <std::mutex> ctxFileSystem( lockFileSystem );
 
-                                    bool hasRelSrcPath = srcRoot->GetRelativePathFromRoot( srcPath.c_str(), true, relSrcPath );
+                                        hasRelSrcPath = srcRoot->GetRelativePathFromRoot( srcPath.c_str(), true, relSrcPath );
+                                    }
 
                                     if ( hasRelSrcPath )
                                     {
@@ -151,7 +155,12 @@ bool TxdGenModule::ProcessTXDArchive(
                                         {
                                             filePath uniqueTextureNameTGA = directoryPart + fileNamePart + "_" + filePath( theTexture->GetName().c_str() ) + ".tga";
 
-                                            CFile *debugOutputStream = debugRoot->Open( uniqueTextureNameTGA, "wb" );
+                                            CFile *debugOutputStream;
+                                            {
+                                                std::lock_guard <std::mutex> ctxFileSystem( lockFileSystem );
+
+                                                debugOutputStream = debugRoot->Open( uniqueTextureNameTGA, "wb" );
+                                            }
 
                                             if ( debugOutputStream )
                                             {
@@ -370,7 +379,7 @@ struct _discFileSentry_txdgen
     inline bool OnSingletonFile(
         CFileTranslator *sourceRoot, CFileTranslator *buildRoot, const filePath& relPathFromRoot,
         const filePath& fileName, const filePath& extention, CFile *sourceStream,
-        bool isInArchive
+        bool isInArchive, std::mutex& lockFileSystem
     )
     {
         // If we are asked to terminate, just do it.
@@ -391,6 +400,8 @@ struct _discFileSentry_txdgen
 
         if ( requiresCopy )
         {
+            std::lock_guard <std::mutex> ctxFileSystem( lockFileSystem );
+
             targetStream = buildRoot->Open( relPathFromRoot, L"wb" );
         }
 
@@ -411,7 +422,7 @@ struct _discFileSentry_txdgen
                         this->generateMipmaps, this->mipGenMode, this->mipGenMaxLevel,
                         this->improveFiltering,
                         this->doCompress, this->compressionQuality,
-                        this->outputDebug, this->debugTranslator,
+                        this->outputDebug, this->debugTranslator, lockFileSystem,
                         this->gameVersion,
                         errorMessage
                     );
@@ -596,6 +607,10 @@ TxdGenModule::run_config TxdGenModule::ParseConfig( CFileTranslator *root, const
                     {
                         cfg.c_palRuntimeType = rw::PALRUNTIME_PNGQUANT;
                     }
+                    else if ( stricmp( palRuntimeType, "mediancut" ) == 0 )
+                    {
+                        cfg.c_palRuntimeType = rw::PALRUNTIME_MEDIANCUT;
+                    }
                 }
 
                 // DXT compression method.
@@ -837,6 +852,10 @@ bool TxdGenModule::ApplicationMain( const run_config& cfg )
         {
             strPalRuntimeType = "pngquant";
         }
+        else if ( actualPalRuntimeType == rw::PALRUNTIME_MEDIANCUT )
+        {
+            strPalRuntimeType = "mediancut";
+        }
 
         this->OnMessage(
             std::string( "* palRuntimeType: " ) + strPalRuntimeType + "\n"
@@ -943,8 +962,8 @@ bool TxdGenModule::ApplicationMain( const run_config& cfg )
 
                     fileProc.process( &sentry, absGameRootTranslator, absOutputRootTranslator );
 
-                    // Output any warnings.
-                    _warningMan.Purge();
+                    // Output any warnings, also the ones of threads that did not report them yet.
+                    _warningMan.Purge( true );
                 }
                 catch( ... )
                 {
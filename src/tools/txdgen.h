@@ -3,6 +3,10 @@
 
 #include "shared.h"
 
+#include <map>
+#include <mutex>
+#include <thread>
+
 class TxdGenModule : public MessageReceiver
 {
 public:
@@ -66,7 +70,7 @@ public:
         bool generateMipmaps, rw::eMipmapGenerationMode mipGenMode, rw::uint32 mipGenMaxLevel,
         bool improveFiltering,
         bool doCompress, float compressionQuality,
-        bool outputDebug, CFileTranslator *debugRoot,
+        bool outputDebug, CFileTranslator *debugRoot, std::mutex& lockFileSystem,
         const rw::LibraryVersion& gameVersion,
         std::string& errMsg
     ) const;
@@ -76,13 +80,48 @@ public:
         return this->rwEngine;
     }
 
+    // Files can be processed on more than one thread, so every thread collects its own warnings.
+    // That way they are reported together with the file that caused them.
     struct RwWarningBuffer : public rw::WarningManagerInterface
     {
         TxdGenModule *module;
-        std::string buffer;
 
-        void Purge( void )
+        std::mutex lock;
+        std::map <std::thread::id, std::string> buffers;
+
+        void Purge( bool allThreads = false )
         {
+            std::string buffer;
+            {
+                std::lock_guard <std::mutex> ctxBuffers( this->lock );
+
+                if ( allThreads )
+                {
+                    for ( auto& threadBuffer : this->buffers )
+                    {
+                        if ( !buffer.empty() )
+                        {
+                            buffer += '\n';
+                        }
+
+                        buffer += threadBuffer.second;
+                    }
+
+                    this->buffers.clear();
+                }
+                else
+                {
+                    auto iter = this->buffers.find( std::this_thread::get_id() );
+
+                    if ( iter != this->buffers.end() )
+                    {
+                        buffer = std::move( iter->second );
+
+                        this->buffers.erase( iter );
+                    }
+                }
+            }
+
             // Output the content to the stream.
             if ( !buffer.empty() )
             {
@@ -91,13 +130,15 @@ public:
                 buffer += "\n";
 
                 module->OnMessage( buffer );
-
-                buffer.clear();
             }
         }
 
         virtual void OnWarning( std::string&& message ) override
         {
+            std::lock_guard <std::mutex> ctxBuffers( this->lock );
+
+            std::string& buffer = this->buffers[ std::this_thread::get_id() ];
+
             if ( !buffer.empty() )
             {
                 buffer += '\n';
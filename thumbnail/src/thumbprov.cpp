@@ -5,17 +5,17 @@
 RenderWareThumbnailProvider::RenderWareThumbnailProvider( void ) : refCount( 1 )
 {
     this->isInitialized = false;
-    this->thumbObj = NULL;
+    this->thumbStream = NULL;
 
     module_refCount++;
 }
 
 RenderWareThumbnailProvider::~RenderWareThumbnailProvider( void )
 {
-    // If we have a RenderWare object, free it.
-    if ( rw::RwObject *rwObj = this->thumbObj )
+    // If we kept the stream, release it.
+    if ( IStream *thumbStream = this->thumbStream )
     {
-        rwEngine->DeleteRwObject( rwObj );
+        thumbStream->Release();
     }
 
     // TODO: this is actually crap, because after this operation we also have to execute code, anyway.
@@ -81,86 +81,23 @@ IFACEMETHODIMP RenderWareThumbnailProvider::Initialize( IStream *pStream, DWORD
     if ( this->isInitialized )
         return HRESULT_FROM_WIN32(ERROR_ALREADY_INITIALIZED);
 
-    try
-    {
-        // We decide to handle the thing over here.
-        // So we want to read the RenderWare object.
-        rw::Stream *rwStream = RwStreamCreateFromWin32( rwEngine, pStream );
-
-        if ( rwStream )
-        {
-            try
-            {
-                this->thumbObj = rwEngine->Deserialize( rwStream );
-            }
-            catch( ... )
-            {
-                // We failed for some reason.
-            }
+    // We only know the thumbnail size once we are asked for it.
+    // So keep the stream and read just what we need from it later.
+    pStream->AddRef();
 
-            rwEngine->DeleteStream( rwStream );
-        }
+    this->thumbStream = pStream;
 
-        this->isInitialized = true;
+    this->isInitialized = true;
 
-        return S_OK;
-    }
-    catch( ... )
-    {
-        // Shit.
-        return E_FAIL;
-    }
-}
-
-static void adjustToMaxDimm( rw::uint32 width, rw::uint32 height, rw::uint32 maxDimm, rw::uint32& recWidth, rw::uint32& recHeight )
-{
-    if ( width > maxDimm )
-    {
-        double aspectRatio = (double)height / (double)width;
-
-        width = maxDimm;
-        height = (rw::uint32)( (double)width * aspectRatio );
-    }
-    
-    if ( height > maxDimm )
-    {
-        double aspectRatio = (double)width / (double)height;
-
-        height = maxDimm;
-        width = (rw::uint32)( (double)height * aspectRatio );
-    }
-
-    recWidth = width;
-    recHeight = height;
+    return S_OK;
 }
 
-struct bitmapPixel
-{
-    unsigned char b, g, r, a;
-};
-
-static HRESULT rasterToHBITMAP( rw::Raster *raster, rw::uint32 bmpWidth, rw::uint32 bmpHeight, HBITMAP *pBitmap, bool& hasAlphaOut )
+static HRESULT thumbnailToHBITMAP( const rw::textureThumbnail& thumb, HBITMAP *pBitmap )
 {
-    rw::Bitmap pixelData = raster->getBitmap();
-
-    // We should scale the bitmap.
-    pixelData.scale( rwEngine, bmpWidth, bmpHeight );
-
-    // We want to encode as 32bit HBITMAP.
-    rw::uint32 width, height;
-    pixelData.getSize( width, height );
-
-    const size_t memSize = sizeof( bitmapPixel ) * width * height;
-
-    void *mem = malloc( memSize );
-
-    if ( !mem )
-        return E_OUTOFMEMORY;
-
     BITMAPINFO bmi;
     bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = width;
-    bmi.bmiHeader.biHeight = -(LONG)height;
+    bmi.bmiHeader.biWidth = thumb.width;
+    bmi.bmiHeader.biHeight = -(LONG)thumb.height;
     bmi.bmiHeader.biPlanes = 1;
     bmi.bmiHeader.biBitCount = 32;
     bmi.bmiHeader.biCompression = 0;
@@ -170,152 +107,78 @@ static HRESULT rasterToHBITMAP( rw::Raster *raster, rw::uint32 bmpWidth, rw::uin
     bmi.bmiHeader.biClrUsed = 0;
     bmi.bmiHeader.biClrImportant = 0;
 
-    // Fill colors.
-    bool hasAlpha = false;
-
-    void *colorStart = mem;
-
-    try
-    {
-        for ( rw::uint32 y = 0; y < height; y++ )
-        {
-            for ( rw::uint32 x = 0; x < width; x++ )
-            {
-                bitmapPixel *pix = (bitmapPixel*)colorStart + y * width + x;
-
-                rw::uint8 r, g, b, a;
-
-                bool gotColor = pixelData.browsecolor( x, y, r, g, b, a );
-
-                if ( !gotColor )
-                {
-                    r = 0;
-                    g = 0;
-                    b = 0;
-                    a = 255;
-                }
-
-                if ( a != 255 )
-                {
-                    hasAlpha = true;
-                }
-
-                pix->r = r;
-                pix->g = g;
-                pix->b = b;
-                pix->a = a;
-            }
-        }
-    }
-    catch( ... )
-    {
-        free( mem );
-
-        throw;
-    }
-
     // Create the bitmap!
+    // The thumbnail texels already are in the 32bit BGRA layout of a DIB.
     void *ppv;
 
     HBITMAP resBmp = CreateDIBSection( NULL, &bmi, DIB_RGB_COLORS, &ppv, NULL, 0 );
 
-    if ( resBmp )
-    {
-        SetDIBits( NULL, resBmp, 0, height, colorStart, &bmi, DIB_RGB_COLORS );
-    }
-
-    free( mem );
-
     if ( !resBmp )
         return S_FALSE;
 
+    SetDIBits( NULL, resBmp, 0, thumb.height, thumb.texels.data(), &bmi, DIB_RGB_COLORS );
+
     // Give the result HBITMAP to the runtime.
     *pBitmap = resBmp;
-    hasAlphaOut = hasAlpha;
-
-    // We do not know about alpha.
 
     return S_OK;
 }
 
-static HRESULT generateRasterPreviewHBITMAP( UINT cx, rw::Raster *texRaster, HBITMAP *pBitmap, WTS_ALPHATYPE *pAlphaType )
+IFACEMETHODIMP RenderWareThumbnailProvider::GetThumbnail( UINT cx, HBITMAP *pBitmap, WTS_ALPHATYPE *pAlphaType )
 {
-    // So we want to turn this into an experimental HBITMAP.
-    // Lets do it!
-    // First determine the final size that it should have.
-    rw::uint32 width, height;
-    texRaster->getSize( width, height );
-
-    rw::uint32 recWidth, recHeight;
-    {
-        adjustToMaxDimm( width, height, cx, recWidth, recHeight );
-    }
+    if ( !this->isInitialized )
+        return S_FALSE;
 
-    rw::Raster *srcRaster = rw::AcquireRaster( texRaster );
+    IStream *thumbStream = this->thumbStream;
 
-    HRESULT res;
+    if ( !thumbStream )
+        return S_FALSE;
 
     try
     {
-        // Do stuff.
-        bool hasAlpha = false;
-        HBITMAP bmp;
+        // Read from the start, in case we are asked more than once.
+        LARGE_INTEGER streamBegin;
+        streamBegin.QuadPart = 0;
 
-        res = rasterToHBITMAP( srcRaster, recWidth, recHeight, &bmp, hasAlpha );
+        thumbStream->Seek( streamBegin, STREAM_SEEK_SET, NULL );
 
-        if ( res == S_OK )
-        {
-            *pBitmap = bmp;
-            *pAlphaType = ( hasAlpha ? WTSAT_ARGB : WTSAT_RGB );
-        }
-    }
-    catch( ... )
-    {
-        rw::DeleteRaster( srcRaster );
+        rw::Stream *rwStream = RwStreamCreateFromWin32( rwEngine, thumbStream );
 
-        throw;
-    }
+        if ( rwStream )
+        {
+            // Only decode the first texture, at the mipmap level closest to the requested size.
+            rw::textureThumbnail thumb;
+            bool gotThumbnail = false;
 
-    // Clean up.
-    rw::DeleteRaster( srcRaster );
+            try
+            {
+                gotThumbnail = rw::ReadTextureThumbnail( rwEngine, rwStream, cx, cx, thumb );
+            }
+            catch( ... )
+            {
+                rwEngine->DeleteStream( rwStream );
 
-    return res;
-}
+                throw;
+            }
 
-IFACEMETHODIMP RenderWareThumbnailProvider::GetThumbnail( UINT cx, HBITMAP *pBitmap, WTS_ALPHATYPE *pAlphaType )
-{
-    if ( !this->isInitialized )
-        return S_FALSE;
+            rwEngine->DeleteStream( rwStream );
 
-    // We can always have no TXD available.
-    if ( rw::RwObject *thumbObj = this->thumbObj )
-    {
-        try
-        {
-            // It all depends on the kind of object we have!
-            if ( rw::TexDictionary *txd = rw::ToTexDictionary( rwEngine, thumbObj ) )
+            if ( gotThumbnail )
             {
-                // As a test, return the first raster of the TXD.
-                if ( rw::TextureBase *texHandle = GetFirstTexture( txd ) )
-                {
-                    if ( rw::Raster *texRaster = texHandle->GetRaster() )
-                    {
-                        return generateRasterPreviewHBITMAP( cx, texRaster, pBitmap, pAlphaType );
-                    }
-                }
-            }
-            else if ( rw::TextureBase *texHandle = rw::ToTexture( rwEngine, this->thumbObj ) )
-            {
-                if ( rw::Raster *texRaster = texHandle->GetRaster() )
+                HRESULT res = thumbnailToHBITMAP( thumb, pBitmap );
+
+                if ( res == S_OK )
                 {
-                    return generateRasterPreviewHBITMAP( cx, texRaster, pBitmap, pAlphaType );
+                    *pAlphaType = ( thumb.hasAlpha ? WTSAT_ARGB : WTSAT_RGB );
                 }
+
+                return res;
             }
         }
-        catch( ... )
-        {
-            // Ignore any kind of runtime error we could encounter.
-        }
+    }
+    catch( ... )
+    {
+        // Ignore any kind of runtime error we could encounter.
     }
 
     return S_FALSE;
@@ -19,5 +19,5 @@ private:
 
     std::atomic <unsigned long> refCount;
 
-    rw::RwObject *thumbObj;
+    IStream *thumbStream;
 };
\ No newline at end of file